@@ -1,5 +1,6 @@
 import logging
 import datetime
+import time
 from ..models import Consultation, ConsultationStatus, get_db
 from ..utils.mqtt_utils import publish_consultation_request, publish_mqtt_message
 from ..utils.mqtt_topics import MQTTTopics
@@ -158,7 +159,9 @@ class ConsultationController:
                 'request_message': consultation.request_message,
                 'course_code': consultation.course_code,
                 'status': consultation.status.value,
-                'requested_at': consultation.requested_at.isoformat() if consultation.requested_at else None
+                'requested_at': consultation.requested_at.isoformat() if consultation.requested_at else None,
+                # Epoch ms at publish; desk units echo it back with their own hop timestamps
+                'sent_at_ms': int(time.time() * 1000)
             }
 
             logger.info(f"Publishing consultation request {consultation.id} for faculty {faculty.id} using async MQTT")
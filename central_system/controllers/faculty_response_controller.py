@@ -110,6 +110,7 @@ class FacultyResponseController:
             faculty_name = response_data.get('faculty_name', 'Unknown')
 
             logger.info(f"Received {response_type} response from faculty {faculty_id} ({faculty_name}) for message {message_id}")
+            self._log_response_latency(message_id, response_data)
 
             # Process the response
             success = self._process_faculty_response(response_data)
@@ -177,6 +178,29 @@ class FacultyResponseController:
         except Exception as e:
             logger.debug(f"Error processing faculty heartbeat: {str(e)}")
 
+    def _log_response_latency(self, message_id, response_data: Dict[str, Any]):
+        """
+        Log the per-hop latency a desk unit reports alongside its response.
+
+        Args:
+            message_id: Consultation the response belongs to
+            response_data (dict): Response with the unit's trace fields
+        """
+        hops = []
+        if 'transit_ms' in response_data:
+            hops.append(f"transit {response_data['transit_ms']}ms")
+        if 'render_ms' in response_data:
+            hops.append(f"render {response_data['render_ms']}ms")
+        if 'response_ms' in response_data:
+            hops.append(f"faculty {response_data['response_ms']}ms")
+
+        responded_at = response_data.get('responded_at_ms')
+        if responded_at:
+            hops.append(f"return {int(datetime.now().timestamp() * 1000) - responded_at}ms")
+
+        if hops:
+            logger.info(f"Latency for message {message_id}: {', '.join(hops)}")
+
     def _process_faculty_response(self, response_data: Dict[str, Any]) -> bool:
         """
         Process faculty response and update consultation status.
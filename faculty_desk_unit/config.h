@@ -8,6 +8,8 @@
 // Added: Grace Period functionality for reliable BLE presence detection
 
 // === FACULTY INFORMATION ===
+// Defaults for the whole image. A unit provisioned over MQTT keeps its own
+// identity in NVS instead (see UNIT PROVISIONING), so one build serves the fleet.
 #define FACULTY_ID 1
 #define FACULTY_NAME "Dave Jomillo"
 #define FACULTY_DEPARTMENT "Helpdesk"
@@ -36,6 +38,14 @@
 #define BLE_SCAN_DURATION_QUICK 1             // Short scan when monitoring
 #define BLE_SCAN_DURATION_FULL 3              // Full scan when searching
 
+// Night profile: slower scanning outside office hours. These and the values
+// above form the default scan policy; the scan_policy topic can override them.
+#define SCAN_DAY_START_MINUTE (7 * 60)          // 07:00 local time
+#define SCAN_NIGHT_START_MINUTE (19 * 60)       // 19:00 local time
+#define BLE_NIGHT_INTERVAL_SEARCHING 10000
+#define BLE_NIGHT_INTERVAL_MONITORING 20000
+#define BLE_NIGHT_INTERVAL_CONFIDENT 60000
+
 // State confirmation timings
 #define PRESENCE_CONFIRM_TIME 6000            // Time to confirm presence change
 #define ABSENCE_CONFIRM_TIME 15000            // Time to confirm absence
@@ -43,6 +53,18 @@
 // Performance monitoring
 #define BLE_STATS_REPORT_INTERVAL 60000      // Report stats every minute
 
+// Non-blocking scanning
+#define BLE_NONBLOCKING_SCAN true             // Scan in the background, results via onResult callback
+#define BLE_SCAN_COMPLETE_GRACE_MS 1000       // Extra time before an unfinished scan window is stopped
+
+// Radio duty cycle and advertisement filtering
+#define BLE_RADIO_SCAN_INTERVAL_MS 100        // Scan interval within a window
+#define BLE_RADIO_SCAN_WINDOW_MS 99           // Listening time per interval
+#define BLE_PASSIVE_SCAN true                 // No scan requests; the advertisement has all that is needed
+#define BLE_CONTROLLER_FILTER false           // Controller whitelist + duplicate filter: the host only
+                                              // hears registered beacons, one report per window.
+                                              // Beacons must use public addresses.
+
 // === GRACE PERIOD SETTINGS (NEW - JEYSIBN'S SUGGESTION) ===
 #define BLE_GRACE_PERIOD_MS 60000              // 1 minute grace period before status change
 #define BLE_RECONNECT_ATTEMPT_INTERVAL 5000    // Try reconnecting every 5 seconds
@@ -50,11 +72,22 @@
 #define BLE_FAST_RECONNECT_INTERVAL 2000       // Faster attempts in first 20 seconds
 #define BLE_SIGNAL_STRENGTH_THRESHOLD -80      // Minimum RSSI to accept signal
 
+// === RSSI FILTERING & DISTANCE ===
+// Each beacon's per-window best RSSI runs through a Kalman filter
+#define BLE_RSSI_HYSTERESIS_DB 6               // In range at the threshold, out only this far below it
+#define BLE_BEACON_TX_POWER_1M -59             // Beacon RSSI at 1 m, for distance estimates
+#define BLE_PATH_LOSS_EXPONENT_X10 25          // Path loss exponent x10: 20 free space, 30+ cluttered
+#define BLE_SCAN_INTERVAL_CONFIDENT 15000      // Monitoring interval while the signal is well in range
+
 // === WIFI CONFIGURATION ===
 #define WIFI_SSID "Je"
 #define WIFI_PASSWORD "qazxcvbnm"
 #define WIFI_CONNECT_TIMEOUT 20000
 #define WIFI_RECONNECT_INTERVAL 5000
+#define WIFI_FAST_CONNECT true               // Rejoin the last AP on its channel, reusing a recent lease
+#define WIFI_FAST_CONNECT_TIMEOUT 3000       // Then fall back to a full scan with DHCP
+#define WIFI_LEASE_REUSE_S 3600              // Keep below the DHCP server's lease time
+#define WIFI_CONNECT_POLL_MS 50
 
 // === MQTT CONFIGURATION ===
 #define MQTT_SERVER "192.168.1.100"
@@ -63,18 +96,59 @@
 #define MQTT_PASSWORD "desk_password"
 #define MQTT_KEEPALIVE 60
 #define MQTT_QOS 1
-#define MQTT_CLIENT_ID "Faculty_Desk_Unit_1"
+#define MQTT_BUFFER_SIZE (WIRE_PAYLOAD_BUFFER_SIZE + 128)  // One payload plus topic and header; PubSubClient defaults to 256
+
+// === MQTT BROKER FAILOVER ===
+// MQTT_SERVER is the primary; standbys are tried while it backs off, and the
+// unit moves back once the primary has been healthy for a while
+#define MQTT_STANDBY_BROKERS ""              // "host:port,host,ip:port@name" - no port: MQTT_PORT; @name: TLS certificate name
+#define MQTT_TCP_CONNECT_TIMEOUT_MS 1500     // Per attempt, so a dead broker is left quickly
+#define MQTT_CONNACK_TIMEOUT_S 3             // PubSubClient socket timeout, also bounds the CONNACK wait
+
+// === MQTT TLS ===
+// Certificates are PEM string literals: they stay in flash and are parsed
+// once. Reconnects resume the last TLS session instead of a full handshake.
+#define MQTT_USE_TLS false                   // Set MQTT_PORT to 8883 as well
+#define MQTT_TLS_SERVER_NAME ""              // Name on the primary's certificate when MQTT_SERVER is an IP
+#define MQTT_TLS_CA_CERT ""                  // Broker CA; required with TLS
+#define MQTT_TLS_CLIENT_CERT ""              // Client certificate and key, for mutual TLS only
+#define MQTT_TLS_CLIENT_KEY ""
 
 // === MQTT TOPICS ===
-// Standardized format matching central system
-#define MQTT_TOPIC_STATUS "consultease/faculty/1/status"
-#define MQTT_TOPIC_MESSAGES "consultease/faculty/1/messages"
-#define MQTT_TOPIC_HEARTBEAT "consultease/faculty/1/heartbeat"
-#define MQTT_TOPIC_RESPONSES "consultease/faculty/1/responses"
-
-// Legacy topics for backward compatibility
-#define MQTT_LEGACY_STATUS "faculty/1/status"
-#define MQTT_LEGACY_MESSAGES "faculty/1/messages"
+// Built at boot from the unit's faculty ID, standardized format matching the
+// central system (src/optimizations/unit_config.h):
+//   consultease/faculty/<id>/status, messages, heartbeat, metrics (hot-path
+//   latency percentiles), responses, wire_format (retained per-topic
+//   encoding), beacons (retained colleague beacons, {"MAC":faculty_id}) and
+//   scan_policy (retained scan timing overrides)
+//   faculty/<id>/status and faculty/<id>/messages for backward compatibility
+// The MQTT client ID is Faculty_Desk_Unit_<id>.
+
+// === UNIT PROVISIONING ===
+// A retained message on consultease/provision/<chip MAC> (12 hex digits, as
+// printed at boot) stores this unit's identity in NVS, e.g.
+// {"faculty_id":3,"faculty_name":"Prof. Robert Chen","department":"Computer Science",
+//  "beacon_mac":"AA:BB:CC:DD:EE:03"}. The unit restarts into it at the next
+// quiet moment; an empty identity returns it to the FACULTY_* defaults.
+// Messages must be signed with UNIT_PROVISIONING_KEY (HMAC-SHA256, see
+// config_templates/unit_configuration_guide.md); anything else is ignored.
+// Off by default: enable it only with a fleet key set.
+#define UNIT_PROVISIONING_ENABLED false
+#define UNIT_PROVISIONING_KEY ""             // Fleet secret, 16+ characters; keep it off the broker
+
+// === PUBLISH RATE CONTROL ===
+#define PRESENCE_COALESCE_WINDOW_MS 2000     // Presence transitions within this window publish once
+#define STATUS_BUCKET_CAPACITY 3             // Status publishes allowed in a burst
+#define STATUS_BUCKET_REFILL_MS 20000        // One status publish regained per interval
+#define HEARTBEAT_BUCKET_CAPACITY 2          // Heartbeat topic publishes allowed in a burst
+#define HEARTBEAT_BUCKET_REFILL_MS 60000     // One heartbeat topic publish regained per interval
+#define HEARTBEAT_FULL_EVERY 12              // Every Nth heartbeat repeats all fields (hourly)
+#define HEARTBEAT_HEAP_DELTA 4096            // free_heap is re-reported once it moves this far
+
+// === WIRE FORMAT ===
+#define WIRE_FORMAT_CBOR_ENABLED true        // Advertise CBOR in heartbeats and honour the wire_format topic
+#define WIRE_PAYLOAD_BUFFER_SIZE 1024        // One encoded payload (response + trace)
+#define NETWORK_SCRATCH_SIZE 2048            // Per-pass arena for network temporaries (two payloads)
 
 // === BUTTON CONFIGURATION ===
 #define BUTTON_A_PIN 15               // Blue button (Acknowledge)
@@ -86,8 +160,14 @@
 #define TFT_CS 5
 #define TFT_RST 22
 #define TFT_DC 21
+#define TFT_MOSI 23                          // VSPI defaults, used by the DMA driver
+#define TFT_SCLK 18
+#define TFT_BL -1                            // Backlight (BLK) GPIO, -1 if wired to 3.3V
+#define TFT_SPI_FREQUENCY 40000000
 #define SCREEN_WIDTH 320
 #define SCREEN_HEIGHT 240
+#define DISPLAY_PARTIAL_REDRAW true          // Push only changed 40x40 tiles via a strip buffer
+#define DISPLAY_STRIP_LINES 20               // Lines per DMA strip (2 strips x 12.8KB)
 
 // === SIMPLIFIED UI LAYOUT ===
 #define TOP_PANEL_HEIGHT 30
@@ -145,12 +225,17 @@
 #define TIME_ZONE_OFFSET 8               // GMT+8 for Philippines
 #define NTP_UPDATE_INTERVAL 7200000      // 2 hours in milliseconds
 #define NTP_SYNC_TIMEOUT 10000           // 10 seconds timeout for NTP sync
+#define NTP_PERIODIC_CHECK_MS 2000       // Periodic resync is checked this long after it starts
 #define NTP_RETRY_INTERVAL 30000         // 30 seconds between retry attempts
 #define NTP_MAX_RETRIES 3                // Maximum retry attempts
 
 // === SYSTEM TIMING CONSTANTS ===
 #define MESSAGE_DISPLAY_TIMEOUT 30000        // Auto-clear messages after 30s
 #define HEARTBEAT_INTERVAL 300000            // Send heartbeat every 5 minutes
+#define METRICS_PUBLISH_INTERVAL 300000      // Profiler histogram window
+#define ENABLE_METRICS_EXPORT true
+#define MEMORY_SAMPLE_INTERVAL 30000         // Heap free/largest-block sampling
+#define MEMORY_PRESSURE_CACHE_BYTES 4096     // Text cache budget while memory is under pressure
 #define STATUS_UPDATE_INTERVAL 10000         // Update system status every 10s
 #define TIME_UPDATE_INTERVAL 5000            // Update time display every 5s
 #define CONFIRMATION_DISPLAY_TIME 2000       // Show response confirmation for 2s
@@ -158,6 +243,8 @@
 
 // === SYSTEM LIMITS ===
 #define MAX_MESSAGE_LENGTH 512               // Prevent buffer overflow
+#define MESSAGE_CHARS_PER_LINE 40            // Size-1 text columns in the message card
+#define MESSAGE_LINES_PER_PAGE 5             // Message lines shown per page
 #define JSON_BUFFER_SIZE 1024                // For MQTT message construction
 #define MAX_WIFI_RETRY_COUNT 10              // Maximum WiFi connection retries
 #define MAX_MQTT_RETRY_COUNT 5               // Maximum MQTT connection retries
@@ -166,20 +253,52 @@
 #define ENABLE_OFFLINE_MODE true
 #define MAX_QUEUED_MESSAGES 20               // Maximum incoming messages to queue
 #define MAX_QUEUED_RESPONSES 10              // Maximum responses to queue when offline
+#define OFFLINE_RESPONSE_STORE_SIZE 5120     // Shared payload bytes for queued responses (~480 each, 930 max)
 #define MAX_QUEUED_STATUS_UPDATES 15         // Maximum status updates to queue
 #define MESSAGE_RETRY_ATTEMPTS 3             // Retry attempts for failed messages
 #define MESSAGE_RETRY_INTERVAL 5000          // Interval between retry attempts
-#define OFFLINE_STORAGE_SIZE 4096            // EEPROM storage for persistence
-#define MESSAGE_PERSISTENCE_ENABLED true     // Enable EEPROM message persistence
+#define OFFLINE_STORAGE_SIZE 8192            // Flash log size (bytes) that triggers compaction
+#define MESSAGE_PERSISTENCE_ENABLED true     // Persist queued responses to a LittleFS log
+#define OFFLINE_LOG_PATH "/offline_queue.log"
+#define OFFLINE_LOG_FLUSH_INTERVAL 2000      // Batch interval for flash log writes
 #define SYNC_RETRY_INTERVAL 30000            // Interval for sync retry attempts
 #define QUEUE_CLEANUP_INTERVAL 60000         // Clean expired messages every minute
 #define MESSAGE_EXPIRY_TIME 300000           // Messages expire after 5 minutes
 #define OFFLINE_HEARTBEAT_INTERVAL 60000     // Heartbeat when offline (1 minute)
+#define OFFLINE_STATUS_SLOTS (BEACON_REGISTRY_CAPACITY + 3)  // Every tracked faculty, plus own status, legacy status and heartbeat
+#define OFFLINE_STATUS_PAYLOAD_SIZE 384      // Per status slot; presence and heartbeat stay near 200
+#define OFFLINE_FLUSH_BUDGET_MS 50           // Max time per update cycle spent flushing the queue
 
 // === POWER MANAGEMENT ===
 #define ENABLE_POWER_MANAGEMENT true
-#define CPU_FREQ_NORMAL 240
-#define CPU_FREQ_POWER_SAVE 80
+#define CPU_FREQ_NORMAL 240                  // Dynamic frequency ceiling
+#define CPU_FREQ_POWER_SAVE 80               // Floor while the measured load allows
+#define CPU_LOAD_SAMPLE_INTERVAL 5000        // Scheduler load sampling for the CPU clock
+#define SCHEDULER_STATS_REPORT_INTERVAL 300000  // Per-timer run time / lateness dump
+#define ENABLE_AWAY_LIGHT_SLEEP true         // Automatic light sleep while AWAY; MQTT data and buttons wake it
+#define LIGHT_SLEEP_AWAY_DELAY_MS 60000      // Stay fully awake this long after the faculty leaves
+#define LIGHT_SLEEP_MAX_MS (MQTT_KEEPALIVE * 1000UL / 4)  // Network keepalive poll while light sleep is allowed
+#define LIGHT_SLEEP_LOOP_POLL_MS 3000        // Same in loop() mode, which has no socket wake
+
+// === TASK RUNTIME (DUAL CORE) ===
+#define ENABLE_TASK_RUNTIME true             // false = everything in loop(), still event-driven
+#define BLE_TASK_CORE 0                      // Shares core 0 with the Bluetooth controller
+#define NETWORK_TASK_CORE 1
+#define UI_TASK_CORE 1
+#define BLE_TASK_PRIORITY 2
+#define NETWORK_TASK_PRIORITY 1
+#define UI_TASK_PRIORITY 3                   // Preempts network work on the shared core
+#define BLE_TASK_STACK_SIZE 4096
+#define NETWORK_TASK_STACK_SIZE 8192
+#define UI_TASK_STACK_SIZE 6144
+#define SOCKET_WAKE_TASK_STACK_SIZE 2048  // Only waits in select() and posts a request
+#define NETWORK_TASK_PERIOD_MS 10            // WiFi/MQTT socket poll
+#define LOOP_NETWORK_POLL_MS 100             // Same, when loop() runs everything
+#define BUTTON_IDLE_POLL_MS 1000             // Fallback poll between button interrupts
+#define INBOX_SERVICE_INTERVAL 1000          // Message expiry check
+#define UI_EVENT_QUEUE_LENGTH 8
+#define NETWORK_QUEUE_LENGTH 4               // Also the size of the request block pool
+#define NETWORK_QUEUE_SEND_TIMEOUT_MS 50
 
 // === DEBUG SETTINGS ===
 #define ENABLE_SERIAL_DEBUG true
@@ -214,11 +333,7 @@
 inline bool validateConfiguration() {
   bool valid = true;
 
-  // MAC address validation
-  if (strlen(FACULTY_BEACON_MAC) != 17) {
-    DEBUG_PRINTLN("ERROR: FACULTY_BEACON_MAC must be 17 characters");
-    valid = false;
-  }
+  // FACULTY_BEACON_MAC is checked when the sketch compiles
 
   // WiFi validation
   if (strlen(WIFI_SSID) == 0) {
@@ -251,8 +366,8 @@ inline bool validateConfiguration() {
   }
 
   // Display pin validation
-  int displayPins[] = {TFT_CS, TFT_RST, TFT_DC};
-  for (int i = 0; i < 3; i++) {
+  int displayPins[] = {TFT_CS, TFT_RST, TFT_DC, TFT_BL};
+  for (int i = 0; i < 4; i++) {
     if (displayPins[i] == BUTTON_A_PIN || displayPins[i] == BUTTON_B_PIN) {
       DEBUG_PRINTLN("ERROR: Display pin conflicts with button pin");
       valid = false;
@@ -12,20 +12,68 @@
 #include <BLEDevice.h>
 #include <BLEScan.h>
 #include <BLEAdvertisedDevice.h>
+#include <esp_gap_ble_api.h>
+#include <esp_sleep.h>
+#include <driver/gpio.h>
+#include <hal/gpio_ll.h>
+#include <esp_pm.h>
+#include <lwip/sockets.h>
 #include <Adafruit_GFX.h>
 #include <Adafruit_ST7789.h>
 #include <SPI.h>
+#include <LittleFS.h>
+#include <Preferences.h>
 #include <time.h>
+#include <sys/time.h>
 #include "config.h"
+#include "src/optimizations/enhanced_messaging.h"
+#include "src/optimizations/wire_format.h"
+#include "src/optimizations/beacon_registry.h"
+#include "src/optimizations/rssi_filter.h"
+#include "src/optimizations/scan_policy.h"
+#include "src/optimizations/event_scheduler.h"
+#include "src/optimizations/performance_optimization.h"
+#include "src/optimizations/memory_optimization.h"
+#include "src/optimizations/tls_session.h"
+#include "src/optimizations/broker_pool.h"
+#include "src/optimizations/unit_config.h"
+#if UNIT_PROVISIONING_ENABLED
+#include "src/optimizations/security_enhancements.h"
+#endif
 
 // ================================
 // GLOBAL OBJECTS
 // ================================
+#if MQTT_USE_TLS
+TLSSessionClient wifiClient;
+#else
 WiFiClient wifiClient;
+#endif
 PubSubClient mqttClient(wifiClient);
-Adafruit_ST7789 tft = Adafruit_ST7789(TFT_CS, TFT_DC, TFT_RST);
+HardwareConfig displayHardware;                    // Pins filled in by setupDisplay()
+ST7789Display displayPanel(&displayHardware);
 BLEScan* pBLEScan;
 
+// ================================
+// UNIT IDENTITY
+// ================================
+// config.h gives the image's default identity, checked here at compile
+// time. setup() replaces it with the NVS provisioning record when there is
+// one; everything else reads unitProfile, never the FACULTY_* macros.
+static_assert(FACULTY_ID >= 1 && FACULTY_ID <= 0xFFFF, "FACULTY_ID must be 1..65535");
+static_assert(UnitConfig::isAddress(FACULTY_BEACON_MAC) && UnitConfig::addressValue(FACULTY_BEACON_MAC) != 0,
+              "FACULTY_BEACON_MAC must look like AA:BB:CC:DD:EE:FF");
+
+constexpr UnitIdentity DEFAULT_IDENTITY = {
+  FACULTY_ID, UnitConfig::addressValue(FACULTY_BEACON_MAC), FACULTY_NAME, FACULTY_DEPARTMENT
+};
+
+static_assert(!UNIT_PROVISIONING_ENABLED || UnitConfig::textLength(UNIT_PROVISIONING_KEY) >= 16,
+              "UNIT_PROVISIONING_KEY must be set (16+ characters) to enable provisioning");
+
+UnitProfile unitProfile;
+bool identityRebootPending = false;  // A new identity is in NVS; restart at a quiet moment
+
 // ================================
 // UI AND BUTTON VARIABLES
 // ================================
@@ -36,6 +84,8 @@ bool animationState = false;
 // Button variables
 bool buttonAPressed = false;
 bool buttonBPressed = false;
+bool buttonALongPressed = false;
+bool buttonBLongPressed = false;
 unsigned long buttonALastDebounce = 0;
 unsigned long buttonBLastDebounce = 0;
 bool buttonALastState = HIGH;
@@ -44,106 +94,388 @@ bool buttonBLastState = HIGH;
 // Message variables
 bool messageDisplayed = false;
 unsigned long messageDisplayStart = 0;
-String lastReceivedMessage = "";
-String messageId = "";
+
+// Inbox: onMqttMessage() parses straight into a MessageQueue slot, so a
+// burst of requests is held without copies or heap use. The message on
+// screen is the queue's selection, which is never evicted or expired.
+const EnhancedMessage* currentMessage = nullptr;   // Message on screen
 
 // Global variables
 unsigned long lastHeartbeat = 0;
-unsigned long lastMqttReconnect = 0;
 
 bool wifiConnected = false;
 bool mqttConnected = false;
-String currentMessage = "";
-String lastDisplayedTime = "";
-String lastDisplayedDate = "";
+
+// Away power mode and light sleep totals (see AWAY LIGHT SLEEP)
+bool awayPowerMode = false;
+volatile bool lightSleepAllowed = false;   // The power manager may light-sleep the chip
+volatile bool buttonWakeArmed = false;     // Buttons are GPIO wake levels; the ISR disarms them
+unsigned long lightSleepCount = 0;         // Times light sleep was allowed
+unsigned long lightSleepMs = 0;            // Time it was allowed, closed periods only
+unsigned long lightSleepSince = 0;
+bool lightSleepSupported = true;           // Until esp_pm refuses
+esp_pm_lock_handle_t networkPmLock = nullptr;
+esp_pm_lock_handle_t displayPmLock = nullptr;
+bool networkPmLockHeld = false;            // Network context only
+bool displayPmLockHeld = false;            // UI context only
+
+// Temporaries of one network pass (payload encoding); reset at the top of
+// every pass by whichever context runs the network side
+alignas(MEMORY_BLOCK_ALIGNMENT) uint8_t networkScratchStorage[NETWORK_SCRATCH_SIZE];
+ScratchArena networkScratch(networkScratchStorage, sizeof(networkScratchStorage));
+
+// Last WiFi association for the fast reconnect path (see WIFI FAST CONNECT)
+#define WIFI_FAST_CACHE_MAGIC 0x57464331UL
+#define WIFI_FAST_CACHE_NAMESPACE "wifi_fast"
+#define WIFI_CLOCK_VALID_EPOCH 1577836800    // 2020-01-01: below this the RTC clock was never set
+
+struct WifiFastCache {
+  uint32_t magic;
+  uint8_t bssid[6];
+  uint8_t channel;
+  uint8_t reserved;
+  uint32_t ip;
+  uint32_t gateway;
+  uint32_t subnet;
+  uint32_t dns;
+  uint32_t leaseEpoch;       // When DHCP granted ip, epoch seconds; 0 = clock was not set
+  uint32_t check;
+};
+RTC_NOINIT_ATTR WifiFastCache wifiFastCache;
+bool wifiStaticLease = false;        // This connection reuses the cached lease instead of DHCP
+bool wifiAttemptFast = false;
+unsigned long wifiAttemptStart = 0;
+uint8_t wifiReconnectAttempts = 0;
+unsigned long bootOnlineMs = 0;      // Boot to first MQTT connection
+
+// Broker link, stepped by the network task (see MQTT FUNCTIONS)
+enum MqttLinkState : uint8_t {
+  MQTT_LINK_IDLE,          // Waiting out the broker pool's backoff
+  MQTT_LINK_HANDSHAKE,     // TLS only: socket open, handshake stepped each pass
+  MQTT_LINK_SESSION,       // Transport open; MQTT CONNECT on the next pass
+  MQTT_LINK_UP
+};
+BrokerPool brokerPool;
+MqttLinkState mqttLinkState = MQTT_LINK_IDLE;
+uint8_t mqttLinkBroker = BROKER_NONE;
+unsigned long mqttLinkStart = 0;
+
+// Mitigation step the UI side should apply (see MEMORY PRESSURE)
+volatile MemoryPressure uiMemoryPressure = MEMORY_PRESSURE_NONE;
+bool memoryRebootPending = false;
 
 // NTP synchronization variables
 bool ntpSyncInProgress = false;
 unsigned long lastNtpSyncAttempt = 0;
 int ntpRetryCount = 0;
-String ntpSyncStatus = "PENDING";
+enum NtpSyncState : uint8_t { NTP_SYNC_PENDING, NTP_SYNC_SYNCING, NTP_SYNC_SYNCED, NTP_SYNC_FAILED };
+const char* const NTP_SYNC_NAMES[] = { "PENDING", "SYNCING", "SYNCED", "FAILED" };  // By NtpSyncState
+volatile NtpSyncState ntpSyncState = NTP_SYNC_PENDING;  // One byte, so other tasks read it whole
 
 // ================================
-// SIMPLE OFFLINE MESSAGE QUEUE
+// OFFLINE MESSAGE QUEUE (RING BUFFER)
 // ================================
+// Faculty responses wait in a FIFO ring (O(1) push/pop, oldest dropped on
+// overflow). Presence/status updates are coalesced per topic so only the
+// newest state goes out, and always after the pending responses.
+// Response payloads vary from ~480 bytes to most of a wire buffer, so they
+// share one FIFO store at their own length; status slots are fixed and small.
 
 struct SimpleMessage {
   char topic[64];
-  char payload[512];
+  char* payload;            // Into responseStore or statusPayloads
   unsigned long timestamp;
   int retry_count;
   bool is_response;
+  uint32_t sequence;        // Response order, also used as the flash log key
 };
 
-// Queue variables
-SimpleMessage messageQueue[10];  // Adjust size as needed
-int queueCount = 0;
+// Response ring
+SimpleMessage responseQueue[MAX_QUEUED_RESPONSES];
+int responseHead = 0;       // Index of the oldest queued response
+int responseCount = 0;
+uint8_t responseStoreStorage[OFFLINE_RESPONSE_STORE_SIZE];
+FifoArena responseStore(responseStoreStorage, sizeof(responseStoreStorage));
+
+// Newest pending status update per topic
+SimpleMessage statusSlots[OFFLINE_STATUS_SLOTS];
+char statusPayloads[OFFLINE_STATUS_SLOTS][OFFLINE_STATUS_PAYLOAD_SIZE];
+bool statusSlotPending[OFFLINE_STATUS_SLOTS] = { false };
+int statusPendingCount = 0;
+
 bool systemOnline = false;
 
+// Flash log bookkeeping (see PERSISTENT OFFLINE LOG)
+uint32_t nextResponseSequence = 1;
+uint32_t persistedThrough = 0;   // Newest response sequence written to flash
+uint32_t committedThrough = 0;   // Newest response sequence sent or dropped
+uint32_t loggedCommit = 0;       // Newest commit marker written to flash
+bool offlineLogReady = false;
+
+// ================================
+// TASK RUNTIME MESSAGE TYPES
+// ================================
+enum UiEventType {
+  UI_EVT_PRESENCE_CHANGED,
+  UI_EVT_STATUS_CHANGED,
+  UI_EVT_MESSAGE_RECEIVED,
+  UI_EVT_BUTTON,            // Edge on a button pin (from the GPIO interrupt)
+  UI_EVT_BLE_WINDOW,        // Scan window finished; loop() mode only
+  UI_EVT_MEMORY_PRESSURE    // Memory monitor changed the mitigation step
+};
+
+struct UiEvent {
+  UiEventType type;
+};
+
+enum NetworkRequestType {
+  NET_REQ_PUBLISH,
+  NET_REQ_PUBLISH_PRESENCE,
+  NET_REQ_PUBLISH_RESPONSE,
+  NET_REQ_SOCKET_READABLE      // From the socket wake task (see AWAY LIGHT SLEEP)
+};
+
+// Button responses carry their fields; the network task picks the encoding
+enum ResponseKind : uint8_t {
+  RESPONSE_ACKNOWLEDGE,
+  RESPONSE_BUSY
+};
+
+struct NetworkRequest {
+  NetworkRequestType type;
+  bool is_response;
+  ResponseKind response_kind;  // NET_REQ_PUBLISH_RESPONSE only
+  char message_id[32];         // NET_REQ_PUBLISH_RESPONSE only
+  char topic[64];
+  char payload[512];           // Original message for NET_REQ_PUBLISH_RESPONSE
+  MessageTrace trace;          // NET_REQ_PUBLISH_RESPONSE only
+  unsigned long received_time; // NET_REQ_PUBLISH_RESPONSE only, millis()
+};
+
+// ================================
+// WIRE FORMAT TYPES
+// ================================
+// Bit per topic the central system may ask to receive as CBOR
+enum WireTopic : uint8_t {
+  WIRE_TOPIC_NONE = 0,
+  WIRE_TOPIC_STATUS = 1 << 0,
+  WIRE_TOPIC_HEARTBEAT = 1 << 1,
+  WIRE_TOPIC_RESPONSES = 1 << 2,
+  WIRE_TOPIC_METRICS = 1 << 3
+};
+
+// Writes one payload; called once per encoding that is needed
+typedef void (*PayloadBuilder)(WireWriter& writer, const void* context);
+
+struct ResponseDraft {
+  ResponseKind kind;
+  const char* messageId;
+  const char* originalMessage;
+  const MessageTrace* trace;
+  unsigned long receivedTime;
+};
+
+// ================================
+// PUBLISH RATE CONTROL TYPES
+// ================================
+// Caps publishes per topic: bursts up to capacity, then one per refill period
+struct TokenBucket {
+  uint8_t tokens;
+  uint8_t capacity;
+  uint32_t refillMs;
+  unsigned long lastRefill;
+};
+
+// Presence fields whose change is worth a status publish
+struct PresenceSnapshot {
+  bool valid;                 // false until the first publish
+  bool present;
+  bool inGracePeriod;
+  NtpSyncState ntpSync;
+};
+
+// What the central system last heard in a heartbeat
+struct HeartbeatState {
+  bool valid;                 // false forces the next heartbeat to be complete
+  uint8_t sinceFull;
+  uint32_t freeHeap;
+  bool wifiConnected;
+  bool timeInitialized;
+  bool present;
+  NtpSyncState ntpSync;
+};
+
+struct HeartbeatDraft {
+  bool full;
+  const HeartbeatState* reported;
+  HeartbeatState current;
+};
+
 // ================================
 // OFFLINE QUEUE FUNCTIONS
 // ================================
 
+// Presence state is retained by the broker so a late subscriber gets the
+// current state without the unit re-sending it; everything else is an event.
+// Covers this unit's status topics and those of tracked colleagues.
+bool isRetainedTopic(const char* topic) {
+  size_t length = strlen(topic);
+  return length >= 7 && strcmp(topic + length - 7, "/status") == 0;
+}
+
 void initOfflineQueue() {
-  queueCount = 0;
+  responseHead = 0;
+  responseCount = 0;
+  responseStore.reset();
+  for (int i = 0; i < OFFLINE_STATUS_SLOTS; i++) {
+    statusSlotPending[i] = false;
+    statusSlots[i].topic[0] = '\0';
+    statusSlots[i].payload = statusPayloads[i];
+    statusSlots[i].payload[0] = '\0';
+  }
+  statusPendingCount = 0;
   systemOnline = false;
   DEBUG_PRINTLN("📥 Offline message queue initialized");
 }
 
+int offlineQueueDepth() {
+  return responseCount + statusPendingCount;
+}
+
+// entry.payload must already hold payloadLength + 1 bytes
+void fillQueuedMessage(SimpleMessage& entry, const char* topic, const char* payload, size_t payloadLength,
+                       bool isResponse) {
+  strncpy(entry.topic, topic, sizeof(entry.topic) - 1);
+  entry.topic[sizeof(entry.topic) - 1] = '\0';
+  memcpy(entry.payload, payload, payloadLength + 1);
+  entry.timestamp = millis();
+  entry.retry_count = 0;
+  entry.is_response = isResponse;
+}
+
+// Each status topic keeps its own slot; a free slot is taken for a new
+// topic. -1 when every slot holds another topic's pending update.
+int findStatusSlot(const char* topic) {
+  int freeSlot = -1;
+  for (int i = 0; i < OFFLINE_STATUS_SLOTS; i++) {
+    if (strcmp(statusSlots[i].topic, topic) == 0) return i;
+    if (freeSlot < 0 && !statusSlotPending[i]) freeSlot = i;
+  }
+  return freeSlot;
+}
+
+void dropStatusSlot(int slot) {
+  if (statusSlotPending[slot]) {
+    statusSlotPending[slot] = false;
+    statusPendingCount--;
+  }
+}
+
+void popResponse() {
+  committedThrough = responseQueue[responseHead].sequence;
+  responseStore.releaseOldest(strlen(responseQueue[responseHead].payload) + 1);
+  responseHead = (responseHead + 1) % MAX_QUEUED_RESPONSES;
+  responseCount--;
+}
+
 bool queueMessage(const char* topic, const char* payload, bool isResponse = false) {
-  if (queueCount >= 10) {
-    DEBUG_PRINTLN("⚠️ Queue full, dropping oldest message");
-    // Shift queue to make room
-    for (int i = 0; i < 9; i++) {
-      messageQueue[i] = messageQueue[i + 1];
+  size_t payloadLength = strlen(payload);
+
+  if (!isResponse) {
+    // Metrics are the only status payload this large; they accumulate instead
+    if (payloadLength >= OFFLINE_STATUS_PAYLOAD_SIZE) {
+      DEBUG_PRINTF("⚠️ %u-byte payload for %s too large to queue\n", (unsigned)payloadLength, topic);
+      dropStaleStatus(topic);
+      return false;
+    }
+
+    // Coalesce: a newer state for the same topic replaces the queued one
+    int slot = findStatusSlot(topic);
+    if (slot < 0) {
+      // Overwriting another topic's state would lose it silently
+      DEBUG_PRINTF("⚠️ All %d status slots pending, dropping update for %s\n", OFFLINE_STATUS_SLOTS, topic);
+      return false;
+    }
+    bool replaced = statusSlotPending[slot];
+    fillQueuedMessage(statusSlots[slot], topic, payload, payloadLength, false);
+    if (!replaced) {
+      statusSlotPending[slot] = true;
+      statusPendingCount++;
     }
-    queueCount = 9;
+    DEBUG_PRINTF("📥 %s status update (%d in queue): %s\n",
+                replaced ? "Coalesced" : "Queued", offlineQueueDepth(), topic);
+    return true;
+  }
+
+  if (payloadLength >= responseStore.getCapacity()) {
+    DEBUG_PRINTF("⚠️ %u-byte response for %s too large to queue\n", (unsigned)payloadLength, topic);
+    return false;
   }
 
-  // Add new message
-  strncpy(messageQueue[queueCount].topic, topic, 63);
-  strncpy(messageQueue[queueCount].payload, payload, 511);
-  messageQueue[queueCount].topic[63] = '\0';
-  messageQueue[queueCount].payload[511] = '\0';
-  messageQueue[queueCount].timestamp = millis();
-  messageQueue[queueCount].retry_count = 0;
-  messageQueue[queueCount].is_response = isResponse;
+  char* block = nullptr;
+  while (responseCount >= MAX_QUEUED_RESPONSES ||
+         !(block = static_cast<char*>(responseStore.allocate(payloadLength + 1)))) {
+    DEBUG_PRINTLN("⚠️ Queue full, dropping oldest message");
+    popResponse();
+  }
 
-  queueCount++;
-  DEBUG_PRINTF("📥 Queued message (%d in queue): %s\n", queueCount, topic);
+  int tail = (responseHead + responseCount) % MAX_QUEUED_RESPONSES;
+  responseQueue[tail].payload = block;
+  fillQueuedMessage(responseQueue[tail], topic, payload, payloadLength, true);
+  responseQueue[tail].sequence = nextResponseSequence++;
+  responseCount++;
+
+  DEBUG_PRINTF("📥 Queued message (%d in queue): %s\n", offlineQueueDepth(), topic);
   return true;
 }
 
-bool processQueuedMessages() {
-  if (!mqttClient.connected() || queueCount == 0) {
-    return false;
+// Publishes one queued entry; returns false if the broker refused it
+bool flushQueuedEntry(SimpleMessage& entry, bool& drop) {
+  drop = false;
+  if (mqttClient.publish(entry.topic, entry.payload, isRetainedTopic(entry.topic))) {
+    DEBUG_PRINTF("📤 Sent queued message: %s\n", entry.topic);
+    drop = true;
+    return true;
   }
 
-  // Process one message at a time
-  bool success = mqttClient.publish(messageQueue[0].topic, messageQueue[0].payload, MQTT_QOS);
+  entry.retry_count++;
+  if (entry.retry_count > MESSAGE_RETRY_ATTEMPTS) {
+    DEBUG_PRINTF("❌ Message failed after %d retries, dropping\n", MESSAGE_RETRY_ATTEMPTS);
+    drop = true;
+  }
+  return false;
+}
 
-  if (success) {
-    DEBUG_PRINTF("📤 Sent queued message: %s\n", messageQueue[0].topic);
+// Sends queued messages until empty, a publish fails or the time budget is spent
+int processQueuedMessages() {
+  if (!mqttClient.connected() || offlineQueueDepth() == 0) {
+    return 0;
+  }
 
-    // Remove processed message by shifting queue
-    for (int i = 0; i < queueCount - 1; i++) {
-      messageQueue[i] = messageQueue[i + 1];
-    }
-    queueCount--;
-    return true;
-  } else {
-    // Increment retry count
-    messageQueue[0].retry_count++;
-    if (messageQueue[0].retry_count > 3) {
-      DEBUG_PRINTLN("❌ Message failed after 3 retries, dropping");
-      // Remove failed message
-      for (int i = 0; i < queueCount - 1; i++) {
-        messageQueue[i] = messageQueue[i + 1];
-      }
-      queueCount--;
-    }
-    return false;
+  unsigned long start = millis();
+  int sent = 0;
+  bool drop;
+
+  // Responses first, oldest to newest
+  while (responseCount > 0 && millis() - start < OFFLINE_FLUSH_BUDGET_MS) {
+    bool ok = flushQueuedEntry(responseQueue[responseHead], drop);
+    if (drop) popResponse();
+    if (!ok) return sent;
+    sent++;
   }
+
+  // Then the newest state of each status topic
+  for (int i = 0; i < OFFLINE_STATUS_SLOTS && statusPendingCount > 0; i++) {
+    if (!statusSlotPending[i]) continue;
+    if (responseCount > 0 || millis() - start >= OFFLINE_FLUSH_BUDGET_MS) break;
+
+    bool ok = flushQueuedEntry(statusSlots[i], drop);
+    if (drop) dropStatusSlot(i);
+    if (!ok) return sent;
+    sent++;
+  }
+
+  return sent;
 }
 
 void updateOfflineQueue() {
@@ -152,21 +484,267 @@ void updateOfflineQueue() {
   systemOnline = wifiConnected && mqttConnected;
 
   // If just came online, process queue
-  if (!wasOnline && systemOnline && queueCount > 0) {
-    DEBUG_PRINTF("🌐 System online - processing %d queued messages\n", queueCount);
+  if (!wasOnline && systemOnline && offlineQueueDepth() > 0) {
+    DEBUG_PRINTF("🌐 System online - processing %d queued messages\n", offlineQueueDepth());
   }
 
-  // Process one message per update cycle
+  // Flush a batch per update cycle, bounded by OFFLINE_FLUSH_BUDGET_MS
   if (systemOnline) {
     processQueuedMessages();
   }
 }
 
+// ================================
+// PERSISTENT OFFLINE LOG (LITTLEFS)
+// ================================
+// Queued responses are appended to an append-only log as compact binary
+// records (header + actual topic/payload bytes), so ACK/BUSY replies
+// survive a power cut during an outage. Responses only ever leave the ring
+// from its head, so one COMMIT record ("everything up to sequence N is
+// done") tracks progress. persistOfflineQueue() batches the writes on the
+// network side; the button path only touches RAM.
+
+#define OFFLINE_LOG_MAGIC 0xC5
+#define OFFLINE_LOG_TEMP_PATH "/offline_queue.tmp"
+
+enum OfflineLogRecordType {
+  LOG_REC_RESPONSE = 1,
+  LOG_REC_COMMIT = 2
+};
+
+struct __attribute__((packed)) OfflineLogRecordHeader {
+  uint8_t magic;
+  uint8_t type;
+  uint8_t topicLength;
+  uint16_t payloadLength;
+  uint32_t sequence;
+  uint16_t crc;             // CRC-16/CCITT over header (crc = 0), topic and payload
+};
+
+uint16_t crc16Update(uint16_t crc, const uint8_t* data, size_t length) {
+  for (size_t i = 0; i < length; i++) {
+    crc ^= (uint16_t)data[i] << 8;
+    for (int bit = 0; bit < 8; bit++) {
+      crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : crc << 1;
+    }
+  }
+  return crc;
+}
+
+bool writeLogRecord(File& file, uint8_t type, uint32_t sequence, const char* topic, const char* payload) {
+  OfflineLogRecordHeader header;
+  size_t topicLength = strlen(topic);
+  size_t payloadLength = strlen(payload);
+
+  header.magic = OFFLINE_LOG_MAGIC;
+  header.type = type;
+  header.topicLength = topicLength;
+  header.payloadLength = payloadLength;
+  header.sequence = sequence;
+  header.crc = 0;
+
+  uint16_t crc = crc16Update(0xFFFF, (const uint8_t*)&header, sizeof(header));
+  crc = crc16Update(crc, (const uint8_t*)topic, topicLength);
+  header.crc = crc16Update(crc, (const uint8_t*)payload, payloadLength);
+
+  return file.write((const uint8_t*)&header, sizeof(header)) == sizeof(header) &&
+         file.write((const uint8_t*)topic, topicLength) == topicLength &&
+         file.write((const uint8_t*)payload, payloadLength) == payloadLength;
+}
+
+// Only the compacted copy left means a power cut after the log was removed
+// (images before the one-step rename did that); the copy was complete by
+// then. A copy beside the log is a compaction cut short and is dropped.
+File openOfflineLog() {
+  if (!LittleFS.exists(OFFLINE_LOG_PATH) && LittleFS.exists(OFFLINE_LOG_TEMP_PATH)) {
+    DEBUG_PRINTLN("💾 Offline log missing - recovering the compacted copy");
+    LittleFS.rename(OFFLINE_LOG_TEMP_PATH, OFFLINE_LOG_PATH);
+  } else {
+    LittleFS.remove(OFFLINE_LOG_TEMP_PATH);
+  }
+  return LittleFS.open(OFFLINE_LOG_PATH, FILE_READ);
+}
+
+// Boot-time replay: one forward pass, stops at the first torn/corrupt record.
+// Only a live response (newer than every commit so far) takes a ring slot.
+void recoverOfflineQueue() {
+  File file = openOfflineLog();
+  if (!file) return;
+
+  uint32_t newestSequence = 0;
+  uint32_t newestCommit = 0;
+  int records = 0;
+  OfflineLogRecordHeader header;
+  char topic[sizeof(SimpleMessage::topic)];
+  uint8_t chunk[64];
+
+  while (file.read((uint8_t*)&header, sizeof(header)) == sizeof(header)) {
+    if (header.magic != OFFLINE_LOG_MAGIC ||
+        header.topicLength >= sizeof(SimpleMessage::topic) ||
+        header.payloadLength >= responseStore.getCapacity()) {
+      break;
+    }
+
+    // CRC first, streaming the payload past; it is read for real only
+    // once the record turns out to be a live response
+    if (file.read((uint8_t*)topic, header.topicLength) != header.topicLength) break;
+    topic[header.topicLength] = '\0';
+    size_t payloadStart = file.position();
+
+    uint16_t expectedCrc = header.crc;
+    header.crc = 0;
+    uint16_t crc = crc16Update(0xFFFF, (const uint8_t*)&header, sizeof(header));
+    crc = crc16Update(crc, (const uint8_t*)topic, header.topicLength);
+    size_t left = header.payloadLength;
+    while (left > 0) {
+      size_t length = min(left, sizeof(chunk));
+      if (file.read(chunk, length) != length) break;
+      crc = crc16Update(crc, chunk, length);
+      left -= length;
+    }
+    if (left > 0 || crc != expectedCrc) break;
+    records++;
+
+    uint32_t sequence = header.sequence;
+    if (header.type == LOG_REC_COMMIT) {
+      if (sequence > newestCommit) newestCommit = sequence;
+      while (responseCount > 0 && responseQueue[responseHead].sequence <= newestCommit) {
+        popResponse();
+      }
+      continue;
+    }
+    if (header.type != LOG_REC_RESPONSE || sequence <= newestCommit) continue;
+
+    // Live response: room is made the same way as queueMessage() does
+    size_t recordEnd = file.position();
+    if (responseCount >= MAX_QUEUED_RESPONSES) popResponse();
+    char* block;
+    while (!(block = static_cast<char*>(responseStore.reserve(header.payloadLength + 1)))) {
+      popResponse();
+    }
+    if (!file.seek(payloadStart) ||
+        file.read((uint8_t*)block, header.payloadLength) != header.payloadLength) {
+      break;
+    }
+    block[header.payloadLength] = '\0';
+    responseStore.commit(header.payloadLength + 1);
+    file.seek(recordEnd);
+
+    SimpleMessage& entry = responseQueue[(responseHead + responseCount) % MAX_QUEUED_RESPONSES];
+    strcpy(entry.topic, topic);
+    entry.payload = block;
+    entry.timestamp = millis();
+    entry.retry_count = 0;
+    entry.is_response = true;
+    entry.sequence = sequence;
+    responseCount++;
+    if (sequence > newestSequence) newestSequence = sequence;
+  }
+  file.close();
+
+  nextResponseSequence = max(newestSequence, newestCommit) + 1;
+  persistedThrough = newestSequence;
+  loggedCommit = newestCommit;
+  committedThrough = max(committedThrough, newestCommit);
+
+  DEBUG_PRINTF("💾 Offline log recovered: %d records, %d unsent responses replayed\n",
+              records, responseCount);
+
+  if (responseCount == 0) {
+    LittleFS.remove(OFFLINE_LOG_PATH);
+  }
+}
+
+void initOfflineLog() {
+  if (!MESSAGE_PERSISTENCE_ENABLED) return;
+
+  if (!LittleFS.begin(true)) {
+    DEBUG_PRINTLN("⚠️ LittleFS mount failed - offline queue is RAM only");
+    return;
+  }
+  offlineLogReady = true;
+  recoverOfflineQueue();
+}
+
+// Rewrites the log with only the responses still queued
+void compactOfflineLog() {
+  File file = LittleFS.open(OFFLINE_LOG_TEMP_PATH, FILE_WRITE);
+  if (!file) return;
+
+  bool ok = true;
+  for (int i = 0; i < responseCount && ok; i++) {
+    SimpleMessage& entry = responseQueue[(responseHead + i) % MAX_QUEUED_RESPONSES];
+    ok = writeLogRecord(file, LOG_REC_RESPONSE, entry.sequence, entry.topic, entry.payload);
+  }
+  file.close();
+
+  // rename() replaces the log in one step: a power cut leaves either the
+  // old log or the compacted one, never neither
+  if (ok && LittleFS.rename(OFFLINE_LOG_TEMP_PATH, OFFLINE_LOG_PATH)) {
+    persistedThrough = nextResponseSequence - 1;
+    loggedCommit = committedThrough;
+    DEBUG_PRINTF("💾 Offline log compacted to %d responses\n", responseCount);
+  }
+}
+
+// Batched write-behind of queue changes; called from the network side
+void persistOfflineQueue() {
+  if (!offlineLogReady) return;
+
+  uint32_t commitTarget = min(committedThrough, persistedThrough);
+  bool needsCommit = commitTarget > loggedCommit;
+  bool hasUnlogged = responseCount > 0 &&
+      responseQueue[(responseHead + responseCount - 1) % MAX_QUEUED_RESPONSES].sequence > persistedThrough;
+  if (!needsCommit && !hasUnlogged) return;
+
+  // Nothing left to replay: drop the log instead of appending a marker
+  if (responseCount == 0) {
+    LittleFS.remove(OFFLINE_LOG_PATH);
+    loggedCommit = commitTarget;
+    return;
+  }
+
+  File file = LittleFS.open(OFFLINE_LOG_PATH, FILE_APPEND);
+  if (!file) return;
+
+  if (file.size() > OFFLINE_STORAGE_SIZE) {
+    file.close();
+    compactOfflineLog();
+    return;
+  }
+
+  if (needsCommit && writeLogRecord(file, LOG_REC_COMMIT, commitTarget, "", "")) {
+    loggedCommit = commitTarget;
+  }
+
+  for (int i = 0; i < responseCount; i++) {
+    SimpleMessage& entry = responseQueue[(responseHead + i) % MAX_QUEUED_RESPONSES];
+    if (entry.sequence <= persistedThrough) continue;
+    if (!writeLogRecord(file, LOG_REC_RESPONSE, entry.sequence, entry.topic, entry.payload)) break;
+    persistedThrough = entry.sequence;
+  }
+  file.close();
+}
+
+// Anything still queued for a status topic is stale once a newer state is out
+void dropStaleStatus(const char* topic) {
+  int slot = findStatusSlot(topic);
+  if (slot >= 0 && strcmp(statusSlots[slot].topic, topic) == 0) dropStatusSlot(slot);
+}
+
 // Enhanced publish function with queuing
 bool publishWithQueue(const char* topic, const char* payload, bool isResponse = false) {
+  PERF_PROFILE_SCOPE(PERF_SPAN_PUBLISH);
+
+  // Keep responses in order behind any that are still queued
+  if (isResponse && responseCount > 0) {
+    return queueMessage(topic, payload, isResponse);
+  }
+
   if (mqttClient.connected()) {
-    bool success = mqttClient.publish(topic, payload, MQTT_QOS);
+    bool success = mqttClient.publish(topic, payload, isRetainedTopic(topic));
     if (success) {
+      if (!isResponse) dropStaleStatus(topic);
       return true;
     } else {
       // MQTT publish failed, queue the message
@@ -178,81 +756,375 @@ bool publishWithQueue(const char* topic, const char* payload, bool isResponse =
   }
 }
 
+// ================================
+// WIRE FORMAT NEGOTIATION
+// ================================
+// Topics the central system asked to receive as CBOR, from its retained
+// wire_format message. Without one (a legacy central system)
+// everything stays JSON; legacy topics and the offline queue always are.
+uint8_t cborTopics = WIRE_TOPIC_NONE;
+
+// ================================
+// PER-TOPIC TOKEN BUCKETS
+// ================================
+TokenBucket statusBucket = { STATUS_BUCKET_CAPACITY, STATUS_BUCKET_CAPACITY, STATUS_BUCKET_REFILL_MS, 0 };
+TokenBucket heartbeatBucket = { HEARTBEAT_BUCKET_CAPACITY, HEARTBEAT_BUCKET_CAPACITY, HEARTBEAT_BUCKET_REFILL_MS, 0 };
+HeartbeatState reportedHeartbeat = { false, 0, 0, false, false, false, NTP_SYNC_PENDING };
+
+bool takeToken(TokenBucket& bucket) {
+  unsigned long now = millis();
+  unsigned long refills = (now - bucket.lastRefill) / bucket.refillMs;
+  if (refills > 0) {
+    bucket.tokens = min((unsigned long)bucket.capacity, bucket.tokens + refills);
+    bucket.lastRefill = bucket.tokens == bucket.capacity ? now : bucket.lastRefill + refills * bucket.refillMs;
+  }
+
+  if (bucket.tokens == 0) return false;
+  bucket.tokens--;
+  return true;
+}
+
+// Encodes into network scratch: CBOR when negotiated and deliverable now,
+// otherwise JSON through the queueing publish path
+bool publishEncoded(const char* topic, uint8_t wireTopic, PayloadBuilder build, const void* context,
+                    bool isResponse) {
+  ScratchFrame frame(networkScratch);
+  uint8_t* buffer = static_cast<uint8_t*>(frame.allocate(WIRE_PAYLOAD_BUFFER_SIZE));
+  if (!buffer) {
+    DEBUG_PRINTF("⚠️ Network scratch exhausted, %s not sent\n", topic);
+    return false;
+  }
+  bool inOrder = !(isResponse && responseCount > 0);
+
+  if ((cborTopics & wireTopic) && inOrder && mqttClient.connected()) {
+    WireWriter cbor(WIRE_FORMAT_CBOR, buffer, WIRE_PAYLOAD_BUFFER_SIZE);
+    build(cbor, context);
+    if (cbor.ok() && mqttClient.publish(topic, cbor.data(), cbor.length(), isRetainedTopic(topic))) {
+      if (!isResponse) dropStaleStatus(topic);
+      return true;
+    }
+  }
+
+  WireWriter json(WIRE_FORMAT_JSON, buffer, WIRE_PAYLOAD_BUFFER_SIZE);
+  build(json, context);
+  if (!json.ok()) {
+    DEBUG_PRINTF("⚠️ Payload for %s exceeds %d bytes\n", topic, WIRE_PAYLOAD_BUFFER_SIZE);
+    return false;
+  }
+  return publishWithQueue(topic, json.c_str(), isResponse);
+}
+
+// The hash picks the topic and the key bytes confirm it
+uint8_t wireTopicFromKey(const JsonToken& token) {
+  const char* key;
+  uint8_t topic;
+  switch (token.keyHash) {
+    case JsonStream::keyHash("status"): key = "status"; topic = WIRE_TOPIC_STATUS; break;
+    case JsonStream::keyHash("heartbeat"): key = "heartbeat"; topic = WIRE_TOPIC_HEARTBEAT; break;
+    case JsonStream::keyHash("responses"): key = "responses"; topic = WIRE_TOPIC_RESPONSES; break;
+    case JsonStream::keyHash("metrics"): key = "metrics"; topic = WIRE_TOPIC_METRICS; break;
+    default: return WIRE_TOPIC_NONE;
+  }
+  return JsonStream::keyEquals(token, key) ? topic : WIRE_TOPIC_NONE;
+}
+
+bool collectWireFormat(const JsonToken& token, void* context) {
+  uint8_t& topics = *static_cast<uint8_t*>(context);
+  uint8_t bit = wireTopicFromKey(token);
+  if (bit == WIRE_TOPIC_NONE || token.type != JSON_VALUE_STRING) return true;
+
+  if (token.valueLength == 4 && memcmp(token.value, "cbor", 4) == 0) {
+    topics |= bit;
+  } else {
+    topics &= ~bit;
+  }
+  return true;
+}
+
+// e.g. {"status":"cbor","heartbeat":"cbor","responses":"json"}
+void handleWireFormatMessage(const byte* payload, unsigned int length) {
+  if (!WIRE_FORMAT_CBOR_ENABLED) return;
+
+  uint8_t topics = WIRE_TOPIC_NONE;
+  if (!JsonStream::parse((const char*)payload, length, collectWireFormat, &topics)) {
+    DEBUG_PRINTLN("⚠️ Ignoring malformed wire format message");
+    return;
+  }
+  cborTopics = topics;
+  DEBUG_PRINTF("📦 Wire format: status=%s heartbeat=%s responses=%s metrics=%s\n",
+              (topics & WIRE_TOPIC_STATUS) ? "cbor" : "json",
+              (topics & WIRE_TOPIC_HEARTBEAT) ? "cbor" : "json",
+              (topics & WIRE_TOPIC_RESPONSES) ? "cbor" : "json",
+              (topics & WIRE_TOPIC_METRICS) ? "cbor" : "json");
+}
+
 // ================================
 // FORWARD DECLARATIONS
 // ================================
 void publishPresenceUpdate();
+void requestPresencePublish();
 void updateMainDisplay();
 void updateSystemStatus();
+void updateTimeAndDate();
+void displayIncomingMessage(const EnhancedMessage& message);
 
 // ================================
-// BEACON VALIDATOR
+// TASK RUNTIME PLUMBING (DUAL CORE)
 // ================================
-bool isFacultyBeacon(BLEAdvertisedDevice& device) {
-  String deviceMAC = device.getAddress().toString().c_str();
-  deviceMAC.toUpperCase();
+// With ENABLE_TASK_RUNTIME the unit runs three FreeRTOS tasks instead of
+// loop(): BLE scanning, the WiFi/MQTT stack and a high-priority UI task.
+// Only the UI task touches the display and only the network task touches
+// mqttClient and the offline queue; everything else is handed over here.
+
+bool taskRuntimeActive = false;
+QueueHandle_t uiEventQueue = NULL;
+QueueHandle_t networkQueue = NULL;
+TaskHandle_t bleTaskHandle = NULL;
+TaskHandle_t networkTaskHandle = NULL;
+TaskHandle_t uiTaskHandle = NULL;
+TaskHandle_t socketWakeTaskHandle = NULL;
+volatile int socketWakeFd = -1;            // Socket being watched; -1 = disarmed
+
+// Guards MessageQueue between the network task (receive) and the UI task
+SemaphoreHandle_t inboxMutex = NULL;
+
+// Requests are built in place in a pool slot and only the pointer goes
+// through networkQueue, so producers on small stacks (BLE task) never
+// hold a copy and the queue never copies the payload
+NetworkRequest networkRequestSlots[NETWORK_QUEUE_LENGTH];
+BlockPool networkRequestPool(networkRequestSlots, sizeof(NetworkRequest), NETWORK_QUEUE_LENGTH);
+
+NetworkRequest* acquireNetworkRequest(NetworkRequestType type) {
+  NetworkRequest* request = static_cast<NetworkRequest*>(networkRequestPool.acquire());
+  if (!request) {
+    DEBUG_PRINTLN("⚠️ Network request queue full");
+    return nullptr;
+  }
+  request->type = type;
+  return request;
+}
+
+bool sendNetworkRequest(NetworkRequest* request) {
+  if (xQueueSend(networkQueue, &request, pdMS_TO_TICKS(NETWORK_QUEUE_SEND_TIMEOUT_MS)) != pdTRUE) {
+    networkRequestPool.release(request);
+    DEBUG_PRINTLN("⚠️ Network request queue full");
+    return false;
+  }
+  return true;
+}
 
-  String expectedMAC = String(FACULTY_BEACON_MAC);
-  expectedMAC.toUpperCase();
+void postUiEvent(UiEventType type) {
+  UiEvent event = { type };
+  if (xQueueSend(uiEventQueue, &event, 0) != pdTRUE) {
+    DEBUG_PRINTF("⚠️ UI event queue full, dropping event %d\n", type);
+  }
+}
+
+bool postNetworkRequest(NetworkRequestType type, const char* topic = "", const char* payload = "",
+                        bool isResponse = false) {
+  NetworkRequest* request = acquireNetworkRequest(type);
+  if (!request) return false;
+  request->is_response = isResponse;
+  strncpy(request->topic, topic, sizeof(request->topic) - 1);
+  request->topic[sizeof(request->topic) - 1] = '\0';
+  strncpy(request->payload, payload, sizeof(request->payload) - 1);
+  request->payload[sizeof(request->payload) - 1] = '\0';
+  return sendNetworkRequest(request);
+}
+
+// Presence confirmed/changed: publish it and redraw the main area
+void notifyPresenceChanged() {
+  if (taskRuntimeActive) {
+    postNetworkRequest(NET_REQ_PUBLISH_PRESENCE);
+    postUiEvent(UI_EVT_PRESENCE_CHANGED);
+    return;
+  }
+  requestPresencePublish();
+  updatePresencePowerState();
+  if (!isConfirmationShowing()) updateMainDisplay();
+}
+
+// Connection or time sync state changed: redraw the status panel and clock
+void requestStatusRedraw() {
+  if (taskRuntimeActive) {
+    postUiEvent(UI_EVT_STATUS_CHANGED);
+    return;
+  }
+  updateSystemStatus();
+}
+
+// Publish from any context; in task mode the network task does the publish
+bool submitPublish(const char* topic, const char* payload, bool isResponse) {
+  if (taskRuntimeActive) {
+    return postNetworkRequest(NET_REQ_PUBLISH, topic, payload, isResponse);
+  }
+  return publishWithQueue(topic, payload, isResponse);
+}
 
-  return deviceMAC.equals(expectedMAC);
+bool publishResponse(ResponseKind kind, const char* messageId, const char* originalMessage,
+                     const MessageTrace& trace, unsigned long receivedTime);
+
+// A colleague tracked by this unit arrived or left: their beacon's state
+// goes out on their own status topic, as if their desk unit had sent it
+void notifyTrackedPresenceChanged(uint16_t facultyId, bool present) {
+  char topic[UNIT_TOPIC_SIZE];
+  UnitProfile::formatTopic(facultyId, UNIT_TOPIC_STATUS, topic, sizeof(topic));
+
+  char payload[160];
+  WireWriter writer(WIRE_FORMAT_JSON, (uint8_t*)payload, sizeof(payload));
+  writer.beginObject();
+  writer.addUInt("faculty_id", facultyId);
+  writer.addBool("present", present);
+  writer.addString("status", present ? "AVAILABLE" : "AWAY");
+  writer.addUInt("timestamp", millis());
+  writer.addUInt("reported_by", unitProfile.getFacultyId());
+  writer.endObject();
+
+  DEBUG_PRINTF("👥 Tracked faculty %u: %s\n", facultyId, present ? "PRESENT" : "AWAY");
+  submitPublish(topic, writer.c_str(), false);
+}
+
+// Button response for the message on screen, encoded on the network side.
+// The press is stamped here so queueing to the network task is not counted.
+bool submitResponse(ResponseKind kind, const EnhancedMessage& message) {
+  MessageTrace trace = message.trace;
+  trace.respondedAtMs = epochNowMs();
+  trace.respondedMillis = millis();
+  if (trace.rendered) MessageStatistics::recordResponseTime(trace.respondedMillis - trace.renderedMillis);
+
+  if (!taskRuntimeActive) {
+    return publishResponse(kind, message.messageId, message.data.rawMessage, trace, message.receivedTime);
+  }
+
+  NetworkRequest* request = acquireNetworkRequest(NET_REQ_PUBLISH_RESPONSE);
+  if (!request) return false;
+  request->is_response = true;
+  request->response_kind = kind;
+  request->topic[0] = '\0';
+  strncpy(request->message_id, message.messageId, sizeof(request->message_id) - 1);
+  request->message_id[sizeof(request->message_id) - 1] = '\0';
+  strncpy(request->payload, message.data.rawMessage, sizeof(request->payload) - 1);
+  request->payload[sizeof(request->payload) - 1] = '\0';
+  request->trace = trace;
+  request->received_time = message.receivedTime;
+  return sendNetworkRequest(request);
 }
 
 // ================================
 // BUTTON HANDLING CLASS
 // ================================
+// Edges wake the UI side through uiEventQueue; debouncing and the long
+// press are then finished on timers (see EVENT SCHEDULING). One event is
+// in flight at a time, so contact bounce cannot fill the queue.
+volatile bool buttonEdgePending = false;
+
+void IRAM_ATTR onButtonEdge() {
+  // A wake level keeps firing while the button is down, so the first one
+  // puts both pins back on edges. Register writes only: this runs from IRAM.
+  if (buttonWakeArmed) {
+    buttonWakeArmed = false;
+    gpio_ll_wakeup_disable(&GPIO, (gpio_num_t)BUTTON_A_PIN);
+    gpio_ll_wakeup_disable(&GPIO, (gpio_num_t)BUTTON_B_PIN);
+    gpio_ll_set_intr_type(&GPIO, (gpio_num_t)BUTTON_A_PIN, GPIO_INTR_ANYEDGE);
+    gpio_ll_set_intr_type(&GPIO, (gpio_num_t)BUTTON_B_PIN, GPIO_INTR_ANYEDGE);
+  }
+
+  if (buttonEdgePending || !uiEventQueue) return;
+  buttonEdgePending = true;
+
+  UiEvent event = { UI_EVT_BUTTON };
+  BaseType_t woken = pdFALSE;
+  xQueueSendFromISR(uiEventQueue, &event, &woken);
+  portYIELD_FROM_ISR(woken);
+}
+
 class ButtonHandler {
 private:
   int pinA, pinB;
-  bool lastStateA, lastStateB;
+  bool lastReadingA, lastReadingB;
+  bool stableStateA, stableStateB;
   unsigned long lastDebounceA, lastDebounceB;
+  unsigned long pressStartA, pressStartB;
+  bool longPressFiredA, longPressFiredB;
+
+  // Debounces one button. A short press is reported on release, a long
+  // press as soon as the hold time is reached (and then the release is
+  // swallowed), so holding a button never also sends a response.
+  void updateButton(int pin, bool& lastReading, bool& stableState, unsigned long& lastDebounce,
+                    unsigned long& pressStart, bool& longPressFired, bool& shortFlag, bool& longFlag,
+                    const char* name) {
+    bool reading = digitalRead(pin);
+    if (reading != lastReading) {
+      lastDebounce = millis();
+      lastReading = reading;
+    }
+
+    if ((millis() - lastDebounce) > BUTTON_DEBOUNCE_DELAY && reading != stableState) {
+      stableState = reading;
+      if (stableState == LOW) {
+        pressStart = millis();
+        longPressFired = false;
+      } else if (!longPressFired) {
+        shortFlag = true;
+        DEBUG_PRINTF("%s PRESSED\n", name);
+      }
+    }
+
+    if (stableState == LOW && !longPressFired && (millis() - pressStart) >= BUTTON_LONG_PRESS_TIME) {
+      longPressFired = true;
+      longFlag = true;
+      DEBUG_PRINTF("%s HELD\n", name);
+    }
+  }
+
+  // How long until updateButton() has something to decide for this button
+  unsigned long pollDelay(bool lastReading, bool stableState, unsigned long lastDebounce,
+                          unsigned long pressStart, bool longPressFired) {
+    unsigned long now = millis();
+    if (lastReading != stableState) {
+      unsigned long elapsed = now - lastDebounce;
+      return elapsed > BUTTON_DEBOUNCE_DELAY ? 0 : BUTTON_DEBOUNCE_DELAY + 1 - elapsed;
+    }
+    if (stableState == LOW && !longPressFired) {
+      unsigned long elapsed = now - pressStart;
+      return elapsed >= BUTTON_LONG_PRESS_TIME ? 0 : BUTTON_LONG_PRESS_TIME - elapsed;
+    }
+    return BUTTON_IDLE_POLL_MS;
+  }
 
 public:
   ButtonHandler(int buttonAPin, int buttonBPin) {
     pinA = buttonAPin;
     pinB = buttonBPin;
-    lastStateA = HIGH;
-    lastStateB = HIGH;
-    lastDebounceA = 0;
-    lastDebounceB = 0;
+    lastReadingA = lastReadingB = HIGH;
+    stableStateA = stableStateB = HIGH;
+    lastDebounceA = lastDebounceB = 0;
+    pressStartA = pressStartB = 0;
+    longPressFiredA = longPressFiredB = false;
   }
 
   void init() {
     pinMode(pinA, INPUT_PULLUP);
     pinMode(pinB, INPUT_PULLUP);
+    attachInterrupt(digitalPinToInterrupt(pinA), onButtonEdge, CHANGE);
+    attachInterrupt(digitalPinToInterrupt(pinB), onButtonEdge, CHANGE);
     DEBUG_PRINTLN("Buttons initialized:");
     DEBUG_PRINTF("  Button A (Blue/Acknowledge): Pin %d\n", pinA);
     DEBUG_PRINTF("  Button B (Red/Busy): Pin %d\n", pinB);
   }
 
   void update() {
-    // Button A (Acknowledge) handling
-    bool readingA = digitalRead(pinA);
-    if (readingA != lastStateA) {
-      lastDebounceA = millis();
-    }
-
-    if ((millis() - lastDebounceA) > BUTTON_DEBOUNCE_DELAY) {
-      if (readingA == LOW && lastStateA == HIGH) {
-        buttonAPressed = true;
-        DEBUG_PRINTLN("🔵 BUTTON A (ACKNOWLEDGE) PRESSED");
-      }
-    }
-    lastStateA = readingA;
-
-    // Button B (Busy) handling
-    bool readingB = digitalRead(pinB);
-    if (readingB != lastStateB) {
-      lastDebounceB = millis();
-    }
+    updateButton(pinA, lastReadingA, stableStateA, lastDebounceA, pressStartA, longPressFiredA,
+                 buttonAPressed, buttonALongPressed, "🔵 BUTTON A (ACKNOWLEDGE)");
+    updateButton(pinB, lastReadingB, stableStateB, lastDebounceB, pressStartB, longPressFiredB,
+                 buttonBPressed, buttonBLongPressed, "🔴 BUTTON B (BUSY)");
+  }
 
-    if ((millis() - lastDebounceB) > BUTTON_DEBOUNCE_DELAY) {
-      if (readingB == LOW && lastStateB == HIGH) {
-        buttonBPressed = true;
-        DEBUG_PRINTLN("🔴 BUTTON B (BUSY) PRESSED");
-      }
-    }
-    lastStateB = readingB;
+  // Bounded by BUTTON_IDLE_POLL_MS, a fallback should an edge be missed
+  unsigned long msUntilNextPoll() {
+    unsigned long delayA = pollDelay(lastReadingA, stableStateA, lastDebounceA, pressStartA, longPressFiredA);
+    unsigned long delayB = pollDelay(lastReadingB, stableStateB, lastDebounceB, pressStartB, longPressFiredB);
+    return min(delayA, delayB);
   }
 
   bool isButtonAPressed() {
@@ -270,8 +1142,47 @@ public:
     }
     return false;
   }
+
+  bool isButtonALongPressed() {
+    if (buttonALongPressed) {
+      buttonALongPressed = false;
+      return true;
+    }
+    return false;
+  }
+
+  bool isButtonBLongPressed() {
+    if (buttonBLongPressed) {
+      buttonBLongPressed = false;
+      return true;
+    }
+    return false;
+  }
 };
 
+// ================================
+// BLE SCAN WINDOW SHARED STATE
+// ================================
+// onResult() and the scan-complete callback run on the BLE host task,
+// so sightings and window completion are handed to loop() through these.
+portMUX_TYPE bleSightingMux = portMUX_INITIALIZER_UNLOCKED;
+volatile bool bleScanWindowComplete = false;
+
+// Lets the scanner finish the window right away instead of at its deadline
+void wakeBleScanner() {
+  if (taskRuntimeActive) {
+    if (bleTaskHandle) xTaskNotifyGive(bleTaskHandle);
+  } else if (uiEventQueue) {
+    UiEvent event = { UI_EVT_BLE_WINDOW };
+    xQueueSend(uiEventQueue, &event, 0);
+  }
+}
+
+void onBLEScanComplete(BLEScanResults results) {
+  bleScanWindowComplete = true;
+  wakeBleScanner();
+}
+
 // ================================
 // ENHANCED PRESENCE DETECTOR WITH GRACE PERIOD
 // ================================
@@ -294,23 +1205,88 @@ private:
   const int CONFIRM_SCANS = 2;            // Scans needed to confirm presence
   const int CONFIRM_ABSENCE_SCANS = 3;    // More scans needed to confirm absence
 
+  // Beacon sightings reported by the scan callback during the current window
+  volatile bool windowSighted = false;
+  volatile int windowBestRSSI = -999;
+
+  // Smoothed signal level; sightings only count while it is in range
+  RssiFilter rssiFilter = RssiFilter(BLE_SIGNAL_STRENGTH_THRESHOLD, BLE_RSSI_HYSTERESIS_DB);
+
+  // Whose presence this tracks; only this unit's own faculty drives the display
+  uint16_t facultyId = 0;
+  bool ownFaculty = false;
+
 public:
-  void checkBeacon(bool beaconFound, int rssi = 0) {
+  void setIdentity(uint16_t id, bool own) {
+    facultyId = id;
+    ownFaculty = own;
+  }
+
+  uint16_t getFacultyId() const { return facultyId; }
+
+  // Forget everything before the tracker is handed to another beacon
+  void reset() {
+    currentPresence = false;
+    lastKnownPresence = false;
+    lastDetectionTime = 0;
+    lastStateChange = 0;
+    gracePeriodStartTime = 0;
+    inGracePeriod = false;
+    gracePeriodAttempts = 0;
+    consecutiveDetections = 0;
+    consecutiveMisses = 0;
+    rssiFilter.reset();
+
+    portENTER_CRITICAL(&bleSightingMux);
+    windowSighted = false;
+    windowBestRSSI = -999;
+    portEXIT_CRITICAL(&bleSightingMux);
+  }
+
+  // Called from MyAdvertisedDeviceCallbacks::onResult (BLE host task)
+  void reportSighting(int rssi) {
+    portENTER_CRITICAL(&bleSightingMux);
+    windowSighted = true;
+    if (rssi > windowBestRSSI) {
+      windowBestRSSI = rssi;
+    }
+    portEXIT_CRITICAL(&bleSightingMux);
+  }
+
+  // Returns whether the beacon was sighted since the last call and starts a new window
+  bool takeWindowSighting(int* bestRSSI) {
+    portENTER_CRITICAL(&bleSightingMux);
+    bool sighted = windowSighted;
+    *bestRSSI = windowBestRSSI;
+    windowSighted = false;
+    windowBestRSSI = -999;
+    portEXIT_CRITICAL(&bleSightingMux);
+    return sighted;
+  }
+
+  // One call per scan window with the window's best RSSI
+  void checkBeacon(bool beaconFound, int rssi) {
     unsigned long now = millis();
 
+    if (beaconFound) {
+      rssiFilter.update(rssi);
+    } else {
+      rssiFilter.miss();
+    }
+
+    // A sighting whose smoothed level is out of range counts as a miss
+    if (beaconFound && !rssiFilter.isInRange()) {
+      DEBUG_PRINTF("⚠️ Beacon found but signal weak: %d dBm filtered (threshold: %d)\n",
+                  rssiFilter.getRssi(), BLE_SIGNAL_STRENGTH_THRESHOLD);
+      beaconFound = false;
+    }
+
     if (beaconFound) {
       // Beacon detected!
       lastDetectionTime = now;
       consecutiveDetections++;
       consecutiveMisses = 0;
 
-      // Optional RSSI filtering for better reliability
-      if (rssi != 0 && rssi < BLE_SIGNAL_STRENGTH_THRESHOLD) {
-        DEBUG_PRINTF("⚠️ Beacon found but signal weak: %d dBm (threshold: %d)\n",
-                    rssi, BLE_SIGNAL_STRENGTH_THRESHOLD);
-        return; // Ignore weak signals
-      }
-
       // If we were in grace period, cancel it
       if (inGracePeriod) {
         DEBUG_PRINTF("✅ BLE reconnected during grace period! (attempt %d/%d)\n",
@@ -318,8 +1294,9 @@ public:
         endGracePeriod(true); // Successfully reconnected
       }
 
-      // Confirm presence if we have enough detections
-      if (consecutiveDetections >= CONFIRM_SCANS && !currentPresence) {
+      // Confirm presence if we have enough detections; a signal well clear
+      // of the threshold needs no second look
+      if ((consecutiveDetections >= CONFIRM_SCANS || rssiFilter.isConfident()) && !currentPresence) {
         updatePresenceStatus(true, now);
       }
 
@@ -401,9 +1378,12 @@ private:
       consecutiveDetections = 0;
       consecutiveMisses = 0;
 
-      // Update systems
-      publishPresenceUpdate();
-      updateMainDisplay(); // This will call your existing display function
+      // Update systems (publish + existing display function)
+      if (ownFaculty) {
+        notifyPresenceChanged();
+      } else {
+        notifyTrackedPresenceChanged(facultyId, currentPresence);
+      }
     }
   }
 
@@ -417,7 +1397,8 @@ public:
     return currentPresence;
   }
 
-  String getStatusString() const {
+  // Literal, so it is safe to hand to another task
+  const char* getStatusText() const {
     // During grace period, maintain last known status
     if (inGracePeriod) {
       return lastKnownPresence ? "AVAILABLE" : "AWAY";
@@ -428,21 +1409,455 @@ public:
   // Additional methods for debugging (optional)
   bool isInGracePeriod() const { return inGracePeriod; }
 
+  bool isSignalInRange() const { return rssiFilter.isInRange(); }
+  bool isSignalConfident() const { return rssiFilter.isConfident(); }
+  bool hasSignal() const { return rssiFilter.isValid(); }
+  int getFilteredRssi() const { return rssiFilter.getRssi(); }
+
+  uint16_t getDistanceCm() const {
+    return rssiFilter.getDistanceCm(BLE_BEACON_TX_POWER_1M, BLE_PATH_LOSS_EXPONENT_X10);
+  }
+
   unsigned long getGracePeriodRemaining() const {
     if (!inGracePeriod) return 0;
     unsigned long elapsed = millis() - gracePeriodStartTime;
     return elapsed < BLE_GRACE_PERIOD_MS ? (BLE_GRACE_PERIOD_MS - elapsed) : 0;
   }
 
-  String getDetailedStatus() const {
+  const char* formatDetailedStatus(char* output, size_t outputSize) const {
     if (inGracePeriod) {
-      unsigned long remaining = getGracePeriodRemaining() / 1000;
-      return "AVAILABLE (reconnecting... " + String(remaining) + "s)";
+      unsigned remaining = getGracePeriodRemaining() / 1000;
+      snprintf(output, outputSize, "AVAILABLE (reconnecting... %us)", remaining);
+      return output;
     }
-    return getStatusString();
+    return getStatusText();
   }
 };
 
+// ================================
+// BEACON TRACKING (MULTI-FACULTY)
+// ================================
+// Every advertisement is looked up by its integer address in beaconRegistry,
+// which names the tracker its sightings feed. Tracker 0 is this unit's own
+// faculty (the unit identity's beacon); the others follow colleagues listed
+// in the retained beacons message, all within the same scan window.
+BooleanPresenceDetector beaconTrackers[BEACON_REGISTRY_CAPACITY];
+BooleanPresenceDetector& presenceDetector = beaconTrackers[0];
+
+// Read by onResult() on the BLE host task; replaced under bleSightingMux
+BeaconRegistry beaconRegistry;
+uint64_t ownBeaconAddress = 0;
+
+// Faculty each tracker is assigned to (0 = free); owned by the BLE side
+uint16_t trackerFaculty[BEACON_REGISTRY_CAPACITY] = { 0 };
+
+// Beacon list received on the network side, applied by the BLE side
+BeaconRegistry pendingBeaconRegistry;
+volatile bool beaconRegistryPending = false;
+
+// The address was checked at compile time or when it was provisioned
+void initBeaconRegistry() {
+  const UnitIdentity& identity = unitProfile.get();
+  presenceDetector.setIdentity(identity.facultyId, true);
+  trackerFaculty[0] = identity.facultyId;
+  ownBeaconAddress = identity.beaconAddress;
+  beaconRegistry.add(ownBeaconAddress, identity.facultyId, 0);
+}
+
+// Called for every advertisement, so only integer work here
+void reportBeaconAddress(uint64_t address, int rssi) {
+  portENTER_CRITICAL(&bleSightingMux);
+  const BeaconEntry* entry = beaconRegistry.find(address);
+  uint8_t tracker = entry ? entry->tracker : BEACON_NO_TRACKER;
+  portEXIT_CRITICAL(&bleSightingMux);
+
+  if (tracker != BEACON_NO_TRACKER) {
+    beaconTrackers[tracker].reportSighting(rssi);
+  }
+}
+
+void reportBeaconSighting(BLEAdvertisedDevice& device) {
+  reportBeaconAddress(BeaconRegistry::fromBytes(*device.getAddress().getNative()), device.getRSSI());
+}
+
+// Mirrors registry changes into the controller whitelist (BLE_CONTROLLER_FILTER).
+// Only called between scan windows: the controller rejects whitelist
+// changes while a whitelist-filtered scan is running.
+void syncControllerWhitelist(const BeaconRegistry& from, const BeaconRegistry& to) {
+  if (!BLE_CONTROLLER_FILTER) return;
+
+  uint8_t bytes[6];
+  for (uint8_t slot = 0; slot < BEACON_REGISTRY_SLOTS; slot++) {
+    const BeaconEntry* entry = from.entryAt(slot);
+    if (entry && !to.find(entry->address)) {
+      BeaconRegistry::toBytes(entry->address, bytes);
+      BLEDevice::whiteListRemove(BLEAddress(bytes));
+    }
+  }
+  for (uint8_t slot = 0; slot < BEACON_REGISTRY_SLOTS; slot++) {
+    const BeaconEntry* entry = to.entryAt(slot);
+    if (entry && !from.find(entry->address)) {
+      BeaconRegistry::toBytes(entry->address, bytes);
+      BLEDevice::whiteListAdd(BLEAddress(bytes));
+    }
+  }
+}
+
+// Drops sightings from outside a scan window for every tracker
+void discardBeaconSightings() {
+  int rssi;
+  for (int i = 0; i < BEACON_REGISTRY_CAPACITY; i++) {
+    beaconTrackers[i].takeWindowSighting(&rssi);
+  }
+}
+
+int findTracker(const uint16_t* assignment, uint16_t facultyId) {
+  for (int i = 0; i < BEACON_REGISTRY_CAPACITY; i++) {
+    if (assignment[i] == facultyId) return i;
+  }
+  return -1;
+}
+
+// Swaps in a received beacon list. A colleague who stays listed keeps their
+// tracker (and presence state) even if their beacon changed; one who is
+// dropped while present is reported AWAY so their retained status is not stale.
+void applyPendingBeaconRegistry() {
+  if (!beaconRegistryPending) return;
+
+  BeaconRegistry requested;
+  portENTER_CRITICAL(&bleSightingMux);
+  requested = pendingBeaconRegistry;
+  beaconRegistryPending = false;
+  portEXIT_CRITICAL(&bleSightingMux);
+
+  uint16_t assignment[BEACON_REGISTRY_CAPACITY] = { 0 };
+  assignment[0] = unitProfile.getFacultyId();
+
+  // Keep trackers of colleagues still listed, then hand out free ones
+  for (uint8_t slot = 0; slot < BEACON_REGISTRY_SLOTS; slot++) {
+    const BeaconEntry* entry = requested.entryAt(slot);
+    if (!entry || findTracker(assignment, entry->facultyId) >= 0) continue;
+    int kept = findTracker(trackerFaculty, entry->facultyId);
+    if (kept > 0) assignment[kept] = entry->facultyId;
+  }
+  for (uint8_t slot = 0; slot < BEACON_REGISTRY_SLOTS; slot++) {
+    const BeaconEntry* entry = requested.entryAt(slot);
+    if (!entry || findTracker(assignment, entry->facultyId) >= 0) continue;
+    int freeTracker = findTracker(assignment, 0);
+    if (freeTracker < 0) {
+      DEBUG_PRINTF("⚠️ No tracker left for faculty %u\n", entry->facultyId);
+      continue;
+    }
+    assignment[freeTracker] = entry->facultyId;
+  }
+
+  BeaconRegistry next;
+  next.add(ownBeaconAddress, unitProfile.getFacultyId(), 0);
+  for (uint8_t slot = 0; slot < BEACON_REGISTRY_SLOTS; slot++) {
+    const BeaconEntry* entry = requested.entryAt(slot);
+    if (!entry) continue;
+    int tracker = findTracker(assignment, entry->facultyId);
+    if (tracker >= 0) next.add(entry->address, entry->facultyId, tracker);
+  }
+
+  for (int i = 1; i < BEACON_REGISTRY_CAPACITY; i++) {
+    if (assignment[i] == trackerFaculty[i]) continue;
+    if (trackerFaculty[i] != 0 && beaconTrackers[i].getPresence()) {
+      notifyTrackedPresenceChanged(trackerFaculty[i], false);
+    }
+    beaconTrackers[i].reset();
+    beaconTrackers[i].setIdentity(assignment[i], false);
+    trackerFaculty[i] = assignment[i];
+  }
+
+  syncControllerWhitelist(beaconRegistry, next);
+  portENTER_CRITICAL(&bleSightingMux);
+  beaconRegistry = next;
+  portEXIT_CRITICAL(&bleSightingMux);
+
+  DEBUG_PRINTF("👥 Beacon registry: %d beacons\n", next.size());
+}
+
+// Feeds the window's sightings to the colleagues' trackers; the unit's own
+// tracker is driven by AdaptiveBLEScanner, which also picks the scan mode
+void checkTrackedBeacons() {
+  applyPendingBeaconRegistry();
+
+  for (int i = 1; i < BEACON_REGISTRY_CAPACITY; i++) {
+    if (trackerFaculty[i] == 0) continue;
+    int rssi;
+    bool sighted = beaconTrackers[i].takeWindowSighting(&rssi);
+    beaconTrackers[i].checkBeacon(sighted, rssi);
+  }
+}
+
+bool collectBeaconEntry(const JsonToken& token, void* context) {
+  BeaconRegistry& registry = *static_cast<BeaconRegistry*>(context);
+  if (token.depth != 1) return true;
+
+  uint64_t address;
+  long facultyId = token.type == JSON_VALUE_NUMBER ? JsonStream::toLong(token.value, token.valueLength) : 0;
+  if (!BeaconRegistry::parseAddress(token.key, token.keyLength, address) || facultyId <= 0 ||
+      facultyId > 0xFFFF || address == ownBeaconAddress ||
+      !registry.add(address, facultyId, BEACON_NO_TRACKER)) {
+    DEBUG_PRINTF("⚠️ Skipping beacon entry %.*s\n", (int)token.keyLength, token.key ? token.key : "");
+  }
+  return true;
+}
+
+// Network side, e.g. {"51:00:25:04:02:B7":2,"51:00:25:04:02:C4":3}
+// Replaces the colleague list; the unit's own beacon always stays.
+void handleBeaconRegistryMessage(const byte* payload, unsigned int length) {
+  BeaconRegistry requested;
+  if (!JsonStream::parse((const char*)payload, length, collectBeaconEntry, &requested)) {
+    DEBUG_PRINTLN("⚠️ Ignoring malformed beacon list");
+    return;
+  }
+
+  portENTER_CRITICAL(&bleSightingMux);
+  pendingBeaconRegistry = requested;
+  beaconRegistryPending = true;
+  portEXIT_CRITICAL(&bleSightingMux);
+}
+
+// ================================
+// SCAN POLICY
+// ================================
+// Scan timing per situation and time of day. The table starts from the
+// config.h values and can be overlaid by the retained scan_policy
+// message, which the BLE side picks up before its next window.
+ScanPolicyTable defaultScanPolicyTable() {
+  ScanPolicyTable table;
+  ScanParams* day = table.params[0];
+  day[SCAN_MODE_SEARCHING] = { BLE_SCAN_INTERVAL_SEARCHING, BLE_SCAN_DURATION_FULL };
+  day[SCAN_MODE_MONITORING] = { BLE_SCAN_INTERVAL_MONITORING, BLE_SCAN_DURATION_QUICK };
+  day[SCAN_MODE_CONFIDENT] = { BLE_SCAN_INTERVAL_CONFIDENT, BLE_SCAN_DURATION_QUICK };
+  day[SCAN_MODE_VERIFYING] = { BLE_SCAN_INTERVAL_VERIFICATION, BLE_SCAN_DURATION_QUICK };
+  day[SCAN_MODE_GRACE] = { BLE_RECONNECT_ATTEMPT_INTERVAL, BLE_SCAN_DURATION_QUICK };
+
+  // Transitions keep their day timing so confirmations stay as quick
+  ScanParams* night = table.params[1];
+  night[SCAN_MODE_SEARCHING] = { BLE_NIGHT_INTERVAL_SEARCHING, BLE_SCAN_DURATION_QUICK };
+  night[SCAN_MODE_MONITORING] = { BLE_NIGHT_INTERVAL_MONITORING, BLE_SCAN_DURATION_QUICK };
+  night[SCAN_MODE_CONFIDENT] = { BLE_NIGHT_INTERVAL_CONFIDENT, BLE_SCAN_DURATION_QUICK };
+  night[SCAN_MODE_VERIFYING] = day[SCAN_MODE_VERIFYING];
+  night[SCAN_MODE_GRACE] = day[SCAN_MODE_GRACE];
+
+  table.profileStart[0] = SCAN_DAY_START_MINUTE;
+  table.profileStart[1] = SCAN_NIGHT_START_MINUTE;
+  return table;
+}
+
+TableScanPolicy scanPolicy(defaultScanPolicyTable());
+
+// Update received on the network side, installed by the BLE side
+ScanPolicyTable pendingScanPolicy;
+volatile bool scanPolicyPending = false;
+volatile bool scanResultsReleasePending = false;  // Set by the memory monitor
+
+// Local time without blocking; SCAN_POLICY_NO_TIME until NTP has synced
+int localMinuteOfDay() {
+  if (!timeInitialized) return SCAN_POLICY_NO_TIME;
+
+  time_t now = time(nullptr);
+  struct tm timeinfo;
+  localtime_r(&now, &timeinfo);
+  return timeinfo.tm_hour * 60 + timeinfo.tm_min;
+}
+
+void applyPendingScanPolicy() {
+  if (!scanPolicyPending) return;
+
+  portENTER_CRITICAL(&bleSightingMux);
+  scanPolicy.setTable(pendingScanPolicy);
+  scanPolicyPending = false;
+  portEXIT_CRITICAL(&bleSightingMux);
+  DEBUG_PRINTLN("📡 Scan policy updated");
+}
+
+// Between windows, on the scanner's own task
+void releasePendingScanResults() {
+  if (!scanResultsReleasePending) return;
+  scanResultsReleasePending = false;
+  pBLEScan->clearResults();
+  DEBUG_PRINTLN("🧹 BLE scan results released");
+}
+
+// e.g. {"night":{"monitoring":{"interval_ms":30000,"duration_s":1}},"night_start":"20:00"}
+void handleScanPolicyMessage(const byte* payload, unsigned int length) {
+  ScanPolicyTable table;
+  portENTER_CRITICAL(&bleSightingMux);
+  table = scanPolicyPending ? pendingScanPolicy : scanPolicy.getTable();
+  portEXIT_CRITICAL(&bleSightingMux);
+
+  if (!TableScanPolicy::parseUpdate((const char*)payload, length, table) || !TableScanPolicy::validate(table)) {
+    DEBUG_PRINTLN("⚠️ Ignoring invalid scan policy");
+    return;
+  }
+
+  portENTER_CRITICAL(&bleSightingMux);
+  pendingScanPolicy = table;
+  scanPolicyPending = true;
+  portEXIT_CRITICAL(&bleSightingMux);
+}
+
+// ================================
+// UNIT PROVISIONING
+// ================================
+// Network side. Topics, subscriptions and the beacon registry all derive
+// from the identity, so a new one takes effect through a restart (see
+// restartIfQuiet()). The retained message comes back on every connect,
+// which is why it is compared with the identity in use first.
+//
+// Any broker client can publish here, so a message is only taken when it
+// carries an HMAC-SHA256 under UNIT_PROVISIONING_KEY: "<64 hex digits>\n<body>",
+// the HMAC over "<provisioning topic>\n<body>". The topic names the chip, so
+// a record signed for one unit does not apply to another.
+#if UNIT_PROVISIONING_ENABLED
+#define PROVISION_SIGNATURE_HEX (SIGNATURE_LENGTH * 2)
+
+void setupProvisioningKey() {
+  MessageAuthenticator::init();
+  if (!MessageAuthenticator::setKey((const uint8_t*)UNIT_PROVISIONING_KEY, strlen(UNIT_PROVISIONING_KEY))) {
+    DEBUG_PRINTLN("⚠️ Provisioning key rejected - provisioning messages will be ignored");
+  }
+}
+
+// Checks the signature line; body points past it on success. A signature
+// alone (no newline) signs an empty body.
+bool authenticateProvisioning(const byte* payload, unsigned int length, const char*& body, size_t& bodyLength) {
+  if (length < PROVISION_SIGNATURE_HEX ||
+      (length > PROVISION_SIGNATURE_HEX && payload[PROVISION_SIGNATURE_HEX] != '\n')) {
+    return false;
+  }
+  size_t headerLength = min((size_t)length, (size_t)PROVISION_SIGNATURE_HEX + 1);
+  body = (const char*)payload + headerLength;
+  bodyLength = length - headerLength;
+
+  const char* topic = unitProfile.getTopic(UNIT_TOPIC_PROVISION);
+  size_t topicLength = strlen(topic);
+  ScratchFrame frame(networkScratch);
+  char* signature = static_cast<char*>(frame.allocate(PROVISION_SIGNATURE_HEX + 1));
+  char* signedText = static_cast<char*>(frame.allocate(topicLength + 1 + bodyLength + 1));
+  if (!signature || !signedText) {
+    DEBUG_PRINTLN("⚠️ Network scratch exhausted, provisioning message not checked");
+    return false;
+  }
+  memcpy(signature, payload, PROVISION_SIGNATURE_HEX);
+  signature[PROVISION_SIGNATURE_HEX] = '\0';
+  memcpy(signedText, topic, topicLength);
+  signedText[topicLength] = '\n';
+  memcpy(signedText + topicLength + 1, body, bodyLength);
+  signedText[topicLength + 1 + bodyLength] = '\0';
+  return strlen(signedText) == topicLength + 1 + bodyLength &&
+         MessageAuthenticator::verifyMessage(signedText, signature);
+}
+#else
+void setupProvisioningKey() {}
+
+// Never subscribed in this image
+bool authenticateProvisioning(const byte* payload, unsigned int length, const char*& body, size_t& bodyLength) {
+  return false;
+}
+#endif
+
+void handleProvisioningMessage(const byte* payload, unsigned int length) {
+  // Clearing the retained message on the broker; the unit keeps its identity
+  if (length == 0) return;
+
+  const char* body;
+  size_t bodyLength;
+  if (!authenticateProvisioning(payload, length, body, bodyLength)) {
+    DEBUG_PRINTLN("⚠️ Ignoring unsigned provisioning message");
+    return;
+  }
+
+  // A signed empty body returns the unit to the image defaults
+  if (bodyLength == 0) {
+    if (!unitProfile.isProvisioned() || !UnitProfile::erase()) return;
+    DEBUG_PRINTLN("🪪 Provisioning cleared - restart into the image defaults scheduled");
+    identityRebootPending = true;
+    return;
+  }
+
+  UnitIdentity requested = unitProfile.get();
+  if (!UnitProfile::parseProvisioning(body, bodyLength, requested)) {
+    DEBUG_PRINTLN("⚠️ Ignoring invalid provisioning message");
+    return;
+  }
+
+  bool changed = !UnitProfile::sameIdentity(requested, unitProfile.get());
+  if (!changed && unitProfile.isProvisioned()) return;
+  if (!UnitProfile::store(requested)) {
+    DEBUG_PRINTLN("❌ Provisioning could not be stored");
+    return;
+  }
+
+  // The same identity as the image default only needs recording
+  if (!changed) return;
+  DEBUG_PRINTF("🪪 Provisioned as faculty %u (%s) - restart scheduled for a quiet moment\n",
+               requested.facultyId, requested.name);
+  identityRebootPending = true;
+}
+
+// ================================
+// CONTROLLER-FILTERED SCANNING
+// ================================
+// With BLE_CONTROLLER_FILTER the scan bypasses BLEScan: the controller is
+// told to report only whitelisted addresses, once per window, so the host
+// never sees the phones and watches around it. Results arrive through the
+// custom GAP handler on the BLE host task, like onResult() would.
+volatile uint32_t controllerScanSeconds = 0;
+
+void onControllerScanEvent(esp_gap_ble_cb_event_t event, esp_ble_gap_cb_param_t* param) {
+  switch (event) {
+    case ESP_GAP_BLE_SCAN_PARAM_SET_COMPLETE_EVT:
+      if (controllerScanSeconds > 0) {
+        esp_ble_gap_start_scanning(controllerScanSeconds);
+        controllerScanSeconds = 0;
+      }
+      break;
+
+    case ESP_GAP_BLE_SCAN_RESULT_EVT:
+      if (param->scan_rst.search_evt == ESP_GAP_SEARCH_INQ_RES_EVT) {
+        reportBeaconAddress(BeaconRegistry::fromBytes(param->scan_rst.bda), param->scan_rst.rssi);
+      } else if (param->scan_rst.search_evt == ESP_GAP_SEARCH_INQ_CMPL_EVT) {
+        bleScanWindowComplete = true;
+        wakeBleScanner();
+      }
+      break;
+
+    default:
+      break;
+  }
+}
+
+// Scanning starts once the controller has taken the parameters
+bool startControllerScan(int durationSeconds) {
+  esp_ble_scan_params_t params;
+  params.scan_type = BLE_PASSIVE_SCAN ? BLE_SCAN_TYPE_PASSIVE : BLE_SCAN_TYPE_ACTIVE;
+  params.own_addr_type = BLE_ADDR_TYPE_PUBLIC;
+  params.scan_filter_policy = BLE_SCAN_FILTER_ALLOW_ONLY_WLST;
+  params.scan_interval = BLE_RADIO_SCAN_INTERVAL_MS * 1000 / 625;  // 0.625 ms units
+  params.scan_window = BLE_RADIO_SCAN_WINDOW_MS * 1000 / 625;
+  params.scan_duplicate = BLE_SCAN_DUPLICATE_ENABLE;
+
+  controllerScanSeconds = durationSeconds;
+  if (esp_ble_gap_set_scan_params(&params) != ESP_OK) {
+    controllerScanSeconds = 0;
+    return false;
+  }
+  return true;
+}
+
+void stopScanWindow() {
+  if (BLE_CONTROLLER_FILTER) {
+    esp_ble_gap_stop_scanning();
+  } else {
+    pBLEScan->stop();
+  }
+}
+
 // ================================
 // ADAPTIVE BLE SCANNER CLASS (Enhanced for Grace Period)
 // ================================
@@ -466,6 +1881,15 @@ private:
     // Reference to presence detector (will be set in init)
     BooleanPresenceDetector* presenceDetectorPtr = nullptr;
 
+    // Interval/duration per situation (set in init)
+    ScanPolicy* policy = nullptr;
+    uint8_t windowProfile = 0;
+
+    // Background scan window (BLE_NONBLOCKING_SCAN)
+    bool scanInProgress = false;
+    unsigned long scanStartTime = 0;
+    int scanWindowDuration = 0;
+
     // Performance stats
     struct {
         unsigned long totalScans = 0;
@@ -476,35 +1900,41 @@ private:
         unsigned long timeInMonitoring = 0;
         unsigned long timeInVerifying = 0;
         unsigned long lastModeStart = 0;
+        unsigned long radioOnMs[SCAN_POLICY_PROFILES] = { 0 };
+        unsigned long windows[SCAN_POLICY_PROFILES] = { 0 };
+        unsigned long profileTime[SCAN_POLICY_PROFILES] = { 0 };
     } stats;
 
-    // Dynamic intervals based on mode and grace period
-    unsigned long getCurrentScanInterval() {
+    // Window timing comes from the scan policy for the current situation
+    ScanPolicyMode getPolicyMode() {
         // During grace period, scan more frequently to catch reconnections
         if (presenceDetectorPtr && presenceDetectorPtr->isInGracePeriod()) {
-            return BLE_RECONNECT_ATTEMPT_INTERVAL;
+            return SCAN_MODE_GRACE;
         }
 
         switch(currentMode) {
-            case SEARCHING: return BLE_SCAN_INTERVAL_SEARCHING;
-            case MONITORING: return BLE_SCAN_INTERVAL_MONITORING;
-            case VERIFYING: return BLE_SCAN_INTERVAL_VERIFICATION;
-            default: return BLE_SCAN_INTERVAL_SEARCHING;
+            case SEARCHING: return SCAN_MODE_SEARCHING;
+            case MONITORING:
+                // A signal well clear of the threshold can be checked less often
+                return (presenceDetectorPtr && presenceDetectorPtr->isSignalConfident()) ?
+                       SCAN_MODE_CONFIDENT : SCAN_MODE_MONITORING;
+            case VERIFYING: return SCAN_MODE_VERIFYING;
+            default: return SCAN_MODE_SEARCHING;
         }
     }
 
+    unsigned long getCurrentScanInterval() {
+        return policy->getParams(getPolicyMode(), localMinuteOfDay()).intervalMs;
+    }
+
     int getCurrentScanDuration() {
-        // During grace period, use quick scans to save power while still being responsive
-        if (presenceDetectorPtr && presenceDetectorPtr->isInGracePeriod()) {
-            return BLE_SCAN_DURATION_QUICK;
-        }
+        return policy->getParams(getPolicyMode(), localMinuteOfDay()).durationSeconds;
+    }
 
-        switch(currentMode) {
-            case SEARCHING: return BLE_SCAN_DURATION_FULL;
-            case MONITORING: return BLE_SCAN_DURATION_QUICK;
-            case VERIFYING: return BLE_SCAN_DURATION_QUICK;
-            default: return BLE_SCAN_DURATION_FULL;
-        }
+    // Radio time is charged to the profile that scheduled the window
+    void recordRadioTime(unsigned long listenedMs) {
+        stats.radioOnMs[windowProfile] += listenedMs;
+        stats.windows[windowProfile]++;
     }
 
     void updateStats(unsigned long now) {
@@ -515,6 +1945,7 @@ private:
             case MONITORING: stats.timeInMonitoring += timeInMode; break;
             case VERIFYING: stats.timeInVerifying += timeInMode; break;
         }
+        stats.profileTime[policy->getProfile(localMinuteOfDay())] += timeInMode;
         stats.lastModeStart = now;
 
         // Report stats periodically
@@ -542,32 +1973,65 @@ private:
             DEBUG_PRINTF("   Time Distribution - Searching: %.1f%% | Monitoring: %.1f%% | Verifying: %.1f%%\n",
                         searchingPercent, monitoringPercent, verifyingPercent);
             DEBUG_PRINTF("   Current Mode: %s | Interval: %lums\n",
-                        getModeString().c_str(), getCurrentScanInterval());
+                        getModeName(), getCurrentScanInterval());
+        }
+
+        // Radio duty cycle per policy profile
+        for (uint8_t i = 0; i < policy->getProfileCount(); i++) {
+            if (stats.profileTime[i] == 0) continue;
+            DEBUG_PRINTF("   Radio On [%s]: %lus over %lu windows | %.1f%% duty\n",
+                        policy->getProfileName(i), stats.radioOnMs[i] / 1000, stats.windows[i],
+                        (stats.radioOnMs[i] * 100.0) / stats.profileTime[i]);
         }
     }
 
 public:
-    void init(BooleanPresenceDetector* detector) {
+    void init(BooleanPresenceDetector* detector, ScanPolicy* scanPolicy) {
         presenceDetectorPtr = detector;
+        policy = scanPolicy;
         currentMode = SEARCHING;
         lastScanTime = 0;
         modeChangeTime = millis();
         statsReportTime = millis();
         stats.lastModeStart = millis();
 
+        ScanParams searching = policy->getParams(SCAN_MODE_SEARCHING, localMinuteOfDay());
+        ScanParams monitoring = policy->getParams(SCAN_MODE_MONITORING, localMinuteOfDay());
         DEBUG_PRINTLN("🔍 Adaptive BLE Scanner with Grace Period initialized");
-        DEBUG_PRINTF("   Searching Mode: %dms interval, %ds duration\n",
-                    BLE_SCAN_INTERVAL_SEARCHING, BLE_SCAN_DURATION_FULL);
-        DEBUG_PRINTF("   Monitoring Mode: %dms interval, %ds duration\n",
-                    BLE_SCAN_INTERVAL_MONITORING, BLE_SCAN_DURATION_QUICK);
+        DEBUG_PRINTF("   Searching Mode: %lums interval, %ds duration\n",
+                    (unsigned long)searching.intervalMs, searching.durationSeconds);
+        DEBUG_PRINTF("   Monitoring Mode: %lums interval, %ds duration\n",
+                    (unsigned long)monitoring.intervalMs, monitoring.durationSeconds);
         DEBUG_PRINTF("   Grace Period: %ds with %dms reconnect attempts\n",
                     BLE_GRACE_PERIOD_MS / 1000, BLE_RECONNECT_ATTEMPT_INTERVAL);
     }
 
     void update() {
-        if (!presenceDetectorPtr) return;  // Safety check
+        if (!presenceDetectorPtr || !policy) return;  // Safety check
 
         unsigned long now = millis();
+
+        // The controller-filtered scan only exists as a background window
+        if (BLE_NONBLOCKING_SCAN || BLE_CONTROLLER_FILTER) {
+            if (scanInProgress) {
+                if (!bleScanWindowComplete) {
+                    // Radio is still listening in the background - never block here
+                    unsigned long windowLimit = scanWindowDuration * 1000UL + BLE_SCAN_COMPLETE_GRACE_MS;
+                    if (now - scanStartTime < windowLimit) return;
+
+                    DEBUG_PRINTLN("⚠️ BLE scan window overran - stopping scan");
+                    stopScanWindow();
+                }
+                finishScanWindow(now);
+            }
+
+            if (now - lastScanTime < getCurrentScanInterval()) return;
+
+            updateStats(now);
+            startScanWindow(now);
+            return;
+        }
+
         unsigned long interval = getCurrentScanInterval();
 
         // Check if it's time to scan
@@ -577,12 +2041,103 @@ public:
         updateStats(now);
 
         // Perform adaptive scan
-        bool beaconFound = performScan();
+        applyPendingScanPolicy();
+        releasePendingScanResults();
+        windowProfile = policy->getProfile(localMinuteOfDay());
+        int bestRSSI;
+        PerfScope scanSpan(PERF_SPAN_SCAN);  // The whole blocking window
+        bool beaconFound = performScan(&bestRSSI);
+        recordRadioTime(millis() - now);
+        lastScanTime = now;
+        processScanResult(beaconFound, bestRSSI, now, interval);
+        checkTrackedBeacons();
+    }
+
+    unsigned long getTotalScans() { return stats.totalScans; }
+    unsigned long getDetections() { return stats.successfulDetections; }
+
+    unsigned long getRadioOnMs() {
+        unsigned long total = 0;
+        for (uint8_t i = 0; i < SCAN_POLICY_PROFILES; i++) {
+            total += stats.radioOnMs[i];
+        }
+        return total;
+    }
+
+    // Nothing to do but wait for the next SEARCHING window
+    bool isIdleSearching() {
+        return presenceDetectorPtr && policy && !scanInProgress &&
+               getPolicyMode() == SCAN_MODE_SEARCHING;
+    }
+
+    // Time until update() has work: the window deadline while a background
+    // scan runs, otherwise the next scan's start
+    unsigned long msUntilNextAction() {
+        if (!presenceDetectorPtr || !policy) return BLE_SCAN_COMPLETE_GRACE_MS;
+
+        unsigned long now = millis();
+        unsigned long due, elapsed;
+        if (scanInProgress) {
+            if (bleScanWindowComplete) return 0;
+            due = scanWindowDuration * 1000UL + BLE_SCAN_COMPLETE_GRACE_MS;
+            elapsed = now - scanStartTime;
+        } else {
+            due = getCurrentScanInterval();
+            elapsed = now - lastScanTime;
+        }
+        return elapsed >= due ? 0 : due - elapsed;
+    }
+
+private:
+    void startScanWindow(unsigned long now) {
+        discardBeaconSightings();  // Drop sightings from outside a window
+        applyPendingScanPolicy();
+        releasePendingScanResults();
+        windowProfile = policy->getProfile(localMinuteOfDay());
+
+        scanWindowDuration = getCurrentScanDuration();
+        bleScanWindowComplete = false;
+
+        bool started = BLE_CONTROLLER_FILTER ? startControllerScan(scanWindowDuration)
+                                             : pBLEScan->start(scanWindowDuration, onBLEScanComplete, false);
+        if (started) {
+            scanInProgress = true;
+            scanStartTime = now;
+        } else {
+            DEBUG_PRINTLN("⚠️ BLE scan start failed - retrying next interval");
+        }
         lastScanTime = now;
+    }
+
+    void finishScanWindow(unsigned long now) {
+        PERF_PROFILE_SCOPE(PERF_SPAN_SCAN);  // Only the processing; the radio ran in the background
+        scanInProgress = false;
+        recordRadioTime(min(now - scanStartTime, scanWindowDuration * 1000UL));
+
+        int bestRSSI;
+        bool beaconFound = presenceDetectorPtr->takeWindowSighting(&bestRSSI);
+        if (!BLE_CONTROLLER_FILTER) pBLEScan->clearResults();
+
+        processScanResult(beaconFound, bestRSSI, now, getCurrentScanInterval());
+        checkTrackedBeacons();
+    }
+
+    void processScanResult(bool beaconFound, int bestRSSI, unsigned long now, unsigned long interval) {
         stats.totalScans++;
 
-        if (beaconFound) {
-            stats.successfulDetections++;
+        // Send to presence detector (this handles grace period logic)
+        presenceDetectorPtr->checkBeacon(beaconFound, bestRSSI);
+
+        // Log RSSI occasionally for signal strength monitoring
+        if (beaconFound && stats.totalScans % 20 == 0) {
+            DEBUG_PRINTF("📶 Beacon RSSI: %d dBm | filtered %d dBm | ~%u cm\n", bestRSSI,
+                        presenceDetectorPtr->getFilteredRssi(), presenceDetectorPtr->getDistanceCm());
+        }
+
+        // Mode decisions follow the filtered level, not the raw sighting
+        bool detected = beaconFound && presenceDetectorPtr->isSignalInRange();
+        if (beaconFound) stats.successfulDetections++;
+        if (detected) {
             consecutiveDetections++;
             consecutiveMisses = 0;
         } else {
@@ -591,72 +2146,57 @@ public:
         }
 
         // Smart mode switching (enhanced for grace period)
-        updateScanMode(beaconFound, now);
-
-        // Send to presence detector (this handles grace period logic)
-        presenceDetectorPtr->checkBeacon(beaconFound);
+        updateScanMode(detected, now);
 
         // Debug info (show grace period status)
         if (stats.totalScans % 10 == 0 || beaconFound || presenceDetectorPtr->isInGracePeriod()) {
-            String gracePeriodInfo = "";
+            char gracePeriodInfo[24] = "";
             if (presenceDetectorPtr->isInGracePeriod()) {
-                unsigned long remaining = presenceDetectorPtr->getGracePeriodRemaining() / 1000;
-                gracePeriodInfo = " | GRACE: " + String(remaining) + "s";
+                unsigned remaining = presenceDetectorPtr->getGracePeriodRemaining() / 1000;
+                snprintf(gracePeriodInfo, sizeof(gracePeriodInfo), " | GRACE: %us", remaining);
             }
 
             DEBUG_PRINTF("🔍 BLE Scan #%lu: %s | Mode: %s%s | Next: %lums\n",
                         stats.totalScans,
                         beaconFound ? "✅ FOUND" : "❌ MISS",
-                        getModeString().c_str(),
-                        gracePeriodInfo.c_str(),
+                        getModeName(),
+                        gracePeriodInfo,
                         interval);
         }
     }
 
+public:
     // Get current scanning statistics
-    String getStatsString() {
+    // Short "MON:87%" form: mode and share of active time spent monitoring
+    const char* formatStats(char* output, size_t outputSize) {
         float efficiency = 0;
         unsigned long totalActiveTime = stats.timeInSearching + stats.timeInMonitoring;
         if (totalActiveTime > 0) {
             efficiency = (stats.timeInMonitoring * 100.0) / totalActiveTime;
         }
 
-        String modeStr = getModeString().substring(0, 3);
+        const char* mode = getModeName();
         if (presenceDetectorPtr && presenceDetectorPtr->isInGracePeriod()) {
-            modeStr = "GRC"; // Grace period indicator
+            mode = "GRC"; // Grace period indicator
         }
 
-        return modeStr + ":" + String(efficiency, 0) + "%";
+        snprintf(output, outputSize, "%.3s:%.0f%%", mode, efficiency);
+        return output;
     }
 
 private:
-    bool performScan() {
+    bool performScan(int* bestRSSI) {
         int duration = getCurrentScanDuration();
 
         // Add error handling for BLE scan
-        BLEScanResults* results = nullptr;
         bool beaconDetected = false;
-        int bestRSSI = -999;
+        *bestRSSI = -999;
 
         try {
-            results = pBLEScan->start(duration, false);
-
-            if (results && results->getCount() > 0) {
-                for (int i = 0; i < results->getCount(); i++) {
-                    BLEAdvertisedDevice device = results->getDevice(i);
-                    if (isFacultyBeacon(device)) {
-                        beaconDetected = true;
-                        bestRSSI = device.getRSSI();
-
-                        // Log RSSI occasionally for signal strength monitoring
-                        if (stats.totalScans % 20 == 0) {
-                            DEBUG_PRINTF("📶 Beacon RSSI: %d dBm\n", bestRSSI);
-                        }
-                        break;
-                    }
-                }
-            }
-
+            // Sightings come in through onResult(); BLEScanResults stays empty
+            discardBeaconSightings();
+            pBLEScan->start(duration, false);
+            beaconDetected = presenceDetectorPtr->takeWindowSighting(bestRSSI);
             pBLEScan->clearResults();
 
         } catch (...) {
@@ -669,19 +2209,25 @@ private:
 
     void updateScanMode(bool beaconFound, unsigned long now) {
         ScanMode newMode = currentMode;
+        bool confident = presenceDetectorPtr->isSignalConfident();
 
         switch(currentMode) {
             case SEARCHING:
-                // Switch to verification after consistent detections
-                if (consecutiveDetections >= 2) {
+                // A strong, steady signal needs no verification phase
+                if (beaconFound && confident) {
+                    newMode = MONITORING;
+                    DEBUG_PRINTLN("📡 BLE Mode: SEARCHING -> MONITORING (strong signal)");
+                } else if (consecutiveDetections >= 2) {
+                    // Switch to verification after consistent detections
                     newMode = VERIFYING;
                     DEBUG_PRINTLN("📡 BLE Mode: SEARCHING -> VERIFYING (beacon detected)");
                 }
                 break;
 
             case MONITORING:
-                // Switch to verification if beacon goes missing
-                if (consecutiveMisses >= 2) {
+                // Switch to verification if beacon goes missing, unless the
+                // filtered level is still well in range (a lost window or two)
+                if (consecutiveMisses >= 2 && !confident) {
                     newMode = VERIFYING;
                     DEBUG_PRINTLN("📡 BLE Mode: MONITORING -> VERIFYING (beacon lost)");
                 }
@@ -689,7 +2235,10 @@ private:
 
             case VERIFYING:
                 // Stay in verification for minimum time, then decide
-                if (now - modeChangeTime > PRESENCE_CONFIRM_TIME) {
+                if (beaconFound && confident) {
+                    newMode = MONITORING;
+                    DEBUG_PRINTLN("📡 BLE Mode: VERIFYING -> MONITORING (strong signal)");
+                } else if (now - modeChangeTime > PRESENCE_CONFIRM_TIME) {
                     if (consecutiveDetections > consecutiveMisses) {
                         newMode = MONITORING;
                         DEBUG_PRINTLN("📡 BLE Mode: VERIFYING -> MONITORING (presence confirmed)");
@@ -717,7 +2266,7 @@ private:
         }
     }
 
-    String getModeString() {
+    const char* getModeName() const {
         switch(currentMode) {
             case SEARCHING: return "SEARCHING";
             case MONITORING: return "MONITORING";
@@ -730,7 +2279,6 @@ private:
 // ================================
 // GLOBAL INSTANCES (CORRECT ORDER)
 // ================================
-BooleanPresenceDetector presenceDetector;
 ButtonHandler buttons(BUTTON_A_PIN, BUTTON_B_PIN);
 AdaptiveBLEScanner adaptiveScanner;
 
@@ -738,38 +2286,49 @@ AdaptiveBLEScanner adaptiveScanner;
 // BLE CALLBACK CLASS
 // ================================
 class MyAdvertisedDeviceCallbacks: public BLEAdvertisedDeviceCallbacks {
-  void onResult(BLEAdvertisedDevice advertisedDevice) {}
+  void onResult(BLEAdvertisedDevice advertisedDevice) {
+    // Runs on the BLE host task while a background scan window is open
+    reportBeaconSighting(advertisedDevice);
+  }
 };
 
 // ================================
-// SIMPLE UI HELPER FUNCTIONS (UNCHANGED)
+// SIMPLE UI HELPER FUNCTIONS
 // ================================
+// All drawing is recorded through DisplayOptimizer; only tiles whose
+// content changed are pushed to the panel when the frame ends.
 void drawSimpleCard(int x, int y, int w, int h, uint16_t color) {
-  tft.fillRect(x, y, w, h, color);
-  tft.drawRect(x, y, w, h, COLOR_ACCENT);
+  DisplayOptimizer::optimizedFillRect(x, y, w, h, color);
+  DisplayOptimizer::optimizedDrawRect(x, y, w, h, COLOR_ACCENT);
+}
+
+// Draws text in the built-in font and returns the x just past it
+int drawText(int x, int y, const char* text, uint16_t color, uint8_t size) {
+  DisplayOptimizer::optimizedDrawText(x, y, text, color, size);
+  return x + strlen(text) * 6 * size;
 }
 
 void drawStatusIndicator(int x, int y, bool available) {
   int radius = 12;
   if (available) {
     if (animationState) {
-      tft.fillCircle(x, y, radius + 2, COLOR_SUCCESS);
-      tft.fillCircle(x, y, radius, COLOR_ACCENT);
+      DisplayOptimizer::optimizedFillCircle(x, y, radius + 2, COLOR_SUCCESS);
+      DisplayOptimizer::optimizedFillCircle(x, y, radius, COLOR_ACCENT);
     } else {
-      tft.fillCircle(x, y, radius, COLOR_SUCCESS);
+      DisplayOptimizer::optimizedFillCircle(x, y, radius, COLOR_SUCCESS);
     }
-    tft.fillCircle(x, y, radius - 4, COLOR_WHITE);
-    tft.fillCircle(x, y, 3, COLOR_SUCCESS);
+    DisplayOptimizer::optimizedFillCircle(x, y, radius - 4, COLOR_WHITE);
+    DisplayOptimizer::optimizedFillCircle(x, y, 3, COLOR_SUCCESS);
   } else {
-    tft.fillCircle(x, y, radius, COLOR_ERROR);
-    tft.fillCircle(x, y, radius - 4, COLOR_WHITE);
-    tft.fillCircle(x, y, 3, COLOR_ERROR);
+    DisplayOptimizer::optimizedFillCircle(x, y, radius, COLOR_ERROR);
+    DisplayOptimizer::optimizedFillCircle(x, y, radius - 4, COLOR_WHITE);
+    DisplayOptimizer::optimizedFillCircle(x, y, 3, COLOR_ERROR);
   }
 }
 
-int getCenterX(String text, int textSize) {
+int getCenterX(const char* text, int textSize) {
   int charWidth = 6 * textSize;
-  int textWidth = text.length() * charWidth;
+  int textWidth = strlen(text) * charWidth;
   return (SCREEN_WIDTH - textWidth) / 2;
 }
 
@@ -777,25 +2336,14 @@ int getCenterX(String text, int textSize) {
 // BUTTON RESPONSE FUNCTIONS (UNCHANGED)
 // ================================
 void handleAcknowledgeButton() {
-  if (!messageDisplayed || currentMessage.isEmpty()) return;
+  if (!messageDisplayed || currentMessage == nullptr) return;
 
   DEBUG_PRINTLN("📤 Sending ACKNOWLEDGE response to central terminal");
 
-  // Create acknowledge response
-  String response = "{";
-  response += "\"faculty_id\":" + String(FACULTY_ID) + ",";
-  response += "\"faculty_name\":\"" + String(FACULTY_NAME) + "\",";
-  response += "\"response_type\":\"ACKNOWLEDGE\",";
-  response += "\"message_id\":\"" + messageId + "\",";
-  response += "\"original_message\":\"" + currentMessage + "\",";
-  response += "\"timestamp\":\"" + String(millis()) + "\",";
-  response += "\"status\":\"Professor acknowledges the request and will respond accordingly\"";
-  response += "}";
-
   // Publish response with offline queuing support
-  bool success = publishWithQueue(MQTT_TOPIC_RESPONSES, response.c_str(), true);
+  bool success = submitResponse(RESPONSE_ACKNOWLEDGE, *currentMessage);
   if (success) {
-    if (mqttClient.connected()) {
+    if (mqttConnected) {
       DEBUG_PRINTLN("✅ ACKNOWLEDGE response sent successfully");
       showResponseConfirmation("ACKNOWLEDGED", COLOR_BLUE);
     } else {
@@ -812,25 +2360,14 @@ void handleAcknowledgeButton() {
 }
 
 void handleBusyButton() {
-  if (!messageDisplayed || currentMessage.isEmpty()) return;
+  if (!messageDisplayed || currentMessage == nullptr) return;
 
   DEBUG_PRINTLN("📤 Sending BUSY response to central terminal");
 
-  // Create busy response
-  String response = "{";
-  response += "\"faculty_id\":" + String(FACULTY_ID) + ",";
-  response += "\"faculty_name\":\"" + String(FACULTY_NAME) + "\",";
-  response += "\"response_type\":\"BUSY\",";
-  response += "\"message_id\":\"" + messageId + "\",";
-  response += "\"original_message\":\"" + currentMessage + "\",";
-  response += "\"timestamp\":\"" + String(millis()) + "\",";
-  response += "\"status\":\"Professor is currently busy and cannot cater to this request\"";
-  response += "}";
-
   // Publish response with offline queuing support
-  bool success = publishWithQueue(MQTT_TOPIC_RESPONSES, response.c_str(), true);
+  bool success = submitResponse(RESPONSE_BUSY, *currentMessage);
   if (success) {
-    if (mqttClient.connected()) {
+    if (mqttConnected) {
       DEBUG_PRINTLN("✅ BUSY response sent successfully");
       showResponseConfirmation("MARKED BUSY", COLOR_ERROR);
     } else {
@@ -846,58 +2383,192 @@ void handleBusyButton() {
   clearCurrentMessage();
 }
 
-void showResponseConfirmation(String confirmText, uint16_t color) {
+void showResponseConfirmation(const char* confirmText, uint16_t color) {
+  DisplayOptimizer::beginFrame();
+  DisplayOptimizer::beginLayer(DISPLAY_LAYER_MAIN);
+
   // Clear main area
-  tft.fillRect(0, MAIN_AREA_Y, SCREEN_WIDTH, MAIN_AREA_HEIGHT, COLOR_WHITE);
+  DisplayOptimizer::optimizedFillRect(0, MAIN_AREA_Y, SCREEN_WIDTH, MAIN_AREA_HEIGHT, COLOR_WHITE);
 
   // Show confirmation card
   drawSimpleCard(20, STATUS_CENTER_Y - 30, 280, 60, color);
+  drawText(getCenterX(confirmText, 2), STATUS_CENTER_Y - 15, confirmText, COLOR_WHITE, 2);
+  drawText(getCenterX("Response Sent", 1), STATUS_CENTER_Y + 10, "Response Sent", COLOR_WHITE, 1);
 
-  int confirmX = getCenterX(confirmText, 2);
-  tft.setCursor(confirmX, STATUS_CENTER_Y - 15);
-  tft.setTextSize(2);
-  tft.setTextColor(COLOR_WHITE);
-  tft.print(confirmText);
-
-  tft.setCursor(getCenterX("Response Sent", 1), STATUS_CENTER_Y + 10);
-  tft.setTextSize(1);
-  tft.setTextColor(COLOR_WHITE);
-  tft.print("Response Sent");
+  DisplayOptimizer::endFrame();
 
-  delay(CONFIRMATION_DISPLAY_TIME);
+  holdConfirmation();
 }
 
 void clearCurrentMessage() {
-  currentMessage = "";
+  EnhancedDisplayManager::clearDisplay();
+  removeCurrentMessage();
   messageDisplayed = false;
   messageDisplayStart = 0;
-  messageId = "";
-  updateMainDisplay(); // Return to normal display
+
+  if (!isConfirmationShowing()) showNextScreen();
+}
+
+// Work through the rest of the inbox before returning to normal display
+void showNextScreen() {
+  if (!showInboxMessage(0)) {
+    updateMainDisplay();
+  }
+}
+
+// ================================
+// WIFI FAST CONNECT
+// ================================
+// The last association lives in RTC memory across resets and sleep, with an
+// NVS copy for power cycles. Joining the cached AP on its channel skips the
+// scan, and a recent DHCP lease is reused as a static address to skip DHCP.
+uint32_t wifiFastCacheCheck(const WifiFastCache& cache) {
+  const uint8_t* bytes = (const uint8_t*)&cache;
+  uint32_t hash = 2166136261UL;
+  for (size_t i = 0; i < offsetof(WifiFastCache, check); i++) {
+    hash = (hash ^ bytes[i]) * 16777619UL;
+  }
+  return hash;
+}
+
+bool wifiFastCacheValid(const WifiFastCache& cache) {
+  return cache.magic == WIFI_FAST_CACHE_MAGIC && cache.check == wifiFastCacheCheck(cache);
+}
+
+// Power-on leaves RTC memory random; NVS covers that case
+bool loadWifiFastCache() {
+  if (wifiFastCacheValid(wifiFastCache)) return true;
+
+  Preferences prefs;
+  bool loaded = prefs.begin(WIFI_FAST_CACHE_NAMESPACE, true) &&
+                prefs.getBytes("cache", &wifiFastCache, sizeof(wifiFastCache)) == sizeof(wifiFastCache) &&
+                wifiFastCacheValid(wifiFastCache);
+  prefs.end();
+  if (!loaded) memset(&wifiFastCache, 0, sizeof(wifiFastCache));
+  return loaded;
+}
+
+void storeWifiFastCache(bool toFlash) {
+  wifiFastCache.magic = WIFI_FAST_CACHE_MAGIC;
+  wifiFastCache.check = wifiFastCacheCheck(wifiFastCache);
+  if (!toFlash) return;
+
+  Preferences prefs;
+  if (prefs.begin(WIFI_FAST_CACHE_NAMESPACE, false)) {
+    prefs.putBytes("cache", &wifiFastCache, sizeof(wifiFastCache));
+  }
+  prefs.end();
+}
+
+// The RTC clock keeps running across resets and sleep, so before NTP has
+// synced it is still good enough to age a lease
+bool wifiLeaseReusable() {
+  if (!WIFI_FAST_CONNECT || !wifiFastCacheValid(wifiFastCache) || wifiFastCache.ip == 0) return false;
+  time_t now = time(nullptr);
+  return wifiFastCache.leaseEpoch != 0 && now > WIFI_CLOCK_VALID_EPOCH &&
+         (uint32_t)now - wifiFastCache.leaseEpoch < WIFI_LEASE_REUSE_S;
+}
+
+// Records the association the unit just made. Flash is written only when
+// the AP or address changed; leases picked up again statically are not
+// re-dated, so reuse cannot outlive the lease the DHCP server granted.
+void rememberWifiAssociation() {
+  if (!WIFI_FAST_CONNECT) return;
+
+  WifiFastCache previous = wifiFastCache;
+  const uint8_t* bssid = WiFi.BSSID();
+  if (bssid) memcpy(wifiFastCache.bssid, bssid, sizeof(wifiFastCache.bssid));
+  wifiFastCache.channel = WiFi.channel();
+
+  if (!wifiStaticLease) {
+    time_t now = time(nullptr);
+    wifiFastCache.ip = WiFi.localIP();
+    wifiFastCache.gateway = WiFi.gatewayIP();
+    wifiFastCache.subnet = WiFi.subnetMask();
+    wifiFastCache.dns = WiFi.dnsIP(0);
+    wifiFastCache.leaseEpoch = now > WIFI_CLOCK_VALID_EPOCH ? (uint32_t)now : 0;
+  }
+
+  bool changed = !wifiFastCacheValid(previous) ||
+                 memcmp(previous.bssid, wifiFastCache.bssid, sizeof(previous.bssid)) != 0 ||
+                 previous.channel != wifiFastCache.channel || previous.ip != wifiFastCache.ip;
+  storeWifiFastCache(changed);
+}
+
+// Fast: straight to the cached AP and channel, with the cached lease when it
+// is still fresh. Otherwise a full scan and DHCP.
+void beginWiFi(bool fast) {
+  fast = fast && WIFI_FAST_CONNECT && wifiFastCacheValid(wifiFastCache) && wifiFastCache.channel != 0;
+  wifiStaticLease = fast && wifiLeaseReusable();
+
+  if (wifiStaticLease) {
+    WiFi.config(IPAddress(wifiFastCache.ip), IPAddress(wifiFastCache.gateway),
+                IPAddress(wifiFastCache.subnet), IPAddress(wifiFastCache.dns));
+  } else {
+    WiFi.config(IPAddress(), IPAddress(), IPAddress());  // DHCP
+  }
+
+  if (fast) {
+    WiFi.begin(WIFI_SSID, WIFI_PASSWORD, wifiFastCache.channel, wifiFastCache.bssid);
+  } else {
+    WiFi.begin(WIFI_SSID, WIFI_PASSWORD);
+  }
+  wifiAttemptFast = fast;
+  wifiAttemptStart = millis();
+}
+
+// The cached address did not carry traffic, or has been reused as long as
+// allowed: rejoin through DHCP. The AP and channel stay cached.
+void abandonStaticLease(const char* reason) {
+  if (!wifiStaticLease) return;
+  DEBUG_PRINTF("📶 Dropping reused lease (%s) - rejoining with DHCP\n", reason);
+  wifiFastCache.leaseEpoch = 0;
+  storeWifiFastCache(true);
+  WiFi.disconnect();
+  beginWiFi(true);
+}
+
+void onWiFiConnected() {
+  wifiConnected = true;
+  wifiReconnectAttempts = 0;
+  DEBUG_PRINTF("📶 WiFi up in %lums (%s%s) - IP ",
+               millis() - wifiAttemptStart, wifiAttemptFast ? "cached AP" : "scan",
+               wifiStaticLease ? ", reused lease" : ", DHCP");
+  DEBUG_PRINTLN(WiFi.localIP());
+  rememberWifiAssociation();
+  ntpRetryCount = 0;
+  beginTimeSync();
+  requestStatusRedraw();
 }
 
 // ================================
-// WIFI FUNCTIONS (UNCHANGED)
+// WIFI FUNCTIONS
 // ================================
+// Only the cold path blocks: the fast path gives up after
+// WIFI_FAST_CONNECT_TIMEOUT and falls back to a scan
 void setupWiFi() {
   DEBUG_PRINT("Connecting to WiFi: ");
   DEBUG_PRINTLN(WIFI_SSID);
 
-  WiFi.begin(WIFI_SSID, WIFI_PASSWORD);
-
-  unsigned long startTime = millis();
-  while (WiFi.status() != WL_CONNECTED &&
-         (millis() - startTime) < WIFI_CONNECT_TIMEOUT) {
-    delay(500);
-    DEBUG_PRINT(".");
-    updateSystemStatus();
+  WiFi.mode(WIFI_STA);
+  bool cached = WIFI_FAST_CONNECT && loadWifiFastCache();
+  beginWiFi(cached);
+
+  unsigned long timeout = wifiAttemptFast ? WIFI_FAST_CONNECT_TIMEOUT : WIFI_CONNECT_TIMEOUT;
+  while (WiFi.status() != WL_CONNECTED) {
+    if (millis() - wifiAttemptStart >= timeout) {
+      if (!wifiAttemptFast) break;
+      DEBUG_PRINT(" cached AP not answering, scanning");
+      WiFi.disconnect();
+      beginWiFi(false);
+      timeout = WIFI_CONNECT_TIMEOUT;
+    }
+    delay(WIFI_CONNECT_POLL_MS);
   }
 
   if (WiFi.status() == WL_CONNECTED) {
-    wifiConnected = true;
     DEBUG_PRINTLN(" connected!");
-    DEBUG_PRINT("IP address: ");
-    DEBUG_PRINTLN(WiFi.localIP());
-    setupTimeWithRetry();
+    onWiFiConnected();
   } else {
     wifiConnected = false;
     DEBUG_PRINTLN(" failed!");
@@ -910,60 +2581,72 @@ void checkWiFiConnection() {
     if (wifiConnected) {
       wifiConnected = false;
       timeInitialized = false;
-      updateSystemStatus();
+      requestStatusRedraw();
     }
 
+    // The first retry goes straight back to the cached AP; later ones scan
     static unsigned long lastReconnectAttempt = 0;
-    if (millis() - lastReconnectAttempt > WIFI_RECONNECT_INTERVAL) {
-      WiFi.reconnect();
+    if (wifiReconnectAttempts == 0 || millis() - lastReconnectAttempt > WIFI_RECONNECT_INTERVAL) {
+      WiFi.disconnect();
+      beginWiFi(wifiReconnectAttempts == 0);
+      wifiReconnectAttempts++;
       lastReconnectAttempt = millis();
     }
   } else if (!wifiConnected) {
-    wifiConnected = true;
-    setupTimeWithRetry();
-    updateSystemStatus();
+    onWiFiConnected();
+  } else if (wifiStaticLease && !wifiLeaseReusable()) {
+    abandonStaticLease("lease age");
   }
 }
 
 // ================================
 // ENHANCED NTP TIME FUNCTIONS
 // ================================
-void setupTimeWithRetry() {
+// Wall clock in epoch milliseconds for message traces; 0 until NTP has synced
+uint64_t epochNowMs() {
+  if (!timeInitialized) return 0;
+  struct timeval now;
+  gettimeofday(&now, nullptr);
+  return (uint64_t)now.tv_sec * 1000 + now.tv_usec / 1000;
+}
+
+// SNTP runs in the background; checkPeriodicTimeSync() notices when it lands
+void beginTimeSync() {
   DEBUG_PRINTLN("Setting up enhanced NTP time synchronization...");
   ntpSyncInProgress = true;
-  ntpRetryCount = 0;
-  ntpSyncStatus = "SYNCING";
+  ntpSyncState = NTP_SYNC_SYNCING;
+  lastNtpSyncAttempt = millis();
 
   // Try multiple NTP servers for better reliability
   configTime(TIME_ZONE_OFFSET * 3600, 0, NTP_SERVER_PRIMARY, NTP_SERVER_SECONDARY, NTP_SERVER_TERTIARY);
+}
 
-  unsigned long startTime = millis();
-  struct tm timeinfo;
-
-  while (!getLocalTime(&timeinfo) && (millis() - startTime) < NTP_SYNC_TIMEOUT) {
-    delay(1000);
-    DEBUG_PRINT(".");
-    updateSystemStatus(); // Update display during sync
-  }
+void finishTimeSync(bool synced) {
+  ntpSyncInProgress = false;
 
-  if (getLocalTime(&timeinfo)) {
+  if (synced) {
+    struct tm timeinfo;
+    getLocalTime(&timeinfo, 0);
     timeInitialized = true;
-    ntpSyncInProgress = false;
-    ntpSyncStatus = "SYNCED";
+    ntpSyncState = NTP_SYNC_SYNCED;
     ntpRetryCount = 0;
     DEBUG_PRINTLN(" Time synced successfully!");
     DEBUG_PRINTF("Current time: %04d-%02d-%02d %02d:%02d:%02d\n",
                 timeinfo.tm_year + 1900, timeinfo.tm_mon + 1, timeinfo.tm_mday,
                 timeinfo.tm_hour, timeinfo.tm_min, timeinfo.tm_sec);
-    updateTimeAndDate();
-    updateSystemStatus();
+    if (!taskRuntimeActive) {
+      updateTimeAndDate();
+    }
+    requestStatusRedraw();  // Also redraws the clock in task mode
+
+    // A lease seen before the clock was set can now be dated
+    if (wifiConnected && !wifiStaticLease && wifiFastCache.leaseEpoch == 0) rememberWifiAssociation();
 
     // Publish NTP sync status to central system
     publishNtpSyncStatus(true);
   } else {
     timeInitialized = false;
-    ntpSyncInProgress = false;
-    ntpSyncStatus = "FAILED";
+    ntpSyncState = NTP_SYNC_FAILED;
     ntpRetryCount++;
     DEBUG_PRINTLN(" Time sync failed!");
 
@@ -973,76 +2656,33 @@ void setupTimeWithRetry() {
 }
 
 void updateTimeAndDate() {
-  if (!wifiConnected) {
-    if (lastDisplayedTime != "OFFLINE") {
-      lastDisplayedTime = "OFFLINE";
-      lastDisplayedDate = "NO WIFI";
-
-      tft.fillRect(TIME_X, TIME_Y, 120, 15, COLOR_PANEL);
-      tft.setCursor(TIME_X, TIME_Y);
-      tft.setTextColor(COLOR_ERROR);
-      tft.setTextSize(1);
-      tft.print("TIME: OFFLINE");
-
-      tft.fillRect(DATE_X - 60, DATE_Y, 70, 15, COLOR_PANEL);
-      tft.setCursor(DATE_X - 60, DATE_Y);
-      tft.setTextColor(COLOR_ERROR);
-      tft.setTextSize(1);
-      tft.print("NO WIFI");
-    }
-    return;
-  }
+  DisplayOptimizer::beginFrame();
+  DisplayOptimizer::beginLayer(DISPLAY_LAYER_CLOCK);
+  DisplayOptimizer::optimizedFillRect(0, BOTTOM_PANEL_Y, SCREEN_WIDTH, BOTTOM_PANEL_HEIGHT, COLOR_PANEL);
 
   struct tm timeinfo;
-  if (getLocalTime(&timeinfo) && timeInitialized) {
+  if (!wifiConnected) {
+    drawText(TIME_X, TIME_Y, "TIME: OFFLINE", COLOR_ERROR, 1);
+    drawText(DATE_X - 60, DATE_Y, "NO WIFI", COLOR_ERROR, 1);
+  } else if (getLocalTime(&timeinfo) && timeInitialized) {
     char timeStr[12];
     strftime(timeStr, sizeof(timeStr), "%H:%M:%S", &timeinfo);
 
     char dateStr[15];
     strftime(dateStr, sizeof(dateStr), "%b %d, %Y", &timeinfo);
 
-    String currentTimeStr = String(timeStr);
-    String currentDateStr = String(dateStr);
-
-    if (currentTimeStr != lastDisplayedTime) {
-      lastDisplayedTime = currentTimeStr;
+    // Unchanged text hashes the same, so only the seconds tile is resent
+    int x = drawText(TIME_X, TIME_Y, "TIME: ", COLOR_ACCENT, 1);
+    drawText(x, TIME_Y, timeStr, COLOR_ACCENT, 1);
 
-      tft.fillRect(TIME_X, TIME_Y, 120, 15, COLOR_PANEL);
-      tft.setCursor(TIME_X, TIME_Y);
-      tft.setTextColor(COLOR_ACCENT);
-      tft.setTextSize(1);
-      tft.print("TIME: ");
-      tft.print(timeStr);
-    }
-
-    if (currentDateStr != lastDisplayedDate) {
-      lastDisplayedDate = currentDateStr;
-
-      tft.fillRect(DATE_X - 90, DATE_Y, 90, 15, COLOR_PANEL);
-      tft.setCursor(DATE_X - 90, DATE_Y);
-      tft.setTextColor(COLOR_ACCENT);
-      tft.setTextSize(1);
-      tft.print("DATE: ");
-      tft.print(dateStr);
-    }
+    x = drawText(DATE_X - 90, DATE_Y, "DATE: ", COLOR_ACCENT, 1);
+    drawText(x, DATE_Y, dateStr, COLOR_ACCENT, 1);
   } else {
-    if (lastDisplayedTime != "SYNCING") {
-      lastDisplayedTime = "SYNCING";
-      lastDisplayedDate = "SYNCING";
-
-      tft.fillRect(TIME_X, TIME_Y, 120, 15, COLOR_PANEL);
-      tft.setCursor(TIME_X, TIME_Y);
-      tft.setTextColor(COLOR_WARNING);
-      tft.setTextSize(1);
-      tft.print("TIME: SYNCING...");
-
-      tft.fillRect(DATE_X - 90, DATE_Y, 90, 15, COLOR_PANEL);
-      tft.setCursor(DATE_X - 90, DATE_Y);
-      tft.setTextColor(COLOR_WARNING);
-      tft.setTextSize(1);
-      tft.print("WAIT...");
-    }
+    drawText(TIME_X, TIME_Y, "TIME: SYNCING...", COLOR_WARNING, 1);
+    drawText(DATE_X - 90, DATE_Y, "WAIT...", COLOR_WARNING, 1);
   }
+
+  DisplayOptimizer::endFrame();
 }
 
 void checkPeriodicTimeSync() {
@@ -1050,28 +2690,28 @@ void checkPeriodicTimeSync() {
   unsigned long now = millis();
 
   // Periodic sync for already synchronized time
-  if (timeInitialized && wifiConnected && (now - lastNTPSync > NTP_UPDATE_INTERVAL)) {
+  if (timeInitialized && wifiConnected && !ntpSyncInProgress && (now - lastNTPSync > NTP_UPDATE_INTERVAL)) {
     DEBUG_PRINTLN("Performing periodic NTP sync...");
     ntpSyncInProgress = true;
-    ntpSyncStatus = "SYNCING";
+    ntpSyncState = NTP_SYNC_SYNCING;
 
     configTime(TIME_ZONE_OFFSET * 3600, 0, NTP_SERVER_PRIMARY, NTP_SERVER_SECONDARY);
+    lastNTPSync = now;
 
-    // Quick check for sync success
-    delay(2000);
+    // The result is checked from a timer instead of stalling the network path
+    scheduleNtpCheck();
+    return;
+  }
+
+  // First sync, started when WiFi came up
+  if (!timeInitialized && ntpSyncInProgress) {
     struct tm timeinfo;
-    if (getLocalTime(&timeinfo)) {
-      ntpSyncStatus = "SYNCED";
-      DEBUG_PRINTLN("Periodic NTP sync successful");
-      publishNtpSyncStatus(true);
-    } else {
-      ntpSyncStatus = "FAILED";
-      DEBUG_PRINTLN("Periodic NTP sync failed");
-      publishNtpSyncStatus(false);
+    if (getLocalTime(&timeinfo, 0)) {
+      finishTimeSync(true);
+    } else if (now - lastNtpSyncAttempt > NTP_SYNC_TIMEOUT) {
+      finishTimeSync(false);
     }
-
-    ntpSyncInProgress = false;
-    lastNTPSync = now;
+    return;
   }
 
   // Retry failed sync attempts
@@ -1079,96 +2719,523 @@ void checkPeriodicTimeSync() {
       (now - lastNtpSyncAttempt > NTP_RETRY_INTERVAL) &&
       ntpRetryCount < NTP_MAX_RETRIES) {
     DEBUG_PRINTF("Retrying NTP sync (attempt %d/%d)...\n", ntpRetryCount + 1, NTP_MAX_RETRIES);
-    lastNtpSyncAttempt = now;
-    setupTimeWithRetry();
+    beginTimeSync();
   }
 }
 
 // ================================
-// MQTT FUNCTIONS (UNCHANGED)
+// MQTT FUNCTIONS
 // ================================
 void setupMQTT() {
+#if MQTT_USE_TLS
+  if (!wifiClient.setCertificates(MQTT_TLS_CA_CERT, MQTT_TLS_CLIENT_CERT, MQTT_TLS_CLIENT_KEY)) {
+    DEBUG_PRINTLN("⚠️ MQTT_USE_TLS is set but MQTT_TLS_CA_CERT is empty");
+  }
+#endif
+  // Standbys carry their own certificate name in MQTT_STANDBY_BROKERS
+  if (!brokerPool.add(MQTT_SERVER, MQTT_PORT, MQTT_TLS_SERVER_NAME)) {
+    DEBUG_PRINTLN("⚠️ MQTT_SERVER or MQTT_TLS_SERVER_NAME is longer than BROKER_HOST_LENGTH allows");
+  }
+  brokerPool.addList(MQTT_STANDBY_BROKERS, MQTT_PORT);
+  DEBUG_PRINTF("MQTT: %u broker(s), primary %s:%u\n", brokerPool.getCount(), MQTT_SERVER, MQTT_PORT);
+
   mqttClient.setServer(MQTT_SERVER, MQTT_PORT);
   mqttClient.setCallback(onMqttMessage);
+  if (!mqttClient.setBufferSize(MQTT_BUFFER_SIZE)) {
+    DEBUG_PRINTLN("⚠️ MQTT buffer allocation failed - large payloads will be dropped");
+  }
   mqttClient.setKeepAlive(MQTT_KEEPALIVE);
+  mqttClient.setSocketTimeout(MQTT_CONNACK_TIMEOUT_S);
 }
 
-void connectMQTT() {
-  if (millis() - lastMqttReconnect < 5000) return;
-  lastMqttReconnect = millis();
+// Each pass does at most one bounded step - the TCP connect, as much of the
+// TLS handshake as the bytes on hand allow, or the MQTT CONNECT - so an
+// unreachable broker costs one short timeout per backoff period instead of
+// a blocking connect on every pass
+void serviceMqttLink() {
+  unsigned long now = millis();
 
-  DEBUG_PRINT("MQTT connecting...");
+  if (!wifiConnected) {
+    // Not the broker's fault: no penalty, retried once WiFi is back
+    if (mqttLinkState != MQTT_LINK_IDLE) closeMqttLink();
+    return;
+  }
 
-  if (mqttClient.connect(MQTT_CLIENT_ID, MQTT_USERNAME, MQTT_PASSWORD)) {
-    mqttConnected = true;
-    DEBUG_PRINTLN(" connected!");
-    mqttClient.subscribe(MQTT_TOPIC_MESSAGES, MQTT_QOS);
-    publishPresenceUpdate();
-    updateSystemStatus();
-  } else {
-    mqttConnected = false;
-    DEBUG_PRINTLN(" failed!");
-    updateSystemStatus();
+  switch (mqttLinkState) {
+    case MQTT_LINK_IDLE: {
+      if (!brokerPool.readyToConnect(now)) return;
+      mqttLinkBroker = brokerPool.choose(now);
+      const char* host = brokerPool.getHost(mqttLinkBroker);
+      uint16_t port = brokerPool.getPort(mqttLinkBroker);
+      brokerPool.reportAttempt(mqttLinkBroker);
+      mqttLinkStart = now;
+
+      DEBUG_PRINTF("MQTT connecting to %s:%u...\n", host, port);
+#if MQTT_USE_TLS
+      bool opened = wifiClient.begin(host, port, MQTT_TCP_CONNECT_TIMEOUT_MS, brokerPool.getServerName(mqttLinkBroker));
+#else
+      bool opened = wifiClient.connect(host, port, MQTT_TCP_CONNECT_TIMEOUT_MS);
+#endif
+      if (!opened) {
+        // No route to it: the background check on a reused lease
+        abandonStaticLease("broker unreachable");
+        failMqttLink("transport");
+        return;
+      }
+      mqttClient.setServer(host, port);
+      mqttLinkState = MQTT_USE_TLS ? MQTT_LINK_HANDSHAKE : MQTT_LINK_SESSION;
+      return;
+    }
+
+    case MQTT_LINK_HANDSHAKE: {
+#if MQTT_USE_TLS
+      // Gives up by itself after TLS_HANDSHAKE_TIMEOUT_MS
+      int ret = wifiClient.handshakeStep();
+      if (ret == MBEDTLS_ERR_SSL_WANT_READ || ret == MBEDTLS_ERR_SSL_WANT_WRITE) return;
+      if (ret != 0) {
+        failMqttLink("handshake");
+        return;
+      }
+#endif
+      mqttLinkState = MQTT_LINK_SESSION;
+      return;
+    }
+
+    case MQTT_LINK_SESSION:
+      // The transport is already open, so this only waits for the CONNACK
+      if (!mqttClient.connect(unitProfile.getClientId(), MQTT_USERNAME, MQTT_PASSWORD)) {
+        failMqttLink("session");
+        return;
+      }
+      brokerPool.reportSuccess(mqttLinkBroker, now - mqttLinkStart, now);
+      mqttLinkState = MQTT_LINK_UP;
+      onMqttConnected();
+      return;
+
+    case MQTT_LINK_UP:
+      if (!mqttClient.connected()) {
+        DEBUG_PRINTF("⚠️ MQTT connection to %s lost\n", brokerPool.getHost(mqttLinkBroker));
+        brokerPool.reportDisconnect(now);
+        mqttLinkState = MQTT_LINK_IDLE;
+        mqttConnected = false;
+        requestStatusRedraw();
+        return;
+      }
+      // Never while a request is on screen: the answer would race the reconnect
+      if (brokerPool.shouldFailBack(now) && !isMessageOnScreen()) {
+        DEBUG_PRINTF("🔀 Primary broker %s has recovered, moving back\n", brokerPool.getHost(0));
+        closeMqttLink();
+      }
+      return;
   }
 }
 
+void onMqttConnected() {
+  mqttConnected = true;
+  DEBUG_PRINTF("✅ MQTT connected to %s in %lums\n", brokerPool.getHost(mqttLinkBroker),
+               (unsigned long)brokerPool.getHealth(mqttLinkBroker).lastConnectMs);
+  if (bootOnlineMs == 0) {
+    bootOnlineMs = millis();
+    DEBUG_PRINTF("📶 Online %lums after boot\n", bootOnlineMs);
+  }
+  mqttClient.subscribe(unitProfile.getTopic(UNIT_TOPIC_MESSAGES), MQTT_QOS);
+  if (WIRE_FORMAT_CBOR_ENABLED) {
+    mqttClient.subscribe(unitProfile.getTopic(UNIT_TOPIC_WIRE_FORMAT), MQTT_QOS);
+  }
+  mqttClient.subscribe(unitProfile.getTopic(UNIT_TOPIC_BEACONS), MQTT_QOS);
+  mqttClient.subscribe(unitProfile.getTopic(UNIT_TOPIC_SCAN_POLICY), MQTT_QOS);
+  if (UNIT_PROVISIONING_ENABLED) {
+    mqttClient.subscribe(unitProfile.getTopic(UNIT_TOPIC_PROVISION), MQTT_QOS);
+  }
+  // The central system may have restarted: resend full state once
+  reportedHeartbeat.valid = false;
+  publishPresenceUpdate();
+  requestStatusRedraw();
+}
+
+void failMqttLink(const char* stage) {
+  unsigned long now = millis();
+  wifiClient.stop();
+  mqttConnected = false;
+  mqttLinkState = MQTT_LINK_IDLE;
+  brokerPool.reportFailure(mqttLinkBroker, now);
+
+  DEBUG_PRINTF("❌ MQTT %s failed on %s (state %d), next try in %lums\n", stage,
+               brokerPool.getHost(mqttLinkBroker), mqttClient.state(),
+               brokerPool.getNextAttemptAt() - now);
+  if (brokerPool.getRoundFailures() == brokerPool.getCount()) {
+    DEBUG_PRINTLN("⚠️ No MQTT broker reachable, backing off");
+  }
+  requestStatusRedraw();
+}
+
+// A close we chose - WiFi loss, failback, socket recycling - costs the
+// broker nothing
+void closeMqttLink() {
+  if (mqttClient.connected()) mqttClient.disconnect();
+  wifiClient.stop();
+  if (mqttLinkState == MQTT_LINK_UP) brokerPool.reportClosed(millis());
+  mqttLinkState = MQTT_LINK_IDLE;
+  mqttConnected = false;
+  requestStatusRedraw();
+}
+
+// ================================
+// MESSAGE INBOX
+// ================================
+void lockInbox() {
+  if (taskRuntimeActive) xSemaphoreTake(inboxMutex, portMAX_DELAY);
+}
+
+void unlockInbox() {
+  if (taskRuntimeActive) xSemaphoreGive(inboxMutex);
+}
+
+void readInboxCounters(int& position, int& count, int& unread) {
+  lockInbox();
+  position = MessageQueue::getCurrentIndex();
+  count = MessageQueue::getMessageCount();
+  unread = MessageQueue::getUnreadCount();
+  unlockInbox();
+}
+
+// messageDisplayed belongs to the UI side; other tasks go by the inbox
+// selection, which is set and cleared under the same lock
+bool isMessageOnScreen() {
+  lockInbox();
+  bool onScreen = currentMessage != nullptr;
+  unlockInbox();
+  return onScreen;
+}
+
+// Selects an inbox entry and puts it on screen. Returns false if the index
+// no longer exists.
+bool showInboxMessage(int index) {
+  lockInbox();
+  const EnhancedMessage* message = nullptr;
+  if (MessageQueue::selectMessage(index)) {
+    MessageQueue::markAsRead(index);
+    message = MessageQueue::peekMessage(index);
+  }
+  currentMessage = message;
+  unlockInbox();
+
+  if (!message) return false;
+  displayIncomingMessage(*message);
+
+  // Stamped once the first page is on the panel
+  uint64_t renderedAt = epochNowMs();
+  lockInbox();
+  MessageQueue::markAsRendered(MessageQueue::getCurrentIndex(), renderedAt, millis());
+  unlockInbox();
+  return true;
+}
+
+// Moves through the inbox in priority order, wrapping at either end
+void showAdjacentInboxMessage(int step) {
+  int position, count, unread;
+  readInboxCounters(position, count, unread);
+  if (count <= 1) return;
+  showInboxMessage((position + step + count) % count);
+}
+
+// Called on the UI side after the network side queued a message
+void onInboxMessageArrived() {
+  wakeFromAway();
+  if (messageDisplayed) {
+    EnhancedDisplayManager::refreshDisplay();  // New counts in the header
+  } else if (!isConfirmationShowing()) {
+    showInboxMessage(0);
+  }  // Otherwise it follows the confirmation card
+}
+
+// Drops the answered message and shows the next one, if any
+void removeCurrentMessage() {
+  lockInbox();
+  int index = MessageQueue::getCurrentIndex();
+  if (index >= 0) {
+    MessageQueue::markAsAcknowledged(index);
+    MessageQueue::removeMessage(index);
+  }
+  currentMessage = nullptr;
+  unlockInbox();
+}
+
+void serviceInbox() {
+  lockInbox();
+  int expired = MessageQueue::cleanup();
+  unlockInbox();
+
+  if (expired > 0) {
+    DEBUG_PRINTF("⌛ %d queued message(s) expired\n", expired);
+    if (messageDisplayed) EnhancedDisplayManager::refreshDisplay();
+  }
+}
+
+// Fills a slot from the raw MQTT payload without touching the heap. The
+// central system publishes plain-text requests here; JSON payloads are
+// read in one streaming pass and formatted into the same display text.
+void parseIncomingMessage(const byte* payload, unsigned int length, EnhancedMessage& message) {
+  unsigned long now = millis();
+  message.type = MSG_CONSULTATION_REQUEST;
+  message.priority = PRIORITY_NORMAL;
+  message.status = STATUS_UNREAD;
+  message.receivedTime = now;
+  message.expiryTime = now + MESSAGE_EXPIRY_TIME;
+  snprintf(message.messageId, sizeof(message.messageId), "%lu_%ld", now, random(1000, 9999));
+  strncpy(message.senderId, "central", sizeof(message.senderId) - 1);
+  message.senderId[sizeof(message.senderId) - 1] = '\0';
+  memset(&message.trace, 0, sizeof(message.trace));
+  message.trace.receivedAtMs = epochNowMs();
+
+  // Overrides type, priority and IDs when the payload carries them, and
+  // picks up the central system's send time for the trace
+  MessageParser::parseMessage((const char*)payload, length, message);
+  MSG_RECORD_STAT(message.type);
+}
+
 void onMqttMessage(char* topic, byte* payload, unsigned int length) {
+  PERF_PROFILE_SCOPE(PERF_SPAN_MQTT_RX);
+
+  switch (unitProfile.matchTopic(topic)) {
+    case UNIT_TOPIC_WIRE_FORMAT:
+      handleWireFormatMessage(payload, length);
+      return;
+    case UNIT_TOPIC_BEACONS:
+      handleBeaconRegistryMessage(payload, length);
+      return;
+    case UNIT_TOPIC_SCAN_POLICY:
+      handleScanPolicyMessage(payload, length);
+      return;
+    case UNIT_TOPIC_PROVISION:
+      handleProvisioningMessage(payload, length);
+      return;
+    default:
+      break;
+  }
+
   // Bounds checking for security
   if (length > MAX_MESSAGE_LENGTH) {
     DEBUG_PRINTF("⚠️ Message too long (%d bytes), truncating to %d\n", length, MAX_MESSAGE_LENGTH);
     length = MAX_MESSAGE_LENGTH;
   }
 
-  String message = "";
-  message.reserve(length + 1);  // Pre-allocate memory
+  if (!presenceDetector.getPresence()) {
+    DEBUG_PRINTLN("📭 Message ignored - Professor is AWAY");
+    return;
+  }
 
-  for (unsigned int i = 0; i < length; i++) {
-    message += (char)payload[i];
+  // Parse straight out of the PubSubClient buffer into a reserved inbox slot;
+  // it only becomes visible to the UI once committed
+  lockInbox();
+  EnhancedMessage* message = MessageQueue::reserveSlot();
+  unlockInbox();
+  if (!message) {
+    DEBUG_PRINTLN("⚠️ Inbox full, message dropped");
+    return;
   }
+  parseIncomingMessage(payload, length, *message);
 
-  DEBUG_PRINTF("📨 Message received (%d bytes): %s\n", length, message.c_str());
+  DEBUG_PRINTF("📨 Message received (%d bytes): %s\n", length, message->data.rawMessage);
 
-  if (presenceDetector.getPresence()) {
-    // Generate message ID for tracking
-    messageId = String(millis()) + "_" + String(random(1000, 9999));
-    lastReceivedMessage = message;
-    displayIncomingMessage(message);
-  } else {
-    DEBUG_PRINTLN("📭 Message ignored - Professor is AWAY");
+  lockInbox();
+  MessageQueue::commitSlot(message);
+  unlockInbox();
+
+  if (taskRuntimeActive) {
+    // Hand over to the UI task, which owns the display
+    postUiEvent(UI_EVT_MESSAGE_RECEIVED);
+    return;
   }
+
+  onInboxMessageArrived();
 }
 
-void publishPresenceUpdate() {
-  String payload = "{";
-  payload += "\"faculty_id\":" + String(FACULTY_ID) + ",";
-  payload += "\"faculty_name\":\"" + String(FACULTY_NAME) + "\",";
-  payload += "\"present\":" + String(presenceDetector.getPresence() ? "true" : "false") + ",";
-  payload += "\"status\":\"" + presenceDetector.getStatusString() + "\",";
-  payload += "\"timestamp\":" + String(millis()) + ",";
-  payload += "\"ntp_sync_status\":\"" + ntpSyncStatus + "\"";
+// ================================
+// PAYLOAD BUILDERS (JSON OR CBOR)
+// ================================
+void buildPresencePayload(WireWriter& writer, const void* context) {
+  writer.beginObject();
+  writer.addUInt("faculty_id", unitProfile.getFacultyId());
+  writer.addString("faculty_name", unitProfile.get().name);
+  writer.addBool("present", presenceDetector.getPresence());
+  writer.addString("status", presenceDetector.getStatusText());
+  writer.addUInt("timestamp", millis());
+  writer.addString("ntp_sync_status", NTP_SYNC_NAMES[ntpSyncState]);
 
   // Add grace period information for debugging
   if (presenceDetector.isInGracePeriod()) {
-    payload += ",\"grace_period_remaining\":" + String(presenceDetector.getGracePeriodRemaining());
-    payload += ",\"in_grace_period\":true";
+    writer.addUInt("grace_period_remaining", presenceDetector.getGracePeriodRemaining());
+    writer.addBool("in_grace_period", true);
   } else {
-    payload += ",\"in_grace_period\":false";
+    writer.addBool("in_grace_period", false);
+  }
+
+  // Smoothed signal and path-loss distance while the beacon is being heard
+  if (presenceDetector.hasSignal()) {
+    writer.addInt("rssi", presenceDetector.getFilteredRssi());
+    writer.addUInt("distance_cm", presenceDetector.getDistanceCm());
   }
 
   // Add detailed status for central system
-  payload += ",\"detailed_status\":\"" + presenceDetector.getDetailedStatus() + "\"";
+  char detailedStatus[40];
+  writer.addString("detailed_status", presenceDetector.formatDetailedStatus(detailedStatus, sizeof(detailedStatus)));
+  writer.endObject();
+}
+
+void buildNtpSyncPayload(WireWriter& writer, const void* context) {
+  bool success = *static_cast<const bool*>(context);
+
+  writer.beginObject();
+  writer.addUInt("faculty_id", unitProfile.getFacultyId());
+  writer.addBool("ntp_sync_success", success);
+  writer.addString("ntp_sync_status", NTP_SYNC_NAMES[ntpSyncState]);
+  writer.addInt("retry_count", ntpRetryCount);
+  writer.addUInt("timestamp", millis());
+
+  if (success && timeInitialized) {
+    struct tm timeinfo;
+    if (getLocalTime(&timeinfo)) {
+      char timeStr[32];
+      strftime(timeStr, sizeof(timeStr), "%Y-%m-%d %H:%M:%S", &timeinfo);
+      writer.addString("current_time", timeStr);
+    }
+  }
+  writer.endObject();
+}
+
+// Complete heartbeats go out every HEARTBEAT_FULL_EVERY; the rest carry
+// only liveness plus the fields that changed since the last one
+void buildHeartbeatPayload(WireWriter& writer, const void* context) {
+  const HeartbeatDraft& draft = *static_cast<const HeartbeatDraft*>(context);
+  const HeartbeatState& now = draft.current;
+  const HeartbeatState& last = *draft.reported;
+  bool full = draft.full;
+
+  writer.beginObject();
+  writer.addUInt("faculty_id", unitProfile.getFacultyId());
+  writer.addUInt("uptime", millis());
+  if (!full) writer.addBool("delta", true);
+
+  uint32_t heapChange = now.freeHeap > last.freeHeap ? now.freeHeap - last.freeHeap : last.freeHeap - now.freeHeap;
+  if (full || heapChange > HEARTBEAT_HEAP_DELTA) writer.addUInt("free_heap", now.freeHeap);
+  if (full || now.wifiConnected != last.wifiConnected) writer.addBool("wifi_connected", now.wifiConnected);
+  if (full || now.timeInitialized != last.timeInitialized) writer.addBool("time_initialized", now.timeInitialized);
+  if (full || now.ntpSync != last.ntpSync) writer.addString("ntp_sync_status", NTP_SYNC_NAMES[now.ntpSync]);
+  if (full || now.present != last.present) writer.addString("presence_status", now.present ? "AVAILABLE" : "AWAY");
+
+  // Capability flag: the central system may answer on the wire_format topic
+  if (full) writer.addString("encodings", WIRE_FORMAT_CBOR_ENABLED ? "json,cbor" : "json");
+  if (full) writer.addBool("provisioned", unitProfile.isProvisioned());
+  writer.endObject();
+}
+
+void buildResponsePayload(WireWriter& writer, const void* context) {
+  const ResponseDraft& draft = *static_cast<const ResponseDraft*>(context);
+  bool acknowledge = draft.kind == RESPONSE_ACKNOWLEDGE;
+
+  char timestamp[12];
+  snprintf(timestamp, sizeof(timestamp), "%lu", millis());
+
+  writer.beginObject();
+  writer.addUInt("faculty_id", unitProfile.getFacultyId());
+  writer.addString("faculty_name", unitProfile.get().name);
+  writer.addString("response_type", acknowledge ? "ACKNOWLEDGE" : "BUSY");
+  writer.addString("message_id", draft.messageId);
+  writer.addString("original_message", draft.originalMessage);
+  writer.addString("timestamp", timestamp);
+  writer.addString("status", acknowledge
+      ? "Professor acknowledges the request and will respond accordingly"
+      : "Professor is currently busy and cannot cater to this request");
+  addResponseTrace(writer, *draft.trace, draft.receivedTime);
+  writer.endObject();
+}
+
+// Per-hop latency: wall-clock stamps where NTP allows, plus on-unit durations
+// from millis() that hold even before the clock is set
+void addResponseTrace(WireWriter& writer, const MessageTrace& trace, unsigned long receivedTime) {
+  if (trace.sentAtMs) writer.addUInt64("sent_at_ms", trace.sentAtMs);
+  if (trace.receivedAtMs) writer.addUInt64("received_at_ms", trace.receivedAtMs);
+  if (trace.renderedAtMs) writer.addUInt64("rendered_at_ms", trace.renderedAtMs);
+  if (trace.respondedAtMs) writer.addUInt64("responded_at_ms", trace.respondedAtMs);
+
+  // Clock skew between the two hosts can make this negative
+  if (trace.sentAtMs && trace.receivedAtMs) {
+    writer.addInt("transit_ms", (int32_t)(int64_t)(trace.receivedAtMs - trace.sentAtMs));
+  }
+  if (trace.rendered) {
+    writer.addUInt("render_ms", trace.renderedMillis - receivedTime);
+    writer.addUInt("response_ms", trace.respondedMillis - trace.renderedMillis);
+  }
+}
+
+bool publishResponse(ResponseKind kind, const char* messageId, const char* originalMessage,
+                     const MessageTrace& trace, unsigned long receivedTime) {
+  ResponseDraft draft = { kind, messageId, originalMessage, &trace, receivedTime };
+  return publishEncoded(unitProfile.getTopic(UNIT_TOPIC_RESPONSES), WIRE_TOPIC_RESPONSES, buildResponsePayload, &draft, true);
+}
+
+// ================================
+// PRESENCE PUBLISH COALESCING
+// ================================
+// Presence transitions are collected for PRESENCE_COALESCE_WINDOW_MS and
+// published once, and only if the result differs from what was last
+// published, so a beacon flapping near the RSSI threshold costs at most one
+// message per window - and none if it settles back. The status topic's
+// token bucket caps what is left.
+bool presencePending = false;
+unsigned long presencePendingSince = 0;
+PresenceSnapshot publishedPresence = { false, false, false, NTP_SYNC_PENDING };
+
+PresenceSnapshot capturePresence() {
+  PresenceSnapshot snapshot;
+  snapshot.valid = true;
+  snapshot.present = presenceDetector.getPresence();
+  snapshot.inGracePeriod = presenceDetector.isInGracePeriod();
+  snapshot.ntpSync = ntpSyncState;
+  return snapshot;
+}
 
-  payload += "}";
+bool samePresence(const PresenceSnapshot& a, const PresenceSnapshot& b) {
+  return a.valid == b.valid && a.present == b.present && a.inGracePeriod == b.inGracePeriod &&
+         a.ntpSync == b.ntpSync;
+}
+
+// Network side: note a transition; the window starts with the first one
+void requestPresencePublish() {
+  if (!presencePending) {
+    presencePending = true;
+    presencePendingSince = millis();
+  }
+}
 
-  // Publish with offline queuing support
-  bool success1 = publishWithQueue(MQTT_TOPIC_STATUS, payload.c_str(), false);
-  bool success2 = publishWithQueue(MQTT_LEGACY_STATUS, payload.c_str(), false);
+void servicePresencePublisher() {
+  if (!presencePending || millis() - presencePendingSince < PRESENCE_COALESCE_WINDOW_MS) return;
+
+  if (samePresence(capturePresence(), publishedPresence)) {
+    presencePending = false;
+    DEBUG_PRINTLN("📡 Presence settled back, nothing to publish");
+    return;
+  }
+
+  // Still pending without a token: the newest state goes out once one refills
+  if (takeToken(statusBucket)) {
+    publishPresenceUpdate();
+  }
+}
+
+void publishPresenceUpdate() {
+  // Publish with offline queuing support; the legacy topic is always JSON
+  bool success1 = publishEncoded(unitProfile.getTopic(UNIT_TOPIC_STATUS), WIRE_TOPIC_STATUS, buildPresencePayload, nullptr, false);
+  bool success2 = publishEncoded(unitProfile.getTopic(UNIT_TOPIC_LEGACY_STATUS), WIRE_TOPIC_NONE, buildPresencePayload, nullptr, false);
+  publishedPresence = capturePresence();
+  presencePending = false;
 
   if (success1 || success2) {
     if (mqttClient.connected()) {
-      DEBUG_PRINTF("📡 Published presence update: %s\n", presenceDetector.getStatusString().c_str());
+      DEBUG_PRINTF("📡 Published presence update: %s\n", presenceDetector.getStatusText());
     } else {
-      DEBUG_PRINTF("📥 Queued presence update: %s\n", presenceDetector.getStatusString().c_str());
+      DEBUG_PRINTF("📥 Queued presence update: %s\n", presenceDetector.getStatusText());
     }
   } else {
     DEBUG_PRINTLN("❌ Failed to send/queue presence update");
@@ -1177,43 +3244,173 @@ void publishPresenceUpdate() {
 
 void publishNtpSyncStatus(bool success) {
   if (!mqttClient.connected()) return;
-
-  String payload = "{";
-  payload += "\"faculty_id\":" + String(FACULTY_ID) + ",";
-  payload += "\"ntp_sync_success\":" + String(success ? "true" : "false") + ",";
-  payload += "\"ntp_sync_status\":\"" + ntpSyncStatus + "\",";
-  payload += "\"retry_count\":" + String(ntpRetryCount) + ",";
-  payload += "\"timestamp\":" + String(millis());
-
-  if (success && timeInitialized) {
-    struct tm timeinfo;
-    if (getLocalTime(&timeinfo)) {
-      char timeStr[32];
-      strftime(timeStr, sizeof(timeStr), "%Y-%m-%d %H:%M:%S", &timeinfo);
-      payload += ",\"current_time\":\"" + String(timeStr) + "\"";
-    }
+  if (!takeToken(heartbeatBucket)) {
+    DEBUG_PRINTLN("⏳ NTP sync status skipped (heartbeat topic rate limit)");
+    return;
   }
 
-  payload += "}";
-
-  mqttClient.publish(MQTT_TOPIC_HEARTBEAT, payload.c_str(), MQTT_QOS);
+  publishEncoded(unitProfile.getTopic(UNIT_TOPIC_HEARTBEAT), WIRE_TOPIC_HEARTBEAT, buildNtpSyncPayload, &success, false);
   DEBUG_PRINTF("📡 Published NTP sync status: %s\n", success ? "SUCCESS" : "FAILED");
 }
 
 void publishHeartbeat() {
   if (!mqttClient.connected()) return;
+  if (!takeToken(heartbeatBucket)) {
+    DEBUG_PRINTLN("⏳ Heartbeat skipped (rate limit)");
+    return;
+  }
 
-  String payload = "{";
-  payload += "\"faculty_id\":" + String(FACULTY_ID) + ",";
-  payload += "\"uptime\":" + String(millis()) + ",";
-  payload += "\"free_heap\":" + String(ESP.getFreeHeap()) + ",";
-  payload += "\"wifi_connected\":" + String(wifiConnected ? "true" : "false") + ",";
-  payload += "\"time_initialized\":" + String(timeInitialized ? "true" : "false") + ",";
-  payload += "\"ntp_sync_status\":\"" + ntpSyncStatus + "\",";
-  payload += "\"presence_status\":\"" + presenceDetector.getStatusString() + "\"";
-  payload += "}";
+  HeartbeatDraft draft;
+  draft.reported = &reportedHeartbeat;
+  draft.full = !reportedHeartbeat.valid || reportedHeartbeat.sinceFull + 1 >= HEARTBEAT_FULL_EVERY;
+  draft.current.valid = true;
+  draft.current.sinceFull = draft.full ? 0 : reportedHeartbeat.sinceFull + 1;
+  draft.current.freeHeap = ESP.getFreeHeap();
+  draft.current.wifiConnected = wifiConnected;
+  draft.current.timeInitialized = timeInitialized;
+  draft.current.present = presenceDetector.getPresence();
+  draft.current.ntpSync = ntpSyncState;
+
+  if (!publishEncoded(unitProfile.getTopic(UNIT_TOPIC_HEARTBEAT), WIRE_TOPIC_HEARTBEAT, buildHeartbeatPayload, &draft, false)) return;
+
+  // Heap drift below the threshold keeps accumulating until it is reported
+  uint32_t reportedHeap = reportedHeartbeat.freeHeap;
+  uint32_t heapChange = draft.current.freeHeap > reportedHeap ? draft.current.freeHeap - reportedHeap
+                                                              : reportedHeap - draft.current.freeHeap;
+  bool heapSent = draft.full || heapChange > HEARTBEAT_HEAP_DELTA;
+  reportedHeartbeat = draft.current;
+  if (!heapSent) reportedHeartbeat.freeHeap = reportedHeap;
+}
 
-  mqttClient.publish(MQTT_TOPIC_HEARTBEAT, payload.c_str());
+// ================================
+// METRICS EXPORT
+// ================================
+// Hot-path latency histograms for fleet dashboards, one flat object per
+// window: <span>_n, <span>_p50, <span>_p99 and <span>_max (microseconds)
+void buildMetricsPayload(WireWriter& writer, const void* context) {
+  char key[16];
+
+  writer.beginObject();
+  writer.addUInt("faculty_id", unitProfile.getFacultyId());
+  writer.addUInt("window_s", PerformanceProfiler::getWindowMs() / 1000);
+  writer.addUInt("cpu_mhz", CPUOptimizer::getCurrentFrequency());
+  writer.addUInt("cpu_load_pm", (uint32_t)(CPUOptimizer::getCPUUsage() * 10));
+  writer.addUInt("scans", adaptiveScanner.getTotalScans());
+  writer.addUInt("detections", adaptiveScanner.getDetections());
+  writer.addUInt("radio_on_s", adaptiveScanner.getRadioOnMs() / 1000);
+  writer.addUInt("sleep_s", lightSleepMs / 1000);
+
+  const HeapSnapshot& heap = MemoryMonitor::getLast();
+  const MemoryTrend& trend = MemoryMonitor::getTrend();
+  writer.addUInt("heap_free", heap.freeBytes);
+  writer.addUInt("heap_min", heap.minFreeBytes);
+  writer.addUInt("heap_largest", heap.largestBlock);
+  writer.addUInt("heap_frag_pm", heap.fragmentationPermille);
+  writer.addInt("heap_slope_bph", trend.freeSlopePerHour);
+  writer.addInt("block_slope_bph", trend.blockSlopePerHour);
+  if (trend.hoursToExhaustion != MEMORY_NO_EXHAUSTION) writer.addUInt("heap_exhaustion_h", trend.hoursToExhaustion);
+  writer.addString("mem_pressure", MemoryMonitor::getPressureName(MemoryMonitor::getPressure()));
+  if (bootOnlineMs) writer.addUInt("boot_online_ms", bootOnlineMs);
+  if (brokerPool.getActive() != BROKER_NONE) {
+    writer.addUInt("broker", brokerPool.getActive());
+    writer.addUInt("broker_connect_ms", brokerPool.getHealth(brokerPool.getActive()).lastConnectMs);
+  }
+#if MQTT_USE_TLS
+  const TLSSessionStats& tls = wifiClient.getStats();
+  writer.addUInt("tls_full", tls.fullHandshakes);
+  writer.addUInt("tls_resumed", tls.resumedHandshakes);
+  writer.addUInt("tls_last_ms", tls.lastHandshakeMs);
+#endif
+
+  for (uint8_t i = 0; i < PERF_SPAN_COUNT; i++) {
+    PerfSpanSummary summary = PerformanceProfiler::summarize((PerfSpan)i);
+    const char* name = PerformanceProfiler::getSpanName((PerfSpan)i);
+    snprintf(key, sizeof(key), "%s_n", name);
+    writer.addUInt(key, summary.count);
+    if (summary.count == 0) continue;
+    snprintf(key, sizeof(key), "%s_p50", name);
+    writer.addUInt(key, summary.p50Us);
+    snprintf(key, sizeof(key), "%s_p99", name);
+    writer.addUInt(key, summary.p99Us);
+    snprintf(key, sizeof(key), "%s_max", name);
+    writer.addUInt(key, summary.maxUs);
+  }
+  writer.endObject();
+}
+
+// Offline windows keep accumulating rather than filling the queue
+void publishMetrics() {
+  if (!ENABLE_METRICS_EXPORT || !mqttClient.connected()) return;
+
+  if (publishEncoded(unitProfile.getTopic(UNIT_TOPIC_METRICS), WIRE_TOPIC_METRICS, buildMetricsPayload, nullptr, false)) {
+    PerformanceProfiler::reset();
+  }
+}
+
+// ================================
+// MEMORY PRESSURE
+// ================================
+// MemoryMonitor picks the step from the heap trend; each step is carried
+// out by the context that owns what it frees. The handler runs on the
+// network side from the memory timer.
+void onMemoryPressure(MemoryPressure level) {
+  uiMemoryPressure = level;
+  if (taskRuntimeActive) {
+    postUiEvent(UI_EVT_MEMORY_PRESSURE);
+  } else {
+    relieveUiMemory();
+  }
+
+  if (level >= MEMORY_PRESSURE_RECLAIM) {
+    scanResultsReleasePending = true;
+    recycleMqttConnection();
+  }
+  // Dropped again if the heap recovers before a quiet moment comes
+  bool reboot = level >= MEMORY_PRESSURE_REBOOT;
+  if (reboot && !memoryRebootPending) {
+    DEBUG_PRINTLN("🔁 Memory exhaustion ahead - restart scheduled for a quiet moment");
+  }
+  memoryRebootPending = reboot;
+}
+
+// UI side: the text cache is the largest heap user it owns
+void relieveUiMemory() {
+  MemoryPressure level = uiMemoryPressure;
+  if (level >= MEMORY_PRESSURE_RECLAIM) {
+    CacheOptimizer::clear();
+  }
+  CacheOptimizer::setByteLimit(level >= MEMORY_PRESSURE_SHRINK ? MEMORY_PRESSURE_CACHE_BYTES : (size_t)-1);
+}
+
+// Closing the connection frees the socket's lwIP buffers; the reconnect
+// allocates them afresh, usually into less fragmented space. Only while
+// AWAY, when incoming requests are ignored anyway.
+void recycleMqttConnection() {
+  if (presenceDetector.getPresence() || !mqttClient.connected()) return;
+  DEBUG_PRINTLN("🧹 Recycling MQTT connection to release socket buffers");
+  closeMqttLink();
+}
+
+// Never in the middle of a consultation: nothing on screen or in the
+// inbox, and the faculty AWAY unless the heap is already under its floor
+bool isQuietForRestart() {
+  int position, count, unread;
+  readInboxCounters(position, count, unread);
+  if (count > 0 || isMessageOnScreen()) return false;
+
+  const HeapSnapshot& heap = MemoryMonitor::getLast();
+  bool belowFloor = heap.freeBytes < MEMORY_FREE_FLOOR || heap.largestBlock < MEMORY_BLOCK_FLOOR;
+  return !presenceDetector.getPresence() || belowFloor;
+}
+
+void restartIfQuiet() {
+  if (!(memoryRebootPending || identityRebootPending) || !isQuietForRestart()) return;
+
+  DEBUG_PRINTLN(identityRebootPending ? "🔁 Restarting with the new unit identity" : "🔁 Restarting to recover heap");
+  persistOfflineQueue();  // Queued responses survive in the flash log
+  if (mqttClient.connected()) mqttClient.disconnect();
+  delay(100);
+  ESP.restart();
 }
 
 // ================================
@@ -1224,216 +3421,234 @@ void setupBLE() {
 
   BLEDevice::init("");
   pBLEScan = BLEDevice::getScan();
-  pBLEScan->setAdvertisedDeviceCallbacks(new MyAdvertisedDeviceCallbacks());
-  pBLEScan->setActiveScan(true);
-  pBLEScan->setInterval(100);
-  pBLEScan->setWindow(99);
+  // wantDuplicates keeps BLEScan from storing a BLEAdvertisedDevice per
+  // address; onResult() only needs the address and RSSI, so skip parsing
+  pBLEScan->setAdvertisedDeviceCallbacks(new MyAdvertisedDeviceCallbacks(), true, false);
+  pBLEScan->setActiveScan(!BLE_PASSIVE_SCAN);
+  pBLEScan->setInterval(BLE_RADIO_SCAN_INTERVAL_MS);
+  pBLEScan->setWindow(BLE_RADIO_SCAN_WINDOW_MS);
+
+  if (BLE_CONTROLLER_FILTER) {
+    BLEDevice::setCustomGapHandler(onControllerScanEvent);
+    syncControllerWhitelist(BeaconRegistry(), beaconRegistry);
+    DEBUG_PRINTF("BLE controller filter: %d whitelisted beacons\n", beaconRegistry.size());
+  }
 
   DEBUG_PRINTLN("BLE ready");
 }
 
 // ================================
-// DISPLAY FUNCTIONS (UNCHANGED - Your existing display logic!)
+// DISPLAY FUNCTIONS
 // ================================
 void setupDisplay() {
-  tft.init(240, 320);
-  tft.setRotation(3);
-  tft.fillScreen(COLOR_WHITE);
+  displayHardware.displayType = DISPLAY_ST7789;
+  displayHardware.displayWidth = 240;
+  displayHardware.displayHeight = 320;
+  displayHardware.displayRotation = 3;
+  displayHardware.pinDisplayCS = TFT_CS;
+  displayHardware.pinDisplayDC = TFT_DC;
+  displayHardware.pinDisplayRST = TFT_RST;
+  displayHardware.pinDisplayMOSI = TFT_MOSI;
+  displayHardware.pinDisplaySCLK = TFT_SCLK;
+  displayHardware.pinDisplayMISO = -1;
+  displayHardware.pinDisplayBacklight = TFT_BL;
+
+  displayPanel.init();
+  displayPanel.fillScreen(COLOR_WHITE);
 
   DEBUG_PRINTLN("Display initialized - With Grace Period BLE System");
 
-  tft.fillScreen(COLOR_BACKGROUND);
+  displayPanel.fillScreen(COLOR_BACKGROUND);
+
+  displayPanel.setCursor(getCenterX("NU FACULTY", 3), 100);
+  displayPanel.setTextColor(COLOR_ACCENT);
+  displayPanel.setTextSize(3);
+  displayPanel.print("NU FACULTY");
 
-  tft.setCursor(getCenterX("NU FACULTY", 3), 100);
-  tft.setTextColor(COLOR_ACCENT);
-  tft.setTextSize(3);
-  tft.print("NU FACULTY");
+  displayPanel.setCursor(getCenterX("DESK UNIT", 2), 130);
+  displayPanel.setTextSize(2);
+  displayPanel.setTextColor(COLOR_TEXT);
+  displayPanel.print("DESK UNIT");
 
-  tft.setCursor(getCenterX("DESK UNIT", 2), 130);
-  tft.setTextSize(2);
-  tft.setTextColor(COLOR_TEXT);
-  tft.print("DESK UNIT");
+  displayPanel.setCursor(getCenterX("Grace Period BLE", 1), 160);
+  displayPanel.setTextSize(1);
+  displayPanel.setTextColor(COLOR_ACCENT);
+  displayPanel.print("Grace Period BLE");
 
-  tft.setCursor(getCenterX("Grace Period BLE", 1), 160);
-  tft.setTextSize(1);
-  tft.setTextColor(COLOR_ACCENT);
-  tft.print("Grace Period BLE");
+  // Everything after the splash screen goes through the dirty-tile engine,
+  // rendering into two strips that are sent to the panel by SPI DMA
+  if (DISPLAY_PARTIAL_REDRAW) {
+    displayPanel.enableAsyncTransfers(SCREEN_WIDTH * DISPLAY_STRIP_LINES, TFT_SPI_FREQUENCY);
+  }
+  CacheOptimizer::init();
+  EnhancedDisplayManager::init();
+  EnhancedDisplayManager::setPageGeometry(MESSAGE_CHARS_PER_LINE, MESSAGE_LINES_PER_PAGE);
+  EnhancedDisplayManager::setPageRenderer(renderMessagePage);
+  DisplayOptimizer::enableFrameBuffer(DISPLAY_PARTIAL_REDRAW);
+  DisplayOptimizer::init(&displayPanel);
 
   delay(2000);
 }
 
 void drawCompleteUI() {
-  tft.fillScreen(COLOR_BACKGROUND);
+  DisplayOptimizer::beginFrame();
+  DisplayOptimizer::beginLayer(DISPLAY_LAYER_BACKGROUND);
 
-  tft.fillRect(0, TOP_PANEL_Y, SCREEN_WIDTH, TOP_PANEL_HEIGHT, COLOR_PANEL);
+  DisplayOptimizer::optimizedFillRect(0, 0, SCREEN_WIDTH, SCREEN_HEIGHT, COLOR_BACKGROUND);
+  DisplayOptimizer::optimizedFillRect(0, TOP_PANEL_Y, SCREEN_WIDTH, TOP_PANEL_HEIGHT, COLOR_PANEL);
 
-  tft.setCursor(PROFESSOR_NAME_X, PROFESSOR_NAME_Y);
-  tft.setTextColor(COLOR_ACCENT);
-  tft.setTextSize(1);
-  tft.print("PROFESSOR: ");
-  tft.setTextSize(1);
-  tft.print(FACULTY_NAME);
+  int x = drawText(PROFESSOR_NAME_X, PROFESSOR_NAME_Y, "PROFESSOR: ", COLOR_ACCENT, 1);
+  drawText(x, PROFESSOR_NAME_Y, unitProfile.get().name, COLOR_ACCENT, 1);
 
-  tft.setCursor(DEPARTMENT_X, DEPARTMENT_Y);
-  tft.setTextColor(COLOR_ACCENT);
-  tft.setTextSize(1);
-  tft.print("DEPARTMENT: ");
-  tft.print(FACULTY_DEPARTMENT);
+  x = drawText(DEPARTMENT_X, DEPARTMENT_Y, "DEPARTMENT: ", COLOR_ACCENT, 1);
+  drawText(x, DEPARTMENT_Y, unitProfile.get().department, COLOR_ACCENT, 1);
 
-  tft.fillRect(0, STATUS_PANEL_Y, SCREEN_WIDTH, STATUS_PANEL_HEIGHT, COLOR_PANEL_DARK);
-  tft.fillRect(0, BOTTOM_PANEL_Y, SCREEN_WIDTH, BOTTOM_PANEL_HEIGHT, COLOR_PANEL);
+  DisplayOptimizer::optimizedFillRect(0, STATUS_PANEL_Y, SCREEN_WIDTH, STATUS_PANEL_HEIGHT, COLOR_PANEL_DARK);
 
   updateTimeAndDate();
   updateMainDisplay();
   updateSystemStatus();
+
+  DisplayOptimizer::endFrame();
 }
 
 void updateMainDisplay() {
-  tft.fillRect(0, MAIN_AREA_Y, SCREEN_WIDTH, MAIN_AREA_HEIGHT, COLOR_WHITE);
+  DisplayOptimizer::beginFrame();
+  DisplayOptimizer::beginLayer(DISPLAY_LAYER_MAIN);
+  DisplayOptimizer::optimizedFillRect(0, MAIN_AREA_Y, SCREEN_WIDTH, MAIN_AREA_HEIGHT, COLOR_WHITE);
 
   if (presenceDetector.getPresence()) {
     drawSimpleCard(20, STATUS_CENTER_Y - 40, 280, 70, COLOR_PANEL);
-
-    int availableX = getCenterX("AVAILABLE", 4);
-    tft.setCursor(availableX, STATUS_CENTER_Y - 25);
-    tft.setTextSize(4);
-    tft.setTextColor(COLOR_SUCCESS);
-    tft.print("AVAILABLE");
-
-    int subtitleX = getCenterX("Ready for Consultation", 2);
-    tft.setCursor(subtitleX, STATUS_CENTER_Y + 5);
-    tft.setTextSize(2);
-    tft.setTextColor(COLOR_ACCENT);
-    tft.print("Ready for Consultation");
-
+    drawText(getCenterX("AVAILABLE", 4), STATUS_CENTER_Y - 25, "AVAILABLE", COLOR_SUCCESS, 4);
+    drawText(getCenterX("Ready for Consultation", 2), STATUS_CENTER_Y + 5,
+             "Ready for Consultation", COLOR_ACCENT, 2);
     drawStatusIndicator(STATUS_CENTER_X, STATUS_CENTER_Y + 50, true);
 
   } else {
     drawSimpleCard(20, STATUS_CENTER_Y - 40, 280, 70, COLOR_GRAY_LIGHT);
-
-    int awayX = getCenterX("AWAY", 4);
-    tft.setCursor(awayX, STATUS_CENTER_Y - 25);
-    tft.setTextSize(4);
-    tft.setTextColor(COLOR_ERROR);
-    tft.print("AWAY");
-
-    int notAvailableX = getCenterX("Not Available", 2);
-    tft.setCursor(notAvailableX, STATUS_CENTER_Y + 5);
-    tft.setTextSize(2);
-    tft.setTextColor(COLOR_WHITE);
-    tft.print("Not Available");
-
+    drawText(getCenterX("AWAY", 4), STATUS_CENTER_Y - 25, "AWAY", COLOR_ERROR, 4);
+    drawText(getCenterX("Not Available", 2), STATUS_CENTER_Y + 5, "Not Available", COLOR_WHITE, 2);
     drawStatusIndicator(STATUS_CENTER_X, STATUS_CENTER_Y + 50, false);
   }
+
+  DisplayOptimizer::endFrame();
 }
 
 void updateSystemStatus() {
-  tft.fillRect(2, STATUS_PANEL_Y + 1, SCREEN_WIDTH - 4, STATUS_PANEL_HEIGHT - 2, COLOR_PANEL_DARK);
+  DisplayOptimizer::beginFrame();
+  DisplayOptimizer::beginLayer(DISPLAY_LAYER_STATUS);
+  DisplayOptimizer::optimizedFillRect(2, STATUS_PANEL_Y + 1, SCREEN_WIDTH - 4, STATUS_PANEL_HEIGHT - 2, COLOR_PANEL_DARK);
 
   int topLineY = STATUS_PANEL_Y + 3;
 
-  tft.setCursor(10, topLineY);
-  tft.setTextColor(COLOR_ACCENT);
-  tft.setTextSize(1);
-  tft.print("WiFi:");
+  int x = drawText(10, topLineY, "WiFi:", COLOR_ACCENT, 1);
   if (wifiConnected) {
-    tft.setTextColor(COLOR_SUCCESS);
-    tft.print("CONNECTED");
+    drawText(x, topLineY, "CONNECTED", COLOR_SUCCESS, 1);
   } else {
-    tft.setTextColor(COLOR_ERROR);
-    tft.print("FAILED");
+    drawText(x, topLineY, "FAILED", COLOR_ERROR, 1);
   }
 
-  tft.setCursor(120, topLineY);
-  tft.setTextColor(COLOR_ACCENT);
-  tft.print("MQTT:");
+  x = drawText(120, topLineY, "MQTT:", COLOR_ACCENT, 1);
   if (mqttConnected) {
-    tft.setTextColor(COLOR_SUCCESS);
-    tft.print("ONLINE");
+    drawText(x, topLineY, "ONLINE", COLOR_SUCCESS, 1);
   } else {
-    tft.setTextColor(COLOR_ERROR);
-    tft.print("OFFLINE");
+    drawText(x, topLineY, "OFFLINE", COLOR_ERROR, 1);
   }
 
-  tft.setCursor(230, topLineY);
-  tft.setTextColor(COLOR_ACCENT);
-  tft.print("BLE:");
-  tft.setTextColor(COLOR_SUCCESS);
-  tft.print("ACTIVE");
+  x = drawText(230, topLineY, "BLE:", COLOR_ACCENT, 1);
+  drawText(x, topLineY, "ACTIVE", COLOR_SUCCESS, 1);
 
   int bottomLineY = STATUS_PANEL_Y + 15;
 
-  tft.setCursor(10, bottomLineY);
-  tft.setTextColor(COLOR_ACCENT);
-  tft.print("TIME:");
+  x = drawText(10, bottomLineY, "TIME:", COLOR_ACCENT, 1);
   if (timeInitialized) {
-    tft.setTextColor(COLOR_SUCCESS);
-    tft.print("SYNCED");
+    drawText(x, bottomLineY, "SYNCED", COLOR_SUCCESS, 1);
   } else if (ntpSyncInProgress) {
-    tft.setTextColor(COLOR_WARNING);
-    tft.print("SYNCING");
-  } else if (ntpSyncStatus == "FAILED") {
-    tft.setTextColor(COLOR_ERROR);
-    tft.print("FAILED");
+    drawText(x, bottomLineY, "SYNCING", COLOR_WARNING, 1);
+  } else if (ntpSyncState == NTP_SYNC_FAILED) {
+    drawText(x, bottomLineY, "FAILED", COLOR_ERROR, 1);
   } else {
-    tft.setTextColor(COLOR_WARNING);
-    tft.print("PENDING");
+    drawText(x, bottomLineY, "PENDING", COLOR_WARNING, 1);
   }
 
-  tft.setCursor(120, bottomLineY);
-  tft.setTextColor(COLOR_ACCENT);
-  tft.print("RAM:");
-  int freeHeapKB = ESP.getFreeHeap() / 1024;
-  tft.printf("%dKB", freeHeapKB);
+  char value[16];
+  x = drawText(120, bottomLineY, "RAM:", COLOR_ACCENT, 1);
+  snprintf(value, sizeof(value), "%uKB", (unsigned)(ESP.getFreeHeap() / 1024));
+  drawText(x, bottomLineY, value, COLOR_ACCENT, 1);
 
-  tft.setCursor(200, bottomLineY);
-  tft.setTextColor(COLOR_ACCENT);
-  tft.print("UPTIME:");
-  unsigned long uptimeMinutes = millis() / 60000;
+  x = drawText(200, bottomLineY, "UPTIME:", COLOR_ACCENT, 1);
+  unsigned uptimeMinutes = millis() / 60000;
   if (uptimeMinutes < 60) {
-    tft.printf("%dm", uptimeMinutes);
+    snprintf(value, sizeof(value), "%um", uptimeMinutes);
   } else {
-    tft.printf("%dh%dm", uptimeMinutes / 60, uptimeMinutes % 60);
+    snprintf(value, sizeof(value), "%uh%um", uptimeMinutes / 60, uptimeMinutes % 60);
   }
+  drawText(x, bottomLineY, value, COLOR_ACCENT, 1);
+
+  DisplayOptimizer::endFrame();
 }
 
 // ================================
-// MESSAGE DISPLAY WITH BUTTONS (UNCHANGED)
+// MESSAGE DISPLAY WITH BUTTONS
 // ================================
-void displayIncomingMessage(String message) {
-  currentMessage = message;
+void displayIncomingMessage(const EnhancedMessage& message) {
   messageDisplayed = true;
   messageDisplayStart = millis();
 
+  // Lays the body out once and draws page 1 through renderMessagePage()
+  EnhancedDisplayManager::displayMessage(message);
+
+  DEBUG_PRINTF("📱 Message displayed with buttons. Message ID: %s, pages: %d\n",
+              message.messageId, EnhancedDisplayManager::getTotalPages());
+}
+
+// Page renderer for EnhancedDisplayManager; paging only re-records this layer
+void renderMessagePage(const EnhancedMessage& message, const MessageLayout& layout, int page) {
+  DisplayOptimizer::beginFrame();
+  DisplayOptimizer::beginLayer(DISPLAY_LAYER_MAIN);
+
   // Clear main area
-  tft.fillRect(0, MAIN_AREA_Y, SCREEN_WIDTH, MAIN_AREA_HEIGHT, COLOR_PANEL);
+  DisplayOptimizer::optimizedFillRect(0, MAIN_AREA_Y, SCREEN_WIDTH, MAIN_AREA_HEIGHT, COLOR_PANEL);
 
-  // Message header
+  // Message header; with several queued, shows the position and what is unread
+  int position, count, unread;
+  readInboxCounters(position, count, unread);
+
+  char title[32];
+  if (count > 1) {
+    snprintf(title, sizeof(title), "MESSAGE %d/%d", position + 1, count);
+  } else {
+    strcpy(title, "NEW MESSAGE");
+  }
   drawSimpleCard(10, MAIN_AREA_Y + 5, SCREEN_WIDTH - 20, 25, COLOR_ACCENT);
+  drawText(getCenterX(title, 2), MAIN_AREA_Y + 12, title, COLOR_BACKGROUND, 2);
 
-  int newMessageX = getCenterX("NEW MESSAGE", 2);
-  tft.setCursor(newMessageX, MAIN_AREA_Y + 12);
-  tft.setTextColor(COLOR_BACKGROUND);
-  tft.setTextSize(2);
-  tft.print("NEW MESSAGE");
+  if (unread > 0) {
+    char unreadLabel[20];
+    snprintf(unreadLabel, sizeof(unreadLabel), "+%d NEW", unread);
+    drawText(18, MAIN_AREA_Y + 14, unreadLabel, COLOR_BACKGROUND, 1);
+  }
 
-  // Message content area
-  tft.setCursor(15, MAIN_AREA_Y + 40);
-  tft.setTextColor(COLOR_TEXT);
-  tft.setTextSize(1);
+  if (layout.pageCount > 1) {
+    char pageLabel[16];
+    snprintf(pageLabel, sizeof(pageLabel), "%d/%u", page + 1, (unsigned)layout.pageCount);
+    drawText(SCREEN_WIDTH - 20 - strlen(pageLabel) * 6, MAIN_AREA_Y + 14, pageLabel, COLOR_BACKGROUND, 1);
+  }
 
+  // Message content: the lines of this page, straight from the slot buffer
+  const char* text = message.data.rawMessage;
   int lineHeight = 10;
-  int maxCharsPerLine = 40;
   int currentY = MAIN_AREA_Y + 40;
-
-  // Display message with word wrapping
-  for (int i = 0; i < message.length(); i += maxCharsPerLine) {
-    String line = message.substring(i, min(i + maxCharsPerLine, (int)message.length()));
-    tft.setCursor(15, currentY);
-    tft.print(line);
+  char line[MESSAGE_CHARS_PER_LINE + 1];
+
+  int first = page * layout.linesPerPage;
+  int last = min((int)layout.lineCount, first + layout.linesPerPage);
+  for (int i = first; i < last; i++) {
+    size_t n = min((size_t)layout.lineLength[i], (size_t)MESSAGE_CHARS_PER_LINE);
+    memcpy(line, text + layout.lineStart[i], n);
+    line[n] = '\0';
+    drawText(15, currentY, line, COLOR_TEXT, 1);
     currentY += lineHeight;
-
-    if (currentY > MAIN_AREA_Y + 85) break; // Leave space for buttons
   }
 
   // Button instructions
@@ -1441,22 +3656,628 @@ void displayIncomingMessage(String message) {
   drawSimpleCard(165, MAIN_AREA_Y + 95, 145, 35, COLOR_ERROR_BG);
 
   // Blue button (Acknowledge)
-  tft.setCursor(15, MAIN_AREA_Y + 102);
-  tft.setTextColor(COLOR_WHITE);
-  tft.setTextSize(1);
-  tft.print("BLUE BUTTON:");
-  tft.setCursor(15, MAIN_AREA_Y + 115);
-  tft.print("ACKNOWLEDGE");
+  drawText(15, MAIN_AREA_Y + 102, (layout.pageCount > 1 || count > 1) ? "BLUE: ACK / HOLD: NEXT" : "BLUE BUTTON:",
+           COLOR_WHITE, 1);
+  drawText(15, MAIN_AREA_Y + 115, "ACKNOWLEDGE", COLOR_WHITE, 1);
 
   // Red button (Busy)
-  tft.setCursor(170, MAIN_AREA_Y + 102);
-  tft.setTextColor(COLOR_WHITE);
-  tft.setTextSize(1);
-  tft.print("RED BUTTON:");
-  tft.setCursor(170, MAIN_AREA_Y + 115);
-  tft.print("BUSY");
+  drawText(170, MAIN_AREA_Y + 102, (layout.pageCount > 1 || count > 1) ? "RED: BUSY / HOLD: BACK" : "RED BUTTON:",
+           COLOR_WHITE, 1);
+  drawText(170, MAIN_AREA_Y + 115, "BUSY", COLOR_WHITE, 1);
 
-  DEBUG_PRINTF("📱 Message displayed with buttons. Message ID: %s\n", messageId.c_str());
+  DisplayOptimizer::endFrame();
+}
+
+// ================================
+// SERVICE FUNCTIONS (SHARED BY LOOP AND TASKS)
+// ================================
+void serviceButtons() {
+  // Update button states
+  buttons.update();
+
+  // Handle button presses
+  if (buttons.isButtonAPressed()) {
+    handleAcknowledgeButton();
+  }
+
+  if (buttons.isButtonBPressed()) {
+    handleBusyButton();
+  }
+
+  // Holding a button pages through a long message without re-wrapping it;
+  // past the last (or first) page it moves on to the next queued message
+  int position, count, unread;
+  readInboxCounters(position, count, unread);
+
+  if (buttons.isButtonALongPressed()) {
+    if (EnhancedDisplayManager::getCurrentPage() + 1 < EnhancedDisplayManager::getTotalPages()) {
+      EnhancedDisplayManager::nextPage();
+    } else if (count > 1) {
+      showAdjacentInboxMessage(1);
+    } else {
+      EnhancedDisplayManager::nextPage();
+    }
+  }
+
+  if (buttons.isButtonBLongPressed()) {
+    if (EnhancedDisplayManager::getCurrentPage() > 0) {
+      EnhancedDisplayManager::previousPage();
+    } else if (count > 1) {
+      showAdjacentInboxMessage(-1);
+    } else {
+      EnhancedDisplayManager::previousPage();
+    }
+  }
+}
+
+void serviceNetwork() {
+  checkWiFiConnection();
+  serviceMqttLink();
+
+  if (mqttConnected) {
+    mqttClient.loop();
+  }
+
+  // Update offline queue system
+  updateOfflineQueue();
+
+  // Coalesced presence changes
+  servicePresencePublisher();
+
+  // Periodic time sync check
+  checkPeriodicTimeSync();
+}
+
+// ================================
+// EVENT SCHEDULING
+// ================================
+// Periodic work runs from deadline timers and input arrives as events, so
+// each context sleeps until its next deadline or event instead of ticking.
+// uiScheduler belongs to the UI task, networkScheduler to the network task;
+// without the task runtime loop() runs both.
+EventScheduler uiScheduler;
+EventScheduler networkScheduler;
+
+uint8_t buttonTimer = EVENT_TIMER_INVALID;
+uint8_t scanTimer = EVENT_TIMER_INVALID;
+uint8_t networkPollTimer = EVENT_TIMER_INVALID;
+uint8_t awayTimer = EVENT_TIMER_INVALID;
+uint8_t confirmationTimer = EVENT_TIMER_INVALID;
+uint8_t ntpCheckTimer = EVENT_TIMER_INVALID;
+
+// The response confirmation card owns the main area while its timer is armed
+void holdConfirmation() {
+  uiScheduler.schedule(confirmationTimer, CONFIRMATION_DISPLAY_TIME, millis());
+}
+
+bool isConfirmationShowing() {
+  return uiScheduler.isArmed(confirmationTimer);
+}
+
+void scheduleNtpCheck() {
+  networkScheduler.schedule(ntpCheckTimer, NTP_PERIODIC_CHECK_MS, millis());
+}
+
+// Scanner time in the BLE task, which has no scheduler of its own
+volatile uint32_t bleBusyUs = 0;
+
+void serviceButtonEvents() {
+  if (buttonEdgePending) wakeFromAway();
+  buttonEdgePending = false;
+  serviceButtons();
+  uiScheduler.schedule(buttonTimer, buttons.msUntilNextPoll(), millis());
+}
+
+void onButtonTimer(void* context) {
+  serviceButtonEvents();
+}
+
+void onTimeTimer(void* context) {
+  updateTimeAndDate();
+}
+
+void onStatusTimer(void* context) {
+  updateSystemStatus();
+}
+
+void onAnimationTimer(void* context) {
+  animationState = !animationState;
+  if (presenceDetector.getPresence() && !messageDisplayed && !isConfirmationShowing()) {
+    updateMainDisplay();  // Only the indicator tiles actually change
+  }
+}
+
+void onInboxTimer(void* context) {
+  serviceInbox();
+}
+
+// The confirmation card has been up long enough; a message that arrived
+// meanwhile is shown now
+void onConfirmationTimer(void* context) {
+  if (!messageDisplayed) showNextScreen();
+}
+
+void onAwayTimer(void* context) {
+  if (!presenceDetector.getPresence()) setAwayPowerMode(true);
+}
+
+// loop() mode only; the BLE task waits on the scanner itself
+void onScanTimer(void* context) {
+  adaptiveScanner.update();
+  uiScheduler.schedule(scanTimer, adaptiveScanner.msUntilNextAction(), millis());
+}
+
+// WiFi/MQTT need polling; requests from other tasks wake the network task early
+void onNetworkPollTimer(void* context) {
+  serviceNetwork();
+
+  bool settled = isNetworkSettled();
+  holdNetworkAwake(!settled);
+  unsigned long period = taskRuntimeActive ? NETWORK_TASK_PERIOD_MS : LOOP_NETWORK_POLL_MS;
+  if (settled && lightSleepAllowed) {
+    // Incoming data wakes the task runtime through the socket; loop() polls
+    period = socketWakeTaskHandle ? LIGHT_SLEEP_MAX_MS : LIGHT_SLEEP_LOOP_POLL_MS;
+    if (wifiClient.available() > 0) period = 0;  // Read before waiting on the socket again
+    else armSocketWake();
+  } else {
+    disarmSocketWake();
+  }
+  networkScheduler.schedule(networkPollTimer, period, millis());
+}
+
+// Periodic resync started by checkPeriodicTimeSync(); the clock was already
+// set, so a readable time here means SNTP answered
+void onNtpCheckTimer(void* context) {
+  struct tm timeinfo;
+  if (getLocalTime(&timeinfo, 0)) {
+    ntpSyncState = NTP_SYNC_SYNCED;
+    DEBUG_PRINTLN("Periodic NTP sync successful");
+    publishNtpSyncStatus(true);
+  } else {
+    ntpSyncState = NTP_SYNC_FAILED;
+    DEBUG_PRINTLN("Periodic NTP sync failed");
+    publishNtpSyncStatus(false);
+  }
+  ntpSyncInProgress = false;
+}
+
+void onHeartbeatTimer(void* context) {
+  publishHeartbeat();
+}
+
+void onMetricsTimer(void* context) {
+  publishMetrics();
+}
+
+void onMemoryTimer(void* context) {
+  MemoryMonitor::sample();
+
+  // Pressure has cleared: give the UI its cache budget back
+  if (MemoryMonitor::getPressure() == MEMORY_PRESSURE_NONE && uiMemoryPressure != MEMORY_PRESSURE_NONE) {
+    onMemoryPressure(MEMORY_PRESSURE_NONE);
+  }
+  restartIfQuiet();
+}
+
+// Write queued responses to flash in batches, off the button path
+void onPersistTimer(void* context) {
+  persistOfflineQueue();
+}
+
+// Load of the busiest core over the last sample: the UI and network
+// schedulers share core 1, the BLE task has core 0. In loop() mode
+// everything runs on one core and bleBusyUs stays zero.
+void onCpuLoadTimer(void* context) {
+  static uint32_t lastSample = micros();
+  static uint32_t lastUiBusy = 0, lastNetworkBusy = 0, lastBleBusy = 0;
+
+  uint32_t now = micros();
+  uint32_t uiBusy = uiScheduler.getBusyMicros();
+  uint32_t networkBusy = networkScheduler.getBusyMicros();
+  uint32_t bleBusy = bleBusyUs;
+
+  uint32_t appCore = (uiBusy - lastUiBusy) + (networkBusy - lastNetworkBusy);
+  uint32_t bleCore = bleBusy - lastBleBusy;
+  CPUOptimizer::reportLoad(max(appCore, bleCore), now - lastSample);
+
+  lastSample = now;
+  lastUiBusy = uiBusy;
+  lastNetworkBusy = networkBusy;
+  lastBleBusy = bleBusy;
+}
+
+void onSchedulerStatsTimer(void* context) {
+  uiScheduler.printStats("ui");
+  networkScheduler.printStats("network");  // Read across tasks; figures are indicative
+  CPUOptimizer::printCPUStats();
+  PerformanceProfiler::printReport();
+  MessageStatistics::printStatistics();
+  MemoryMonitor::printStatus();
+  DEBUG_PRINTF("   Pools: requests %u/%u peak (%lu full) | net scratch %u/%u peak (%lu full)"
+               " | responses %u/%u peak (%lu full)\n",
+               networkRequestPool.getHighWater(), networkRequestPool.getBlockCount(),
+               (unsigned long)networkRequestPool.getFailures(),
+               (unsigned)networkScratch.getHighWater(), (unsigned)networkScratch.getCapacity(),
+               (unsigned long)networkScratch.getFailures(),
+               (unsigned)responseStore.getHighWater(), (unsigned)responseStore.getCapacity(),
+               (unsigned long)responseStore.getFailures());
+  DEBUG_PRINTF("   Light sleep: %s, allowed %lu times, %lus total\n",
+               !ENABLE_AWAY_LIGHT_SLEEP ? "off" : lightSleepSupported ? "available" : "not supported by this core",
+               lightSleepCount, lightSleepMs / 1000);
+  DEBUG_PRINTLN("   Brokers:");
+  brokerPool.printStatus(millis());
+#if MQTT_USE_TLS
+  const TLSSessionStats& tls = wifiClient.getStats();
+  DEBUG_PRINTF("   TLS: %lu full (max %lums) | %lu resumed (max %lums) | %lu fallbacks, %lu failures\n",
+               (unsigned long)tls.fullHandshakes, (unsigned long)tls.maxFullMs,
+               (unsigned long)tls.resumedHandshakes, (unsigned long)tls.maxResumedMs,
+               (unsigned long)tls.resumeFallbacks, (unsigned long)tls.failures);
+#endif
+}
+
+void initEventScheduling() {
+  if (!uiEventQueue) uiEventQueue = xQueueCreate(UI_EVENT_QUEUE_LENGTH, sizeof(UiEvent));
+
+  unsigned long now = millis();
+  buttonTimer = uiScheduler.addTimer("buttons", onButtonTimer, nullptr, 0, EVENT_PRIORITY_HIGH);
+  scanTimer = uiScheduler.addTimer("ble_scan", onScanTimer, nullptr, 0, EVENT_PRIORITY_HIGH);
+  uiScheduler.start(uiScheduler.addTimer("clock", onTimeTimer, nullptr, TIME_UPDATE_INTERVAL), now);
+  uiScheduler.start(uiScheduler.addTimer("status", onStatusTimer, nullptr, STATUS_UPDATE_INTERVAL,
+                                         EVENT_PRIORITY_LOW, true), now);
+  uiScheduler.start(uiScheduler.addTimer("animation", onAnimationTimer, nullptr, ANIMATION_INTERVAL,
+                                         EVENT_PRIORITY_LOW, true), now);
+  uiScheduler.start(uiScheduler.addTimer("inbox", onInboxTimer, nullptr, INBOX_SERVICE_INTERVAL,
+                                         EVENT_PRIORITY_LOW), now);
+  awayTimer = uiScheduler.addTimer("away", onAwayTimer, nullptr, 0, EVENT_PRIORITY_LOW);
+  confirmationTimer = uiScheduler.addTimer("confirmation", onConfirmationTimer, nullptr, 0);
+  uiScheduler.start(uiScheduler.addTimer("cpu_load", onCpuLoadTimer, nullptr, CPU_LOAD_SAMPLE_INTERVAL,
+                                         EVENT_PRIORITY_LOW), now);
+  if (ENABLE_SERIAL_DEBUG) {
+    uiScheduler.start(uiScheduler.addTimer("stats", onSchedulerStatsTimer, nullptr,
+                                           SCHEDULER_STATS_REPORT_INTERVAL, EVENT_PRIORITY_LOW), now);
+  }
+  uiScheduler.schedule(buttonTimer, 0, now);
+
+  networkPollTimer = networkScheduler.addTimer("net_poll", onNetworkPollTimer, nullptr, 0, EVENT_PRIORITY_HIGH);
+  networkScheduler.schedule(networkPollTimer, 0, now);
+  ntpCheckTimer = networkScheduler.addTimer("ntp_check", onNtpCheckTimer, nullptr, 0, EVENT_PRIORITY_LOW);
+  networkScheduler.start(networkScheduler.addTimer("heartbeat", onHeartbeatTimer, nullptr, HEARTBEAT_INTERVAL), now);
+  networkScheduler.start(networkScheduler.addTimer("metrics", onMetricsTimer, nullptr, METRICS_PUBLISH_INTERVAL,
+                                                   EVENT_PRIORITY_LOW), now);
+  networkScheduler.start(networkScheduler.addTimer("persist", onPersistTimer, nullptr, OFFLINE_LOG_FLUSH_INTERVAL,
+                                                   EVENT_PRIORITY_LOW), now);
+  networkScheduler.start(networkScheduler.addTimer("memory", onMemoryTimer, nullptr, MEMORY_SAMPLE_INTERVAL,
+                                                   EVENT_PRIORITY_LOW), now);
+
+  PerformanceProfiler::init();
+  CPUOptimizer::init(CPU_FREQ_POWER_SAVE, CPU_FREQ_NORMAL);
+  CPUOptimizer::enableDynamicFrequency(ENABLE_POWER_MANAGEMENT);
+
+  updatePresencePowerState();  // Boots AWAY until the beacon is confirmed
+}
+
+// Blocks on the UI event queue until an event arrives or the deadline passes
+void waitForUiEvents(unsigned long timeoutMs) {
+  // The panel DMA finishes before this context lets the chip sleep
+  if (displayPmLockHeld) {
+    displayPanel.waitForTransfers();
+    holdDisplayAwake(false);
+  }
+
+  UiEvent event;
+  TickType_t ticks = timeoutMs == EVENT_SCHEDULER_IDLE ? portMAX_DELAY : pdMS_TO_TICKS(timeoutMs);
+  bool received = xQueueReceive(uiEventQueue, &event, ticks) == pdTRUE;
+  holdDisplayAwake(true);  // Either an event or a deadline: the UI runs now
+  if (!received) return;
+
+  uint32_t start = micros();
+  do {
+    handleUiEvent(event);
+  } while (xQueueReceive(uiEventQueue, &event, 0) == pdTRUE);
+  uiScheduler.recordBusy(micros() - start);
+}
+
+// Nothing on the clock face animates while AWAY, so the cosmetic timers
+// can run less often; after LIGHT_SLEEP_AWAY_DELAY_MS the unit also goes
+// into away power mode (see AWAY LIGHT SLEEP)
+void updatePresencePowerState() {
+  bool away = !presenceDetector.getPresence();
+  uiScheduler.setPowerSave(away);
+
+  if (away) {
+    uiScheduler.scheduleNoLaterThan(awayTimer, LIGHT_SLEEP_AWAY_DELAY_MS, millis());
+  } else {
+    uiScheduler.cancel(awayTimer);
+    setAwayPowerMode(false);
+  }
+}
+
+// ================================
+// AWAY LIGHT SLEEP
+// ================================
+// While the faculty is away the power manager may put the chip in light
+// sleep. It only does so when every task on both cores is blocked
+// (FreeRTOS tickless idle), and the earliest task timeout bounds the
+// sleep, so the scanner's and both schedulers' deadlines are kept. WiFi
+// stays associated in modem sleep and wakes for the AP's DTIM beacons;
+// the BLE controller holds its own lock while it scans. Work in flight
+// holds an ESP_PM_NO_LIGHT_SLEEP lock instead:
+// - network: until the link is up and nothing is waiting to go out
+// - display: while the UI runs, and until its SPI DMA has drained
+// With the network lock released, incoming MQTT data wakes the unit: the
+// AP buffers the frame until its next DTIM beacon, WiFi wakes the chip for
+// it, and lwIP hands it to the socket wake task blocked in select(), which
+// wakes the network task. The network side itself only polls every
+// LIGHT_SLEEP_MAX_MS for the keepalive (loop() mode has no socket wake and
+// polls every LIGHT_SLEEP_LOOP_POLL_MS). A button press wakes the unit
+// through a GPIO wake level. This needs an Arduino core built with
+// CONFIG_PM_ENABLE and CONFIG_FREERTOS_USE_TICKLESS_IDLE; on any other
+// core esp_pm refuses and the unit simply stays awake.
+void initLightSleep() {
+  if (!ENABLE_AWAY_LIGHT_SLEEP) return;
+  if (esp_pm_lock_create(ESP_PM_NO_LIGHT_SLEEP, 0, "network", &networkPmLock) != ESP_OK ||
+      esp_pm_lock_create(ESP_PM_NO_LIGHT_SLEEP, 0, "display", &displayPmLock) != ESP_OK) {
+    DEBUG_PRINTLN("⚠️ Power management is not built into this core - no light sleep");
+    networkPmLock = displayPmLock = nullptr;
+    lightSleepSupported = false;
+    return;
+  }
+  // Both sides are busy until they say otherwise
+  holdNetworkAwake(true);
+  holdDisplayAwake(true);
+}
+
+void holdNetworkAwake(bool busy) {
+  if (!networkPmLock || busy == networkPmLockHeld) return;
+  if (busy) esp_pm_lock_acquire(networkPmLock);
+  else esp_pm_lock_release(networkPmLock);
+  networkPmLockHeld = busy;
+}
+
+void holdDisplayAwake(bool busy) {
+  if (!displayPmLock || busy == displayPmLockHeld) return;
+  if (busy) esp_pm_lock_acquire(displayPmLock);
+  else esp_pm_lock_release(displayPmLock);
+  displayPmLockHeld = busy;
+}
+
+// Network context: nothing being connected, flushed or synced
+bool isNetworkSettled() {
+  return wifiConnected && mqttConnected && mqttLinkState == MQTT_LINK_UP &&
+         offlineQueueDepth() == 0 && !presencePending && !ntpSyncInProgress;
+}
+
+// Network context, once everything on the socket has been read: the
+// socket wake task signals the next byte that arrives. A reopened socket
+// replaces the one being watched at the next wait.
+void armSocketWake() {
+  int fd = wifiClient.fd();
+  if (!socketWakeTaskHandle || fd < 0 || socketWakeFd == fd) return;
+  bool idle = socketWakeFd < 0;
+  socketWakeFd = fd;
+  if (idle) xTaskNotifyGive(socketWakeTaskHandle);
+}
+
+void disarmSocketWake() {
+  socketWakeFd = -1;
+}
+
+// Blocked in select() it holds no PM lock, so the chip sleeps meanwhile.
+// It signals once per arming; the wait is bounded so that a disarm or a
+// new socket is seen within LIGHT_SLEEP_MAX_MS.
+void socketWakeTask(void* parameter) {
+  for (;;) {
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+    int fd;
+    while ((fd = socketWakeFd) >= 0) {
+      fd_set readSet;
+      FD_ZERO(&readSet);
+      FD_SET(fd, &readSet);
+      struct timeval timeout = { LIGHT_SLEEP_MAX_MS / 1000, (LIGHT_SLEEP_MAX_MS % 1000) * 1000 };
+      if (select(fd + 1, &readSet, nullptr, nullptr, &timeout) == 0) continue;
+
+      // Readable, or the socket failed: either way the network task looks
+      socketWakeFd = -1;
+      NetworkRequest* request = acquireNetworkRequest(NET_REQ_SOCKET_READABLE);
+      if (request) sendNetworkRequest(request);
+    }
+  }
+}
+
+// Tells the power manager whether it may light-sleep; the CPU clock is
+// its job meanwhile, so CPUOptimizer stands aside
+bool configureLightSleep(bool enabled) {
+  esp_pm_config_esp32_t config = {};
+  config.max_freq_mhz = CPU_FREQ_NORMAL;
+  config.min_freq_mhz = enabled ? CPU_FREQ_POWER_SAVE : CPU_FREQ_NORMAL;
+  config.light_sleep_enable = enabled;
+  return esp_pm_configure(&config) == ESP_OK;
+}
+
+// UI context. The flag is set only here; the ISR may disarm the buttons
+// on its own, which is why disarming is safe to repeat.
+void armButtonWake() {
+  buttonWakeArmed = true;  // Before the levels, so the first one is caught
+  gpio_wakeup_enable((gpio_num_t)BUTTON_A_PIN, GPIO_INTR_LOW_LEVEL);
+  gpio_wakeup_enable((gpio_num_t)BUTTON_B_PIN, GPIO_INTR_LOW_LEVEL);
+  esp_sleep_enable_gpio_wakeup();
+}
+
+void disarmButtonWake() {
+  buttonWakeArmed = false;
+  gpio_wakeup_disable((gpio_num_t)BUTTON_A_PIN);
+  gpio_wakeup_disable((gpio_num_t)BUTTON_B_PIN);
+  gpio_set_intr_type((gpio_num_t)BUTTON_A_PIN, GPIO_INTR_ANYEDGE);
+  gpio_set_intr_type((gpio_num_t)BUTTON_B_PIN, GPIO_INTR_ANYEDGE);
+}
+
+void setLightSleepAllowed(bool allowed) {
+  if (!ENABLE_AWAY_LIGHT_SLEEP || !lightSleepSupported || allowed == lightSleepAllowed) return;
+
+  if (allowed) {
+    CPUOptimizer::enableDynamicFrequency(false);
+    if (!configureLightSleep(true)) {
+      DEBUG_PRINTLN("⚠️ esp_pm refused light sleep (no tickless idle in this core)");
+      lightSleepSupported = false;
+      CPUOptimizer::enableDynamicFrequency(ENABLE_POWER_MANAGEMENT);
+      return;
+    }
+    armButtonWake();
+    lightSleepCount++;
+    lightSleepSince = millis();
+    lightSleepAllowed = true;
+  } else {
+    lightSleepAllowed = false;
+    disarmButtonWake();
+    configureLightSleep(false);
+    CPUOptimizer::enableDynamicFrequency(ENABLE_POWER_MANAGEMENT);
+    lightSleepMs += millis() - lightSleepSince;
+  }
+}
+
+// UI context: decides the mode
+void setAwayPowerMode(bool enabled) {
+  if (enabled == awayPowerMode) return;
+  awayPowerMode = enabled;
+
+  WiFi.setSleep(enabled ? WIFI_PS_MAX_MODEM : WIFI_PS_MIN_MODEM);
+  displayPanel.setBacklight(!enabled);
+  setLightSleepAllowed(enabled);
+  DEBUG_PRINTF("🌙 Away power mode %s\n", enabled ? "on" : "off");
+}
+
+// A button press or a message needs the panel; drop back to away power
+// mode once things are quiet again
+void wakeFromAway() {
+  if (!awayPowerMode) return;
+  setAwayPowerMode(false);
+  uiScheduler.schedule(awayTimer, LIGHT_SLEEP_AWAY_DELAY_MS, millis());
+}
+
+// ================================
+// FREERTOS TASKS
+// ================================
+void handleUiEvent(const UiEvent& event) {
+  switch (event.type) {
+    case UI_EVT_PRESENCE_CHANGED:
+      updatePresencePowerState();
+      if (!isConfirmationShowing()) updateMainDisplay();
+      break;
+
+    case UI_EVT_STATUS_CHANGED:
+      updateTimeAndDate();
+      updateSystemStatus();
+      break;
+
+    case UI_EVT_MESSAGE_RECEIVED:
+      onInboxMessageArrived();
+      break;
+
+    case UI_EVT_BUTTON:
+      serviceButtonEvents();
+      break;
+
+    case UI_EVT_BLE_WINDOW:
+      onScanTimer(nullptr);
+      break;
+
+    case UI_EVT_MEMORY_PRESSURE:
+      relieveUiMemory();
+      break;
+  }
+}
+
+void uiTask(void* parameter) {
+  for (;;) {
+    // Sleep until an event arrives or the next display/button deadline
+    waitForUiEvents(uiScheduler.msUntilNext(millis()));
+    uiScheduler.runDue(millis());
+  }
+}
+
+void handleNetworkRequest(const NetworkRequest& request) {
+  if (request.type == NET_REQ_SOCKET_READABLE) {
+    networkScheduler.scheduleNoLaterThan(networkPollTimer, 0, millis());
+  } else if (request.type == NET_REQ_PUBLISH_PRESENCE) {
+    requestPresencePublish();
+  } else if (request.type == NET_REQ_PUBLISH_RESPONSE) {
+    publishResponse(request.response_kind, request.message_id, request.payload, request.trace,
+                    request.received_time);
+  } else {
+    publishWithQueue(request.topic, request.payload, request.is_response);
+  }
+}
+
+void networkTask(void* parameter) {
+  NetworkRequest* request;
+
+  for (;;) {
+    networkScratch.reset();
+    networkScheduler.runDue(millis());
+
+    // Keep the status panel honest when the broker drops us
+    if (mqttConnected && !mqttClient.connected()) {
+      mqttConnected = false;
+      requestStatusRedraw();
+    }
+
+    // A request from another task ends the wait early
+    unsigned long wait = networkScheduler.msUntilNext(millis());
+    if (xQueueReceive(networkQueue, &request, pdMS_TO_TICKS(wait)) == pdTRUE) {
+      uint32_t start = micros();
+      do {
+        handleNetworkRequest(*request);
+        networkRequestPool.release(request);
+      } while (xQueueReceive(networkQueue, &request, 0) == pdTRUE);
+      networkScheduler.recordBusy(micros() - start);
+
+      // Something to flush now: back to the short poll, awake
+      if (!isNetworkSettled()) {
+        holdNetworkAwake(true);
+        networkScheduler.scheduleNoLaterThan(networkPollTimer, NETWORK_TASK_PERIOD_MS, millis());
+      }
+    }
+  }
+}
+
+void bleTask(void* parameter) {
+  for (;;) {
+    uint32_t start = micros();
+    adaptiveScanner.update();
+    bleBusyUs += micros() - start;
+    // Scan-complete callbacks notify the task, ending the wait early
+    ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(adaptiveScanner.msUntilNextAction()));
+  }
+}
+
+bool startTaskRuntime() {
+  if (!uiEventQueue) uiEventQueue = xQueueCreate(UI_EVENT_QUEUE_LENGTH, sizeof(UiEvent));
+  networkQueue = xQueueCreate(NETWORK_QUEUE_LENGTH, sizeof(NetworkRequest*));
+  inboxMutex = xSemaphoreCreateMutex();
+
+  if (!uiEventQueue || !networkQueue || !inboxMutex) {
+    DEBUG_PRINTLN("❌ Task runtime queues could not be created - staying in loop() mode");
+    return false;
+  }
+
+  // Handover must be visible before any task starts posting
+  taskRuntimeActive = true;
+
+  xTaskCreatePinnedToCore(bleTask, "ble", BLE_TASK_STACK_SIZE, NULL,
+                          BLE_TASK_PRIORITY, &bleTaskHandle, BLE_TASK_CORE);
+  xTaskCreatePinnedToCore(networkTask, "network", NETWORK_TASK_STACK_SIZE, NULL,
+                          NETWORK_TASK_PRIORITY, &networkTaskHandle, NETWORK_TASK_CORE);
+  xTaskCreatePinnedToCore(uiTask, "ui", UI_TASK_STACK_SIZE, NULL,
+                          UI_TASK_PRIORITY, &uiTaskHandle, UI_TASK_CORE);
+  if (ENABLE_AWAY_LIGHT_SLEEP && lightSleepSupported) {
+    xTaskCreatePinnedToCore(socketWakeTask, "socket_wake", SOCKET_WAKE_TASK_STACK_SIZE, NULL,
+                            NETWORK_TASK_PRIORITY, &socketWakeTaskHandle, NETWORK_TASK_CORE);
+  }
+
+  DEBUG_PRINTF("🧵 Task runtime started - BLE: core %d | Network: core %d | UI: core %d\n",
+              BLE_TASK_CORE, NETWORK_TASK_CORE, UI_TASK_CORE);
+  return true;
 }
 
 // ================================
@@ -1476,101 +4297,86 @@ void setup() {
     while(true) delay(5000);
   }
 
-  DEBUG_PRINTF("Faculty: %s\n", FACULTY_NAME);
-  DEBUG_PRINTF("Department: %s\n", FACULTY_DEPARTMENT);
-  DEBUG_PRINTF("iBeacon: %s\n", FACULTY_BEACON_MAC);
+  unitProfile.begin(DEFAULT_IDENTITY, ESP.getEfuseMac());
+  const UnitIdentity& identity = unitProfile.get();
+  char beaconText[18];
+  BeaconRegistry::formatAddress(identity.beaconAddress, beaconText, sizeof(beaconText));
+  DEBUG_PRINTF("Faculty: %s (ID %u, %s)\n", identity.name, identity.facultyId,
+               unitProfile.isProvisioned() ? "provisioned" : "image default");
+  DEBUG_PRINTF("Department: %s\n", identity.department);
+  DEBUG_PRINTF("iBeacon: %s\n", beaconText);
+  if (UNIT_PROVISIONING_ENABLED) {
+    setupProvisioningKey();
+    DEBUG_PRINTF("Provisioning: %s\n", unitProfile.getTopic(UNIT_TOPIC_PROVISION));
+  }
   DEBUG_PRINTF("WiFi: %s\n", WIFI_SSID);
   DEBUG_PRINTF("Grace Period: %d seconds\n", BLE_GRACE_PERIOD_MS / 1000);
 
   // Initialize offline operation system
   DEBUG_PRINTLN("🔄 Initializing offline operation system...");
+  MessageParser::init();
+  MessageQueue::init();
+  MessageStatistics::init();
+  MemoryMonitor::init();
+  MemoryMonitor::setPressureHandler(onMemoryPressure);
   initOfflineQueue();
+  initOfflineLog();
 
   // Initialize components
   buttons.init();
   setupDisplay();
   setupWiFi();
 
+  // Presence goes out before BLE and the UI are up; NTP finishes behind it
+  setupMQTT();
   if (wifiConnected) {
-    setupMQTT();
+    serviceMqttLink();
+    // Nothing else runs yet, so boot waits the handshake out here
+    while (mqttLinkState == MQTT_LINK_HANDSHAKE) {
+      delay(1);
+      serviceMqttLink();
+    }
+    if (mqttLinkState == MQTT_LINK_SESSION) serviceMqttLink();
   }
 
+  initBeaconRegistry();
   setupBLE();
-  adaptiveScanner.init(&presenceDetector);  // Pass reference to presence detector
+  adaptiveScanner.init(&presenceDetector, &scanPolicy);  // Pass reference to presence detector
 
   DEBUG_PRINTLN("=== GRACE PERIOD BLE SYSTEM READY ===");
   DEBUG_PRINTLN("✅ BLE disconnections now have 1-minute grace period!");
   DEBUG_PRINTLN("✅ Simple offline message queuing enabled!");
   drawCompleteUI();
+
+  initLightSleep();
+  initEventScheduling();
+  if (ENABLE_TASK_RUNTIME) {
+    startTaskRuntime();
+  }
+  if (!taskRuntimeActive) {
+    uiScheduler.schedule(scanTimer, 0, millis());
+  }
 }
 
 // ================================
 // MAIN LOOP WITH GRACE PERIOD BLE SCANNER
 // ================================
 void loop() {
-  // Update button states
-  buttons.update();
-
-  // Handle button presses
-  if (buttons.isButtonAPressed()) {
-    handleAcknowledgeButton();
-  }
-
-  if (buttons.isButtonBPressed()) {
-    handleBusyButton();
-  }
-
-  checkWiFiConnection();
-
-  if (wifiConnected && !mqttClient.connected()) {
-    connectMQTT();
-  }
-
-  if (mqttConnected) {
-    mqttClient.loop();
-  }
-
-  // Update offline queue system
-  updateOfflineQueue();
-
-  // ADAPTIVE BLE SCANNING WITH GRACE PERIOD (Replaces old performBLEScan)
-  adaptiveScanner.update();
-
-  // Update time every 5 seconds
-  static unsigned long lastTimeUpdate = 0;
-  if (millis() - lastTimeUpdate > TIME_UPDATE_INTERVAL) {
-    updateTimeAndDate();
-    lastTimeUpdate = millis();
-  }
-
-  // Update system status every 10 seconds
-  static unsigned long lastStatusUpdate = 0;
-  if (millis() - lastStatusUpdate > STATUS_UPDATE_INTERVAL) {
-    updateSystemStatus();
-    lastStatusUpdate = millis();
-  }
-
-  // Heartbeat every 5 minutes
-  static unsigned long lastHeartbeatTime = 0;
-  if (millis() - lastHeartbeatTime > HEARTBEAT_INTERVAL) {
-    publishHeartbeat();
-    lastHeartbeatTime = millis();
+  if (taskRuntimeActive) {
+    // All work runs in the BLE, network and UI tasks
+    vTaskDelay(portMAX_DELAY);
+    return;
   }
 
-  // Periodic time sync check
-  checkPeriodicTimeSync();
-
-  // Simple animation toggle every 800ms
-  static unsigned long lastIndicatorUpdate = 0;
-  if (millis() - lastIndicatorUpdate > ANIMATION_INTERVAL) {
-    animationState = !animationState;
-    if (presenceDetector.getPresence() && !messageDisplayed) {
-      drawStatusIndicator(STATUS_CENTER_X, STATUS_CENTER_Y + 50, true);
-    }
-    lastIndicatorUpdate = millis();
-  }
+  // Sleep until a button/scan event or the earliest deadline (light sleep
+  // while AWAY, if allowed); the adaptive BLE scanner runs from scanTimer
+  unsigned long now = millis();
+  waitForUiEvents(min(uiScheduler.msUntilNext(now), networkScheduler.msUntilNext(now)));
 
-  delay(100);
+  now = millis();
+  networkScratch.reset();
+  networkScheduler.runDue(now);
+  uiScheduler.runDue(now);
 }
 
 // ================================
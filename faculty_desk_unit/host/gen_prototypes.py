@@ -0,0 +1,55 @@
+#!/usr/bin/env python3
+"""Turns the sketch into a C++ translation unit the way arduino-builder does:
+an Arduino.h include first, then prototypes for every top-level function
+before the first function definition. Functions with default arguments are
+skipped; the sketch declares those itself.
+
+usage: gen_prototypes.py sketch.ino out.cpp
+"""
+
+import re
+import sys
+
+KEYWORDS = ('if', 'for', 'while', 'switch', 'return', 'else', 'class', 'struct', 'enum', 'namespace', 'union')
+DEFINITION = re.compile(r'^((?:static\s+|inline\s+)?(?:const\s+)?(?:unsigned\s+)?[A-Za-z_][\w:<>]*[\s\*&]+)'
+                        r'([A-Za-z_]\w*)\s*\(([^;{]*)\)\s*(?:const\s*)?\{')
+
+
+def code_only(line):
+    """The line without strings, character literals and // comments."""
+    line = re.sub(r'"(\\.|[^"\\])*"', '""', line)
+    line = re.sub(r"'(\\.|[^'\\])*'", "''", line)
+    return line.split('//')[0]
+
+
+def main(source_path, out_path):
+    with open(source_path) as source:
+        lines = source.read().split('\n')
+
+    prototypes = []
+    first = None
+    depth = 0
+    for index, line in enumerate(lines):
+        if depth == 0:
+            match = DEFINITION.match(line)
+            if match and match.group(1).split()[0] not in KEYWORDS:
+                if first is None:
+                    first = index
+                if '=' not in match.group(3):
+                    prototypes.append(match.group(1) + match.group(2) + '(' + match.group(3) + ');')
+        code = code_only(line)
+        depth += code.count('{') - code.count('}')
+
+    if first is None:
+        first = len(lines)
+    out = (lines[:first] + ['// Generated prototypes'] + prototypes +
+           ['#line %d "%s"' % (first + 1, source_path)] + lines[first:])
+    with open(out_path, 'w') as target:
+        target.write('#include <Arduino.h>\n#line 1 "%s"\n' % source_path)
+        target.write('\n'.join(out))
+
+
+if __name__ == '__main__':
+    if len(sys.argv) != 3:
+        sys.exit(__doc__)
+    main(sys.argv[1], sys.argv[2])
@@ -0,0 +1,1129 @@
+/**
+ * Host benchmark and replay driver for ConsultEase Faculty Desk Unit
+ * Builds the unmodified sketch against the mocks in mocks/ and either times
+ * its hot paths (--bench), replays BLE sighting traces through setup()
+ * and loop() on the virtual clock (--replay; --task-replay with the BLE,
+ * network and UI tasks of ENABLE_TASK_RUNTIME) or checks parsing, queueing,
+ * rate limiting and the optimization modules against expected results (--test). Every run happens in
+ * a forked child, so each starts from the same power-on state.
+ *
+ *   host_bench [--test] [--bench] [--replay trace.csv...] [--task-replay trace.csv...]
+ *              [--compare baseline.txt] [--tolerance percent] [--verbose]
+ *
+ * Output is one "key value" line per metric. --compare fails when a timing
+ * is more than --tolerance percent slower than the baseline, or when a
+ * replay result differs at all: replays are deterministic, so any change
+ * there is a behaviour change. Timings only compare on the same machine.
+ * A failed --test prints the expectation that did not hold and fails the run.
+ */
+
+#include "sketch_gen.cpp"
+
+#include <chrono>
+#include <fstream>
+#include <sstream>
+#include <map>
+#include <vector>
+#include <unistd.h>
+#include <sys/wait.h>
+
+#define BENCH_TOLERANCE_PERCENT 25            // Default for --tolerance
+#define BENCH_SLACK_NS 20                     // Absolute slack for the very fast paths
+#define BENCH_TARGET_NS 20000000ULL           // Per measurement
+#define BENCH_REPEATS 7
+#define REPLAY_EPOCH 1760317200UL             // 2025-10-13 09:00 at GMT+8: day profile
+#define REPLAY_TAIL_MS 180000UL               // Runs on after the last sighting
+#define REPLAY_ADVERTISING_MS 100             // Default beacon advertising interval
+#define REPLAY_STALL_LIMIT 1000000            // loop() calls without the clock moving
+
+static bool verbose = false;
+static int tolerancePercent = BENCH_TOLERANCE_PERCENT;
+
+// ================================
+// MICRO-BENCHMARKS
+// ================================
+static void emit(const char* key, double value) { printf("%s %.1f\n", key, value); }
+static void emit(const char* key, uint64_t value) { printf("%s %llu\n", key, (unsigned long long)value); }
+
+static void emitMetric(const std::string& prefix, const char* name, uint64_t value) {
+    emit((prefix + "." + name).c_str(), value);
+}
+
+// Best of BENCH_REPEATS timed batches, in nanoseconds per call
+template <typename Fn>
+static double measure(Fn fn) {
+    typedef std::chrono::steady_clock Clock;
+    uint64_t iterations = 1;
+    for (;;) {
+        Clock::time_point start = Clock::now();
+        for (uint64_t i = 0; i < iterations; i++) fn();
+        uint64_t elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count();
+        if (elapsed >= BENCH_TARGET_NS / 10 || iterations >= (1ULL << 30)) {
+            iterations = max<uint64_t>(1, iterations * BENCH_TARGET_NS / max<uint64_t>(elapsed, 1));
+            break;
+        }
+        iterations *= 4;
+    }
+
+    double best = 1e18;
+    for (int repeat = 0; repeat < BENCH_REPEATS; repeat++) {
+        Clock::time_point start = Clock::now();
+        for (uint64_t i = 0; i < iterations; i++) fn();
+        double elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count();
+        best = min(best, elapsed / iterations);
+    }
+    return best;
+}
+
+static void bench(const char* name, double nsPerOp) {
+    std::string key = std::string("bench.") + name + ".ns";
+    emit(key.c_str(), nsPerOp);
+    fflush(stdout);
+}
+
+static void runBenchmarks() {
+    setup();
+
+    static const char consultation[] =
+        "{\"type\":\"consultation_request\",\"request_id\":\"req-20251013-0042\",\"priority\":\"high\","
+        "\"student_id\":\"2021-00417\",\"student_name\":\"Maria Santos\",\"student_department\":\"Computer Science\","
+        "\"course_code\":\"CS 311\",\"course_name\":\"Operating Systems\","
+        "\"request_message\":\"Good morning, could we go over the scheduling homework before Friday's quiz?\","
+        "\"requested_at\":\"2025-10-13T09:12:45\",\"session_id\":\"s-8812\",\"requires_response\":true}";
+    static const char plain[] = "Maria Santos would like to consult about CS 311 scheduling homework.";
+
+    EnhancedMessage message;
+    bench("parse_json", measure([&]() { MessageParser::parseMessage(consultation, sizeof(consultation) - 1, message); }));
+    bench("parse_plain", measure([&]() { MessageParser::parseMessage(plain, sizeof(plain) - 1, message); }));
+
+    MessageLayout layout;
+    MessageParser::parseMessage(consultation, sizeof(consultation) - 1, message);
+    const char* body = message.data.rawMessage;  // Display text, as the UI lays it out
+    bench("layout_text", measure([&]() { MessageFormatter::layoutText(body, 26, 8, layout); }));
+
+    MessageQueue::clearAll();
+    bench("message_queue_add_remove", measure([&]() {
+        MessageQueue::addMessage(message);
+        MessageQueue::removeMessage(0);
+    }));
+
+    // Every incoming message is routed by topic before it is parsed
+    const char* requestTopic = unitProfile.getTopic(UNIT_TOPIC_MESSAGES);
+    UnitTopic routed = UNIT_TOPIC_NONE;
+    bench("topic_match", measure([&]() { routed = unitProfile.matchTopic(requestTopic); }));
+    (void)routed;
+
+    // Sightings arrive for every advertisement heard, tracked or not
+    uint64_t own = DEFAULT_IDENTITY.beaconAddress;
+    uint64_t stranger = own ^ 0x00FFFFFF0000ULL;
+    bench("beacon_sighting_tracked", measure([&]() { reportBeaconAddress(own, -61); }));
+    bench("beacon_sighting_untracked", measure([&]() { reportBeaconAddress(stranger, -70); }));
+
+    bool found = false;
+    bench("presence_check", measure([&]() {
+        found = !found;
+        presenceDetector.checkBeacon(found, found ? -62 : -999);
+    }));
+
+    bench("offline_queue_flush", measure([&]() {
+        queueMessage(unitProfile.getTopic(UNIT_TOPIC_STATUS), "{\"present\":true}");
+        processQueuedMessages();
+    }));
+
+    bench("publish_presence", measure([&]() { publishPresenceUpdate(); }));
+
+    bench("draw_complete_ui", measure([&]() { drawCompleteUI(); }));
+}
+
+// ================================
+// TRACE REPLAY
+// ================================
+// A trace is a list of spans during which a beacon advertises:
+//   from_ms,to_ms,rssi[,interval_ms[,mac]]
+// The MAC defaults to the image's own beacon (FACULTY_BEACON_MAC); '#' starts a comment.
+struct TraceSpan {
+    uint64_t fromUs;
+    uint64_t toUs;
+    int rssi;
+    uint64_t intervalUs;
+    uint8_t address[6];
+};
+
+static bool loadTrace(const char* path, std::vector<TraceSpan>& spans, std::string& error) {
+    std::ifstream in(path);
+    if (!in) {
+        error = "cannot open";
+        return false;
+    }
+
+    uint64_t own = DEFAULT_IDENTITY.beaconAddress;
+
+    std::string line;
+    int lineNumber = 0;
+    while (std::getline(in, line)) {
+        lineNumber++;
+        size_t hash = line.find('#');
+        if (hash != std::string::npos) line.erase(hash);
+        if (line.find_first_not_of(" \t\r") == std::string::npos) continue;
+
+        unsigned long fromMs, toMs, intervalMs = REPLAY_ADVERTISING_MS;
+        int rssi;
+        char mac[32] = "";
+        int fields = sscanf(line.c_str(), " %lu , %lu , %d , %lu , %31s", &fromMs, &toMs, &rssi, &intervalMs, mac);
+        uint64_t address = own;
+        if (fields < 3 || toMs < fromMs || intervalMs == 0 ||
+            (fields == 5 && !BeaconRegistry::parseAddress(mac, strlen(mac), address))) {
+            error = "bad span on line " + std::to_string(lineNumber);
+            return false;
+        }
+
+        TraceSpan span;
+        span.fromUs = fromMs * 1000ULL;
+        span.toUs = toMs * 1000ULL;
+        span.rssi = rssi;
+        span.intervalUs = intervalMs * 1000ULL;
+        BeaconRegistry::toBytes(address, span.address);
+        spans.push_back(span);
+    }
+    return true;
+}
+
+// Advertisements of every span that fall in [fromUs, toUs)
+static size_t traceSightings(const std::vector<TraceSpan>& spans, uint64_t fromUs, uint64_t toUs,
+                             HostSim::Advertisement* out, size_t capacity) {
+    size_t count = 0;
+    for (const TraceSpan& span : spans) {
+        uint64_t start = max(span.fromUs, fromUs);
+        uint64_t end = min(span.toUs, toUs);
+        if (start >= end) continue;
+
+        uint64_t phase = (start - span.fromUs) % span.intervalUs;
+        for (uint64_t at = phase ? start + span.intervalUs - phase : start; at < end && count < capacity;
+             at += span.intervalUs) {
+            memcpy(out[count].address, span.address, sizeof(out[count].address));
+            out[count].rssi = span.rssi;
+            count++;
+        }
+    }
+    return count;
+}
+
+static std::string traceName(const char* path) {
+    std::string name = path;
+    size_t slash = name.find_last_of('/');
+    if (slash != std::string::npos) name.erase(0, slash + 1);
+    size_t dot = name.rfind('.');
+    if (dot != std::string::npos) name.erase(dot);
+    return name;
+}
+
+static int runReplay(const char* path, bool taskRuntime) {
+    std::vector<TraceSpan> spans;
+    std::string error;
+    if (!loadTrace(path, spans, error)) {
+        fprintf(stderr, "%s: %s\n", path, error.c_str());
+        return 1;
+    }
+
+    uint64_t firstSightingUs = UINT64_MAX, lastSightingUs = 0;
+    for (const TraceSpan& span : spans) {
+        firstSightingUs = min(firstSightingUs, span.fromUs);
+        lastSightingUs = max(lastSightingUs, span.toUs);
+    }
+    uint64_t endUs = (spans.empty() ? 0 : lastSightingUs) + REPLAY_TAIL_MS * 1000ULL;
+
+    HostSim::setEpoch(REPLAY_EPOCH);
+    HostSim::setTaskRuntime(taskRuntime);
+    HostSim::setSightingSource([&spans](uint64_t fromUs, uint64_t toUs, HostSim::Advertisement* out, size_t capacity) {
+        return traceSightings(spans, fromUs, toUs, out, capacity);
+    });
+
+    setup();
+    if (taskRuntime && !taskRuntimeActive) {
+        fprintf(stderr, "%s: the task runtime did not start\n", path);
+        return 1;
+    }
+
+    std::string prefix = (taskRuntime ? "task_replay." : "replay.") + traceName(path);
+    bool present = presenceDetector.getPresence();
+    uint32_t transitions = 0, graceEntries = 0;
+    uint64_t firstPresentUs = 0, lastAwayUs = 0;
+    bool inGrace = presenceDetector.isInGracePeriod();
+    uint64_t stalledAt = HostSim::nowUs();
+    uint32_t stalled = 0;
+
+    while (HostSim::nowUs() < endUs && !HostSim::restartRequested()) {
+        loop();
+
+        if (HostSim::nowUs() == stalledAt) {
+            if (++stalled > REPLAY_STALL_LIMIT) {
+                fprintf(stderr, "%s: loop() stopped advancing the clock at %llu ms\n", path,
+                        (unsigned long long)(stalledAt / 1000));
+                return 1;
+            }
+        } else {
+            stalledAt = HostSim::nowUs();
+            stalled = 0;
+        }
+
+        bool grace = presenceDetector.isInGracePeriod();
+        if (grace && !inGrace) graceEntries++;
+        inGrace = grace;
+
+        bool now = presenceDetector.getPresence();
+        if (now == present) continue;
+        present = now;
+        transitions++;
+        if (now && firstPresentUs == 0) firstPresentUs = HostSim::nowUs();
+        if (!now) lastAwayUs = HostSim::nowUs();
+        if (verbose) {
+            fprintf(stderr, "[%s] %.1fs %s\n", prefix.c_str(), HostSim::nowUs() / 1e6, now ? "PRESENT" : "AWAY");
+        }
+    }
+
+    const HostSim::RadioLog& radio = HostSim::radioLog();
+    const HostSim::MqttLog& mqtt = HostSim::mqttLog();
+    uint64_t runMs = HostSim::nowUs() / 1000;
+
+    emitMetric(prefix, "transitions", transitions);
+    emitMetric(prefix, "grace_periods", graceEntries);
+    emitMetric(prefix, "final_present", present ? 1 : 0);
+    // Time from the first advertisement to PRESENT, and from the last one to AWAY
+    emitMetric(prefix, "arrival_ms", firstPresentUs && firstPresentUs >= firstSightingUs
+                                         ? (firstPresentUs - firstSightingUs) / 1000 : 0);
+    emitMetric(prefix, "departure_ms", lastAwayUs && lastAwayUs >= lastSightingUs
+                                           ? (lastAwayUs - lastSightingUs) / 1000 : 0);
+    emitMetric(prefix, "scan_windows", radio.windows);
+    emitMetric(prefix, "radio_listen_ms", radio.listenUs / 1000);
+    emitMetric(prefix, "radio_duty_permille", runMs ? radio.listenUs / runMs : 0);
+    emitMetric(prefix, "advertisements", radio.advertisementsDelivered);
+    emitMetric(prefix, "mqtt_publishes", mqtt.publishes);
+    emitMetric(prefix, "mqtt_bytes", mqtt.publishedBytes);
+    emitMetric(prefix, "light_sleeps", lightSleepCount);
+    emitMetric(prefix, "light_sleep_ms", lightSleepMs);
+    emitMetric(prefix, "display_pixels", HostSim::displayLog().pixelsWritten);
+    return 0;
+}
+
+// ================================
+// ASSERTIONS
+// ================================
+// Each test runs in its own child from power-on. EXPECT reports every
+// expectation that does not hold and lets the test go on.
+static int expectFailures = 0;
+
+#define EXPECT(condition) expectThat((condition), #condition, __LINE__)
+
+static void expectThat(bool ok, const char* text, int line) {
+    if (ok) return;
+    fprintf(stderr, "    host_bench.cpp:%d: expected %s\n", line, text);
+    expectFailures++;
+}
+
+struct PublishRecord {
+    std::string topic;
+    std::string payload;
+};
+
+static std::vector<PublishRecord> publishes;
+
+static void recordPublishes() {
+    publishes.clear();
+    HostSim::onPublish([](const char* topic, const uint8_t* payload, size_t length) {
+        publishes.push_back(PublishRecord{topic, std::string((const char*)payload, length)});
+    });
+}
+
+static int countPublishes(const char* topic) {
+    int count = 0;
+    for (const PublishRecord& record : publishes) count += record.topic == topic;
+    return count;
+}
+
+static void testParsing() {
+    EnhancedMessage message;
+
+    static const char consultation[] =
+        " {\"type\":\"consultation_request\",\"request_id\":\"req-0042\",\"priority\":\"high\","
+        "\"student_name\":\"Maria Santos\",\"course_code\":\"CS 311\","
+        "\"request_message\":\"Could we go over the homework?\",\"sent_at_ms\":1760317200123}";
+    memset(&message, 0, sizeof(message));
+    EXPECT(MessageParser::parseMessage(consultation, sizeof(consultation) - 1, message));
+    EXPECT(message.type == MSG_CONSULTATION_REQUEST);
+    EXPECT(message.priority == PRIORITY_HIGH);
+    EXPECT(strcmp(message.messageId, "req-0042") == 0);
+    EXPECT(message.trace.sentAtMs == 1760317200123ULL);
+    EXPECT(strcmp(message.data.rawMessage,
+                  "Student: Maria Santos\nCourse: CS 311\nRequest: Could we go over the homework?") == 0);
+
+    static const char notification[] = "{\"title\":\"Fire drill\",\"message\":\"At 10:00\"}";
+    memset(&message, 0, sizeof(message));
+    EXPECT(MessageParser::parseMessage(notification, sizeof(notification) - 1, message));
+    EXPECT(message.type == MSG_SYSTEM_NOTIFICATION);
+    EXPECT(strcmp(message.data.rawMessage, "Fire drill\nAt 10:00") == 0);
+
+    // Not JSON, or JSON without any known field: shown as sent
+    static const char truncated[] = "{\"student_name\":\"Maria";
+    memset(&message, 0, sizeof(message));
+    EXPECT(MessageParser::parseMessage(truncated, sizeof(truncated) - 1, message));
+    EXPECT(strcmp(message.data.rawMessage, truncated) == 0);
+    EXPECT(!MessageParser::parseMessage("", 0, message));
+
+    uint8_t topics = WIRE_TOPIC_METRICS;
+    static const char wireFormat[] = "{\"status\":\"cbor\",\"heartbeat\":\"cbor\",\"metrics\":\"json\",\"other\":\"cbor\"}";
+    EXPECT(JsonStream::parse(wireFormat, sizeof(wireFormat) - 1, collectWireFormat, &topics));
+    EXPECT(topics == (WIRE_TOPIC_STATUS | WIRE_TOPIC_HEARTBEAT));
+
+    // Keys with the same FNV-1a hash as "priority", "message" and "status":
+    // the hash alone would take them for those keys
+    static_assert(JsonStream::keyHash("cv_djyi") == JsonStream::keyHash("priority"), "collision");
+    static_assert(JsonStream::keyHash("pxikwgg") == JsonStream::keyHash("message"), "collision");
+    static_assert(JsonStream::keyHash("addujic") == JsonStream::keyHash("status"), "collision");
+    static const char colliding[] =
+        "{\"title\":\"Fire drill\",\"cv_djyi\":\"emergency\",\"pxikwgg\":\"wrong\",\"message\":\"At 10:00\"}";
+    memset(&message, 0, sizeof(message));
+    EXPECT(MessageParser::parseMessage(colliding, sizeof(colliding) - 1, message));
+    EXPECT(message.priority != PRIORITY_EMERGENCY);
+    EXPECT(strcmp(message.data.rawMessage, "Fire drill\nAt 10:00") == 0);
+    topics = WIRE_TOPIC_NONE;
+    static const char collidingWire[] = "{\"addujic\":\"cbor\"}";
+    EXPECT(JsonStream::parse(collidingWire, sizeof(collidingWire) - 1, collectWireFormat, &topics));
+    EXPECT(topics == WIRE_TOPIC_NONE);
+
+    // End to end: the broker delivers a request and it reaches the inbox,
+    // which only takes requests while the faculty member is present
+    TraceSpan beacon = { 0, UINT64_MAX, -60, REPLAY_ADVERTISING_MS * 1000ULL, {} };
+    BeaconRegistry::toBytes(DEFAULT_IDENTITY.beaconAddress, beacon.address);
+    std::vector<TraceSpan> spans(1, beacon);
+    HostSim::setSightingSource([&spans](uint64_t fromUs, uint64_t toUs, HostSim::Advertisement* out, size_t capacity) {
+        return traceSightings(spans, fromUs, toUs, out, capacity);
+    });
+    setup();
+    uint32_t deadline = HostSim::nowMs() + 30000;
+    while (!presenceDetector.getPresence() && HostSim::nowMs() < deadline) loop();
+    EXPECT(presenceDetector.getPresence());
+
+    int before = MessageQueue::getMessageCount();
+    HostSim::injectMqttMessage(unitProfile.getTopic(UNIT_TOPIC_MESSAGES), consultation + 1);
+    deadline = HostSim::nowMs() + 5000;
+    while (MessageQueue::getMessageCount() == before && HostSim::nowMs() < deadline) loop();
+    EXPECT(MessageQueue::getMessageCount() == before + 1);
+    const EnhancedMessage* received = MessageQueue::peekMessage(0);
+    EXPECT(received && strcmp(received->messageId, "req-0042") == 0);
+}
+
+static void testQueueOrdering() {
+    setup();
+    const char* responses = unitProfile.getTopic(UNIT_TOPIC_RESPONSES);
+    const char* status = unitProfile.getTopic(UNIT_TOPIC_STATUS);
+
+    // Inbox: highest priority first, arrival order within a priority
+    MessageQueue::clearAll();
+    static const MessagePriority priorities[] = { PRIORITY_LOW, PRIORITY_HIGH, PRIORITY_NORMAL, PRIORITY_HIGH };
+    for (int i = 0; i < 4; i++) {
+        EnhancedMessage message;
+        memset(&message, 0, sizeof(message));
+        snprintf(message.messageId, sizeof(message.messageId), "m%d", i);
+        strcpy(message.data.rawMessage, "body");
+        message.priority = priorities[i];
+        EXPECT(MessageQueue::addMessage(message));
+    }
+    static const char* inboxOrder[] = { "m1", "m3", "m2", "m0" };
+    for (int i = 0; i < 4; i++) {
+        const EnhancedMessage* message = MessageQueue::peekMessage(i);
+        EXPECT(message && strcmp(message->messageId, inboxOrder[i]) == 0);
+    }
+
+    // Offline queue: more responses than fit, in mixed sizes
+    for (int i = 0; i < 12; i++) {
+        std::string payload = "{\"n\":" + std::to_string(i) + ",\"pad\":\"" + std::string(i % 3 ? 300 : 900, 'x') + "\"}";
+        EXPECT(queueMessage(responses, payload.c_str(), true));
+    }
+    EXPECT(queueMessage(status, "{\"present\":true}"));
+    EXPECT(responseCount > 0 && responseCount <= MAX_QUEUED_RESPONSES);
+
+    // A new response waits behind the queued ones
+    recordPublishes();
+    EXPECT(publishWithQueue(responses, "{\"n\":12}", true));
+    EXPECT(publishes.empty());
+
+    for (int pass = 0; pass < 20 && offlineQueueDepth() > 0; pass++) processQueuedMessages();
+    EXPECT(offlineQueueDepth() == 0);
+
+    // Oldest dropped, the rest in order, status last
+    EXPECT(!publishes.empty() && publishes.back().topic == status);
+    int expected = -1;
+    for (size_t i = 0; i + 1 < publishes.size(); i++) {
+        EXPECT(publishes[i].topic == responses);
+        int n = atoi(publishes[i].payload.c_str() + 5);
+        EXPECT(expected < 0 ? n > 0 : n == expected);
+        expected = n + 1;
+    }
+    EXPECT(expected == 13);
+}
+
+static void testCoalescing() {
+    setup();
+    const char* status = unitProfile.getTopic(UNIT_TOPIC_STATUS);
+    const char* legacy = unitProfile.getTopic(UNIT_TOPIC_LEGACY_STATUS);
+
+    // Offline queue: newest state per topic only
+    EXPECT(queueMessage(status, "{\"s\":1}"));
+    EXPECT(queueMessage(status, "{\"s\":2}"));
+    EXPECT(queueMessage(legacy, "{\"s\":3}"));
+    EXPECT(queueMessage(status, "{\"s\":4}"));
+    EXPECT(statusPendingCount == 2);
+
+    recordPublishes();
+    processQueuedMessages();
+    EXPECT(publishes.size() == 2);
+    EXPECT(countPublishes(status) == 1 && countPublishes(legacy) == 1);
+    for (const PublishRecord& record : publishes) {
+        if (record.topic == status) EXPECT(record.payload == "{\"s\":4}");
+    }
+
+    // A live publish makes the queued state for its topic stale
+    EXPECT(queueMessage(status, "{\"s\":5}"));
+    EXPECT(publishWithQueue(status, "{\"s\":6}"));
+    EXPECT(statusPendingCount == 0);
+
+    // Once every slot holds a pending topic, a new topic is refused rather
+    // than overwriting one; the topics already queued still coalesce
+    char topic[48];
+    for (int i = 0; i < OFFLINE_STATUS_SLOTS; i++) {
+        snprintf(topic, sizeof(topic), "consultease/faculty/%d/status", 100 + i);
+        EXPECT(queueMessage(topic, "{\"s\":7}"));
+    }
+    EXPECT(!queueMessage("consultease/faculty/999/status", "{\"s\":8}"));
+    EXPECT(queueMessage(topic, "{\"s\":9}"));
+    EXPECT(statusPendingCount == OFFLINE_STATUS_SLOTS);
+    recordPublishes();
+    processQueuedMessages();
+    EXPECT(publishes.size() == OFFLINE_STATUS_SLOTS);
+    EXPECT(countPublishes("consultease/faculty/100/status") == 1);
+    EXPECT(countPublishes("consultease/faculty/999/status") == 0);
+    EXPECT(statusPendingCount == 0);
+
+    // Presence: one publish per window, none when it settles back
+    NtpSyncState settled = ntpSyncState;
+    recordPublishes();
+    ntpSyncState = NTP_SYNC_FAILED;
+    requestPresencePublish();
+    HostSim::advance(PRESENCE_COALESCE_WINDOW_MS / 2);
+    requestPresencePublish();
+    servicePresencePublisher();
+    EXPECT(countPublishes(status) == 0);
+    HostSim::advance(PRESENCE_COALESCE_WINDOW_MS / 2);
+    servicePresencePublisher();
+    EXPECT(countPublishes(status) == 1);
+
+    ntpSyncState = NTP_SYNC_SYNCING;
+    requestPresencePublish();
+    ntpSyncState = NTP_SYNC_FAILED;
+    HostSim::advance(PRESENCE_COALESCE_WINDOW_MS);
+    servicePresencePublisher();
+    EXPECT(countPublishes(status) == 1);
+    EXPECT(!presencePending);
+    ntpSyncState = settled;
+}
+
+static void testTokenBuckets() {
+    setup();
+
+    TokenBucket bucket = { 2, 2, 1000, millis() };
+    EXPECT(takeToken(bucket));
+    EXPECT(takeToken(bucket));
+    EXPECT(!takeToken(bucket));
+    HostSim::advance(999);
+    EXPECT(!takeToken(bucket));
+    HostSim::advance(1);
+    EXPECT(takeToken(bucket));
+    EXPECT(!takeToken(bucket));
+
+    // Refills stop at capacity however long it sat idle
+    HostSim::advance(60000);
+    EXPECT(takeToken(bucket));
+    EXPECT(takeToken(bucket));
+    EXPECT(!takeToken(bucket));
+
+    // Refill time carries over between partial intervals
+    HostSim::advance(1500);
+    EXPECT(takeToken(bucket));
+    HostSim::advance(500);
+    EXPECT(takeToken(bucket));
+
+    // An empty status bucket holds presence back until the next refill
+    const char* status = unitProfile.getTopic(UNIT_TOPIC_STATUS);
+    while (takeToken(statusBucket)) {}
+    recordPublishes();
+    ntpSyncState = ntpSyncState == NTP_SYNC_FAILED ? NTP_SYNC_SYNCED : NTP_SYNC_FAILED;
+    requestPresencePublish();
+    HostSim::advance(PRESENCE_COALESCE_WINDOW_MS);
+    servicePresencePublisher();
+    EXPECT(countPublishes(status) == 0);
+    EXPECT(presencePending);
+    HostSim::advance(STATUS_BUCKET_REFILL_MS);
+    servicePresencePublisher();
+    EXPECT(countPublishes(status) == 1);
+}
+
+// While away, light sleep stretches the network poll to the keepalive; a
+// message must still get through as soon as it reaches the socket
+static void testSocketWake() {
+    HostSim::setEpoch(REPLAY_EPOCH);
+    HostSim::setSightingSource([](uint64_t fromUs, uint64_t toUs, HostSim::Advertisement* out, size_t capacity) {
+        return (size_t)0;
+    });
+    HostSim::setTaskRuntime(true);
+    setup();
+    EXPECT(taskRuntimeActive);
+    uint32_t deadline = HostSim::nowMs() + LIGHT_SLEEP_AWAY_DELAY_MS + 30000;
+    while (!(lightSleepAllowed && isNetworkSettled()) && HostSim::nowMs() < deadline) loop();
+    EXPECT(lightSleepAllowed && isNetworkSettled());
+    EXPECT(socketWakeTaskHandle != nullptr);
+
+    // Mid-way between two keepalive polls
+    deadline = HostSim::nowMs() + LIGHT_SLEEP_MAX_MS / 2;
+    while (HostSim::nowMs() < deadline) loop();
+    cborTopics = WIRE_TOPIC_NONE;
+    HostSim::injectMqttMessage(unitProfile.getTopic(UNIT_TOPIC_WIRE_FORMAT), "{\"status\":\"cbor\"}");
+    uint32_t sentAt = HostSim::nowMs();
+    while (cborTopics == WIRE_TOPIC_NONE && HostSim::nowMs() - sentAt < LIGHT_SLEEP_MAX_MS) loop();
+    EXPECT(cborTopics == WIRE_TOPIC_STATUS);
+    // loop() only hands back once every task waits again, a UI tick
+    // later; the poll alone would have taken LIGHT_SLEEP_MAX_MS / 2
+    EXPECT(HostSim::nowMs() - sentAt < LIGHT_SLEEP_MAX_MS / 4);
+    EXPECT(lightSleepAllowed);
+}
+
+// Power cycle for the offline queue: RAM state gone, flash kept
+static void rebootOfflineQueue() {
+    responseHead = 0;
+    responseCount = 0;
+    responseStore.reset();
+    nextResponseSequence = 1;
+    persistedThrough = 0;
+    committedThrough = 0;
+    loggedCommit = 0;
+    recoverOfflineQueue();
+}
+
+static void writeTestLog(const char* path, const std::vector<std::pair<uint8_t, uint32_t>>& records) {
+    File file = LittleFS.open(path, FILE_WRITE);
+    for (const auto& record : records) {
+        std::string payload = "{\"n\":" + std::to_string(record.second) + "}";
+        const char* topic = record.first == LOG_REC_COMMIT ? "" : "r";
+        writeLogRecord(file, record.first, record.second, topic,
+                       record.first == LOG_REC_COMMIT ? "" : payload.c_str());
+    }
+    file.close();
+}
+
+static void testOfflineLog() {
+    setup();
+    const char* responses = unitProfile.getTopic(UNIT_TOPIC_RESPONSES);
+
+    // Replay: order, payloads and fresh sequences past the replayed ones
+    for (int i = 0; i < 3; i++) {
+        std::string payload = "{\"n\":" + std::to_string(i) + "}";
+        EXPECT(queueMessage(responses, payload.c_str(), true));
+    }
+    persistOfflineQueue();
+    popResponse();
+    persistOfflineQueue();
+    rebootOfflineQueue();
+    EXPECT(responseCount == 2);
+    EXPECT(strcmp(responseQueue[responseHead].topic, responses) == 0);
+    EXPECT(strcmp(responseQueue[responseHead].payload, "{\"n\":1}") == 0);
+    EXPECT(strcmp(responseQueue[(responseHead + 1) % MAX_QUEUED_RESPONSES].payload, "{\"n\":2}") == 0);
+    EXPECT(nextResponseSequence == 4 && committedThrough == 1);
+
+    // Commits, and responses they cover, never take a slot from a live one
+    std::vector<std::pair<uint8_t, uint32_t>> records;
+    records.push_back({ LOG_REC_COMMIT, 1 });
+    for (uint32_t n = 2; n < 2 + MAX_QUEUED_RESPONSES; n++) records.push_back({ LOG_REC_RESPONSE, n });
+    records.push_back({ LOG_REC_RESPONSE, 1 });
+    records.push_back({ LOG_REC_COMMIT, 1 });
+    writeTestLog(OFFLINE_LOG_PATH, records);
+    rebootOfflineQueue();
+    EXPECT(responseCount == MAX_QUEUED_RESPONSES);
+    EXPECT(responseQueue[responseHead].sequence == 2);
+    EXPECT(committedThrough == 1);
+
+    // A torn record ends the replay; what came before it stands
+    File file = LittleFS.open(OFFLINE_LOG_PATH, FILE_APPEND);
+    OfflineLogRecordHeader torn = { OFFLINE_LOG_MAGIC, LOG_REC_RESPONSE, 1, 40, 99, 0 };
+    file.write((const uint8_t*)&torn, sizeof(torn));
+    file.write((const uint8_t*)"r{\"n\"", 5);
+    file.close();
+    rebootOfflineQueue();
+    EXPECT(responseCount == MAX_QUEUED_RESPONSES);
+    EXPECT(nextResponseSequence == 2 + MAX_QUEUED_RESPONSES);
+
+    // Compaction cut short: a copy beside the log is dropped...
+    writeTestLog(OFFLINE_LOG_PATH, { { LOG_REC_RESPONSE, 5 }, { LOG_REC_RESPONSE, 6 } });
+    writeTestLog(OFFLINE_LOG_TEMP_PATH, { { LOG_REC_RESPONSE, 5 } });
+    rebootOfflineQueue();
+    EXPECT(responseCount == 2);
+    EXPECT(!LittleFS.exists(OFFLINE_LOG_TEMP_PATH));
+
+    // ...and a copy with no log left is what gets replayed
+    LittleFS.rename(OFFLINE_LOG_PATH, OFFLINE_LOG_TEMP_PATH);
+    rebootOfflineQueue();
+    EXPECT(responseCount == 2 && responseQueue[responseHead].sequence == 5);
+    EXPECT(LittleFS.exists(OFFLINE_LOG_PATH) && !LittleFS.exists(OFFLINE_LOG_TEMP_PATH));
+
+    // A compaction replaces the log and leaves no copy behind
+    std::string padding(400, 'x');
+    for (int i = 0; i < 30; i++) {
+        std::string payload = "{\"n\":" + std::to_string(i) + ",\"pad\":\"" + padding + "\"}";
+        EXPECT(queueMessage(responses, payload.c_str(), true));
+        persistOfflineQueue();
+    }
+    persistOfflineQueue();
+    File log = LittleFS.open(OFFLINE_LOG_PATH, FILE_READ);
+    EXPECT(log && log.size() <= OFFLINE_STORAGE_SIZE + MAX_QUEUED_RESPONSES * (padding.size() + 100));
+    log.close();
+    EXPECT(!LittleFS.exists(OFFLINE_LOG_TEMP_PATH));
+    uint32_t newest = responseQueue[(responseHead + responseCount - 1) % MAX_QUEUED_RESPONSES].sequence;
+    int queued = responseCount;
+    rebootOfflineQueue();
+    EXPECT(responseCount == queued);
+    EXPECT(responseQueue[(responseHead + responseCount - 1) % MAX_QUEUED_RESPONSES].sequence == newest);
+}
+
+// Wrapping breaks at the last space that fits, at newlines, or mid-word
+// only for a word longer than the line; pages never split a line
+static std::vector<std::string> layoutLines(const char* text, int lineWidth, MessageLayout& layout) {
+    MessageFormatter::layoutText(text, lineWidth, 2, layout);
+    std::vector<std::string> lines;
+    for (int i = 0; i < layout.lineCount; i++) {
+        lines.push_back(std::string(text + layout.lineStart[i], layout.lineLength[i]));
+    }
+    return lines;
+}
+
+static void testFormatter() {
+    ConsultationRequest request;
+    memset(&request, 0, sizeof(request));
+    char output[96];
+
+    strcpy(request.studentName, "Maria Santos");
+    strcpy(request.courseName, "Data Structures");
+    strcpy(request.requestMessage, "Office hours?");
+    MessageFormatter::formatConsultationForDisplay(request, output, sizeof(output));
+    EXPECT(strcmp(output, "Student: Maria Santos\nCourse: Data Structures\nRequest: Office hours?") == 0);
+    strcpy(request.courseCode, "CS 311");
+    request.studentName[0] = '\0';
+    MessageFormatter::formatConsultationForDisplay(request, output, 24);
+    EXPECT(strcmp(output, "Student: Unknown\nCourse") == 0);
+
+    SystemNotification notification;
+    memset(&notification, 0, sizeof(notification));
+    strcpy(notification.message, "At 10:00");
+    MessageFormatter::formatNotificationForDisplay(notification, output, sizeof(output));
+    EXPECT(strcmp(output, "At 10:00") == 0);
+    strcpy(notification.title, "Fire drill");
+    MessageFormatter::formatNotificationForDisplay(notification, output, sizeof(output));
+    EXPECT(strcmp(output, "Fire drill\nAt 10:00") == 0);
+
+    MessageLayout layout;
+    const char* text = "The quick brown fox  jumps";
+    std::vector<std::string> lines = layoutLines(text, 10, layout);
+    EXPECT((lines == std::vector<std::string>{"The quick", "brown fox", "jumps"}));
+    EXPECT(layout.pageCount == 2);
+    EXPECT((layoutLines("abcdefghijkl", 5, layout) == std::vector<std::string>{"abcde", "fghij", "kl"}));
+    EXPECT((layoutLines("one\r\ntwo\n\nthree", 10, layout) == std::vector<std::string>{"one", "two", "", "three"}));
+    EXPECT(layoutLines("", 10, layout).empty() && layout.pageCount == 1);
+
+    MessageFormatter::getTextPage(text, 0, 10, 2, output, sizeof(output));
+    EXPECT(strcmp(output, "The quick\nbrown fox") == 0);
+    MessageFormatter::getTextPage(text, 1, 10, 2, output, sizeof(output));
+    EXPECT(strcmp(output, "jumps") == 0);
+    MessageFormatter::getTextPage(text, 2, 10, 2, output, sizeof(output));
+    EXPECT(output[0] == '\0');
+    // Too small for the second line: the page stops after the first
+    MessageFormatter::getTextPage(text, 0, 10, 2, output, 12);
+    EXPECT(strcmp(output, "The quick") == 0);
+    EXPECT(MessageFormatter::calculateTextPages(text, 10, 3) == 1);
+    // Eight lines at width 4: "The", "quic", "k", "brow", "n", "fox", "jump", "s"
+    EXPECT(MessageFormatter::calculateTextPages(text, 4, 2) == 4);
+}
+
+static std::string unescape(const char* raw, size_t outputSize = 64) {
+    char output[64];
+    size_t length = JsonStream::copyString(raw, strlen(raw), output, outputSize);
+    EXPECT(length == strlen(output));
+    return std::string(output, length);
+}
+
+static void testJsonStrings() {
+    EXPECT(unescape("a\\\"b\\\\c\\/d\\n\\r\\t\\b\\f") == "a\"b\\c/d\n\r\t\b\f");
+    EXPECT(unescape("caf\\u00e9 \\u20AC") == "caf\xC3\xA9 \xE2\x82\xAC");
+    EXPECT(unescape("\\u0041") == "A");
+
+    // Surrogate pairs join into one 4-byte sequence; a lone half is '?'
+    EXPECT(unescape("\\ud83d\\ude00") == "\xF0\x9F\x98\x80");
+    EXPECT(unescape("\\ud83dx") == "?x");
+    EXPECT(unescape("\\ud83d\\u0041") == "?A");
+    EXPECT(unescape("\\ude00") == "?");
+    EXPECT(unescape("\\u12") == "?12");
+    EXPECT(unescape("\\uzzzz") == "?zzzz");
+
+    // Truncation keeps the terminator and never splits a sequence
+    EXPECT(unescape("abcdef", 4) == "abc");
+    EXPECT(unescape("a\\u00e9", 3) == "a");
+    EXPECT(unescape("\\ud83d\\ude00!", 5) == "\xF0\x9F\x98\x80");
+    EXPECT(unescape("\\ud83d\\ude00!", 4) == "");
+}
+
+static std::vector<uint8_t> bytesOf(const WireWriter& writer) {
+    return std::vector<uint8_t>(writer.data(), writer.data() + writer.length());
+}
+
+static void testWireFormat() {
+    uint8_t buffer[96];
+
+    WireWriter cbor(WIRE_FORMAT_CBOR, buffer, sizeof(buffer));
+    cbor.beginObject();
+    cbor.addUInt("a", 23);
+    cbor.addUInt("b", 24);
+    cbor.addUInt("c", 500);
+    cbor.addUInt("d", 70000);
+    cbor.addInt("e", -5);
+    cbor.addInt("f", -300);
+    cbor.addBool("g", true);
+    cbor.addBool("h", false);
+    cbor.addString("i", "hi");
+    cbor.addUInt64("j", 1760317200123ULL);
+    cbor.endObject();
+    EXPECT(cbor.ok());
+    EXPECT((bytesOf(cbor) == std::vector<uint8_t>{
+        0xBF,
+        0x61, 'a', 0x17,
+        0x61, 'b', 0x18, 0x18,
+        0x61, 'c', 0x19, 0x01, 0xF4,
+        0x61, 'd', 0x1A, 0x00, 0x01, 0x11, 0x70,
+        0x61, 'e', 0x24,
+        0x61, 'f', 0x39, 0x01, 0x2B,
+        0x61, 'g', 0xF5,
+        0x61, 'h', 0xF4,
+        0x61, 'i', 0x62, 'h', 'i',
+        0x61, 'j', 0x1B, 0x00, 0x00, 0x01, 0x99, 0xDB, 0x14, 0xD6, 0xFB,
+        0xFF}));
+
+    WireWriter json(WIRE_FORMAT_JSON, buffer, sizeof(buffer));
+    json.beginObject();
+    json.addInt("n", -7);
+    json.addBool("ok", true);
+    json.addString("s", "q\"\\\n\x01");
+    json.endObject();
+    EXPECT(json.ok());
+    EXPECT(strcmp(json.c_str(), "{\"n\":-7,\"ok\":true,\"s\":\"q\\\"\\\\\\n\\u0001\"}") == 0);
+
+    // One byte is held back for the terminator, in both formats
+    WireWriter small(WIRE_FORMAT_CBOR, buffer, 5);
+    small.beginObject();
+    small.addUInt("a", 1);
+    EXPECT(small.ok() && small.length() == 4);
+    small.endObject();
+    EXPECT(!small.ok());
+}
+
+static void testBrokerPool() {
+    BrokerPool pool;
+    EXPECT(pool.add("primary", 1883));
+    EXPECT(pool.addList("standby:8883", 1883) == 1);
+    EXPECT(!pool.add("", 1883) && !pool.add("other", 0));
+    EXPECT(pool.getCount() == 2 && pool.getPort(1) == 8883);
+
+    // Equal scores: the primary first
+    unsigned long now = 100000;
+    EXPECT(pool.readyToConnect(now) && pool.choose(now) == 0);
+
+    // A failure cools the broker down and moves to the standby shortly
+    pool.reportAttempt(0);
+    pool.reportFailure(0, now);
+    EXPECT(pool.getScore(0, now) == BROKER_SCORE_MAX - BROKER_SCORE_FAILURE);
+    EXPECT(pool.getNextAttemptAt() - now >= BROKER_FAILOVER_DELAY_MS / 2);
+    EXPECT(pool.getNextAttemptAt() - now <= BROKER_FAILOVER_DELAY_MS);
+    EXPECT(!pool.readyToConnect(now));
+    EXPECT(pool.choose(pool.getNextAttemptAt()) == 1);
+
+    // Consecutive failures double the cooldown, with jitter, up to the cap
+    for (uint8_t n = 2; n <= 10; n++) {
+        pool.reportFailure(0, now);
+        uint32_t backoff = min(BROKER_BACKOFF_BASE_MS << (n - 1), BROKER_BACKOFF_MAX_MS);
+        uint32_t cooldown = pool.getHealth(0).cooldownUntil - now;
+        EXPECT(cooldown >= backoff / 2 && cooldown <= backoff);
+    }
+    EXPECT(pool.getHealth(0).consecutiveFailures == 10 && pool.getScore(0, now) == 0);
+
+    // Both cooling down: the retry waits for the first to come back
+    pool.reportFailure(1, now);
+    EXPECT(pool.getRoundFailures() == 11);
+    EXPECT(pool.getNextAttemptAt() == pool.getHealth(1).cooldownUntil);
+    EXPECT(pool.choose(now) == 1);
+
+    // Connected to the standby; the primary earns its score back while idle
+    now = pool.getHealth(0).cooldownUntil;
+    pool.reportSuccess(1, 250, now);
+    EXPECT(pool.getActive() == 1 && pool.getRoundFailures() == 0);
+    EXPECT(pool.getHealth(1).lastConnectMs == 250);
+    EXPECT(pool.getScore(0, pool.getHealth(0).lastChange + 10 * BROKER_SCORE_RECOVERY_MS) == 10);
+    EXPECT(!pool.shouldFailBack(now + BROKER_FAILBACK_MS / 2));
+    // Past the failback time, but the primary's score is still behind
+    EXPECT(!pool.shouldFailBack(now + BROKER_FAILBACK_MS + 1));
+    unsigned long rested = now + BROKER_SCORE_MAX * BROKER_SCORE_RECOVERY_MS;
+    EXPECT(pool.shouldFailBack(rested));
+    pool.reportClosed(rested);
+    EXPECT(pool.getActive() == BROKER_NONE && pool.readyToConnect(rested));
+    EXPECT(pool.choose(rested) == 0);
+
+    // A connection that did not last counts as a failure; one that did
+    // only costs a little score and a spread-out reconnect
+    pool.reportSuccess(0, 100, rested);
+    uint32_t failures = pool.getHealth(0).failures;
+    pool.reportDisconnect(rested + BROKER_STABLE_MS / 2);
+    EXPECT(pool.getHealth(0).failures == failures + 1);
+    EXPECT(pool.getHealth(0).consecutiveFailures == 1);
+
+    unsigned long later = rested + 10 * BROKER_FAILBACK_MS;
+    pool.reportSuccess(0, 100, later);
+    pool.reportDisconnect(later + BROKER_STABLE_MS);
+    EXPECT(pool.getHealth(0).failures == failures + 1);
+    EXPECT(pool.getScore(0, later + BROKER_STABLE_MS) == BROKER_SCORE_MAX - BROKER_SCORE_DROP);
+    EXPECT(!pool.readyToConnect(later + BROKER_STABLE_MS));
+    EXPECT(pool.readyToConnect(later + BROKER_STABLE_MS + 3000));
+}
+
+static void testRssiFilter() {
+    RssiFilter filter(-70, 5);
+    EXPECT(!filter.isValid() && !filter.isInRange());
+
+    // The first window sets the estimate outright
+    filter.update(-65);
+    EXPECT(filter.isValid() && filter.getRssi() == -65 && filter.isInRange());
+
+    // Inside the hysteresis band it stays in range, however long
+    for (int i = 0; i < 20; i++) {
+        filter.update(-73);
+        EXPECT(filter.isInRange());
+    }
+    EXPECT(filter.getRssi() == -73);
+    EXPECT(!filter.isConfident());
+
+    // Below the band it leaves, and does not come back until the threshold
+    int windows = 0;
+    while (filter.isInRange() && windows < 20) {
+        filter.update(-85);
+        windows++;
+    }
+    EXPECT(!filter.isInRange() && windows < 20);
+    for (int i = 0; i < 20; i++) {
+        filter.update(-72);
+        EXPECT(!filter.isInRange());
+    }
+
+    // A single strong window moves a settled estimate only part of the way
+    filter.update(-60);
+    EXPECT(filter.getRssi() > -72 && filter.getRssi() < -66);
+
+    // Steady and well above the threshold: confident, the noise has settled
+    for (int i = 0; i < 30; i++) filter.update(-50);
+    EXPECT(filter.isInRange() && filter.isConfident());
+    EXPECT(filter.getStdDev() <= 2);
+
+    // Path loss: at txPower it is 1 m, every 10 * n dB further is ten times that
+    EXPECT(filter.getDistanceCm(-50, 20) == 100);
+    uint16_t far = filter.getDistanceCm(-30, 20);
+    EXPECT(far >= 995 && far <= 1005);
+
+    // Misses widen the estimate, then drop it
+    int stdDev = filter.getStdDev();
+    filter.miss();
+    EXPECT(filter.isValid() && filter.getStdDev() > stdDev);
+    for (int i = 1; i < RSSI_MAX_MISSED_WINDOWS; i++) filter.miss();
+    EXPECT(!filter.isValid() && !filter.isInRange() && filter.getDistanceCm(-50, 20) == 0);
+}
+
+struct TestCase {
+    const char* name;
+    void (*fn)();
+};
+
+static const TestCase TESTS[] = {
+    { "parsing", testParsing },
+    { "queue_ordering", testQueueOrdering },
+    { "coalescing", testCoalescing },
+    { "token_buckets", testTokenBuckets },
+    { "offline_log", testOfflineLog },
+    { "socket_wake", testSocketWake },
+    { "formatter", testFormatter },
+    { "json_strings", testJsonStrings },
+    { "wire_format", testWireFormat },
+    { "broker_pool", testBrokerPool },
+    { "rssi_filter", testRssiFilter },
+};
+
+// ================================
+// DRIVER
+// ================================
+// Runs fn in a child with a fresh copy of the power-on state; its stdout is
+// captured so the parent can compare it
+static bool runIsolated(std::function<int()> fn, std::string& output) {
+    int pipeFds[2];
+    if (pipe(pipeFds) != 0) return false;
+    fflush(stdout);
+
+    pid_t child = fork();
+    if (child < 0) return false;
+    if (child == 0) {
+        close(pipeFds[0]);
+        dup2(pipeFds[1], STDOUT_FILENO);
+        HostSim::setSerialEcho(verbose);
+        int status = fn();
+        fflush(stdout);
+        _exit(status);
+    }
+
+    close(pipeFds[1]);
+    char buffer[4096];
+    ssize_t n;
+    while ((n = read(pipeFds[0], buffer, sizeof(buffer))) > 0) output.append(buffer, n);
+    close(pipeFds[0]);
+
+    int status = 0;
+    waitpid(child, &status, 0);
+    return WIFEXITED(status) && WEXITSTATUS(status) == 0;
+}
+
+static bool runAllTests() {
+    int failed = 0;
+    for (const TestCase& test : TESTS) {
+        std::string output;
+        bool passed = runIsolated([&test]() {
+            test.fn();
+            return expectFailures ? 1 : 0;
+        }, output);
+        if (verbose) fputs(output.c_str(), stderr);
+        fprintf(stderr, "  %-8s test.%s\n", passed ? "ok" : "FAILED", test.name);
+        if (!passed) failed++;
+    }
+    if (failed) {
+        fprintf(stderr, "%d of %d tests failed\n", failed, (int)(sizeof(TESTS) / sizeof(TESTS[0])));
+    } else {
+        fprintf(stderr, "All %d tests passed\n", (int)(sizeof(TESTS) / sizeof(TESTS[0])));
+    }
+    return failed == 0;
+}
+
+static std::map<std::string, std::string> parseMetrics(const std::string& text) {
+    std::map<std::string, std::string> metrics;
+    std::istringstream in(text);
+    std::string key, value;
+    while (in >> key >> value) metrics[key] = value;
+    return metrics;
+}
+
+static bool isTiming(const std::string& key) {
+    return key.compare(0, 6, "bench.") == 0;
+}
+
+static int compare(const std::map<std::string, std::string>& current, const char* baselinePath) {
+    std::ifstream in(baselinePath);
+    if (!in) {
+        fprintf(stderr, "No baseline at %s - run 'make baseline' first\n", baselinePath);
+        return 1;
+    }
+    std::stringstream text;
+    text << in.rdbuf();
+    std::map<std::string, std::string> baseline = parseMetrics(text.str());
+
+    int failures = 0;
+    for (const auto& metric : current) {
+        auto base = baseline.find(metric.first);
+        if (base == baseline.end()) {
+            fprintf(stderr, "  new      %-48s %s\n", metric.first.c_str(), metric.second.c_str());
+            continue;
+        }
+        if (isTiming(metric.first)) {
+            double was = atof(base->second.c_str());
+            double now = atof(metric.second.c_str());
+            bool slower = now > was * (100 + tolerancePercent) / 100 + BENCH_SLACK_NS;
+            fprintf(stderr, "  %-8s %-48s %10.1f -> %10.1f ns (%+.0f%%)\n", slower ? "SLOWER" : "ok",
+                    metric.first.c_str(), was, now, was > 0 ? (now - was) * 100 / was : 0.0);
+            if (slower) failures++;
+        } else if (metric.second != base->second) {
+            fprintf(stderr, "  CHANGED  %-48s %s -> %s\n", metric.first.c_str(), base->second.c_str(),
+                    metric.second.c_str());
+            failures++;
+        }
+    }
+    for (const auto& metric : baseline) {
+        if (!current.count(metric.first)) {
+            fprintf(stderr, "  MISSING  %s\n", metric.first.c_str());
+            failures++;
+        }
+    }
+
+    if (failures) {
+        fprintf(stderr, "%d regression(s) against %s\n", failures, baselinePath);
+        return 1;
+    }
+    fprintf(stderr, "No regressions against %s\n", baselinePath);
+    return 0;
+}
+
+static int usage() {
+    fprintf(stderr, "usage: host_bench [--test] [--bench] [--replay trace.csv...] [--task-replay trace.csv...]\n"
+                    "                  [--compare baseline.txt] [--tolerance percent] [--verbose]\n");
+    return 2;
+}
+
+int main(int argc, char** argv) {
+    bool runBench = false;
+    bool runTests = false;
+    std::vector<const char*> traces;
+    std::vector<const char*> taskTraces;
+    const char* baselinePath = nullptr;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--bench") == 0) {
+            runBench = true;
+        } else if (strcmp(argv[i], "--test") == 0) {
+            runTests = true;
+        } else if (strcmp(argv[i], "--replay") == 0) {
+            while (i + 1 < argc && strncmp(argv[i + 1], "--", 2) != 0) traces.push_back(argv[++i]);
+        } else if (strcmp(argv[i], "--task-replay") == 0) {
+            while (i + 1 < argc && strncmp(argv[i + 1], "--", 2) != 0) taskTraces.push_back(argv[++i]);
+        } else if (strcmp(argv[i], "--compare") == 0 && i + 1 < argc) {
+            baselinePath = argv[++i];
+        } else if (strcmp(argv[i], "--tolerance") == 0 && i + 1 < argc) {
+            tolerancePercent = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--verbose") == 0) {
+            verbose = true;
+        } else {
+            return usage();
+        }
+    }
+    if (!runTests && !runBench && traces.empty() && taskTraces.empty()) return usage();
+
+    std::string output;
+    bool ok = true;
+    if (runTests) ok = runAllTests() && ok;
+    if (runBench) ok = runIsolated([]() { runBenchmarks(); return 0; }, output) && ok;
+    for (const char* trace : traces) {
+        ok = runIsolated([trace]() { return runReplay(trace, false); }, output) && ok;
+    }
+    for (const char* trace : taskTraces) {
+        ok = runIsolated([trace]() { return runReplay(trace, true); }, output) && ok;
+    }
+
+    if (!baselinePath) fputs(output.c_str(), stdout);
+    if (!ok) {
+        fprintf(stderr, "A run failed\n");
+        return 1;
+    }
+    return baselinePath ? compare(parseMetrics(output), baselinePath) : 0;
+}
@@ -0,0 +1,85 @@
+/**
+ * Adafruit GFX for the host build
+ * Primitives reduce to drawPixel/fillRect like the real library; text uses
+ * the classic 6x8 cell (5x7 glyph plus a blank column and row) with
+ * made-up glyph bitmaps, so layout and raster work match the panel while
+ * the pixels themselves do not.
+ */
+
+#ifndef HOST_ADAFRUIT_GFX_H
+#define HOST_ADAFRUIT_GFX_H
+
+#include <Arduino.h>
+
+class Adafruit_GFX : public Print {
+public:
+    Adafruit_GFX(int16_t w, int16_t h);
+    virtual ~Adafruit_GFX() {}
+
+    virtual void drawPixel(int16_t x, int16_t y, uint16_t color) = 0;
+    virtual void startWrite() {}
+    virtual void endWrite() {}
+    virtual void fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color);
+    virtual void drawFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color);
+    virtual void drawFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color);
+    virtual void fillScreen(uint16_t color);
+    virtual void setRotation(uint8_t r);
+
+    void drawLine(int16_t x0, int16_t y0, int16_t x1, int16_t y1, uint16_t color);
+    void drawRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color);
+    void drawCircle(int16_t x0, int16_t y0, int16_t r, uint16_t color);
+    void fillCircle(int16_t x0, int16_t y0, int16_t r, uint16_t color);
+    void drawChar(int16_t x, int16_t y, unsigned char c, uint16_t color, uint16_t bg, uint8_t size);
+    void getTextBounds(const char* text, int16_t x, int16_t y, int16_t* x1, int16_t* y1, uint16_t* w, uint16_t* h);
+
+    void setCursor(int16_t x, int16_t y) { cursorX = x; cursorY = y; }
+    void setTextColor(uint16_t c) { textColor = textBackground = c; }
+    void setTextColor(uint16_t c, uint16_t bg) { textColor = c; textBackground = bg; }
+    void setTextSize(uint8_t s) { textSize = s > 0 ? s : 1; }
+    void setTextWrap(bool w) { wrap = w; }
+    int16_t width() const { return currentWidth; }
+    int16_t height() const { return currentHeight; }
+    uint8_t getRotation() const { return rotation; }
+    int16_t getCursorX() const { return cursorX; }
+    int16_t getCursorY() const { return cursorY; }
+
+    size_t write(uint8_t c) override;
+    using Print::write;
+
+protected:
+    int16_t rawWidth, rawHeight;
+    int16_t currentWidth, currentHeight;
+    int16_t cursorX = 0, cursorY = 0;
+    uint16_t textColor = 0xFFFF, textBackground = 0xFFFF;
+    uint8_t textSize = 1;
+    uint8_t rotation = 0;
+    bool wrap = true;
+};
+
+class GFXcanvas1 : public Adafruit_GFX {
+public:
+    GFXcanvas1(uint16_t w, uint16_t h);
+    ~GFXcanvas1();
+    void drawPixel(int16_t x, int16_t y, uint16_t color) override;
+    void fillScreen(uint16_t color) override;
+    bool getPixel(int16_t x, int16_t y) const;
+    uint8_t* getBuffer() const { return buffer; }
+
+private:
+    uint8_t* buffer;
+};
+
+class GFXcanvas16 : public Adafruit_GFX {
+public:
+    GFXcanvas16(uint16_t w, uint16_t h);
+    ~GFXcanvas16();
+    void drawPixel(int16_t x, int16_t y, uint16_t color) override;
+    void fillScreen(uint16_t color) override;
+    uint16_t getPixel(int16_t x, int16_t y) const;
+    uint16_t* getBuffer() const { return buffer; }
+
+private:
+    uint16_t* buffer;
+};
+
+#endif // HOST_ADAFRUIT_GFX_H
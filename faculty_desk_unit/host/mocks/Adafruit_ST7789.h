@@ -0,0 +1,35 @@
+/**
+ * ST7789 panel for the host build: keeps no frame, counts pixel writes in
+ * HostSim::displayLog()
+ */
+
+#ifndef HOST_ADAFRUIT_ST7789_H
+#define HOST_ADAFRUIT_ST7789_H
+
+#include "Adafruit_GFX.h"
+
+#define ST77XX_BLACK 0x0000
+#define ST77XX_WHITE 0xFFFF
+
+class Adafruit_ST7789 : public Adafruit_GFX {
+public:
+    Adafruit_ST7789(int8_t cs, int8_t dc, int8_t rst);
+    Adafruit_ST7789(int8_t cs, int8_t dc, int8_t mosi, int8_t sclk, int8_t rst);
+
+    void init(uint16_t width, uint16_t height, uint8_t spiMode = 0);
+    void setSPISpeed(uint32_t freq) {}
+    void drawPixel(int16_t x, int16_t y, uint16_t color) override;
+    void fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) override;
+    void fillScreen(uint16_t color) override;
+
+    void setAddrWindow(uint16_t x, uint16_t y, uint16_t w, uint16_t h);
+    void writePixels(uint16_t* colors, uint32_t length, bool block = true, bool bigEndian = false);
+    void writeColor(uint16_t color, uint32_t length);
+    void dmaWait() {}
+    void enableDisplay(bool enable) {}
+    void enableSleep(bool enable) {}
+    void invertDisplay(bool invert) {}
+    void sendCommand(uint8_t command, const uint8_t* data = nullptr, uint8_t length = 0) {}
+};
+
+#endif // HOST_ADAFRUIT_ST7789_H
@@ -0,0 +1,201 @@
+/**
+ * Arduino core for the host build of ConsultEase Faculty Desk Unit
+ * Just enough of the ESP32 Arduino API for the sketch and the optimization
+ * modules, on the virtual clock of host_sim.h.
+ */
+
+#ifndef HOST_ARDUINO_H
+#define HOST_ARDUINO_H
+
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <cstdio>
+#include <cstdlib>
+#include <cstdarg>
+#include <cmath>
+#include <string>
+#include <algorithm>
+#include <functional>
+#include <time.h>
+#include <sys/time.h>
+
+#include "host_sim.h"
+
+typedef uint8_t byte;
+typedef bool boolean;
+
+#define HIGH 1
+#define LOW 0
+#define INPUT 0x01
+#define OUTPUT 0x03
+#define INPUT_PULLUP 0x05
+#define RISING 0x01
+#define FALLING 0x02
+#define CHANGE 0x03
+
+#define IRAM_ATTR
+#define RTC_DATA_ATTR
+#define RTC_NOINIT_ATTR
+#define PROGMEM
+#define F(s) (s)
+
+#define DEC 10
+#define HEX 16
+
+using std::min;
+using std::max;
+
+class String {
+public:
+    String() {}
+    String(const char* text) : value(text ? text : "") {}
+    String(const std::string& text) : value(text) {}
+    String(char c) : value(1, c) {}
+    String(int v, int base = DEC) : value(format(v, base)) {}
+    String(unsigned int v, int base = DEC) : value(format(v, base)) {}
+    String(long v, int base = DEC) : value(format(v, base)) {}
+    String(unsigned long v, int base = DEC) : value(format(v, base)) {}
+    String(float v, int decimals = 2) : value(formatFloat(v, decimals)) {}
+    String(double v, int decimals = 2) : value(formatFloat(v, decimals)) {}
+
+    const char* c_str() const { return value.c_str(); }
+    unsigned int length() const { return value.size(); }
+    bool isEmpty() const { return value.empty(); }
+    bool reserve(unsigned int size) { value.reserve(size); return true; }
+    String substring(unsigned int from, unsigned int to) const { return value.substr(from, to - from); }
+    String substring(unsigned int from) const { return value.substr(from); }
+    void toUpperCase() { for (auto& c : value) c = toupper(c); }
+    void toLowerCase() { for (auto& c : value) c = tolower(c); }
+    void trim();
+    bool equals(const String& other) const { return value == other.value; }
+    bool startsWith(const String& prefix) const { return value.compare(0, prefix.value.size(), prefix.value) == 0; }
+    int indexOf(char c, unsigned int from = 0) const;
+    int indexOf(const String& s, unsigned int from = 0) const;
+    long toInt() const { return atol(value.c_str()); }
+    float toFloat() const { return atof(value.c_str()); }
+
+    String& operator+=(const String& other) { value += other.value; return *this; }
+    String& operator+=(const char* other) { value += other ? other : ""; return *this; }
+    String& operator+=(char c) { value += c; return *this; }
+    String& operator+=(int v) { value += format(v, DEC); return *this; }
+    String& operator+=(unsigned long v) { value += format(v, DEC); return *this; }
+    bool operator==(const String& other) const { return value == other.value; }
+    bool operator!=(const String& other) const { return value != other.value; }
+    bool operator==(const char* other) const { return value == (other ? other : ""); }
+    bool operator!=(const char* other) const { return !(*this == other); }
+    char operator[](unsigned int index) const { return index < value.size() ? value[index] : 0; }
+    char charAt(unsigned int index) const { return (*this)[index]; }
+
+private:
+    std::string value;
+
+    static std::string format(long long v, int base);
+    static std::string format(unsigned long long v, int base);
+    static std::string format(int v, int base) { return format((long long)v, base); }
+    static std::string format(long v, int base) { return format((long long)v, base); }
+    static std::string format(unsigned int v, int base) { return format((unsigned long long)v, base); }
+    static std::string format(unsigned long v, int base) { return format((unsigned long long)v, base); }
+    static std::string formatFloat(double v, int decimals);
+
+    friend String operator+(const String& a, const String& b);
+};
+
+inline String operator+(const String& a, const String& b) { return String(a.value + b.value); }
+inline String operator+(const char* a, const String& b) { return String(a) + b; }
+inline String operator+(const String& a, const char* b) { return a + String(b); }
+
+class Print;
+
+class Printable {
+public:
+    virtual ~Printable() {}
+    virtual size_t printTo(Print& p) const = 0;
+};
+
+class Print {
+public:
+    virtual ~Print() {}
+    virtual size_t write(uint8_t c) = 0;
+    virtual size_t write(const uint8_t* buffer, size_t size);
+    size_t write(const char* text) { return text ? write((const uint8_t*)text, strlen(text)) : 0; }
+    size_t write(const char* buffer, size_t size) { return write((const uint8_t*)buffer, size); }
+
+    size_t print(const char* text) { return write(text); }
+    size_t print(const String& text) { return write(text.c_str()); }
+    size_t print(char c) { return write((uint8_t)c); }
+    size_t print(int v, int base = DEC) { return print(String(v, base)); }
+    size_t print(unsigned int v, int base = DEC) { return print(String(v, base)); }
+    size_t print(long v, int base = DEC) { return print(String(v, base)); }
+    size_t print(unsigned long v, int base = DEC) { return print(String(v, base)); }
+    size_t print(double v, int decimals = 2) { return print(String(v, decimals)); }
+    size_t print(const Printable& v) { return v.printTo(*this); }
+
+    size_t println() { return write("\n"); }
+    template <typename T> size_t println(const T& v) { return print(v) + println(); }
+    template <typename T> size_t println(const T& v, int format) { return print(v, format) + println(); }
+
+    size_t printf(const char* format, ...) __attribute__((format(printf, 2, 3)));
+};
+
+class HardwareSerial : public Print {
+public:
+    void begin(unsigned long) {}
+    void end() {}
+    void flush();
+    int available() { return 0; }
+    int read() { return -1; }
+    operator bool() const { return true; }
+
+    size_t write(uint8_t c) override;
+    size_t write(const uint8_t* buffer, size_t size) override;
+    using Print::write;
+};
+
+extern HardwareSerial Serial;
+
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+void yield();
+
+long random(long howBig);
+long random(long howSmall, long howBig);
+void randomSeed(unsigned long seed);
+
+void pinMode(uint8_t pin, uint8_t mode);
+int digitalRead(uint8_t pin);
+void digitalWrite(uint8_t pin, uint8_t level);
+int analogRead(uint8_t pin);
+void analogWrite(uint8_t pin, int value);
+void attachInterrupt(uint8_t pin, void (*isr)(void), int mode);
+void detachInterrupt(uint8_t pin);
+#define digitalPinToInterrupt(p) (p)
+
+uint32_t getCpuFrequencyMhz();
+bool setCpuFrequencyMhz(uint32_t mhz);
+
+class EspClass {
+public:
+    uint32_t getFreeHeap();
+    uint32_t getMinFreeHeap();
+    uint32_t getMaxAllocHeap();
+    uint32_t getHeapSize();
+    uint32_t getFreePsram();
+    uint32_t getCycleCount();
+    uint64_t getEfuseMac();
+    const char* getChipModel() { return "host"; }
+    void restart();
+};
+
+extern EspClass ESP;
+
+bool getLocalTime(struct tm* info, uint32_t ms = 5000);
+void configTime(long gmtOffsetSec, int daylightOffsetSec, const char* server1,
+                const char* server2 = nullptr, const char* server3 = nullptr);
+void configTzTime(const char* tz, const char* server1, const char* server2 = nullptr, const char* server3 = nullptr);
+
+#include "freertos_host.h"
+
+#endif // HOST_ARDUINO_H
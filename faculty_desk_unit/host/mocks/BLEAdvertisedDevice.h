@@ -0,0 +1,56 @@
+/**
+ * ESP32 BLE Arduino advertisement types for the host build
+ */
+
+#ifndef HOST_BLE_ADVERTISED_DEVICE_H
+#define HOST_BLE_ADVERTISED_DEVICE_H
+
+#include <Arduino.h>
+#include "esp_bt.h"
+
+class BLEAddress {
+public:
+    BLEAddress() { memset(address, 0, sizeof(address)); }
+    BLEAddress(esp_bd_addr_t native) { memcpy(address, native, sizeof(address)); }
+    BLEAddress(const String& text);
+
+    esp_bd_addr_t* getNative() { return &address; }
+    String toString() const;
+    bool equals(const BLEAddress& other) const { return memcmp(address, other.address, sizeof(address)) == 0; }
+
+private:
+    esp_bd_addr_t address;
+};
+
+class BLEAdvertisedDevice {
+public:
+    BLEAdvertisedDevice() : rssi(0) {}
+    BLEAdvertisedDevice(const BLEAddress& address, int rssi) : address(address), rssi(rssi) {}
+
+    BLEAddress getAddress() { return address; }
+    int getRSSI() { return rssi; }
+    bool haveRSSI() { return true; }
+    String getName() { return String(); }
+    bool haveName() { return false; }
+    int8_t getTXPower() { return 0; }
+    bool haveTXPower() { return false; }
+    String toString() { return address.toString(); }
+
+private:
+    BLEAddress address;
+    int rssi;
+};
+
+class BLEScanResults {
+public:
+    int getCount() { return 0; }
+    BLEAdvertisedDevice getDevice(uint32_t) { return BLEAdvertisedDevice(); }
+};
+
+class BLEAdvertisedDeviceCallbacks {
+public:
+    virtual ~BLEAdvertisedDeviceCallbacks() {}
+    virtual void onResult(BLEAdvertisedDevice advertisedDevice) = 0;
+};
+
+#endif // HOST_BLE_ADVERTISED_DEVICE_H
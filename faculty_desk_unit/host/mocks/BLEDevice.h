@@ -0,0 +1,27 @@
+/**
+ * ESP32 BLE Arduino device singleton for the host build
+ */
+
+#ifndef HOST_BLE_DEVICE_H
+#define HOST_BLE_DEVICE_H
+
+#include <Arduino.h>
+#include "BLEScan.h"
+#include "esp_bt.h"
+#include "esp_gap_ble_api.h"
+
+typedef void (*gap_event_handler)(esp_gap_ble_cb_event_t event, esp_ble_gap_cb_param_t* param);
+
+class BLEDevice {
+public:
+    static void init(String deviceName);
+    static void deinit(bool releaseMemory = false);
+    static BLEScan* getScan();
+    static bool getInitialized();
+    static void setPower(esp_power_level_t level, esp_ble_power_type_t type = ESP_BLE_PWR_TYPE_DEFAULT);
+    static void whiteListAdd(BLEAddress address);
+    static void whiteListRemove(BLEAddress address);
+    static void setCustomGapHandler(gap_event_handler handler);
+};
+
+#endif // HOST_BLE_DEVICE_H
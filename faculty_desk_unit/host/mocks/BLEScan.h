@@ -0,0 +1,38 @@
+/**
+ * ESP32 BLE Arduino scanner for the host build. The radio is simulated: a
+ * window asks HostSim's sighting source what was heard once it closes.
+ */
+
+#ifndef HOST_BLE_SCAN_H
+#define HOST_BLE_SCAN_H
+
+#include "BLEAdvertisedDevice.h"
+
+class BLEScan {
+public:
+    void setActiveScan(bool active) { activeScan = active; }
+    void setAdvertisedDeviceCallbacks(BLEAdvertisedDeviceCallbacks* callbacks, bool wantDuplicates = false,
+                                      bool shouldParse = true);
+    void setInterval(uint16_t intervalMs) { interval = intervalMs; }
+    void setWindow(uint16_t windowMs) { window = windowMs; }
+
+    // Background window; scanCompleteCB fires when it closes
+    bool start(uint32_t durationSeconds, void (*scanCompleteCB)(BLEScanResults), bool isContinue = false);
+    // Blocking window: the virtual clock runs through it
+    BLEScanResults* start(uint32_t durationSeconds, bool isContinue = false);
+    void stop();
+    void erase(BLEAddress address) {}
+    void clearResults() {}
+    BLEScanResults* getResults() { return &results; }
+
+    BLEAdvertisedDeviceCallbacks* getCallbacks() const { return callbacks; }
+
+private:
+    BLEAdvertisedDeviceCallbacks* callbacks = nullptr;
+    BLEScanResults results;
+    bool activeScan = false;
+    uint16_t interval = 100;
+    uint16_t window = 99;
+};
+
+#endif // HOST_BLE_SCAN_H
@@ -0,0 +1,10 @@
+/**
+ * ESP32 BLE Arduino utilities for the host build (nothing is used)
+ */
+
+#ifndef HOST_BLE_UTILS_H
+#define HOST_BLE_UTILS_H
+
+#include "BLEDevice.h"
+
+#endif // HOST_BLE_UTILS_H
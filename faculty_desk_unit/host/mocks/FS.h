@@ -0,0 +1,64 @@
+/**
+ * Arduino FS for the host build: files live in memory for the process
+ */
+
+#ifndef HOST_FS_H
+#define HOST_FS_H
+
+#include <Arduino.h>
+#include <memory>
+#include <string>
+#include <vector>
+
+#define FILE_READ "r"
+#define FILE_WRITE "w"
+#define FILE_APPEND "a"
+
+namespace fs {
+
+typedef std::vector<uint8_t> FileData;
+
+class File : public Print {
+public:
+    File() {}
+    File(std::shared_ptr<FileData> data, bool writable, size_t position)
+        : data(data), writable(writable), cursor(position) {}
+
+    size_t write(uint8_t b) override { return write(&b, 1); }
+    size_t write(const uint8_t* buffer, size_t size) override;
+    using Print::write;
+    size_t read(uint8_t* buffer, size_t size);
+    int read();
+    int peek();
+    int available();
+    bool seek(uint32_t position);
+    size_t position() const { return cursor; }
+    size_t size() const { return data ? data->size() : 0; }
+    void flush() {}
+    void close() { data.reset(); }
+    operator bool() const { return (bool)data; }
+
+private:
+    std::shared_ptr<FileData> data;
+    bool writable = false;
+    size_t cursor = 0;
+};
+
+class FS {
+public:
+    File open(const char* path, const char* mode = FILE_READ, bool create = false);
+    bool exists(const char* path);
+    bool remove(const char* path);
+    bool rename(const char* from, const char* to);
+    bool mkdir(const char* path) { return true; }
+
+protected:
+    std::vector<std::pair<std::string, std::shared_ptr<FileData>>> files;
+    std::shared_ptr<FileData>* find(const char* path);
+};
+
+} // namespace fs
+
+using fs::File;
+
+#endif // HOST_FS_H
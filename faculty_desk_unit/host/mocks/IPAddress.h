@@ -0,0 +1,45 @@
+/**
+ * Arduino IPAddress for the host build
+ */
+
+#ifndef HOST_IP_ADDRESS_H
+#define HOST_IP_ADDRESS_H
+
+#include <Arduino.h>
+
+class IPAddress : public Printable {
+public:
+    IPAddress() { memset(bytes, 0, sizeof(bytes)); }
+    IPAddress(uint8_t a, uint8_t b, uint8_t c, uint8_t d) { bytes[0] = a; bytes[1] = b; bytes[2] = c; bytes[3] = d; }
+    IPAddress(uint32_t address) { memcpy(bytes, &address, sizeof(bytes)); }
+
+    operator uint32_t() const { uint32_t address; memcpy(&address, bytes, sizeof(address)); return address; }
+    uint8_t operator[](int index) const { return bytes[index]; }
+    uint8_t& operator[](int index) { return bytes[index]; }
+    bool operator==(const IPAddress& other) const { return memcmp(bytes, other.bytes, sizeof(bytes)) == 0; }
+    bool operator!=(const IPAddress& other) const { return !(*this == other); }
+
+    size_t printTo(Print& p) const override {
+        return p.printf("%u.%u.%u.%u", bytes[0], bytes[1], bytes[2], bytes[3]);
+    }
+
+    String toString() const {
+        char text[16];
+        snprintf(text, sizeof(text), "%u.%u.%u.%u", bytes[0], bytes[1], bytes[2], bytes[3]);
+        return String(text);
+    }
+
+    bool fromString(const char* text) {
+        unsigned a, b, c, d;
+        if (!text || sscanf(text, "%u.%u.%u.%u", &a, &b, &c, &d) != 4 || a > 255 || b > 255 || c > 255 || d > 255) {
+            return false;
+        }
+        bytes[0] = a; bytes[1] = b; bytes[2] = c; bytes[3] = d;
+        return true;
+    }
+
+private:
+    uint8_t bytes[4];
+};
+
+#endif // HOST_IP_ADDRESS_H
@@ -0,0 +1,22 @@
+/**
+ * LittleFS for the host build: an in-memory file system per process
+ */
+
+#ifndef HOST_LITTLEFS_H
+#define HOST_LITTLEFS_H
+
+#include "FS.h"
+
+class LittleFSFS : public fs::FS {
+public:
+    bool begin(bool formatOnFail = false, const char* basePath = "/littlefs", uint8_t maxOpenFiles = 10,
+               const char* partitionLabel = "spiffs") { return true; }
+    void end() {}
+    bool format() { files.clear(); return true; }
+    size_t totalBytes() { return 1024 * 1024; }
+    size_t usedBytes();
+};
+
+extern LittleFSFS LittleFS;
+
+#endif // HOST_LITTLEFS_H
@@ -0,0 +1,55 @@
+/**
+ * ESP32 Preferences (NVS) for the host build: one in-memory store per
+ * process, shared by every Preferences object like the real partition
+ */
+
+#ifndef HOST_PREFERENCES_H
+#define HOST_PREFERENCES_H
+
+#include <Arduino.h>
+#include <string>
+#include <vector>
+
+class Preferences {
+public:
+    bool begin(const char* name, bool readOnly = false);
+    void end() { opened = false; }
+    bool clear();
+    bool remove(const char* key);
+    bool isKey(const char* key);
+
+    size_t putBytes(const char* key, const void* value, size_t length);
+    size_t getBytes(const char* key, void* buffer, size_t length);
+    size_t getBytesLength(const char* key);
+
+    size_t putUChar(const char* key, uint8_t value) { return putBytes(key, &value, sizeof(value)); }
+    uint8_t getUChar(const char* key, uint8_t defaultValue = 0) { return get(key, defaultValue); }
+    size_t putUShort(const char* key, uint16_t value) { return putBytes(key, &value, sizeof(value)); }
+    uint16_t getUShort(const char* key, uint16_t defaultValue = 0) { return get(key, defaultValue); }
+    size_t putInt(const char* key, int32_t value) { return putBytes(key, &value, sizeof(value)); }
+    int32_t getInt(const char* key, int32_t defaultValue = 0) { return get(key, defaultValue); }
+    size_t putUInt(const char* key, uint32_t value) { return putBytes(key, &value, sizeof(value)); }
+    uint32_t getUInt(const char* key, uint32_t defaultValue = 0) { return get(key, defaultValue); }
+    size_t putULong64(const char* key, uint64_t value) { return putBytes(key, &value, sizeof(value)); }
+    uint64_t getULong64(const char* key, uint64_t defaultValue = 0) { return get(key, defaultValue); }
+    size_t putBool(const char* key, bool value) { return putUChar(key, value ? 1 : 0); }
+    bool getBool(const char* key, bool defaultValue = false) { return getUChar(key, defaultValue ? 1 : 0) != 0; }
+
+    size_t putString(const char* key, const char* value);
+    size_t putString(const char* key, const String& value) { return putString(key, value.c_str()); }
+    size_t getString(const char* key, char* buffer, size_t length);
+    String getString(const char* key, const String& defaultValue = String());
+
+private:
+    std::string space;
+    bool opened = false;
+    bool readOnly = false;
+
+    std::string qualified(const char* key) const { return space + "/" + key; }
+    template <typename T> T get(const char* key, T defaultValue) {
+        T value;
+        return getBytesLength(key) == sizeof(T) && getBytes(key, &value, sizeof(T)) == sizeof(T) ? value : defaultValue;
+    }
+};
+
+#endif // HOST_PREFERENCES_H
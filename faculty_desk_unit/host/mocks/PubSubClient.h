@@ -0,0 +1,75 @@
+/**
+ * PubSubClient for the host build. Follows the real client's connection
+ * handling over the given Client; publishes are counted by HostSim, and
+ * injected messages are delivered from loop().
+ */
+
+#ifndef HOST_PUBSUBCLIENT_H
+#define HOST_PUBSUBCLIENT_H
+
+#include <Arduino.h>
+#include "WiFi.h"
+#include <string>
+
+#define MQTT_MAX_PACKET_SIZE 256
+
+#define MQTT_CONNECTION_TIMEOUT -4
+#define MQTT_CONNECTION_LOST -3
+#define MQTT_CONNECT_FAILED -2
+#define MQTT_DISCONNECTED -1
+#define MQTT_CONNECTED 0
+
+#define MQTT_CALLBACK_SIGNATURE std::function<void(char*, uint8_t*, unsigned int)> callback
+
+class PubSubClient {
+public:
+    PubSubClient() {}
+    PubSubClient(Client& client) : client(&client) {}
+
+    PubSubClient& setServer(const char* domain, uint16_t port);
+    PubSubClient& setServer(IPAddress ip, uint16_t port);
+    PubSubClient& setCallback(MQTT_CALLBACK_SIGNATURE);
+    PubSubClient& setClient(Client& client);
+    PubSubClient& setKeepAlive(uint16_t seconds) { keepAlive = seconds; return *this; }
+    PubSubClient& setSocketTimeout(uint16_t seconds) { socketTimeout = seconds; return *this; }
+    bool setBufferSize(uint16_t size);
+    uint16_t getBufferSize() { return bufferSize; }
+
+    bool connect(const char* id);
+    bool connect(const char* id, const char* user, const char* pass);
+    bool connect(const char* id, const char* user, const char* pass, const char* willTopic, uint8_t willQos,
+                 bool willRetain, const char* willMessage, bool cleanSession = true);
+    void disconnect();
+
+    bool publish(const char* topic, const char* payload);
+    bool publish(const char* topic, const char* payload, bool retained);
+    bool publish(const char* topic, const uint8_t* payload, unsigned int length);
+    bool publish(const char* topic, const uint8_t* payload, unsigned int length, bool retained);
+    bool beginPublish(const char* topic, unsigned int length, bool retained);
+    size_t write(uint8_t b);
+    size_t write(const uint8_t* buffer, size_t size);
+    int endPublish();
+
+    bool subscribe(const char* topic);
+    bool subscribe(const char* topic, uint8_t qos);
+    bool unsubscribe(const char* topic);
+    bool loop();
+    bool connected();
+    int state() { return connectionState; }
+
+private:
+    Client* client = nullptr;
+    std::function<void(char*, uint8_t*, unsigned int)> messageCallback;
+    char domain[64] = "";
+    uint16_t port = 0;
+    uint16_t keepAlive = 15;
+    uint16_t socketTimeout = 15;
+    uint16_t bufferSize = MQTT_MAX_PACKET_SIZE;
+    int connectionState = MQTT_DISCONNECTED;
+
+    std::string streamTopic;
+    std::string streamPayload;
+    bool streamOpen = false;
+};
+
+#endif // HOST_PUBSUBCLIENT_H
@@ -0,0 +1,99 @@
+/**
+ * ESP32 WiFi and socket client for the host build. Association succeeds
+ * while HostSim::setWifiAvailable() is set; sockets connect while the
+ * broker is available and drop when it goes away.
+ */
+
+#ifndef HOST_WIFI_H
+#define HOST_WIFI_H
+
+#include <Arduino.h>
+#include "IPAddress.h"
+
+typedef enum {
+    WL_IDLE_STATUS = 0,
+    WL_NO_SSID_AVAIL = 1,
+    WL_SCAN_COMPLETED = 2,
+    WL_CONNECTED = 3,
+    WL_CONNECT_FAILED = 4,
+    WL_CONNECTION_LOST = 5,
+    WL_DISCONNECTED = 6
+} wl_status_t;
+
+typedef enum { WIFI_OFF, WIFI_STA, WIFI_AP, WIFI_AP_STA } wifi_mode_t;
+typedef enum { WIFI_PS_NONE, WIFI_PS_MIN_MODEM, WIFI_PS_MAX_MODEM } wifi_ps_type_t;
+typedef int WiFiEvent_t;
+
+class Client : public Print {
+public:
+    virtual int connect(IPAddress ip, uint16_t port) = 0;
+    virtual int connect(const char* host, uint16_t port) = 0;
+    virtual size_t write(uint8_t b) = 0;
+    virtual size_t write(const uint8_t* buffer, size_t size) = 0;
+    virtual int available() = 0;
+    virtual int read() = 0;
+    virtual int read(uint8_t* buffer, size_t size) = 0;
+    virtual int peek() = 0;
+    virtual void flush() = 0;
+    virtual void stop() = 0;
+    virtual uint8_t connected() = 0;
+    virtual operator bool() = 0;
+    void setTimeout(unsigned long) {}
+};
+
+class WiFiClient : public Client {
+public:
+    int connect(IPAddress ip, uint16_t port) override;
+    int connect(const char* host, uint16_t port) override;
+    int connect(const char* host, uint16_t port, int32_t timeoutMs);
+    size_t write(uint8_t b) override { return write(&b, 1); }
+    size_t write(const uint8_t* buffer, size_t size) override { return connected() ? size : 0; }
+    int available() override { return 0; }
+    int read() override { return -1; }
+    int read(uint8_t* buffer, size_t size) override { return -1; }
+    int peek() override { return -1; }
+    void flush() override {}
+    void stop() override { open = false; }
+    uint8_t connected() override;
+    operator bool() override { return connected(); }
+    int fd() const { return open ? 3 : -1; }
+    int setNoDelay(bool) { return 0; }
+
+private:
+    bool open = false;
+    uint32_t generation = 0;      // Broker generation the socket was opened in
+};
+
+class WiFiClass {
+public:
+    wl_status_t begin(const char* ssid, const char* passphrase = nullptr, int32_t channel = 0,
+                      const uint8_t* bssid = nullptr, bool connect = true);
+    bool config(IPAddress localIP, IPAddress gateway, IPAddress subnet,
+                IPAddress dns1 = IPAddress(), IPAddress dns2 = IPAddress());
+    wl_status_t status();
+    bool reconnect();
+    bool disconnect(bool wifiOff = false, bool eraseAp = false);
+    bool isConnected() { return status() == WL_CONNECTED; }
+
+    IPAddress localIP();
+    IPAddress gatewayIP();
+    IPAddress subnetMask();
+    IPAddress dnsIP(uint8_t index = 0);
+    uint8_t* BSSID();
+    int32_t channel();
+    int8_t RSSI();
+    String SSID();
+    String macAddress();
+
+    bool mode(wifi_mode_t mode) { return true; }
+    bool setAutoReconnect(bool) { return true; }
+    bool setSleep(bool) { return true; }
+    bool setSleep(wifi_ps_type_t) { return true; }
+    bool persistent(bool) { return true; }
+    bool setHostname(const char*) { return true; }
+    void onEvent(void (*)(WiFiEvent_t)) {}
+};
+
+extern WiFiClass WiFi;
+
+#endif // HOST_WIFI_H
@@ -0,0 +1,18 @@
+/**
+ * ESP32 WiFiClientSecure for the host build (no TLS; plain socket)
+ */
+
+#ifndef HOST_WIFI_CLIENT_SECURE_H
+#define HOST_WIFI_CLIENT_SECURE_H
+
+#include "WiFi.h"
+
+class WiFiClientSecure : public WiFiClient {
+public:
+    void setCACert(const char*) {}
+    void setCertificate(const char*) {}
+    void setPrivateKey(const char*) {}
+    void setInsecure() {}
+};
+
+#endif // HOST_WIFI_CLIENT_SECURE_H
@@ -0,0 +1,19 @@
+/**
+ * ESP-IDF Bluetooth controller types for the host build
+ */
+
+#ifndef HOST_ESP_BT_H
+#define HOST_ESP_BT_H
+
+#include <cstdint>
+
+typedef enum {
+    ESP_PWR_LVL_N12, ESP_PWR_LVL_N9, ESP_PWR_LVL_N6, ESP_PWR_LVL_N3,
+    ESP_PWR_LVL_N0, ESP_PWR_LVL_P3, ESP_PWR_LVL_P6, ESP_PWR_LVL_P9
+} esp_power_level_t;
+
+typedef enum { ESP_BLE_PWR_TYPE_DEFAULT, ESP_BLE_PWR_TYPE_SCAN, ESP_BLE_PWR_TYPE_ADV } esp_ble_power_type_t;
+
+typedef uint8_t esp_bd_addr_t[6];
+
+#endif // HOST_ESP_BT_H
@@ -0,0 +1,61 @@
+/**
+ * ESP-IDF BLE GAP scan API for the host build (BLE_CONTROLLER_FILTER path).
+ * Windows are served by the same simulated radio as BLEScan.
+ */
+
+#ifndef HOST_ESP_GAP_BLE_API_H
+#define HOST_ESP_GAP_BLE_API_H
+
+#include <cstdint>
+#include "esp_bt.h"
+
+typedef int esp_err_t;
+#ifndef ESP_OK
+#define ESP_OK 0
+#endif
+
+typedef enum {
+    ESP_GAP_BLE_SCAN_PARAM_SET_COMPLETE_EVT = 2,
+    ESP_GAP_BLE_SCAN_RESULT_EVT = 3,
+    ESP_GAP_BLE_SCAN_START_COMPLETE_EVT = 7,
+    ESP_GAP_BLE_SCAN_STOP_COMPLETE_EVT = 18
+} esp_gap_ble_cb_event_t;
+
+typedef enum { ESP_GAP_SEARCH_INQ_RES_EVT = 0, ESP_GAP_SEARCH_INQ_CMPL_EVT = 1 } esp_gap_search_evt_t;
+typedef enum { BLE_SCAN_TYPE_PASSIVE = 0, BLE_SCAN_TYPE_ACTIVE = 1 } esp_ble_scan_type_t;
+typedef enum { BLE_ADDR_TYPE_PUBLIC = 0, BLE_ADDR_TYPE_RANDOM } esp_ble_addr_type_t;
+typedef enum { BLE_SCAN_DUPLICATE_DISABLE = 0, BLE_SCAN_DUPLICATE_ENABLE } esp_ble_scan_duplicate_t;
+typedef enum {
+    BLE_SCAN_FILTER_ALLOW_ALL = 0,
+    BLE_SCAN_FILTER_ALLOW_ONLY_WLST,
+    BLE_SCAN_FILTER_ALLOW_UND_RPA_DIR,
+    BLE_SCAN_FILTER_ALLOW_WLIST_PRA_DIR
+} esp_ble_scan_filter_t;
+
+typedef struct {
+    esp_ble_scan_type_t scan_type;
+    esp_ble_addr_type_t own_addr_type;
+    esp_ble_scan_filter_t scan_filter_policy;
+    uint16_t scan_interval;
+    uint16_t scan_window;
+    esp_ble_scan_duplicate_t scan_duplicate;
+} esp_ble_scan_params_t;
+
+typedef union {
+    struct {
+        esp_gap_search_evt_t search_evt;
+        esp_bd_addr_t bda;
+        int rssi;
+    } scan_rst;
+    struct {
+        int status;
+    } scan_param_cmpl;
+} esp_ble_gap_cb_param_t;
+
+typedef void (*esp_gap_ble_cb_t)(esp_gap_ble_cb_event_t event, esp_ble_gap_cb_param_t* param);
+
+esp_err_t esp_ble_gap_set_scan_params(esp_ble_scan_params_t* params);
+esp_err_t esp_ble_gap_start_scanning(uint32_t durationSeconds);
+esp_err_t esp_ble_gap_stop_scanning();
+
+#endif // HOST_ESP_GAP_BLE_API_H
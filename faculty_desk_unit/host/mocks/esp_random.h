@@ -0,0 +1,11 @@
+/**
+ * ESP-IDF random API for the host build (deterministic, see esp_system.h)
+ */
+
+#ifndef HOST_ESP_RANDOM_H
+#define HOST_ESP_RANDOM_H
+
+#include <cstddef>
+#include "esp_system.h"
+
+#endif // HOST_ESP_RANDOM_H
@@ -0,0 +1,16 @@
+/**
+ * ESP-IDF system API for the host build
+ */
+
+#ifndef HOST_ESP_SYSTEM_H
+#define HOST_ESP_SYSTEM_H
+
+#include <cstdint>
+
+typedef enum { ESP_MAC_WIFI_STA, ESP_MAC_WIFI_SOFTAP, ESP_MAC_BT, ESP_MAC_ETH } esp_mac_type_t;
+
+int esp_read_mac(uint8_t* mac, esp_mac_type_t type);
+uint32_t esp_random();
+void esp_fill_random(void* buffer, size_t length);
+
+#endif // HOST_ESP_SYSTEM_H
@@ -0,0 +1,25 @@
+/**
+ * ESP-IDF GPIO register layer for the host build: the ISR-safe calls map
+ * onto the driver calls in driver/gpio.h
+ */
+
+#ifndef HOST_HAL_GPIO_LL_H
+#define HOST_HAL_GPIO_LL_H
+
+#include "driver/gpio.h"
+
+typedef struct gpio_dev_s {
+    int unused;
+} gpio_dev_t;
+
+extern gpio_dev_t GPIO;
+
+static inline void gpio_ll_wakeup_disable(gpio_dev_t* hw, gpio_num_t pin) {
+    gpio_wakeup_disable(pin);
+}
+
+static inline void gpio_ll_set_intr_type(gpio_dev_t* hw, gpio_num_t pin, gpio_int_type_t type) {
+    gpio_set_intr_type(pin, type);
+}
+
+#endif // HOST_HAL_GPIO_LL_H
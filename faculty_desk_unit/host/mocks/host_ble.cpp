@@ -0,0 +1,181 @@
+/**
+ * Host BLE radio for ConsultEase Faculty Desk Unit
+ * One radio behind both scan APIs. A window collects what the sighting
+ * source reports for its time span and completes when it closes: results
+ * through the callbacks (or the custom GAP handler), then the completion.
+ */
+
+#include <Arduino.h>
+#include <BLEDevice.h>
+#include <set>
+#include <vector>
+
+#define HOST_RADIO_BATCH 256
+
+namespace {
+    HostSim::SightingSource sightingSource;
+    HostSim::RadioLog radioCounters = {};
+
+    bool bleInitialized = false;
+    BLEScan scanner;
+    gap_event_handler gapHandler = nullptr;
+    std::set<uint64_t> whiteList;
+    esp_ble_scan_params_t gapParams = {};
+
+    bool windowOpen = false;
+    uint32_t windowId = 0;
+    uint64_t windowStartUs = 0;
+
+    uint64_t addressKey(const uint8_t* address) {
+        uint64_t key = 0;
+        for (int i = 0; i < 6; i++) key = (key << 8) | address[i];
+        return key;
+    }
+
+    uint32_t openWindow() {
+        windowOpen = true;
+        windowStartUs = HostSim::nowUs();
+        radioCounters.windows++;
+        return ++windowId;
+    }
+
+    void closeWindow() {
+        windowOpen = false;
+        radioCounters.listenUs += HostSim::nowUs() - windowStartUs;
+    }
+
+    // Everything heard between the window start and now
+    std::vector<HostSim::Advertisement> collect(bool whiteListOnly, bool dropDuplicates) {
+        std::vector<HostSim::Advertisement> heard;
+        if (!sightingSource) return heard;
+
+        HostSim::Advertisement batch[HOST_RADIO_BATCH];
+        size_t count = sightingSource(windowStartUs, HostSim::nowUs(), batch, HOST_RADIO_BATCH);
+        std::set<uint64_t> seen;
+        for (size_t i = 0; i < count && i < HOST_RADIO_BATCH; i++) {
+            uint64_t key = addressKey(batch[i].address);
+            if (whiteListOnly && !whiteList.count(key)) continue;
+            if (dropDuplicates && !seen.insert(key).second) continue;
+            heard.push_back(batch[i]);
+        }
+        radioCounters.advertisementsDelivered += heard.size();
+        return heard;
+    }
+
+    // Ends a BLEScan window unless stop() or a newer start got there first
+    void finishScan(uint32_t id, void (*complete)(BLEScanResults)) {
+        if (!windowOpen || id != windowId) return;
+        closeWindow();
+        BLEAdvertisedDeviceCallbacks* callbacks = scanner.getCallbacks();
+        for (const HostSim::Advertisement& ad : collect(false, false)) {
+            if (callbacks) callbacks->onResult(BLEAdvertisedDevice(BLEAddress((uint8_t*)ad.address), ad.rssi));
+        }
+        if (complete) complete(*scanner.getResults());
+    }
+
+    void finishGapScan(uint32_t id) {
+        if (!windowOpen || id != windowId) return;
+        closeWindow();
+        bool whiteListOnly = gapParams.scan_filter_policy == BLE_SCAN_FILTER_ALLOW_ONLY_WLST;
+        bool dropDuplicates = gapParams.scan_duplicate == BLE_SCAN_DUPLICATE_ENABLE;
+
+        esp_ble_gap_cb_param_t param;
+        for (const HostSim::Advertisement& ad : collect(whiteListOnly, dropDuplicates)) {
+            memset(&param, 0, sizeof(param));
+            param.scan_rst.search_evt = ESP_GAP_SEARCH_INQ_RES_EVT;
+            memcpy(param.scan_rst.bda, ad.address, sizeof(param.scan_rst.bda));
+            param.scan_rst.rssi = ad.rssi;
+            if (gapHandler) gapHandler(ESP_GAP_BLE_SCAN_RESULT_EVT, &param);
+        }
+        memset(&param, 0, sizeof(param));
+        param.scan_rst.search_evt = ESP_GAP_SEARCH_INQ_CMPL_EVT;
+        if (gapHandler) gapHandler(ESP_GAP_BLE_SCAN_RESULT_EVT, &param);
+    }
+}
+
+namespace HostSim {
+    void setSightingSource(SightingSource source) { sightingSource = source; }
+    const RadioLog& radioLog() { return radioCounters; }
+}
+
+// ================================
+// ADDRESSES
+// ================================
+BLEAddress::BLEAddress(const String& text) {
+    memset(address, 0, sizeof(address));
+    unsigned int bytes[6];
+    if (sscanf(text.c_str(), "%x:%x:%x:%x:%x:%x", &bytes[0], &bytes[1], &bytes[2], &bytes[3], &bytes[4],
+               &bytes[5]) == 6) {
+        for (int i = 0; i < 6; i++) address[i] = bytes[i];
+    }
+}
+
+String BLEAddress::toString() const {
+    char text[18];
+    snprintf(text, sizeof(text), "%02x:%02x:%02x:%02x:%02x:%02x", address[0], address[1], address[2], address[3],
+             address[4], address[5]);
+    return String(text);
+}
+
+// ================================
+// BLEDevice / BLEScan
+// ================================
+void BLEDevice::init(String deviceName) { bleInitialized = true; }
+void BLEDevice::deinit(bool releaseMemory) { bleInitialized = false; }
+BLEScan* BLEDevice::getScan() { return &scanner; }
+bool BLEDevice::getInitialized() { return bleInitialized; }
+void BLEDevice::setPower(esp_power_level_t level, esp_ble_power_type_t type) {}
+void BLEDevice::whiteListAdd(BLEAddress address) { whiteList.insert(addressKey(*address.getNative())); }
+void BLEDevice::whiteListRemove(BLEAddress address) { whiteList.erase(addressKey(*address.getNative())); }
+void BLEDevice::setCustomGapHandler(gap_event_handler handler) { gapHandler = handler; }
+
+void BLEScan::setAdvertisedDeviceCallbacks(BLEAdvertisedDeviceCallbacks* deviceCallbacks, bool wantDuplicates,
+                                          bool shouldParse) {
+    callbacks = deviceCallbacks;
+}
+
+bool BLEScan::start(uint32_t durationSeconds, void (*scanCompleteCB)(BLEScanResults), bool isContinue) {
+    if (windowOpen) return false;
+    uint32_t id = openWindow();
+    HostSim::schedule(HostSim::nowUs() + durationSeconds * 1000000ULL,
+                      [id, scanCompleteCB]() { finishScan(id, scanCompleteCB); });
+    return true;
+}
+
+BLEScanResults* BLEScan::start(uint32_t durationSeconds, bool isContinue) {
+    if (windowOpen) return &results;
+    uint32_t id = openWindow();
+    HostSim::schedule(HostSim::nowUs() + durationSeconds * 1000000ULL, [id]() { finishScan(id, nullptr); });
+    HostSim::advance(durationSeconds * 1000);
+    return &results;
+}
+
+// Like the stack: a stopped window reports nothing and never completes
+void BLEScan::stop() {
+    if (windowOpen) closeWindow();
+}
+
+// ================================
+// GAP SCANNING
+// ================================
+esp_err_t esp_ble_gap_set_scan_params(esp_ble_scan_params_t* params) {
+    gapParams = *params;
+    HostSim::schedule(HostSim::nowUs(), []() {
+        esp_ble_gap_cb_param_t param;
+        memset(&param, 0, sizeof(param));
+        if (gapHandler) gapHandler(ESP_GAP_BLE_SCAN_PARAM_SET_COMPLETE_EVT, &param);
+    });
+    return ESP_OK;
+}
+
+esp_err_t esp_ble_gap_start_scanning(uint32_t durationSeconds) {
+    if (windowOpen) return -1;
+    uint32_t id = openWindow();
+    HostSim::schedule(HostSim::nowUs() + durationSeconds * 1000000ULL, [id]() { finishGapScan(id); });
+    return ESP_OK;
+}
+
+esp_err_t esp_ble_gap_stop_scanning() {
+    if (windowOpen) closeWindow();
+    return ESP_OK;
+}
@@ -0,0 +1,296 @@
+/**
+ * Host display for ConsultEase Faculty Desk Unit: Adafruit GFX primitives,
+ * canvases and a pixel-counting ST7789
+ */
+
+#include <Adafruit_GFX.h>
+#include <Adafruit_ST7789.h>
+#include <SPI.h>
+
+#define HOST_PANEL_WIDTH 240
+#define HOST_PANEL_HEIGHT 320
+
+SPIClass SPI;
+
+namespace {
+    HostSim::DisplayLog displayCounters = {};
+
+    // Made-up 5x7 glyph columns: stable per character, blank for a space
+    uint8_t glyphColumn(unsigned char c, int column) {
+        if (c == ' ') return 0;
+        uint32_t bits = (c + 1) * 0x9E3779B1u;
+        return ((bits >> (column * 6)) & 0x7F) | (column == 0 || column == 4 ? 0x41 : 0);
+    }
+
+    void swap16(int16_t& a, int16_t& b) {
+        int16_t t = a;
+        a = b;
+        b = t;
+    }
+}
+
+namespace HostSim {
+    const DisplayLog& displayLog() { return displayCounters; }
+}
+
+// ================================
+// ADAFRUIT GFX
+// ================================
+Adafruit_GFX::Adafruit_GFX(int16_t w, int16_t h)
+    : rawWidth(w), rawHeight(h), currentWidth(w), currentHeight(h) {}
+
+void Adafruit_GFX::fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) {
+    startWrite();
+    for (int16_t i = x; i < x + w; i++) {
+        for (int16_t j = y; j < y + h; j++) drawPixel(i, j, color);
+    }
+    endWrite();
+}
+
+void Adafruit_GFX::drawFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color) { fillRect(x, y, w, 1, color); }
+void Adafruit_GFX::drawFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color) { fillRect(x, y, 1, h, color); }
+void Adafruit_GFX::fillScreen(uint16_t color) { fillRect(0, 0, currentWidth, currentHeight, color); }
+
+void Adafruit_GFX::setRotation(uint8_t r) {
+    rotation = r & 3;
+    currentWidth = rotation & 1 ? rawHeight : rawWidth;
+    currentHeight = rotation & 1 ? rawWidth : rawHeight;
+}
+
+void Adafruit_GFX::drawLine(int16_t x0, int16_t y0, int16_t x1, int16_t y1, uint16_t color) {
+    if (x0 == x1) {
+        if (y0 > y1) swap16(y0, y1);
+        drawFastVLine(x0, y0, y1 - y0 + 1, color);
+        return;
+    }
+    if (y0 == y1) {
+        if (x0 > x1) swap16(x0, x1);
+        drawFastHLine(x0, y0, x1 - x0 + 1, color);
+        return;
+    }
+
+    bool steep = abs(y1 - y0) > abs(x1 - x0);
+    if (steep) {
+        swap16(x0, y0);
+        swap16(x1, y1);
+    }
+    if (x0 > x1) {
+        swap16(x0, x1);
+        swap16(y0, y1);
+    }
+    int16_t dx = x1 - x0;
+    int16_t dy = abs(y1 - y0);
+    int16_t err = dx / 2;
+    int16_t step = y0 < y1 ? 1 : -1;
+    startWrite();
+    for (; x0 <= x1; x0++) {
+        if (steep) {
+            drawPixel(y0, x0, color);
+        } else {
+            drawPixel(x0, y0, color);
+        }
+        err -= dy;
+        if (err < 0) {
+            y0 += step;
+            err += dx;
+        }
+    }
+    endWrite();
+}
+
+void Adafruit_GFX::drawRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) {
+    drawFastHLine(x, y, w, color);
+    drawFastHLine(x, y + h - 1, w, color);
+    drawFastVLine(x, y, h, color);
+    drawFastVLine(x + w - 1, y, h, color);
+}
+
+void Adafruit_GFX::drawCircle(int16_t x0, int16_t y0, int16_t r, uint16_t color) {
+    int16_t f = 1 - r, ddx = 1, ddy = -2 * r, x = 0, y = r;
+    startWrite();
+    drawPixel(x0, y0 + r, color);
+    drawPixel(x0, y0 - r, color);
+    drawPixel(x0 + r, y0, color);
+    drawPixel(x0 - r, y0, color);
+    while (x < y) {
+        if (f >= 0) {
+            y--;
+            ddy += 2;
+            f += ddy;
+        }
+        x++;
+        ddx += 2;
+        f += ddx;
+        drawPixel(x0 + x, y0 + y, color);
+        drawPixel(x0 - x, y0 + y, color);
+        drawPixel(x0 + x, y0 - y, color);
+        drawPixel(x0 - x, y0 - y, color);
+        drawPixel(x0 + y, y0 + x, color);
+        drawPixel(x0 - y, y0 + x, color);
+        drawPixel(x0 + y, y0 - x, color);
+        drawPixel(x0 - y, y0 - x, color);
+    }
+    endWrite();
+}
+
+// Vertical spans, as the library's fillCircleHelper draws them
+void Adafruit_GFX::fillCircle(int16_t x0, int16_t y0, int16_t r, uint16_t color) {
+    startWrite();
+    drawFastVLine(x0, y0 - r, 2 * r + 1, color);
+    int16_t f = 1 - r, ddx = 1, ddy = -2 * r, x = 0, y = r, px = x, py = y;
+    while (x < y) {
+        if (f >= 0) {
+            y--;
+            ddy += 2;
+            f += ddy;
+        }
+        x++;
+        ddx += 2;
+        f += ddx;
+        if (x < y + 1) {
+            drawFastVLine(x0 + x, y0 - y, 2 * y + 1, color);
+            drawFastVLine(x0 - x, y0 - y, 2 * y + 1, color);
+        }
+        if (y != py) {
+            drawFastVLine(x0 + py, y0 - px, 2 * px + 1, color);
+            drawFastVLine(x0 - py, y0 - px, 2 * px + 1, color);
+            py = y;
+        }
+        px = x;
+    }
+    endWrite();
+}
+
+void Adafruit_GFX::drawChar(int16_t x, int16_t y, unsigned char c, uint16_t color, uint16_t bg, uint8_t size) {
+    startWrite();
+    for (int column = 0; column < 6; column++) {
+        uint8_t bits = column < 5 ? glyphColumn(c, column) : 0;
+        for (int row = 0; row < 8; row++, bits >>= 1) {
+            if (!(bits & 1) && bg == color) continue;
+            uint16_t pixel = bits & 1 ? color : bg;
+            if (size == 1) {
+                drawPixel(x + column, y + row, pixel);
+            } else {
+                fillRect(x + column * size, y + row * size, size, size, pixel);
+            }
+        }
+    }
+    endWrite();
+}
+
+size_t Adafruit_GFX::write(uint8_t c) {
+    if (c == '\n') {
+        cursorX = 0;
+        cursorY += 8 * textSize;
+    } else if (c != '\r') {
+        if (wrap && cursorX + 6 * textSize > currentWidth) {
+            cursorX = 0;
+            cursorY += 8 * textSize;
+        }
+        drawChar(cursorX, cursorY, c, textColor, textBackground, textSize);
+        cursorX += 6 * textSize;
+    }
+    return 1;
+}
+
+void Adafruit_GFX::getTextBounds(const char* text, int16_t x, int16_t y, int16_t* x1, int16_t* y1, uint16_t* w,
+                                 uint16_t* h) {
+    int lines = 1, column = 0, widest = 0;
+    for (const char* p = text; p && *p; p++) {
+        if (*p == '\n') {
+            lines++;
+            column = 0;
+        } else if (*p != '\r') {
+            widest = max(widest, ++column);
+        }
+    }
+    *x1 = x;
+    *y1 = y;
+    *w = widest * 6 * textSize;
+    *h = lines * 8 * textSize;
+}
+
+// ================================
+// CANVASES
+// ================================
+GFXcanvas1::GFXcanvas1(uint16_t w, uint16_t h) : Adafruit_GFX(w, h) {
+    buffer = (uint8_t*)calloc(((w + 7) / 8) * h, 1);
+}
+
+GFXcanvas1::~GFXcanvas1() { free(buffer); }
+
+void GFXcanvas1::drawPixel(int16_t x, int16_t y, uint16_t color) {
+    if (!buffer || x < 0 || y < 0 || x >= currentWidth || y >= currentHeight) return;
+    uint8_t* byte = &buffer[y * ((rawWidth + 7) / 8) + x / 8];
+    uint8_t mask = 0x80 >> (x & 7);
+    *byte = color ? *byte | mask : *byte & ~mask;
+}
+
+void GFXcanvas1::fillScreen(uint16_t color) {
+    if (buffer) memset(buffer, color ? 0xFF : 0x00, ((rawWidth + 7) / 8) * rawHeight);
+}
+
+bool GFXcanvas1::getPixel(int16_t x, int16_t y) const {
+    if (!buffer || x < 0 || y < 0 || x >= currentWidth || y >= currentHeight) return false;
+    return buffer[y * ((rawWidth + 7) / 8) + x / 8] & (0x80 >> (x & 7));
+}
+
+GFXcanvas16::GFXcanvas16(uint16_t w, uint16_t h) : Adafruit_GFX(w, h) {
+    buffer = (uint16_t*)calloc((size_t)w * h, sizeof(uint16_t));
+}
+
+GFXcanvas16::~GFXcanvas16() { free(buffer); }
+
+void GFXcanvas16::drawPixel(int16_t x, int16_t y, uint16_t color) {
+    if (!buffer || x < 0 || y < 0 || x >= currentWidth || y >= currentHeight) return;
+    buffer[y * rawWidth + x] = color;
+}
+
+void GFXcanvas16::fillScreen(uint16_t color) {
+    if (!buffer) return;
+    for (size_t i = 0; i < (size_t)rawWidth * rawHeight; i++) buffer[i] = color;
+}
+
+uint16_t GFXcanvas16::getPixel(int16_t x, int16_t y) const {
+    if (!buffer || x < 0 || y < 0 || x >= currentWidth || y >= currentHeight) return 0;
+    return buffer[y * rawWidth + x];
+}
+
+// ================================
+// ST7789
+// ================================
+Adafruit_ST7789::Adafruit_ST7789(int8_t cs, int8_t dc, int8_t rst)
+    : Adafruit_GFX(HOST_PANEL_WIDTH, HOST_PANEL_HEIGHT) {}
+
+Adafruit_ST7789::Adafruit_ST7789(int8_t cs, int8_t dc, int8_t mosi, int8_t sclk, int8_t rst)
+    : Adafruit_GFX(HOST_PANEL_WIDTH, HOST_PANEL_HEIGHT) {}
+
+void Adafruit_ST7789::init(uint16_t width, uint16_t height, uint8_t spiMode) {
+    rawWidth = width;
+    rawHeight = height;
+    setRotation(rotation);
+}
+
+void Adafruit_ST7789::drawPixel(int16_t x, int16_t y, uint16_t color) {
+    if (x < 0 || y < 0 || x >= currentWidth || y >= currentHeight) return;
+    displayCounters.pixelsWritten++;
+}
+
+// One address window per rectangle, clipped like the library
+void Adafruit_ST7789::fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) {
+    int16_t x0 = max<int16_t>(x, 0), y0 = max<int16_t>(y, 0);
+    int16_t x1 = min<int16_t>(x + w, currentWidth), y1 = min<int16_t>(y + h, currentHeight);
+    if (x1 <= x0 || y1 <= y0) return;
+    displayCounters.pixelsWritten += (uint64_t)(x1 - x0) * (y1 - y0);
+    if (x0 == 0 && y0 == 0 && x1 == currentWidth && y1 == currentHeight) displayCounters.fullScreenFills++;
+}
+
+void Adafruit_ST7789::fillScreen(uint16_t color) { fillRect(0, 0, currentWidth, currentHeight, color); }
+
+void Adafruit_ST7789::setAddrWindow(uint16_t x, uint16_t y, uint16_t w, uint16_t h) {}
+
+void Adafruit_ST7789::writePixels(uint16_t* colors, uint32_t length, bool block, bool bigEndian) {
+    displayCounters.pixelsWritten += length;
+}
+
+void Adafruit_ST7789::writeColor(uint16_t color, uint32_t length) { displayCounters.pixelsWritten += length; }
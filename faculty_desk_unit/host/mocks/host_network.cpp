@@ -0,0 +1,314 @@
+/**
+ * Host network for ConsultEase Faculty Desk Unit: WiFi association on the
+ * virtual clock and an in-process MQTT broker
+ */
+
+#include <Arduino.h>
+#include <WiFi.h>
+#include <PubSubClient.h>
+#include <lwip/sockets.h>
+#include <deque>
+#include <vector>
+#include <string>
+
+// Association times: cached AP and lease, cached AP with DHCP, full scan
+#define HOST_WIFI_STATIC_JOIN_MS 250
+#define HOST_WIFI_FAST_JOIN_MS 800
+#define HOST_WIFI_SCAN_JOIN_MS 2500
+#define HOST_TCP_CONNECT_MS 20
+#define HOST_MQTT_CONNACK_MS 30
+
+namespace {
+    enum WifiState { WIFI_IDLE, WIFI_JOINING, WIFI_JOINED };
+
+    bool wifiAvailable = true;
+    WifiState wifiState = WIFI_IDLE;
+    uint64_t wifiJoinedAtUs = 0;
+    bool staticConfig = false;
+    IPAddress staticIP;
+    uint8_t apBssid[6] = {0x02, 0x11, 0x22, 0x33, 0x44, 0x55};
+    int32_t apChannel = 6;
+
+    bool brokerAvailable = true;
+    uint32_t brokerGeneration = 0;    // Bumped when the broker goes away: open sockets die
+
+    struct PendingMessage {
+        std::string topic;
+        std::string payload;
+    };
+    std::deque<PendingMessage> inbound;
+
+    HostSim::MqttLog mqttCounters = {};
+    std::function<void(const char*, const uint8_t*, size_t)> publishHook;
+
+    bool wifiUp() {
+        if (wifiState == WIFI_JOINING && HostSim::nowUs() >= wifiJoinedAtUs) wifiState = WIFI_JOINED;
+        return wifiAvailable && wifiState == WIFI_JOINED;
+    }
+
+    void recordPublish(const char* topic, const uint8_t* payload, size_t length) {
+        mqttCounters.publishes++;
+        mqttCounters.publishedBytes += length;
+        if (publishHook) publishHook(topic, payload, length);
+    }
+}
+
+namespace HostSim {
+    void setWifiAvailable(bool available) {
+        wifiAvailable = available;
+        if (!available) wifiState = WIFI_IDLE;
+    }
+
+    void setBrokerAvailable(bool available) {
+        if (brokerAvailable && !available) brokerGeneration++;
+        brokerAvailable = available;
+    }
+
+    void injectMqttMessage(const char* topic, const char* payload) {
+        inbound.push_back(PendingMessage{topic, payload});
+    }
+
+    const MqttLog& mqttLog() { return mqttCounters; }
+
+    void onPublish(std::function<void(const char* topic, const uint8_t* payload, size_t length)> fn) {
+        publishHook = fn;
+    }
+}
+
+// ================================
+// WIFI
+// ================================
+WiFiClass WiFi;
+
+wl_status_t WiFiClass::begin(const char* ssid, const char* passphrase, int32_t channel, const uint8_t* bssid,
+                             bool connect) {
+    if (!wifiAvailable) {
+        wifiState = WIFI_IDLE;
+        return WL_DISCONNECTED;
+    }
+    bool cachedAp = channel == apChannel && bssid && memcmp(bssid, apBssid, sizeof(apBssid)) == 0;
+    uint32_t joinMs = !cachedAp ? HOST_WIFI_SCAN_JOIN_MS : staticConfig ? HOST_WIFI_STATIC_JOIN_MS
+                                                                        : HOST_WIFI_FAST_JOIN_MS;
+    wifiState = WIFI_JOINING;
+    wifiJoinedAtUs = HostSim::nowUs() + joinMs * 1000ULL;
+    return WL_DISCONNECTED;
+}
+
+bool WiFiClass::config(IPAddress localIP, IPAddress gateway, IPAddress subnet, IPAddress dns1, IPAddress dns2) {
+    staticConfig = (uint32_t)localIP != 0;
+    staticIP = localIP;
+    return true;
+}
+
+wl_status_t WiFiClass::status() {
+    if (wifiUp()) return WL_CONNECTED;
+    return wifiAvailable ? WL_DISCONNECTED : WL_NO_SSID_AVAIL;
+}
+
+bool WiFiClass::reconnect() {
+    begin(nullptr, nullptr, apChannel, apBssid);
+    return true;
+}
+
+bool WiFiClass::disconnect(bool wifiOff, bool eraseAp) {
+    wifiState = WIFI_IDLE;
+    return true;
+}
+
+IPAddress WiFiClass::localIP() {
+    if (!wifiUp()) return IPAddress();
+    return staticConfig ? staticIP : IPAddress(192, 168, 1, 50);
+}
+
+IPAddress WiFiClass::gatewayIP() { return wifiUp() ? IPAddress(192, 168, 1, 1) : IPAddress(); }
+IPAddress WiFiClass::subnetMask() { return wifiUp() ? IPAddress(255, 255, 255, 0) : IPAddress(); }
+IPAddress WiFiClass::dnsIP(uint8_t index) { return wifiUp() ? IPAddress(192, 168, 1, 1) : IPAddress(); }
+uint8_t* WiFiClass::BSSID() { return wifiUp() ? apBssid : nullptr; }
+int32_t WiFiClass::channel() { return wifiUp() ? apChannel : 0; }
+int8_t WiFiClass::RSSI() { return wifiUp() ? -58 : 0; }
+String WiFiClass::SSID() { return wifiUp() ? String("host-sim") : String(); }
+String WiFiClass::macAddress() { return String("A1:B2:C3:D4:E5:F6"); }
+
+// ================================
+// TCP
+// ================================
+int WiFiClient::connect(IPAddress ip, uint16_t port) { return connect("ip", port, 0); }
+int WiFiClient::connect(const char* host, uint16_t port) { return connect(host, port, 0); }
+
+// An unreachable broker costs the whole timeout, like a SYN nobody answers
+int WiFiClient::connect(const char* host, uint16_t port, int32_t timeoutMs) {
+    open = false;
+    if (!wifiUp()) return 0;
+    if (!brokerAvailable) {
+        HostSim::advance(timeoutMs > 0 ? timeoutMs : 3000);
+        return 0;
+    }
+    HostSim::advance(HOST_TCP_CONNECT_MS);
+    open = true;
+    generation = brokerGeneration;
+    return 1;
+}
+
+uint8_t WiFiClient::connected() {
+    if (open && (!wifiUp() || !brokerAvailable || generation != brokerGeneration)) open = false;
+    return open;
+}
+
+// The firmware's one socket is the broker connection: readable once
+// something was injected for it, or once it is dead
+static bool brokerSocketReadable() {
+    return !inbound.empty() || !wifiUp() || !brokerAvailable;
+}
+
+// Linked in place of select() (-Wl,--wrap=select); a task waits on the
+// virtual clock like any other FreeRTOS wait
+extern "C" int __wrap_select(int fdCount, fd_set* readSet, fd_set* writeSet, fd_set* errorSet,
+                             struct timeval* timeout) {
+    TickType_t ticks = timeout ? timeout->tv_sec * 1000 + timeout->tv_usec / 1000 : portMAX_DELAY;
+    bool readable = hostWaitUntil(brokerSocketReadable, ticks);
+    if (writeSet) FD_ZERO(writeSet);
+    if (errorSet) FD_ZERO(errorSet);
+    if (!readable && readSet) FD_ZERO(readSet);
+    return readable ? 1 : 0;
+}
+
+// ================================
+// MQTT
+// ================================
+PubSubClient& PubSubClient::setServer(const char* host, uint16_t serverPort) {
+    snprintf(domain, sizeof(domain), "%s", host ? host : "");
+    port = serverPort;
+    return *this;
+}
+
+PubSubClient& PubSubClient::setServer(IPAddress ip, uint16_t serverPort) {
+    snprintf(domain, sizeof(domain), "%u.%u.%u.%u", ip[0], ip[1], ip[2], ip[3]);
+    port = serverPort;
+    return *this;
+}
+
+PubSubClient& PubSubClient::setCallback(MQTT_CALLBACK_SIGNATURE) {
+    messageCallback = callback;
+    return *this;
+}
+
+PubSubClient& PubSubClient::setClient(Client& newClient) {
+    client = &newClient;
+    return *this;
+}
+
+bool PubSubClient::setBufferSize(uint16_t size) {
+    if (size == 0) return false;
+    bufferSize = size;
+    return true;
+}
+
+bool PubSubClient::connect(const char* id) { return connect(id, nullptr, nullptr, nullptr, 0, false, nullptr); }
+
+bool PubSubClient::connect(const char* id, const char* user, const char* pass) {
+    return connect(id, user, pass, nullptr, 0, false, nullptr);
+}
+
+// Opens the transport itself when it is not up yet, like the library
+bool PubSubClient::connect(const char* id, const char* user, const char* pass, const char* willTopic,
+                           uint8_t willQos, bool willRetain, const char* willMessage, bool cleanSession) {
+    if (connected()) return true;
+    if (!client || (!client->connected() && !client->connect(domain, port))) {
+        mqttCounters.connectFailures++;
+        connectionState = MQTT_CONNECT_FAILED;
+        return false;
+    }
+    HostSim::advance(HOST_MQTT_CONNACK_MS);
+    if (!client->connected()) {
+        mqttCounters.connectFailures++;
+        connectionState = MQTT_CONNECTION_TIMEOUT;
+        return false;
+    }
+    mqttCounters.connects++;
+    connectionState = MQTT_CONNECTED;
+    return true;
+}
+
+void PubSubClient::disconnect() {
+    connectionState = MQTT_DISCONNECTED;
+    if (client) client->stop();
+}
+
+bool PubSubClient::connected() {
+    if (connectionState != MQTT_CONNECTED) return false;
+    if (!client || !client->connected()) {
+        connectionState = MQTT_CONNECTION_LOST;
+        return false;
+    }
+    return true;
+}
+
+bool PubSubClient::publish(const char* topic, const char* payload) {
+    return publish(topic, (const uint8_t*)payload, payload ? strlen(payload) : 0, false);
+}
+
+bool PubSubClient::publish(const char* topic, const char* payload, bool retained) {
+    return publish(topic, (const uint8_t*)payload, payload ? strlen(payload) : 0, retained);
+}
+
+bool PubSubClient::publish(const char* topic, const uint8_t* payload, unsigned int length) {
+    return publish(topic, payload, length, false);
+}
+
+// Same size rule as the library: header, topic and payload in one buffer
+bool PubSubClient::publish(const char* topic, const uint8_t* payload, unsigned int length, bool retained) {
+    if (!connected() || !topic) return false;
+    if (5 + 2 + strlen(topic) + length > bufferSize) return false;
+    recordPublish(topic, payload, length);
+    return true;
+}
+
+bool PubSubClient::beginPublish(const char* topic, unsigned int length, bool retained) {
+    if (!connected() || !topic) return false;
+    streamTopic = topic;
+    streamPayload.clear();
+    streamPayload.reserve(length);
+    streamOpen = true;
+    return true;
+}
+
+size_t PubSubClient::write(uint8_t b) { return write(&b, 1); }
+
+size_t PubSubClient::write(const uint8_t* buffer, size_t size) {
+    if (!streamOpen) return 0;
+    streamPayload.append((const char*)buffer, size);
+    return size;
+}
+
+int PubSubClient::endPublish() {
+    if (!streamOpen) return 0;
+    streamOpen = false;
+    if (!connected()) return 0;
+    recordPublish(streamTopic.c_str(), (const uint8_t*)streamPayload.data(), streamPayload.size());
+    return 1;
+}
+
+bool PubSubClient::subscribe(const char* topic) { return subscribe(topic, 0); }
+
+bool PubSubClient::subscribe(const char* topic, uint8_t qos) {
+    if (!connected()) return false;
+    mqttCounters.subscribes++;
+    return true;
+}
+
+bool PubSubClient::unsubscribe(const char* topic) { return connected(); }
+
+// Hands over everything injected since the last call
+bool PubSubClient::loop() {
+    if (!connected()) return false;
+    while (!inbound.empty() && messageCallback) {
+        PendingMessage message = inbound.front();
+        inbound.pop_front();
+        std::vector<char> topic(message.topic.begin(), message.topic.end());
+        topic.push_back('\0');
+        std::vector<uint8_t> payload(message.payload.begin(), message.payload.end());
+        payload.push_back('\0');
+        messageCallback(topic.data(), payload.data(), message.payload.size());
+    }
+    return connected();
+}
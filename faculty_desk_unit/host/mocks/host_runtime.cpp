@@ -0,0 +1,709 @@
+/**
+ * Host runtime for ConsultEase Faculty Desk Unit: virtual clock, event
+ * queue, Arduino core, FreeRTOS tasks and queues, sleep and the simulated
+ * wall clock
+ */
+
+#include <Arduino.h>
+#include <esp_sleep.h>
+#include <esp_heap_caps.h>
+#include <esp_system.h>
+#include <driver/gpio.h>
+#include <hal/gpio_ll.h>
+#include <esp_pm.h>
+#include <queue>
+#include <deque>
+#include <vector>
+#include <map>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+#define HOST_NTP_SYNC_DELAY_US 300000ULL     // configTime() to the first SNTP answer
+#define HOST_PIN_COUNT 64
+
+// ================================
+// VIRTUAL CLOCK AND EVENTS
+// ================================
+namespace {
+    struct ScheduledEvent {
+        uint64_t atUs;
+        uint64_t sequence;        // Same-time events run in the order they were scheduled
+        HostSim::Event fn;
+    };
+
+    struct LaterFirst {
+        bool operator()(const ScheduledEvent& a, const ScheduledEvent& b) const {
+            return a.atUs != b.atUs ? a.atUs > b.atUs : a.sequence > b.sequence;
+        }
+    };
+
+    uint64_t clockUs = 0;
+    uint64_t eventSequence = 0;
+    std::priority_queue<ScheduledEvent, std::vector<ScheduledEvent>, LaterFirst> events;
+
+    bool serialEcho = false;
+    bool restartFlag = false;
+    uint32_t heapFree = 180000;
+    uint32_t heapLargest = 110000;
+    uint32_t heapMinimum = 180000;
+    uint32_t cpuMhz = 240;
+    uint32_t randomState = 1;
+
+    uint32_t wallEpoch = 0;
+    bool ntpConfigured = false;
+    uint64_t ntpSyncAtUs = 0;
+
+    int pinLevels[HOST_PIN_COUNT];
+    bool pinLevelsReady = false;
+    void (*pinIsrs[HOST_PIN_COUNT])(void) = {};
+    int pinIsrModes[HOST_PIN_COUNT] = {};
+    bool pinWakeLow[HOST_PIN_COUNT] = {};
+    uint64_t sleepTimerUs = 0;
+    esp_sleep_wakeup_cause_t wakeCause = ESP_SLEEP_WAKEUP_UNDEFINED;
+
+    // Buttons idle high on their pull-ups
+    int& pinLevel(uint8_t pin) {
+        if (!pinLevelsReady) {
+            for (int i = 0; i < HOST_PIN_COUNT; i++) pinLevels[i] = HIGH;
+            pinLevelsReady = true;
+        }
+        return pinLevels[pin % HOST_PIN_COUNT];
+    }
+
+    bool wakePinLow() {
+        for (int i = 0; i < HOST_PIN_COUNT; i++) {
+            if (pinWakeLow[i] && pinLevel(i) == LOW) return true;
+        }
+        return false;
+    }
+
+    bool ntpSynced() {
+        return wallEpoch != 0 && ntpConfigured && clockUs >= ntpSyncAtUs;
+    }
+
+    uint64_t wallClockUs() {
+        return ntpSynced() ? (uint64_t)wallEpoch * 1000000ULL + clockUs : clockUs;
+    }
+
+    uint32_t nextRandom() {
+        // xorshift32: fast, and the same sequence on every run
+        randomState ^= randomState << 13;
+        randomState ^= randomState >> 17;
+        randomState ^= randomState << 5;
+        return randomState;
+    }
+}
+
+namespace HostSim {
+    uint64_t nowUs() { return clockUs; }
+    uint32_t nowMs() { return clockUs / 1000; }
+
+    void advanceTo(uint64_t us) {
+        while (!events.empty() && events.top().atUs <= us) {
+            ScheduledEvent event = events.top();
+            events.pop();
+            if (event.atUs > clockUs) clockUs = event.atUs;
+            event.fn();
+        }
+        if (us > clockUs) clockUs = us;
+    }
+
+    void advance(uint32_t ms) { advanceTo(clockUs + (uint64_t)ms * 1000); }
+
+    void schedule(uint64_t atUs, Event fn) {
+        events.push(ScheduledEvent{max(atUs, clockUs), eventSequence++, fn});
+    }
+
+    bool hasEvents() { return !events.empty(); }
+    uint64_t nextEventUs() { return events.empty() ? UINT64_MAX : events.top().atUs; }
+
+    void clearEvents() {
+        while (!events.empty()) events.pop();
+    }
+
+    void setSerialEcho(bool echo) { serialEcho = echo; }
+    void setEpoch(uint32_t epochSeconds) { wallEpoch = epochSeconds; }
+
+    void setPin(uint8_t pin, int level) {
+        int& current = pinLevel(pin);
+        if (current == level) return;
+        current = level;
+
+        uint8_t index = pin % HOST_PIN_COUNT;
+        int mode = pinIsrModes[index];
+        bool fire = mode == CHANGE || (mode == FALLING && level == LOW) || (mode == RISING && level == HIGH);
+        if (pinIsrs[index] && fire) pinIsrs[index]();
+    }
+
+    void setHeap(uint32_t freeBytes, uint32_t largestBlock) {
+        heapFree = freeBytes;
+        heapLargest = largestBlock;
+        heapMinimum = min(heapMinimum, freeBytes);
+    }
+
+    bool restartRequested() { return restartFlag; }
+}
+
+// ================================
+// ARDUINO CORE
+// ================================
+HardwareSerial Serial;
+EspClass ESP;
+
+size_t HardwareSerial::write(uint8_t c) {
+    if (serialEcho) fputc(c, stdout);
+    return 1;
+}
+
+size_t HardwareSerial::write(const uint8_t* buffer, size_t size) {
+    if (serialEcho) fwrite(buffer, 1, size, stdout);
+    return size;
+}
+
+void HardwareSerial::flush() {
+    if (serialEcho) fflush(stdout);
+}
+
+size_t Print::write(const uint8_t* buffer, size_t size) {
+    size_t written = 0;
+    while (size--) written += write(*buffer++);
+    return written;
+}
+
+size_t Print::printf(const char* format, ...) {
+    char small[256];
+    va_list args;
+    va_start(args, format);
+    int length = vsnprintf(small, sizeof(small), format, args);
+    va_end(args);
+    if (length < 0) return 0;
+    if ((size_t)length < sizeof(small)) return write((const uint8_t*)small, length);
+
+    std::vector<char> large(length + 1);
+    va_start(args, format);
+    vsnprintf(large.data(), large.size(), format, args);
+    va_end(args);
+    return write((const uint8_t*)large.data(), length);
+}
+
+std::string String::format(long long v, int base) {
+    if (base == DEC) return std::to_string(v);
+    return format((unsigned long long)v, base);
+}
+
+std::string String::format(unsigned long long v, int base) {
+    if (base == DEC) return std::to_string(v);
+    std::string out;
+    do {
+        int digit = v % base;
+        out.insert(out.begin(), digit < 10 ? '0' + digit : 'a' + digit - 10);
+        v /= base;
+    } while (v);
+    return out;
+}
+
+std::string String::formatFloat(double v, int decimals) {
+    char buffer[64];
+    snprintf(buffer, sizeof(buffer), "%.*f", decimals, v);
+    return buffer;
+}
+
+void String::trim() {
+    size_t start = value.find_first_not_of(" \t\r\n");
+    if (start == std::string::npos) {
+        value.clear();
+        return;
+    }
+    size_t end = value.find_last_not_of(" \t\r\n");
+    value = value.substr(start, end - start + 1);
+}
+
+int String::indexOf(char c, unsigned int from) const {
+    size_t at = value.find(c, from);
+    return at == std::string::npos ? -1 : (int)at;
+}
+
+int String::indexOf(const String& s, unsigned int from) const {
+    size_t at = value.find(s.value, from);
+    return at == std::string::npos ? -1 : (int)at;
+}
+
+unsigned long millis() { return clockUs / 1000; }
+unsigned long micros() { return (unsigned long)clockUs; }
+void delay(unsigned long ms) { vTaskDelay(ms); }
+void delayMicroseconds(unsigned int us) { HostSim::advanceTo(clockUs + us); }
+void yield() {}
+
+long random(long howBig) { return howBig > 0 ? nextRandom() % howBig : 0; }
+long random(long howSmall, long howBig) { return howBig > howSmall ? howSmall + random(howBig - howSmall) : howSmall; }
+void randomSeed(unsigned long seed) { randomState = seed ? seed : 1; }
+
+void pinMode(uint8_t pin, uint8_t mode) {}
+int digitalRead(uint8_t pin) { return pinLevel(pin); }
+void digitalWrite(uint8_t pin, uint8_t level) { pinLevel(pin) = level; }
+int analogRead(uint8_t pin) { return 2048; }
+void analogWrite(uint8_t pin, int value) {}
+
+void attachInterrupt(uint8_t pin, void (*isr)(void), int mode) {
+    pinIsrs[pin % HOST_PIN_COUNT] = isr;
+    pinIsrModes[pin % HOST_PIN_COUNT] = mode;
+}
+
+void detachInterrupt(uint8_t pin) { pinIsrs[pin % HOST_PIN_COUNT] = nullptr; }
+
+uint32_t getCpuFrequencyMhz() { return cpuMhz; }
+
+bool setCpuFrequencyMhz(uint32_t mhz) {
+    cpuMhz = mhz;
+    return true;
+}
+
+uint32_t EspClass::getFreeHeap() { return heapFree; }
+uint32_t EspClass::getMinFreeHeap() { return heapMinimum; }
+uint32_t EspClass::getMaxAllocHeap() { return heapLargest; }
+uint32_t EspClass::getHeapSize() { return 320 * 1024; }
+uint32_t EspClass::getFreePsram() { return 0; }
+uint32_t EspClass::getCycleCount() { return (uint32_t)(clockUs * cpuMhz); }
+uint64_t EspClass::getEfuseMac() { return 0x0000A1B2C3D4E5F6ULL; }
+
+void EspClass::restart() {
+    Serial.println("[host] ESP.restart() requested");
+    restartFlag = true;
+}
+
+void* heap_caps_malloc(size_t size, uint32_t caps) { return malloc(size); }
+void heap_caps_free(void* ptr) { free(ptr); }
+size_t heap_caps_get_free_size(uint32_t caps) { return heapFree; }
+size_t heap_caps_get_minimum_free_size(uint32_t caps) { return heapMinimum; }
+size_t heap_caps_get_largest_free_block(uint32_t caps) { return heapLargest; }
+
+int esp_read_mac(uint8_t* mac, esp_mac_type_t type) {
+    uint64_t efuse = ESP.getEfuseMac();
+    for (int i = 0; i < 6; i++) mac[i] = efuse >> (8 * (5 - i));
+    mac[5] += (uint8_t)type;
+    return 0;
+}
+
+uint32_t esp_random() { return nextRandom(); }
+
+void esp_fill_random(void* buffer, size_t length) {
+    uint8_t* bytes = (uint8_t*)buffer;
+    while (length--) *bytes++ = (uint8_t)nextRandom();
+}
+
+// ================================
+// SLEEP AND GPIO WAKE
+// ================================
+esp_err_t esp_sleep_enable_timer_wakeup(uint64_t timeUs) {
+    sleepTimerUs = timeUs;
+    return ESP_OK;
+}
+
+esp_err_t esp_sleep_enable_gpio_wakeup() { return ESP_OK; }
+
+esp_err_t esp_sleep_disable_wakeup_source(esp_sleep_source_t source) {
+    if (source == ESP_SLEEP_WAKEUP_TIMER || source == ESP_SLEEP_WAKEUP_ALL) sleepTimerUs = 0;
+    return ESP_OK;
+}
+
+// Sleeps to the timer, or until an event pulls a wake pin low
+esp_err_t esp_light_sleep_start() {
+    uint64_t deadline = clockUs + sleepTimerUs;
+    wakeCause = ESP_SLEEP_WAKEUP_TIMER;
+    while (!wakePinLow()) {
+        uint64_t next = HostSim::nextEventUs();
+        if (next > deadline) {
+            HostSim::advanceTo(deadline);
+            return ESP_OK;
+        }
+        HostSim::advanceTo(next);
+    }
+    wakeCause = ESP_SLEEP_WAKEUP_GPIO;
+    return ESP_OK;
+}
+
+esp_sleep_wakeup_cause_t esp_sleep_get_wakeup_cause() { return wakeCause; }
+
+esp_err_t gpio_set_level(gpio_num_t pin, uint32_t level) {
+    pinLevel(pin) = level;
+    return ESP_OK;
+}
+
+esp_err_t gpio_wakeup_enable(gpio_num_t pin, gpio_int_type_t type) {
+    pinWakeLow[pin % HOST_PIN_COUNT] = type == GPIO_INTR_LOW_LEVEL;
+    return ESP_OK;
+}
+
+esp_err_t gpio_wakeup_disable(gpio_num_t pin) {
+    pinWakeLow[pin % HOST_PIN_COUNT] = false;
+    return ESP_OK;
+}
+
+esp_err_t gpio_set_intr_type(gpio_num_t pin, gpio_int_type_t type) { return ESP_OK; }
+
+gpio_dev_t GPIO;
+
+// ================================
+// POWER MANAGEMENT
+// ================================
+struct esp_pm_lock {
+    const char* name;
+    int count;
+};
+
+esp_err_t esp_pm_configure(const void* config) { return ESP_OK; }
+
+esp_err_t esp_pm_lock_create(esp_pm_lock_type_t type, int arg, const char* name, esp_pm_lock_handle_t* handle) {
+    *handle = new esp_pm_lock{ name, 0 };
+    return ESP_OK;
+}
+
+esp_err_t esp_pm_lock_acquire(esp_pm_lock_handle_t handle) {
+    handle->count++;
+    return ESP_OK;
+}
+
+esp_err_t esp_pm_lock_release(esp_pm_lock_handle_t handle) {
+    if (handle->count == 0) return ESP_ERR_INVALID_STATE;
+    handle->count--;
+    return ESP_OK;
+}
+
+// ================================
+// WALL CLOCK
+// ================================
+// time() and gettimeofday() are wrapped at link time (-Wl,--wrap); before
+// SNTP has answered they count from boot, like the ESP32
+extern "C" time_t __wrap_time(time_t* out) {
+    time_t now = wallClockUs() / 1000000ULL;
+    if (out) *out = now;
+    return now;
+}
+
+extern "C" int __wrap_gettimeofday(struct timeval* tv, void* tz) {
+    uint64_t now = wallClockUs();
+    if (tv) {
+        tv->tv_sec = now / 1000000ULL;
+        tv->tv_usec = now % 1000000ULL;
+    }
+    return 0;
+}
+
+void configTime(long gmtOffsetSec, int daylightOffsetSec, const char* server1, const char* server2,
+                const char* server3) {
+    // POSIX TZ offsets are west-positive
+    char tz[32];
+    long offset = -(gmtOffsetSec + daylightOffsetSec);
+    snprintf(tz, sizeof(tz), "UTC%+ld:%02ld", offset / 3600, labs(offset % 3600) / 60);
+    configTzTime(tz, server1, server2, server3);
+}
+
+void configTzTime(const char* tz, const char* server1, const char* server2, const char* server3) {
+    setenv("TZ", tz, 1);
+    tzset();
+    if (!ntpConfigured) {
+        ntpConfigured = true;
+        ntpSyncAtUs = clockUs + HOST_NTP_SYNC_DELAY_US;
+    }
+}
+
+// Like the core: waits up to ms for the clock to be set
+bool getLocalTime(struct tm* info, uint32_t ms) {
+    if (!ntpSynced()) {
+        uint64_t limit = clockUs + (uint64_t)ms * 1000;
+        if (wallEpoch != 0 && ntpConfigured) limit = min(limit, ntpSyncAtUs);
+        HostSim::advanceTo(limit);
+    }
+    if (!ntpSynced()) return false;
+    time_t now = __wrap_time(nullptr);
+    localtime_r(&now, info);
+    return true;
+}
+
+// ================================
+// FREERTOS
+// ================================
+// Tasks are threads that take turns: exactly one of them, or the main
+// thread, runs at any time. A task gives up its turn only when it blocks,
+// and the main thread - inside loop()'s vTaskDelay - hands the turn to the
+// highest-priority task that can go on, oldest turn first. With none left
+// the virtual clock moves to the next wake-up or event. Only the clock
+// decides the interleaving, so task-mode runs are as repeatable as the rest.
+struct HostQueue {
+    std::deque<std::vector<uint8_t>> items;
+    UBaseType_t length;
+    UBaseType_t itemSize;
+};
+
+struct HostMutex {
+    bool taken;
+};
+
+namespace {
+    enum TaskWait { WAIT_NONE, WAIT_TIME, WAIT_RECEIVE, WAIT_SEND, WAIT_NOTIFY, WAIT_MUTEX, WAIT_CONDITION, WAIT_EXITED };
+
+    struct HostTask {
+        TaskFunction_t fn;
+        void* parameter;
+        UBaseType_t priority;
+        BaseType_t core;
+        TaskWait wait;
+        uint64_t wakeUs;          // Timeout of the wait; UINT64_MAX = none
+        HostQueue* queue;
+        HostMutex* mutex;
+        bool (*ready)();          // WAIT_CONDITION only
+        uint32_t notifications;
+        uint64_t lastTurn;
+    };
+
+    bool taskRuntimeEnabled = false;
+    std::vector<HostTask*> tasks;
+    thread_local HostTask* currentTask = nullptr;   // nullptr on the main thread
+    HostTask* turnHolder = nullptr;
+    uint64_t turnSequence = 0;
+    std::mutex turnLock;
+    std::condition_variable turnChanged;
+
+    uint64_t wakeAfter(TickType_t ticks) {
+        return ticks == portMAX_DELAY ? UINT64_MAX : clockUs + (uint64_t)ticks * 1000;
+    }
+
+    // Gives the turn to next (nullptr = main thread) and waits for it to come back
+    void passTurn(HostTask* next) {
+        HostTask* self = currentTask;
+        std::unique_lock<std::mutex> lock(turnLock);
+        turnHolder = next;
+        turnChanged.notify_all();
+        turnChanged.wait(lock, [self]() { return turnHolder == self; });
+    }
+
+    // Called by a task: sleeps until the main thread finds it can go on
+    void blockTask(TaskWait wait, uint64_t wakeUs, HostQueue* queue = nullptr, HostMutex* mutex = nullptr) {
+        currentTask->wait = wait;
+        currentTask->wakeUs = wakeUs;
+        currentTask->queue = queue;
+        currentTask->mutex = mutex;
+        passTurn(nullptr);
+        currentTask->wait = WAIT_NONE;
+    }
+
+    bool canRun(const HostTask* task) {
+        bool timedOut = clockUs >= task->wakeUs;
+        switch (task->wait) {
+            case WAIT_NONE: return true;
+            case WAIT_TIME: return timedOut;
+            case WAIT_RECEIVE: return timedOut || !task->queue->items.empty();
+            case WAIT_SEND: return timedOut || task->queue->items.size() < task->queue->length;
+            case WAIT_NOTIFY: return timedOut || task->notifications > 0;
+            case WAIT_MUTEX: return timedOut || !task->mutex->taken;
+            case WAIT_CONDITION: return timedOut || task->ready();
+            default: return false;
+        }
+    }
+
+    void taskMain(HostTask* task) {
+        {
+            std::unique_lock<std::mutex> lock(turnLock);
+            turnChanged.wait(lock, [task]() { return turnHolder == task; });
+        }
+        currentTask = task;
+        task->fn(task->parameter);
+        task->wait = WAIT_EXITED;
+        passTurn(nullptr);
+    }
+
+    // One round on the main thread: every task runs until it blocks, then
+    // the clock moves to whatever comes first
+    void runTasks() {
+        for (;;) {
+            HostTask* next = nullptr;
+            for (HostTask* task : tasks) {
+                if (!canRun(task)) continue;
+                if (!next || task->priority > next->priority ||
+                    (task->priority == next->priority && task->lastTurn < next->lastTurn)) {
+                    next = task;
+                }
+            }
+            if (!next) break;
+            next->lastTurn = ++turnSequence;
+            passTurn(next);
+        }
+
+        uint64_t wakeUs = HostSim::nextEventUs();
+        for (HostTask* task : tasks) {
+            if (task->wait != WAIT_EXITED) wakeUs = min(wakeUs, task->wakeUs);
+        }
+        if (wakeUs != UINT64_MAX) HostSim::advanceTo(wakeUs);
+    }
+}
+
+namespace HostSim {
+    void setTaskRuntime(bool enabled) { taskRuntimeEnabled = enabled; }
+}
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t task, const char* name, uint32_t stackDepth, void* parameter,
+                                   UBaseType_t priority, TaskHandle_t* handle, BaseType_t core) {
+    if (!taskRuntimeEnabled) return pdFAIL;
+    HostTask* created = new HostTask{task, parameter, priority, core, WAIT_NONE, UINT64_MAX, nullptr, nullptr, nullptr, 0, 0};
+    tasks.push_back(created);
+    std::thread(taskMain, created).detach();
+    if (handle) *handle = created;
+    return pdPASS;
+}
+
+// On the main thread this is loop() handing over to the tasks
+void vTaskDelay(TickType_t ticks) {
+    if (currentTask) {
+        blockTask(WAIT_TIME, wakeAfter(ticks));
+    } else if (!tasks.empty()) {
+        runTasks();
+    } else if (ticks != portMAX_DELAY) {
+        HostSim::advance(ticks);
+    }
+}
+
+void vTaskDelete(TaskHandle_t task) {}
+
+void vTaskDelayUntil(TickType_t* previousWake, TickType_t period) {
+    *previousWake += period;
+    if ((int32_t)(*previousWake - millis()) > 0) vTaskDelay(*previousWake - millis());
+}
+
+TickType_t xTaskGetTickCount() { return millis(); }
+UBaseType_t uxTaskGetStackHighWaterMark(TaskHandle_t task) { return 4096; }
+BaseType_t xPortGetCoreID() { return currentTask ? currentTask->core : 1; }
+
+void xTaskNotifyGive(TaskHandle_t task) {
+    if (task) static_cast<HostTask*>(task)->notifications++;
+}
+
+void vTaskNotifyGiveFromISR(TaskHandle_t task, BaseType_t* woken) {
+    xTaskNotifyGive(task);
+    if (woken) *woken = pdFALSE;
+}
+
+uint32_t ulTaskNotifyTake(BaseType_t clearOnExit, TickType_t ticks) {
+    if (!currentTask) {
+        vTaskDelay(ticks);
+        return 0;
+    }
+    if (currentTask->notifications == 0 && ticks > 0) blockTask(WAIT_NOTIFY, wakeAfter(ticks));
+    uint32_t value = currentTask->notifications;
+    if (clearOnExit) {
+        currentTask->notifications = 0;
+    } else if (value > 0) {
+        currentTask->notifications--;
+    }
+    return value;
+}
+
+QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t itemSize) {
+    HostQueue* queue = new HostQueue();
+    queue->length = length;
+    queue->itemSize = itemSize;
+    return queue;
+}
+
+void vQueueDelete(QueueHandle_t queue) { delete queue; }
+
+static BaseType_t queuePut(QueueHandle_t queue, const void* item, bool front) {
+    if (!queue || queue->items.size() >= queue->length) return pdFALSE;
+    const uint8_t* bytes = (const uint8_t*)item;
+    std::vector<uint8_t> copy(bytes, bytes + queue->itemSize);
+    if (front) {
+        queue->items.push_front(copy);
+    } else {
+        queue->items.push_back(copy);
+    }
+    return pdTRUE;
+}
+
+// Outside a task nobody else runs while the sender waits, so a full queue stays full
+static BaseType_t queueSend(QueueHandle_t queue, const void* item, TickType_t ticks, bool front) {
+    if (queue && currentTask) {
+        uint64_t wakeUs = wakeAfter(ticks);
+        while (queue->items.size() >= queue->length && ticks > 0 && clockUs < wakeUs) {
+            blockTask(WAIT_SEND, wakeUs, queue);
+        }
+    }
+    return queuePut(queue, item, front);
+}
+
+BaseType_t xQueueSend(QueueHandle_t queue, const void* item, TickType_t ticks) { return queueSend(queue, item, ticks, false); }
+BaseType_t xQueueSendToFront(QueueHandle_t queue, const void* item, TickType_t ticks) { return queueSend(queue, item, ticks, true); }
+
+BaseType_t xQueueSendFromISR(QueueHandle_t queue, const void* item, BaseType_t* woken) {
+    if (woken) *woken = pdFALSE;
+    return queuePut(queue, item, false);
+}
+
+// Waiting is where virtual time passes: a task blocks until another posts
+// or the timeout is reached; outside the task runtime, events run until one
+// of them posts
+BaseType_t xQueueReceive(QueueHandle_t queue, void* item, TickType_t ticks) {
+    if (!queue) return pdFALSE;
+    uint64_t deadline = wakeAfter(ticks);
+    while (queue->items.empty()) {
+        if (currentTask) {
+            if (ticks == 0 || clockUs >= deadline) return pdFALSE;
+            blockTask(WAIT_RECEIVE, deadline, queue);
+            continue;
+        }
+        uint64_t next = HostSim::nextEventUs();
+        if (next == UINT64_MAX && deadline == UINT64_MAX) return pdFALSE;
+        if (next > deadline) {
+            HostSim::advanceTo(deadline);
+            return pdFALSE;
+        }
+        HostSim::advanceTo(next);
+    }
+    memcpy(item, queue->items.front().data(), queue->itemSize);
+    queue->items.pop_front();
+    return pdTRUE;
+}
+
+BaseType_t xQueueOverwrite(QueueHandle_t queue, const void* item) {
+    if (!queue) return pdFALSE;
+    if (!queue->items.empty()) queue->items.pop_back();
+    return queuePut(queue, item, false);
+}
+
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t queue) { return queue ? queue->items.size() : 0; }
+
+BaseType_t xQueueReset(QueueHandle_t queue) {
+    if (queue) queue->items.clear();
+    return pdTRUE;
+}
+
+// Without HostSim::setTaskRuntime() there is no mutex: startTaskRuntime()
+// sees the failure and stays in loop() mode
+SemaphoreHandle_t xSemaphoreCreateMutex() {
+    return taskRuntimeEnabled ? new HostMutex{false} : nullptr;
+}
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t semaphore, TickType_t ticks) {
+    HostMutex* mutex = static_cast<HostMutex*>(semaphore);
+    if (!mutex) return pdTRUE;
+    uint64_t wakeUs = wakeAfter(ticks);
+    while (mutex->taken) {
+        if (!currentTask || ticks == 0 || clockUs >= wakeUs) return pdFALSE;
+        blockTask(WAIT_MUTEX, wakeUs, nullptr, mutex);
+    }
+    mutex->taken = true;
+    return pdTRUE;
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t semaphore) {
+    HostMutex* mutex = static_cast<HostMutex*>(semaphore);
+    if (mutex) mutex->taken = false;
+    return pdTRUE;
+}
+
+bool hostWaitUntil(bool (*ready)(), TickType_t ticks) {
+    if (!currentTask) return ready();
+    uint64_t wakeUs = wakeAfter(ticks);
+    currentTask->ready = ready;
+    while (!ready() && clockUs < wakeUs) blockTask(WAIT_CONDITION, wakeUs);
+    return ready();
+}
@@ -0,0 +1,92 @@
+/**
+ * Host simulation controls for ConsultEase Faculty Desk Unit
+ * The mocks run the firmware on a virtual clock: it only moves through
+ * delay(), the FreeRTOS waits and advance(), so a simulated day takes
+ * milliseconds and every run is repeatable. Scheduled events stand in for
+ * the radio and the broker; they fire while the firmware waits.
+ */
+
+#ifndef HOST_SIM_H
+#define HOST_SIM_H
+
+#include <cstdint>
+#include <cstddef>
+#include <functional>
+
+namespace HostSim {
+    typedef std::function<void()> Event;
+
+    // Virtual clock
+    uint64_t nowUs();
+    uint32_t nowMs();
+    // Runs every event due on the way
+    void advance(uint32_t ms);
+    void advanceTo(uint64_t us);
+
+    // Runs fn at the given virtual time (never earlier than now)
+    void schedule(uint64_t atUs, Event fn);
+    bool hasEvents();
+    uint64_t nextEventUs();       // UINT64_MAX when none
+    void clearEvents();
+
+    // Serial output goes to stdout when set; dropped otherwise
+    void setSerialEcho(bool echo);
+
+    // Wall clock for the simulated time() / getLocalTime(); 0 = NTP never syncs
+    void setEpoch(uint32_t epochSeconds);
+
+    // Network: WiFi association and broker reachability
+    void setWifiAvailable(bool available);
+    void setBrokerAvailable(bool available);
+    // Delivered on the next PubSubClient::loop()
+    void injectMqttMessage(const char* topic, const char* payload);
+
+    struct MqttLog {
+        uint32_t connects;
+        uint32_t connectFailures;
+        uint32_t publishes;
+        uint32_t publishedBytes;
+        uint32_t subscribes;
+    };
+    const MqttLog& mqttLog();
+    // Called for every publish, after it is counted
+    void onPublish(std::function<void(const char* topic, const uint8_t* payload, size_t length)> fn);
+
+    // BLE radio. A window opened by BLEScan::start or the GAP scan API fills
+    // from the sighting source when it closes, then completes like the real
+    // stack: advertisements through the callbacks, then the completion event.
+    struct Advertisement {
+        uint8_t address[6];
+        int rssi;
+    };
+    typedef std::function<size_t(uint64_t fromUs, uint64_t toUs, Advertisement* out, size_t capacity)> SightingSource;
+    void setSightingSource(SightingSource source);
+
+    struct RadioLog {
+        uint32_t windows;
+        uint64_t listenUs;
+        uint32_t advertisementsDelivered;
+    };
+    const RadioLog& radioLog();
+
+    // Buttons are active low with pull-ups: pressed = LOW
+    void setPin(uint8_t pin, int level);
+
+    struct DisplayLog {
+        uint64_t pixelsWritten;       // Through drawPixel/fillRect/writePixels on the panel
+        uint32_t fullScreenFills;
+    };
+    const DisplayLog& displayLog();
+
+    // Simulated heap figures reported by ESP / heap_caps
+    void setHeap(uint32_t freeBytes, uint32_t largestBlock);
+
+    // Lets startTaskRuntime() succeed; call before setup(). Tasks then run
+    // one at a time and loop() hands over to them on every call.
+    void setTaskRuntime(bool enabled);
+
+    // ESP.restart() in the simulation: logged, then the run stops
+    bool restartRequested();
+}
+
+#endif // HOST_SIM_H
@@ -0,0 +1,177 @@
+/**
+ * Host storage for ConsultEase Faculty Desk Unit: NVS and LittleFS in
+ * memory, gone when the process exits
+ */
+
+#include <Preferences.h>
+#include <LittleFS.h>
+#include <map>
+
+namespace {
+    std::map<std::string, std::vector<uint8_t>> nvs;
+}
+
+// ================================
+// PREFERENCES
+// ================================
+bool Preferences::begin(const char* name, bool openReadOnly) {
+    if (!name || !*name) return false;
+    space = name;
+    readOnly = openReadOnly;
+    opened = true;
+    return true;
+}
+
+bool Preferences::clear() {
+    if (!opened || readOnly) return false;
+    std::string prefix = space + "/";
+    for (auto it = nvs.begin(); it != nvs.end();) {
+        it = it->first.compare(0, prefix.size(), prefix) == 0 ? nvs.erase(it) : std::next(it);
+    }
+    return true;
+}
+
+bool Preferences::remove(const char* key) {
+    if (!opened || readOnly) return false;
+    return nvs.erase(qualified(key)) > 0;
+}
+
+bool Preferences::isKey(const char* key) { return opened && nvs.count(qualified(key)) > 0; }
+
+size_t Preferences::putBytes(const char* key, const void* value, size_t length) {
+    if (!opened || readOnly || !key) return 0;
+    const uint8_t* bytes = (const uint8_t*)value;
+    nvs[qualified(key)] = std::vector<uint8_t>(bytes, bytes + length);
+    return length;
+}
+
+size_t Preferences::getBytes(const char* key, void* buffer, size_t length) {
+    if (!opened || !key) return 0;
+    auto it = nvs.find(qualified(key));
+    if (it == nvs.end() || it->second.size() > length) return 0;
+    memcpy(buffer, it->second.data(), it->second.size());
+    return it->second.size();
+}
+
+size_t Preferences::getBytesLength(const char* key) {
+    if (!opened || !key) return 0;
+    auto it = nvs.find(qualified(key));
+    return it == nvs.end() ? 0 : it->second.size();
+}
+
+size_t Preferences::putString(const char* key, const char* value) {
+    if (!value) return 0;
+    return putBytes(key, value, strlen(value) + 1) ? strlen(value) : 0;
+}
+
+size_t Preferences::getString(const char* key, char* buffer, size_t length) {
+    size_t stored = getBytesLength(key);
+    if (stored == 0 || stored > length) return 0;
+    return getBytes(key, buffer, length);
+}
+
+String Preferences::getString(const char* key, const String& defaultValue) {
+    size_t stored = getBytesLength(key);
+    if (stored == 0) return defaultValue;
+    std::vector<char> text(stored);
+    getBytes(key, text.data(), stored);
+    text.back() = '\0';
+    return String(text.data());
+}
+
+// ================================
+// FILES
+// ================================
+LittleFSFS LittleFS;
+
+namespace fs {
+
+size_t File::write(const uint8_t* buffer, size_t size) {
+    if (!data || !writable) return 0;
+    if (cursor + size > data->size()) data->resize(cursor + size);
+    memcpy(data->data() + cursor, buffer, size);
+    cursor += size;
+    return size;
+}
+
+size_t File::read(uint8_t* buffer, size_t size) {
+    if (!data || cursor >= data->size()) return 0;
+    size_t count = min(size, data->size() - cursor);
+    memcpy(buffer, data->data() + cursor, count);
+    cursor += count;
+    return count;
+}
+
+int File::read() {
+    uint8_t b;
+    return read(&b, 1) == 1 ? b : -1;
+}
+
+int File::peek() {
+    if (!data || cursor >= data->size()) return -1;
+    return (*data)[cursor];
+}
+
+int File::available() { return data && cursor < data->size() ? data->size() - cursor : 0; }
+
+bool File::seek(uint32_t target) {
+    if (!data || target > data->size()) return false;
+    cursor = target;
+    return true;
+}
+
+std::shared_ptr<FileData>* FS::find(const char* path) {
+    for (auto& file : files) {
+        if (file.first == path) return &file.second;
+    }
+    return nullptr;
+}
+
+// Like LittleFS, writing replaces the file object: readers keep the old data
+File FS::open(const char* path, const char* mode, bool create) {
+    if (!path) return File();
+    std::shared_ptr<FileData>* existing = find(path);
+
+    if (mode[0] == 'r') {
+        return existing ? File(*existing, false, 0) : File();
+    }
+    if (mode[0] == 'w' || !existing) {
+        std::shared_ptr<FileData> data = std::make_shared<FileData>();
+        if (existing) {
+            *existing = data;
+        } else {
+            files.push_back(std::make_pair(std::string(path), data));
+        }
+        return File(data, true, data->size());
+    }
+    return File(*existing, true, (*existing)->size());
+}
+
+bool FS::exists(const char* path) { return path && find(path); }
+
+bool FS::remove(const char* path) {
+    for (auto it = files.begin(); it != files.end(); ++it) {
+        if (it->first == path) {
+            files.erase(it);
+            return true;
+        }
+    }
+    return false;
+}
+
+bool FS::rename(const char* from, const char* to) {
+    if (!find(from)) return false;
+    remove(to);
+    for (auto& file : files) {
+        if (file.first == from) file.first = to;
+    }
+    return true;
+}
+
+} // namespace fs
+
+size_t LittleFSFS::usedBytes() {
+    size_t used = 0;
+    for (auto& file : files) used += file.second->size();
+    return used;
+}
@@ -0,0 +1,13 @@
+/**
+ * lwIP sockets for the host build. The firmware only select()s on the MQTT
+ * socket; the link wraps select() so it sees the in-process broker (see
+ * host_network.cpp).
+ */
+
+#ifndef HOST_LWIP_SOCKETS_H
+#define HOST_LWIP_SOCKETS_H
+
+#include <sys/select.h>
+#include <sys/time.h>
+
+#endif // HOST_LWIP_SOCKETS_H
@@ -0,0 +1,10 @@
+/**
+ * mbedTLS key type for the host build (type only)
+ */
+
+#ifndef HOST_MBEDTLS_PK_H
+#define HOST_MBEDTLS_PK_H
+
+typedef struct { unsigned char opaque[64]; } mbedtls_pk_context;
+
+#endif // HOST_MBEDTLS_PK_H
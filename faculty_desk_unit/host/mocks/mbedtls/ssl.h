@@ -0,0 +1,16 @@
+/**
+ * mbedTLS types for the host build. The TLS transport is not compiled on
+ * the host (MQTT_USE_TLS is off there); its header only needs the types.
+ */
+
+#ifndef HOST_MBEDTLS_SSL_H
+#define HOST_MBEDTLS_SSL_H
+
+#include "x509_crt.h"
+#include "pk.h"
+
+typedef struct { unsigned char opaque[64]; } mbedtls_ssl_session;
+typedef struct { unsigned char opaque[64]; } mbedtls_ssl_config;
+typedef struct { unsigned char opaque[64]; } mbedtls_ssl_context;
+
+#endif // HOST_MBEDTLS_SSL_H
@@ -0,0 +1,10 @@
+/**
+ * mbedTLS certificate type for the host build (type only)
+ */
+
+#ifndef HOST_MBEDTLS_X509_CRT_H
+#define HOST_MBEDTLS_X509_CRT_H
+
+typedef struct { unsigned char opaque[64]; } mbedtls_x509_crt;
+
+#endif // HOST_MBEDTLS_X509_CRT_H
@@ -0,0 +1,116 @@
+/**
+ * Beacon registry implementation for ConsultEase Faculty Desk Unit
+ */
+
+#include "beacon_registry.h"
+#include <string.h>
+#include <stdio.h>
+
+#define BEACON_ADDRESS_MASK 0xFFFFFFFFFFFFULL
+
+BeaconRegistry::BeaconRegistry() {
+    clear();
+}
+
+void BeaconRegistry::clear() {
+    memset(slots, 0, sizeof(slots));
+    count = 0;
+}
+
+// Fibonacci hashing: the top bits of the product mix every address octet,
+// so vendor prefixes shared by several beacons still spread out
+uint8_t BeaconRegistry::homeSlot(uint64_t address) {
+    return (address * 0x9E3779B97F4A7C15ULL) >> (64 - BEACON_REGISTRY_SLOT_BITS);
+}
+
+bool BeaconRegistry::add(uint64_t address, uint16_t facultyId, uint8_t tracker) {
+    if (address == 0 || (address & ~BEACON_ADDRESS_MASK) != 0) return false;
+    if (count >= BEACON_REGISTRY_CAPACITY) return false;
+
+    uint8_t slot = homeSlot(address);
+    while (slots[slot].address != 0) {
+        if (slots[slot].address == address) return false;
+        slot = (slot + 1) & (BEACON_REGISTRY_SLOTS - 1);
+    }
+
+    slots[slot].address = address;
+    slots[slot].facultyId = facultyId;
+    slots[slot].tracker = tracker;
+    count++;
+    return true;
+}
+
+// The table is never more than half full, so a probe always reaches an
+// empty slot; entries are only removed by clear(), so no tombstones
+const BeaconEntry* BeaconRegistry::find(uint64_t address) const {
+    if (address == 0) return nullptr;
+
+    uint8_t slot = homeSlot(address);
+    while (slots[slot].address != 0) {
+        if (slots[slot].address == address) return &slots[slot];
+        slot = (slot + 1) & (BEACON_REGISTRY_SLOTS - 1);
+    }
+    return nullptr;
+}
+
+BeaconEntry* BeaconRegistry::find(uint64_t address) {
+    return const_cast<BeaconEntry*>(static_cast<const BeaconRegistry*>(this)->find(address));
+}
+
+const BeaconEntry* BeaconRegistry::entryAt(uint8_t slot) const {
+    if (slot >= BEACON_REGISTRY_SLOTS || slots[slot].address == 0) return nullptr;
+    return &slots[slot];
+}
+
+BeaconEntry* BeaconRegistry::entryAt(uint8_t slot) {
+    return const_cast<BeaconEntry*>(static_cast<const BeaconRegistry*>(this)->entryAt(slot));
+}
+
+// ================================
+// ADDRESS CONVERSION
+// ================================
+bool BeaconRegistry::parseAddress(const char* text, size_t length, uint64_t& address) {
+    if (!text || length != 17) return false;
+
+    uint64_t value = 0;
+    for (size_t i = 0; i < length; i++) {
+        char c = text[i];
+        if (i % 3 == 2) {
+            if (c != ':') return false;
+            continue;
+        }
+
+        int digit;
+        if (c >= '0' && c <= '9') digit = c - '0';
+        else if (c >= 'a' && c <= 'f') digit = c - 'a' + 10;
+        else if (c >= 'A' && c <= 'F') digit = c - 'A' + 10;
+        else return false;
+        value = (value << 4) | digit;
+    }
+
+    if (value == 0) return false;
+    address = value;
+    return true;
+}
+
+uint64_t BeaconRegistry::fromBytes(const uint8_t* bytes) {
+    uint64_t value = 0;
+    for (int i = 0; i < 6; i++) {
+        value = (value << 8) | bytes[i];
+    }
+    return value;
+}
+
+void BeaconRegistry::toBytes(uint64_t address, uint8_t* bytes) {
+    for (int i = 5; i >= 0; i--) {
+        bytes[i] = address & 0xFF;
+        address >>= 8;
+    }
+}
+
+void BeaconRegistry::formatAddress(uint64_t address, char* output, size_t outputSize) {
+    snprintf(output, outputSize, "%02X:%02X:%02X:%02X:%02X:%02X",
+             (unsigned)(address >> 40) & 0xFF, (unsigned)(address >> 32) & 0xFF,
+             (unsigned)(address >> 24) & 0xFF, (unsigned)(address >> 16) & 0xFF,
+             (unsigned)(address >> 8) & 0xFF, (unsigned)address & 0xFF);
+}
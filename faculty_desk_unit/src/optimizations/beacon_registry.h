@@ -0,0 +1,60 @@
+/**
+ * Beacon registry for ConsultEase Faculty Desk Unit
+ * Maps 48-bit BLE addresses, held as integers, to the faculty member each
+ * beacon belongs to. The table is open-addressed and never allocates, so an
+ * advertisement is matched with a multiply and a short probe.
+ */
+
+#ifndef BEACON_REGISTRY_H
+#define BEACON_REGISTRY_H
+
+#include <Arduino.h>
+
+// Faculty beacons one unit can track, including its own faculty's
+#define BEACON_REGISTRY_CAPACITY 8
+
+// Table size as a power of two; kept at least twice the capacity so probe
+// runs stay short
+#define BEACON_REGISTRY_SLOT_BITS 4
+#define BEACON_REGISTRY_SLOTS (1 << BEACON_REGISTRY_SLOT_BITS)
+
+#define BEACON_NO_TRACKER 0xFF
+
+struct BeaconEntry {
+    uint64_t address;     // 0 marks an empty slot
+    uint16_t facultyId;
+    uint8_t tracker;      // Presence tracker fed by this beacon's sightings
+};
+
+class BeaconRegistry {
+private:
+    BeaconEntry slots[BEACON_REGISTRY_SLOTS];
+    uint8_t count;
+
+    static uint8_t homeSlot(uint64_t address);
+
+public:
+    BeaconRegistry();
+
+    void clear();
+
+    // Fails when the address is already present, invalid or the table is full
+    bool add(uint64_t address, uint16_t facultyId, uint8_t tracker);
+    BeaconEntry* find(uint64_t address);
+    const BeaconEntry* find(uint64_t address) const;
+
+    uint8_t size() const { return count; }
+
+    // Walk with slot = 0..BEACON_REGISTRY_SLOTS-1; empty slots return nullptr
+    BeaconEntry* entryAt(uint8_t slot);
+    const BeaconEntry* entryAt(uint8_t slot) const;
+
+    // "AA:BB:CC:DD:EE:FF" (either case) to an integer, first octet highest
+    static bool parseAddress(const char* text, size_t length, uint64_t& address);
+    // Six address bytes in transmission order, as returned by BLEAddress::getNative()
+    static uint64_t fromBytes(const uint8_t* bytes);
+    static void toBytes(uint64_t address, uint8_t* bytes);
+    static void formatAddress(uint64_t address, char* output, size_t outputSize);
+};
+
+#endif // BEACON_REGISTRY_H
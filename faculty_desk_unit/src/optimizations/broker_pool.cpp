@@ -0,0 +1,205 @@
+/**
+ * MQTT broker failover implementation for ConsultEase Faculty Desk Unit
+ */
+
+#include "broker_pool.h"
+
+#define BROKER_RECONNECT_SPREAD_MS 3000UL    // After a stable connection drops
+#define BROKER_MAX_BACKOFF_SHIFT 16
+
+BrokerPool::BrokerPool() : count(0), active(BROKER_NONE), connectedAt(0), nextAttemptAt(0), roundFailures(0) {
+}
+
+bool BrokerPool::add(const char* host, uint16_t port, const char* serverName) {
+    if (!host || !*host || port == 0 || count >= BROKER_POOL_MAX) return false;
+    if (!serverName) serverName = "";
+    if (strlen(host) >= BROKER_HOST_LENGTH || strlen(serverName) >= BROKER_HOST_LENGTH) return false;
+
+    Broker& broker = brokers[count++];
+    strcpy(broker.host, host);
+    strcpy(broker.serverName, serverName);
+    broker.port = port;
+    memset(&broker.health, 0, sizeof(broker.health));
+    broker.health.score = BROKER_SCORE_MAX;
+    return true;
+}
+
+uint8_t BrokerPool::addList(const char* list, uint16_t defaultPort) {
+    uint8_t added = 0;
+    if (!list) return added;
+
+    while (*list) {
+        while (*list == ',' || *list == ' ') list++;
+        const char* end = list;
+        while (*end && *end != ',') end++;
+
+        size_t length = end - list;
+        while (length > 0 && list[length - 1] == ' ') length--;
+        // Room for a host, a port and a server name; add() checks each part
+        if (length > 0 && length < 2 * BROKER_HOST_LENGTH + 8) {
+            char host[2 * BROKER_HOST_LENGTH + 8];
+            memcpy(host, list, length);
+            host[length] = '\0';
+
+            const char* serverName = nullptr;
+            char* at = strchr(host, '@');
+            if (at) {
+                *at = '\0';
+                serverName = at + 1;
+            }
+            uint16_t port = defaultPort;
+            char* colon = strchr(host, ':');
+            if (colon) {
+                *colon = '\0';
+                port = atoi(colon + 1);
+            }
+            if (add(host, port, serverName)) added++;
+        }
+        list = end;
+    }
+    return added;
+}
+
+int16_t BrokerPool::currentScore(uint8_t index, unsigned long now) const {
+    const BrokerHealth& health = brokers[index].health;
+    uint32_t recovered = (now - health.lastChange) / BROKER_SCORE_RECOVERY_MS;
+    int32_t score = health.score + (int32_t)min(recovered, (uint32_t)BROKER_SCORE_MAX);
+    return score > BROKER_SCORE_MAX ? BROKER_SCORE_MAX : score;
+}
+
+bool BrokerPool::coolingDown(uint8_t index, unsigned long now) const {
+    const BrokerHealth& health = brokers[index].health;
+    return health.consecutiveFailures > 0 && (long)(health.cooldownUntil - now) > 0;
+}
+
+// Half fixed, half random: never retries immediately, never in lockstep
+uint32_t BrokerPool::jittered(uint32_t delayMs) const {
+    uint32_t half = delayMs / 2;
+    return half + random(0, half + 1);
+}
+
+void BrokerPool::settle(uint8_t index, int16_t delta, unsigned long now) {
+    BrokerHealth& health = brokers[index].health;
+    int32_t score = currentScore(index, now) + delta;
+    if (score < 0) score = 0;
+    if (score > BROKER_SCORE_MAX) score = BROKER_SCORE_MAX;
+    health.score = score;
+    health.lastChange = now;
+}
+
+// A broker that is not cooling down is tried shortly; otherwise wait for
+// the first cooldown to run out
+void BrokerPool::scheduleRetry(unsigned long now) {
+    unsigned long soonest = 0;
+    bool haveSoonest = false;
+    for (uint8_t i = 0; i < count; i++) {
+        if (!coolingDown(i, now)) {
+            nextAttemptAt = now + jittered(BROKER_FAILOVER_DELAY_MS);
+            return;
+        }
+        unsigned long until = brokers[i].health.cooldownUntil;
+        if (!haveSoonest || (long)(until - soonest) < 0) {
+            soonest = until;
+            haveSoonest = true;
+        }
+    }
+    nextAttemptAt = haveSoonest ? soonest : now;
+}
+
+bool BrokerPool::readyToConnect(unsigned long now) const {
+    return count > 0 && (long)(now - nextAttemptAt) >= 0;
+}
+
+uint8_t BrokerPool::choose(unsigned long now) const {
+    uint8_t best = BROKER_NONE;
+    int16_t bestScore = -1;
+    for (uint8_t i = 0; i < count; i++) {
+        if (coolingDown(i, now)) continue;
+        int16_t score = currentScore(i, now);
+        if (score > bestScore) {
+            best = i;
+            bestScore = score;
+        }
+    }
+    if (best != BROKER_NONE) return best;
+
+    // Everything is cooling down: the one that comes back first
+    for (uint8_t i = 0; i < count; i++) {
+        if (best == BROKER_NONE ||
+            (long)(brokers[i].health.cooldownUntil - brokers[best].health.cooldownUntil) < 0) {
+            best = i;
+        }
+    }
+    return best;
+}
+
+void BrokerPool::reportAttempt(uint8_t index) {
+    if (index < count) brokers[index].health.attempts++;
+}
+
+void BrokerPool::reportSuccess(uint8_t index, uint32_t connectMs, unsigned long now) {
+    if (index >= count) return;
+
+    BrokerHealth& health = brokers[index].health;
+    health.consecutiveFailures = 0;
+    health.cooldownUntil = now;
+    health.lastConnectMs = connectMs;
+    settle(index, BROKER_SCORE_SUCCESS, now);
+
+    active = index;
+    connectedAt = now;
+    roundFailures = 0;
+}
+
+void BrokerPool::reportFailure(uint8_t index, unsigned long now) {
+    if (index >= count) return;
+
+    BrokerHealth& health = brokers[index].health;
+    health.failures++;
+    if (health.consecutiveFailures < 255) health.consecutiveFailures++;
+    settle(index, -BROKER_SCORE_FAILURE, now);
+
+    uint8_t shift = min<uint8_t>(health.consecutiveFailures - 1, BROKER_MAX_BACKOFF_SHIFT);
+    uint32_t backoff = min(BROKER_BACKOFF_BASE_MS << shift, BROKER_BACKOFF_MAX_MS);
+    health.cooldownUntil = now + jittered(backoff);
+
+    if (active == index) active = BROKER_NONE;
+    if (roundFailures < 255) roundFailures++;
+    scheduleRetry(now);
+}
+
+void BrokerPool::reportDisconnect(unsigned long now) {
+    if (active == BROKER_NONE) return;
+
+    uint8_t index = active;
+    active = BROKER_NONE;
+    if (now - connectedAt < BROKER_STABLE_MS) {
+        reportFailure(index, now);
+        return;
+    }
+
+    // Most likely the broker restarted and every unit noticed at once
+    settle(index, -BROKER_SCORE_DROP, now);
+    nextAttemptAt = now + jittered(BROKER_RECONNECT_SPREAD_MS);
+}
+
+void BrokerPool::reportClosed(unsigned long now) {
+    active = BROKER_NONE;
+    nextAttemptAt = now;
+}
+
+// choose() must then prefer the primary, or the failback is a wasted reconnect
+bool BrokerPool::shouldFailBack(unsigned long now) const {
+    return active != BROKER_NONE && active != 0 && now - connectedAt > BROKER_FAILBACK_MS &&
+           !coolingDown(0, now) && currentScore(0, now) >= currentScore(active, now);
+}
+
+void BrokerPool::printStatus(unsigned long now) const {
+    for (uint8_t i = 0; i < count; i++) {
+        const BrokerHealth& health = brokers[i].health;
+        Serial.printf("  %c %s:%u score %d | %lu attempts, %lu failed%s | last connect %lums\n",
+                      i == active ? '*' : ' ', brokers[i].host, brokers[i].port, currentScore(i, now),
+                      (unsigned long)health.attempts, (unsigned long)health.failures,
+                      coolingDown(i, now) ? " (cooling down)" : "", (unsigned long)health.lastConnectMs);
+    }
+}
@@ -0,0 +1,108 @@
+/**
+ * MQTT broker failover for ConsultEase Faculty Desk Unit
+ * Keeps a health score per broker and decides which one to try next and
+ * when. Retry delays grow exponentially with jitter, so a fleet of units
+ * that lost the same broker spreads its reconnects out instead of hitting
+ * it in lockstep. While one broker is cooling down, a healthy standby is
+ * tried after a short delay, which gives failover in seconds.
+ */
+
+#ifndef BROKER_POOL_H
+#define BROKER_POOL_H
+
+#include <Arduino.h>
+
+#define BROKER_POOL_MAX 4
+#define BROKER_HOST_LENGTH 48                    // Also bounds the TLS server name
+#define BROKER_NONE 0xFF
+
+// Scores run 0..BROKER_SCORE_MAX; a broker earns points back while left alone
+#define BROKER_SCORE_MAX 100
+#define BROKER_SCORE_SUCCESS 20
+#define BROKER_SCORE_FAILURE 30
+#define BROKER_SCORE_DROP 10                     // Lost a connection it had held for a while
+#define BROKER_SCORE_RECOVERY_MS 30000UL         // One point back per interval
+
+// Per-broker cooldown after consecutive failures: base * 2^(n-1), capped
+#define BROKER_BACKOFF_BASE_MS 1000UL
+#define BROKER_BACKOFF_MAX_MS 60000UL
+#define BROKER_FAILOVER_DELAY_MS 500UL           // Before trying another broker that is not cooling down
+#define BROKER_STABLE_MS 60000UL                 // A shorter connection counts as a failure (flapping)
+
+// Connected to a standby this long with the primary rested: move back
+#define BROKER_FAILBACK_MS 1800000UL
+
+struct BrokerHealth {
+    int16_t score;
+    uint8_t consecutiveFailures;
+    uint32_t attempts;
+    uint32_t failures;
+    uint32_t lastConnectMs;       // Duration of the last successful connect
+    unsigned long cooldownUntil;
+    unsigned long lastChange;     // Last score change, for recovery
+};
+
+class BrokerPool {
+private:
+    struct Broker {
+        char host[BROKER_HOST_LENGTH];
+        char serverName[BROKER_HOST_LENGTH];  // Certificate name when host is an IP; "" = host
+        uint16_t port;
+        BrokerHealth health;
+    };
+
+    Broker brokers[BROKER_POOL_MAX];
+    uint8_t count;
+    uint8_t active;               // Connected broker, BROKER_NONE while down
+    unsigned long connectedAt;
+    unsigned long nextAttemptAt;
+    uint8_t roundFailures;        // Failures since the last success, across brokers
+
+    int16_t currentScore(uint8_t index, unsigned long now) const;
+    bool coolingDown(uint8_t index, unsigned long now) const;
+    uint32_t jittered(uint32_t delayMs) const;
+    void settle(uint8_t index, int16_t delta, unsigned long now);
+    void scheduleRetry(unsigned long now);
+
+public:
+    BrokerPool();
+
+    // Order is preference: the first broker added is the primary
+    bool add(const char* host, uint16_t port, const char* serverName = nullptr);
+    // "host:port,host,ip:port@name" - entries without a port get defaultPort,
+    // "@name" is the name on that broker's TLS certificate
+    uint8_t addList(const char* list, uint16_t defaultPort);
+
+    // True once the backoff delay has passed
+    bool readyToConnect(unsigned long now) const;
+    // Best broker to try now: highest score not cooling down, primary first on ties
+    uint8_t choose(unsigned long now) const;
+
+    void reportAttempt(uint8_t index);
+    void reportSuccess(uint8_t index, uint32_t connectMs, unsigned long now);
+    void reportFailure(uint8_t index, unsigned long now);
+    // The active connection closed; short-lived ones count as failures
+    void reportDisconnect(unsigned long now);
+    // We closed it ourselves (WiFi loss, failback): no penalty, retry at once
+    void reportClosed(unsigned long now);
+
+    // Connected to a standby long enough and the primary has earned its score back
+    bool shouldFailBack(unsigned long now) const;
+
+    uint8_t getCount() const { return count; }
+    uint8_t getActive() const { return active; }
+    const char* getHost(uint8_t index) const { return index < count ? brokers[index].host : ""; }
+    uint16_t getPort(uint8_t index) const { return index < count ? brokers[index].port : 0; }
+    // Name to verify the broker certificate against
+    const char* getServerName(uint8_t index) const {
+        if (index >= count) return "";
+        return brokers[index].serverName[0] ? brokers[index].serverName : brokers[index].host;
+    }
+    const BrokerHealth& getHealth(uint8_t index) const { return brokers[index].health; }
+    unsigned long getNextAttemptAt() const { return nextAttemptAt; }
+    uint8_t getRoundFailures() const { return roundFailures; }
+    int16_t getScore(uint8_t index, unsigned long now) const { return currentScore(index, now); }
+    void printStatus(unsigned long now) const;
+};
+
+#endif // BROKER_POOL_H
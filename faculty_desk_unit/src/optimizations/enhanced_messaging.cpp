@@ -0,0 +1,896 @@
+/**
+ * Enhanced messaging implementation for ConsultEase Faculty Desk Unit
+ */
+
+#include "enhanced_messaging.h"
+#include <string.h>
+#include <stdlib.h>
+#include <strings.h>
+#include <time.h>
+
+// Static member definitions
+MessageParser::ParseScratch MessageParser::scratch;
+const EnhancedMessage* EnhancedDisplayManager::currentMessage = nullptr;
+MessageLayout EnhancedDisplayManager::layout;
+EnhancedDisplayManager::PageRenderer EnhancedDisplayManager::pageRenderer = nullptr;
+bool EnhancedDisplayManager::messageDisplayed = false;
+unsigned long EnhancedDisplayManager::displayStartTime = 0;
+int EnhancedDisplayManager::currentPage = 0;
+int EnhancedDisplayManager::totalPages = 0;
+int EnhancedDisplayManager::lineWidth = 40;
+int EnhancedDisplayManager::linesPerPage = 5;
+
+EnhancedMessage MessageQueue::messages[MessageQueue::MAX_MESSAGES];
+uint8_t MessageQueue::ring[MessageQueue::PRIORITY_LEVELS][MessageQueue::MAX_MESSAGES];
+uint8_t MessageQueue::ringHead[MessageQueue::PRIORITY_LEVELS];
+uint8_t MessageQueue::ringCount[MessageQueue::PRIORITY_LEVELS];
+uint16_t MessageQueue::freeSlots = 0;
+uint16_t MessageQueue::linkedSlots = 0;
+int MessageQueue::messageCount = 0;
+int MessageQueue::unreadCount = 0;
+int MessageQueue::currentSlot = -1;
+unsigned long MessageQueue::lastCleanup = 0;
+
+unsigned long MessageStatistics::totalMessages = 0;
+unsigned long MessageStatistics::consultationRequests = 0;
+unsigned long MessageStatistics::systemNotifications = 0;
+unsigned long MessageStatistics::emergencyMessages = 0;
+unsigned long MessageStatistics::averageResponseTime = 0;
+unsigned long MessageStatistics::responseCount = 0;
+unsigned long MessageStatistics::maxResponseTime = 0;
+unsigned long MessageStatistics::lastResetTime = 0;
+
+// ================================
+// MESSAGE PARSER
+// ================================
+void MessageParser::init() {
+    resetScratch();
+}
+
+void MessageParser::resetScratch() {
+    memset(&scratch, 0, sizeof(scratch));
+    scratch.type = MSG_UNKNOWN;
+}
+
+// Top-level members only; each key is one switch on its precomputed hash.
+// The hash only picks the case: the key bytes confirm it, so an unknown key
+// that happens to collide with a known one is ignored.
+bool MessageParser::handleToken(const JsonToken& token, void* context) {
+    (void)context;
+    if (token.depth != 1 || !token.key) return true;
+    if (token.type == JSON_VALUE_OBJECT || token.type == JSON_VALUE_ARRAY || token.type == JSON_VALUE_NULL) return true;
+
+    ConsultationRequest& request = scratch.request;
+    SystemNotification& notification = scratch.notification;
+    char value[24];
+
+#define COPY_FIELD(field) JsonStream::copyString(token.value, token.valueLength, field, sizeof(field))
+#define KEY_IS(name) JsonStream::keyEquals(token, name)
+
+    switch (token.keyHash) {
+        case JsonStream::keyHash("id"):
+        case JsonStream::keyHash("request_id"):
+        case JsonStream::keyHash("message_id"):
+        case JsonStream::keyHash("consultation_id"):
+            if (!KEY_IS("id") && !KEY_IS("request_id") &&
+                !KEY_IS("message_id") && !KEY_IS("consultation_id")) break;
+            COPY_FIELD(scratch.messageId);
+            break;
+
+        case JsonStream::keyHash("type"):
+        case JsonStream::keyHash("message_type"):
+            if (!KEY_IS("type") && !KEY_IS("message_type")) break;
+            COPY_FIELD(value);
+            scratch.type = detectMessageType(value);
+            break;
+
+        case JsonStream::keyHash("priority"):
+            if (!KEY_IS("priority")) break;
+            COPY_FIELD(value);
+            scratch.priority = parsePriority(value);
+            request.priority = notification.priority = scratch.priority;
+            break;
+
+        case JsonStream::keyHash("student_id"):
+            if (!KEY_IS("student_id")) break;
+            COPY_FIELD(request.studentId);
+            COPY_FIELD(scratch.senderId);
+            scratch.hasConsultationFields = true;
+            break;
+
+        case JsonStream::keyHash("student_name"):
+            if (!KEY_IS("student_name")) break;
+            COPY_FIELD(request.studentName);
+            scratch.hasConsultationFields = true;
+            break;
+
+        case JsonStream::keyHash("student_department"):
+            if (!KEY_IS("student_department")) break;
+            COPY_FIELD(request.studentDepartment);
+            break;
+
+        case JsonStream::keyHash("course_code"):
+            if (!KEY_IS("course_code")) break;
+            COPY_FIELD(request.courseCode);
+            scratch.hasConsultationFields = true;
+            break;
+
+        case JsonStream::keyHash("course_name"):
+            if (!KEY_IS("course_name")) break;
+            COPY_FIELD(request.courseName);
+            break;
+
+        case JsonStream::keyHash("request_message"):
+            if (!KEY_IS("request_message")) break;
+            COPY_FIELD(request.requestMessage);
+            scratch.hasConsultationFields = true;
+            break;
+
+        case JsonStream::keyHash("message"):
+            if (!KEY_IS("message")) break;
+            // request_message wins when both are sent
+            if (request.requestMessage[0] == '\0') COPY_FIELD(request.requestMessage);
+            COPY_FIELD(notification.message);
+            break;
+
+        case JsonStream::keyHash("timestamp"):
+        case JsonStream::keyHash("requested_at"):
+            if (!KEY_IS("timestamp") && !KEY_IS("requested_at")) break;
+            COPY_FIELD(request.timestamp);
+            COPY_FIELD(notification.timestamp);
+            if (!scratch.hasSentAt) parseTimestamp(token, scratch.sentAtMs);
+            break;
+
+        case JsonStream::keyHash("sent_at"):
+        case JsonStream::keyHash("sent_at_ms"):
+            if (!KEY_IS("sent_at") && !KEY_IS("sent_at_ms")) break;
+            scratch.hasSentAt = parseTimestamp(token, scratch.sentAtMs);
+            break;
+
+        case JsonStream::keyHash("session_id"):
+            if (!KEY_IS("session_id")) break;
+            COPY_FIELD(request.sessionId);
+            break;
+
+        case JsonStream::keyHash("requires_response"):
+            if (!KEY_IS("requires_response")) break;
+            request.requiresResponse = JsonStream::toBool(token.value, token.valueLength);
+            break;
+
+        case JsonStream::keyHash("notification_id"):
+            if (!KEY_IS("notification_id")) break;
+            COPY_FIELD(notification.notificationId);
+            scratch.hasNotificationFields = true;
+            break;
+
+        case JsonStream::keyHash("title"):
+            if (!KEY_IS("title")) break;
+            COPY_FIELD(notification.title);
+            scratch.hasNotificationFields = true;
+            break;
+
+        case JsonStream::keyHash("persistent"):
+            if (!KEY_IS("persistent")) break;
+            notification.persistent = JsonStream::toBool(token.value, token.valueLength);
+            break;
+
+        default:
+            break;
+    }
+
+#undef KEY_IS
+#undef COPY_FIELD
+    return true;
+}
+
+MessageType MessageParser::detectMessageType(const char* typeStr) {
+    if (!strcasecmp(typeStr, "consultation") || !strcasecmp(typeStr, "consultation_request") ||
+        !strcasecmp(typeStr, "request")) return MSG_CONSULTATION_REQUEST;
+    if (!strcasecmp(typeStr, "notification") || !strcasecmp(typeStr, "system_notification") ||
+        !strcasecmp(typeStr, "system")) return MSG_SYSTEM_NOTIFICATION;
+    if (!strcasecmp(typeStr, "status") || !strcasecmp(typeStr, "status_update")) return MSG_STATUS_UPDATE;
+    if (!strcasecmp(typeStr, "emergency")) return MSG_EMERGENCY;
+    if (!strcasecmp(typeStr, "maintenance")) return MSG_MAINTENANCE;
+    return MSG_UNKNOWN;
+}
+
+namespace {
+
+// Reads up to count digits; false if fewer are there
+bool readDigits(const char*& text, const char* end, int count, long& value) {
+    value = 0;
+    for (int i = 0; i < count; i++) {
+        if (text >= end || *text < '0' || *text > '9') return false;
+        value = value * 10 + (*text++ - '0');
+    }
+    return true;
+}
+
+// Milliseconds from an optional ".fff..." suffix, extra digits dropped
+long readFraction(const char*& text, const char* end) {
+    if (text >= end || *text != '.') return 0;
+    text++;
+    long ms = 0;
+    int digits = 0;
+    for (; text < end && *text >= '0' && *text <= '9'; text++) {
+        if (digits++ < 3) ms = ms * 10 + (*text - '0');
+    }
+    for (; digits < 3; digits++) ms *= 10;
+    return ms;
+}
+
+// Days since 1970-01-01 of a proleptic Gregorian date
+int64_t daysFromCivil(long year, long month, long day) {
+    year -= month <= 2;
+    long era = (year >= 0 ? year : year - 399) / 400;
+    long yearOfEra = year - era * 400;
+    long dayOfYear = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+    long dayOfEra = yearOfEra * 365 + yearOfEra / 4 - yearOfEra / 100 + dayOfYear;
+    return (int64_t)era * 146097 + dayOfEra - 719468;
+}
+
+} // namespace
+
+// Epoch seconds or milliseconds as a number (told apart by magnitude), or an
+// ISO 8601 string. Python's naive isoformat() carries no offset and is read
+// in the local zone set by configTime().
+bool MessageParser::parseTimestamp(const JsonToken& token, uint64_t& epochMs) {
+    const char* text = token.value;
+    const char* end = token.value + token.valueLength;
+
+    if (token.type == JSON_VALUE_NUMBER) {
+        uint64_t whole = 0;
+        for (; text < end && *text >= '0' && *text <= '9'; text++) {
+            whole = whole * 10 + (*text - '0');
+        }
+        if (whole == 0) return false;
+        epochMs = whole < 100000000000ULL ? whole * 1000 + readFraction(text, end) : whole;
+        return true;
+    }
+    if (token.type != JSON_VALUE_STRING) return false;
+
+    long year, month, day, hour, minute, second;
+    if (!readDigits(text, end, 4, year) || text >= end || *text++ != '-' ||
+        !readDigits(text, end, 2, month) || text >= end || *text++ != '-' ||
+        !readDigits(text, end, 2, day) || text >= end || (*text != 'T' && *text != ' ')) return false;
+    text++;
+    if (!readDigits(text, end, 2, hour) || text >= end || *text++ != ':' ||
+        !readDigits(text, end, 2, minute) || text >= end || *text++ != ':' ||
+        !readDigits(text, end, 2, second)) return false;
+    if (month < 1 || month > 12 || day < 1 || day > 31 || hour > 23 || minute > 59 || second > 60) return false;
+    long ms = readFraction(text, end);
+
+    int64_t seconds;
+    if (text < end && (*text == 'Z' || *text == 'z')) {
+        seconds = daysFromCivil(year, month, day) * 86400 + hour * 3600 + minute * 60 + second;
+    } else if (text < end && (*text == '+' || *text == '-')) {
+        int sign = *text++ == '-' ? -1 : 1;
+        long offsetHours, offsetMinutes = 0;
+        if (!readDigits(text, end, 2, offsetHours)) return false;
+        if (text < end && *text == ':') text++;
+        readDigits(text, end, 2, offsetMinutes);
+        seconds = daysFromCivil(year, month, day) * 86400 + hour * 3600 + minute * 60 + second -
+                  sign * (offsetHours * 3600 + offsetMinutes * 60);
+    } else {
+        struct tm local = {};
+        local.tm_year = year - 1900;
+        local.tm_mon = month - 1;
+        local.tm_mday = day;
+        local.tm_hour = hour;
+        local.tm_min = minute;
+        local.tm_sec = second;
+        local.tm_isdst = -1;
+        time_t converted = mktime(&local);
+        if (converted == (time_t)-1) return false;
+        seconds = converted;
+    }
+
+    if (seconds <= 0) return false;
+    epochMs = (uint64_t)seconds * 1000 + ms;
+    return true;
+}
+
+// Accepts names (any case, as the central system's enum names) or 1-5
+MessagePriority MessageParser::parsePriority(const char* priorityStr) {
+    if (priorityStr[0] >= '0' && priorityStr[0] <= '9') {
+        long level = strtol(priorityStr, nullptr, 10);
+        if (level < PRIORITY_LOW) return PRIORITY_LOW;
+        if (level > PRIORITY_EMERGENCY) return PRIORITY_EMERGENCY;
+        return (MessagePriority)level;
+    }
+    if (!strcasecmp(priorityStr, "low")) return PRIORITY_LOW;
+    if (!strcasecmp(priorityStr, "high")) return PRIORITY_HIGH;
+    if (!strcasecmp(priorityStr, "urgent")) return PRIORITY_URGENT;
+    if (!strcasecmp(priorityStr, "emergency") || !strcasecmp(priorityStr, "critical")) return PRIORITY_EMERGENCY;
+    return PRIORITY_NORMAL;
+}
+
+// Fills content, type and (when sent) priority and IDs; everything else is
+// left as the caller initialised it
+bool MessageParser::parseMessage(const char* rawMessage, size_t length, EnhancedMessage& message) {
+    if (!rawMessage) return false;
+
+    size_t pos = 0;
+    while (pos < length && (rawMessage[pos] == ' ' || rawMessage[pos] == '\t' ||
+                            rawMessage[pos] == '\r' || rawMessage[pos] == '\n')) {
+        pos++;
+    }
+
+    if (pos < length && rawMessage[pos] == '{' && parseJSON(rawMessage + pos, length - pos, message)) {
+        return true;
+    }
+    return parsePlainText(rawMessage, length, message);
+}
+
+bool MessageParser::parseJSON(const char* json, size_t length, EnhancedMessage& message) {
+    resetScratch();
+    if (!JsonStream::parse(json, length, handleToken, nullptr)) return false;
+    if (!scratch.hasConsultationFields && !scratch.hasNotificationFields) return false;
+
+    MessageType type = scratch.type;
+    if (type == MSG_UNKNOWN) {
+        type = scratch.hasConsultationFields ? MSG_CONSULTATION_REQUEST : MSG_SYSTEM_NOTIFICATION;
+    }
+
+    // The body is always display text: the union can hold only one view
+    if (type == MSG_CONSULTATION_REQUEST) {
+        MessageFormatter::formatConsultationForDisplay(scratch.request, message.data.rawMessage,
+                                                       sizeof(message.data.rawMessage));
+    } else {
+        MessageFormatter::formatNotificationForDisplay(scratch.notification, message.data.rawMessage,
+                                                       sizeof(message.data.rawMessage));
+    }
+
+    message.type = type;
+    if (scratch.priority != 0) message.priority = scratch.priority;
+    if (scratch.messageId[0]) strcpy(message.messageId, scratch.messageId);
+    if (scratch.senderId[0]) strcpy(message.senderId, scratch.senderId);
+    if (scratch.sentAtMs) message.trace.sentAtMs = scratch.sentAtMs;
+    return true;
+}
+
+bool MessageParser::parsePlainText(const char* text, size_t length, EnhancedMessage& message) {
+    size_t textLength = length < sizeof(message.data.rawMessage) - 1 ? length : sizeof(message.data.rawMessage) - 1;
+    memcpy(message.data.rawMessage, text, textLength);
+    message.data.rawMessage[textLength] = '\0';
+    message.type = MSG_CONSULTATION_REQUEST;
+    return textLength > 0;
+}
+
+bool MessageParser::validateMessage(const EnhancedMessage& message) {
+    return message.data.rawMessage[0] != '\0' && message.messageId[0] != '\0';
+}
+
+void MessageParser::printMessage(const EnhancedMessage& message) {
+    Serial.printf("Message %s from %s (type %d, priority %d):\n%s\n", message.messageId, message.senderId,
+                  (int)message.type, (int)message.priority, message.data.rawMessage);
+}
+
+// ================================
+// MESSAGE FORMATTER
+// ================================
+// Same layout as the central system's plain-text requests
+void MessageFormatter::formatConsultationForDisplay(const ConsultationRequest& request, char* output, size_t outputSize) {
+    if (!output || outputSize == 0) return;
+
+    const char* course = request.courseCode[0] ? request.courseCode : request.courseName;
+    int used = snprintf(output, outputSize, "Student: %s", request.studentName[0] ? request.studentName : "Unknown");
+    if (course[0] && used >= 0 && (size_t)used < outputSize) {
+        used += snprintf(output + used, outputSize - used, "\nCourse: %s", course);
+    }
+    if (request.requestMessage[0] && used >= 0 && (size_t)used < outputSize) {
+        snprintf(output + used, outputSize - used, "\nRequest: %s", request.requestMessage);
+    }
+}
+
+void MessageFormatter::formatNotificationForDisplay(const SystemNotification& notification, char* output, size_t outputSize) {
+    if (!output || outputSize == 0) return;
+
+    if (notification.title[0]) {
+        snprintf(output, outputSize, "%s\n%s", notification.title, notification.message);
+    } else {
+        snprintf(output, outputSize, "%s", notification.message);
+    }
+}
+
+
+// Word-aware line breaking in one forward scan. Lines break at the last
+// space that fits, at explicit newlines, or mid-word only when a single
+// word is longer than a line. Breaks are stored as offsets; nothing is
+// copied or allocated.
+void MessageFormatter::layoutText(const char* text, int lineWidth, int linesPerPage, MessageLayout& layout) {
+    if (lineWidth < 1) lineWidth = 1;
+    if (lineWidth > 255) lineWidth = 255;
+    if (linesPerPage < 1) linesPerPage = 1;
+
+    layout.lineCount = 0;
+    layout.lineWidth = lineWidth;
+    layout.linesPerPage = linesPerPage;
+
+    size_t length = text ? strlen(text) : 0;
+    size_t pos = 0;
+
+    while (pos < length && layout.lineCount < MESSAGE_LAYOUT_MAX_LINES) {
+        size_t start = pos;
+        size_t end = pos;
+        size_t lastSpace = 0;
+        bool hasSpace = false;
+
+        while (end < length && text[end] != '\n' && text[end] != '\r' && end - start < (size_t)lineWidth) {
+            if (text[end] == ' ') {
+                lastSpace = end;
+                hasSpace = true;
+            }
+            end++;
+        }
+
+        size_t lineEnd = end;
+        size_t next = end;
+        if (end < length && (text[end] == '\n' || text[end] == '\r')) {
+            // Explicit break; treat CRLF as one newline
+            next = end + 1;
+            if (text[end] == '\r' && next < length && text[next] == '\n') next++;
+        } else if (end < length) {
+            if (text[end] == ' ') {
+                next = end + 1;
+            } else if (hasSpace && lastSpace > start) {
+                lineEnd = lastSpace;
+                next = lastSpace + 1;
+            }
+            // Otherwise a single word fills the line: hard break
+        }
+
+        while (lineEnd > start && text[lineEnd - 1] == ' ') lineEnd--;
+
+        layout.lineStart[layout.lineCount] = start;
+        layout.lineLength[layout.lineCount] = lineEnd - start;
+        layout.lineCount++;
+
+        // Spaces at a soft wrap are not carried onto the next line
+        if (next == end || text[next - 1] == ' ') {
+            while (next < length && text[next] == ' ') next++;
+        }
+        pos = next;
+    }
+
+    layout.pageCount = layout.lineCount ? (layout.lineCount + linesPerPage - 1) / linesPerPage : 1;
+}
+
+int MessageFormatter::calculateTextPages(const char* text, int lineWidth, int linesPerPage) {
+    MessageLayout layout;
+    layoutText(text, lineWidth, linesPerPage, layout);
+    return layout.pageCount;
+}
+
+// Copies the lines of one page into output, separated by newlines
+void MessageFormatter::getTextPage(const char* text, int page, int lineWidth, int linesPerPage,
+                                   char* output, size_t outputSize) {
+    if (!output || outputSize == 0) return;
+    output[0] = '\0';
+
+    MessageLayout layout;
+    layoutText(text, lineWidth, linesPerPage, layout);
+    if (page < 0 || page >= layout.pageCount) return;
+
+    size_t used = 0;
+    int first = page * layout.linesPerPage;
+    int last = min((int)layout.lineCount, first + layout.linesPerPage);
+    for (int i = first; i < last; i++) {
+        size_t n = layout.lineLength[i];
+        size_t needed = n + (i > first ? 1 : 0);
+        if (used + needed >= outputSize) break;
+        if (i > first) output[used++] = '\n';
+        memcpy(output + used, text + layout.lineStart[i], n);
+        used += n;
+    }
+    output[used] = '\0';
+}
+
+void MessageFormatter::wrapText(const char* input, char* output, size_t outputSize, int lineWidth) {
+    if (!output || outputSize == 0) return;
+    output[0] = '\0';
+
+    MessageLayout layout;
+    layoutText(input, lineWidth, MESSAGE_LAYOUT_MAX_LINES, layout);
+
+    size_t used = 0;
+    for (int i = 0; i < layout.lineCount; i++) {
+        size_t n = layout.lineLength[i];
+        size_t needed = n + (i > 0 ? 1 : 0);
+        if (used + needed >= outputSize) break;
+        if (i > 0) output[used++] = '\n';
+        memcpy(output + used, input + layout.lineStart[i], n);
+        used += n;
+    }
+    output[used] = '\0';
+}
+
+// ================================
+// MESSAGE QUEUE
+// ================================
+void MessageQueue::init() {
+    memset(ringHead, 0, sizeof(ringHead));
+    memset(ringCount, 0, sizeof(ringCount));
+    freeSlots = (1u << MAX_MESSAGES) - 1;
+    linkedSlots = 0;
+    messageCount = 0;
+    unreadCount = 0;
+    currentSlot = -1;
+    lastCleanup = millis();
+}
+
+int MessageQueue::priorityLevel(MessagePriority priority) {
+    int level = (int)priority - 1;
+    if (level < 0) return 0;
+    if (level >= PRIORITY_LEVELS) return PRIORITY_LEVELS - 1;
+    return level;
+}
+
+// Walks the rings from the highest priority down; at most PRIORITY_LEVELS steps
+int MessageQueue::slotAt(int index) {
+    if (index < 0) return -1;
+    for (int level = PRIORITY_LEVELS - 1; level >= 0; level--) {
+        if (index < ringCount[level]) {
+            return ring[level][(ringHead[level] + index) % MAX_MESSAGES];
+        }
+        index -= ringCount[level];
+    }
+    return -1;
+}
+
+int MessageQueue::indexOfSlot(int slot) {
+    int index = 0;
+    for (int level = PRIORITY_LEVELS - 1; level >= 0; level--) {
+        for (int i = 0; i < ringCount[level]; i++) {
+            if (ring[level][(ringHead[level] + i) % MAX_MESSAGES] == slot) return index + i;
+        }
+        index += ringCount[level];
+    }
+    return -1;
+}
+
+// Drops a slot from its priority ring and returns it to the free set. The
+// head (the common case: oldest or expired) is O(1); elsewhere only the
+// byte indices behind it move.
+void MessageQueue::unlinkSlot(int slot) {
+    int level = priorityLevel(messages[slot].priority);
+    int count = ringCount[level];
+    int pos = 0;
+    while (pos < count && ring[level][(ringHead[level] + pos) % MAX_MESSAGES] != slot) pos++;
+    if (pos == count) return;
+
+    if (pos == 0) {
+        ringHead[level] = (ringHead[level] + 1) % MAX_MESSAGES;
+    } else {
+        for (int i = pos; i < count - 1; i++) {
+            ring[level][(ringHead[level] + i) % MAX_MESSAGES] = ring[level][(ringHead[level] + i + 1) % MAX_MESSAGES];
+        }
+    }
+    ringCount[level]--;
+
+    messageCount--;
+    if (messages[slot].status == STATUS_UNREAD) unreadCount--;
+    linkedSlots &= ~(1u << slot);
+    freeSlots |= (1u << slot);
+    if (currentSlot == slot) currentSlot = -1;
+}
+
+// Every ring is in arrival order, so only heads can be due. A selected head
+// holds back its ring until the unit lets go of it.
+int MessageQueue::removeExpiredMessages() {
+    unsigned long now = millis();
+    int removed = 0;
+
+    for (int level = 0; level < PRIORITY_LEVELS; level++) {
+        while (ringCount[level] > 0) {
+            int slot = ring[level][ringHead[level]];
+            const EnhancedMessage& message = messages[slot];
+            if (slot == currentSlot || message.expiryTime == 0 || (long)(now - message.expiryTime) < 0) break;
+            unlinkSlot(slot);
+            removed++;
+        }
+    }
+    return removed;
+}
+
+// Eviction victim when the inbox is full: oldest unselected message of the
+// lowest priority present
+int MessageQueue::findOldestMessage() {
+    for (int level = 0; level < PRIORITY_LEVELS; level++) {
+        for (int i = 0; i < ringCount[level]; i++) {
+            int slot = ring[level][(ringHead[level] + i) % MAX_MESSAGES];
+            if (slot != currentSlot) return slot;
+        }
+    }
+    return -1;
+}
+
+// Hands out a free body for the caller to fill in place; it stays invisible
+// until commitSlot(). Evicts the least important message if the inbox is full.
+EnhancedMessage* MessageQueue::reserveSlot() {
+    if (freeSlots == 0) {
+        int victim = findOldestMessage();
+        if (victim < 0) return nullptr;
+        Serial.printf("⚠️ Inbox full, dropping message %s\n", messages[victim].messageId);
+        unlinkSlot(victim);
+    }
+
+    int slot = __builtin_ctz(freeSlots);
+    freeSlots &= ~(1u << slot);
+    return &messages[slot];
+}
+
+// Handed out by reserveSlot() and not yet committed or released
+bool MessageQueue::isReserved(int slot) {
+    return slot >= 0 && slot < MAX_MESSAGES && !(freeSlots & (1u << slot)) && !(linkedSlots & (1u << slot));
+}
+
+// Priority must be final here; the message is linked into that ring. A
+// second commit would put the slot in a ring twice and corrupt the counts.
+bool MessageQueue::commitSlot(EnhancedMessage* message) {
+    int slot = message - messages;
+    if (!isReserved(slot)) return false;
+
+    int level = priorityLevel(message->priority);
+    ring[level][(ringHead[level] + ringCount[level]) % MAX_MESSAGES] = slot;
+    ringCount[level]++;
+    linkedSlots |= (1u << slot);
+
+    messageCount++;
+    if (message->status == STATUS_UNREAD) unreadCount++;
+    return true;
+}
+
+// Gives back a reservation that was never committed; a queued message
+// leaves through removeMessage() instead, or its ring would keep the slot
+bool MessageQueue::releaseSlot(EnhancedMessage* message) {
+    int slot = message - messages;
+    if (!isReserved(slot)) return false;
+    freeSlots |= (1u << slot);
+    return true;
+}
+
+bool MessageQueue::addMessage(const EnhancedMessage& message) {
+    EnhancedMessage* slot = reserveSlot();
+    if (!slot) return false;
+    *slot = message;
+    commitSlot(slot);
+    return true;
+}
+
+const EnhancedMessage* MessageQueue::peekMessage(int index) {
+    int slot = slotAt(index);
+    return slot >= 0 ? &messages[slot] : nullptr;
+}
+
+bool MessageQueue::getMessage(int index, EnhancedMessage& message) {
+    const EnhancedMessage* queued = peekMessage(index);
+    if (!queued) return false;
+    message = *queued;
+    return true;
+}
+
+bool MessageQueue::getCurrentMessage(EnhancedMessage& message) {
+    if (currentSlot < 0) return false;
+    message = messages[currentSlot];
+    return true;
+}
+
+bool MessageQueue::getNextMessage(EnhancedMessage& message) {
+    if (messageCount == 0) return false;
+    int index = getCurrentIndex();
+    selectMessage(index < 0 ? 0 : (index + 1) % messageCount);
+    return getCurrentMessage(message);
+}
+
+bool MessageQueue::getPreviousMessage(EnhancedMessage& message) {
+    if (messageCount == 0) return false;
+    int index = getCurrentIndex();
+    selectMessage(index <= 0 ? messageCount - 1 : index - 1);
+    return getCurrentMessage(message);
+}
+
+bool MessageQueue::selectMessage(int index) {
+    int slot = slotAt(index);
+    if (slot < 0) return false;
+    currentSlot = slot;
+    return true;
+}
+
+void MessageQueue::clearSelection() {
+    currentSlot = -1;
+}
+
+int MessageQueue::getCurrentIndex() {
+    return currentSlot < 0 ? -1 : indexOfSlot(currentSlot);
+}
+
+int MessageQueue::getMessageCount() {
+    return messageCount;
+}
+
+int MessageQueue::getUnreadCount() {
+    return unreadCount;
+}
+
+void MessageQueue::markAsRead(int index) {
+    int slot = slotAt(index);
+    if (slot < 0 || messages[slot].status != STATUS_UNREAD) return;
+    messages[slot].status = STATUS_READ;
+    unreadCount--;
+}
+
+// Only the first render counts; paging back to a message is not a new hop
+void MessageQueue::markAsRendered(int index, uint64_t epochMs, unsigned long nowMs) {
+    int slot = slotAt(index);
+    if (slot < 0 || messages[slot].trace.rendered) return;
+    messages[slot].trace.rendered = true;
+    messages[slot].trace.renderedAtMs = epochMs;
+    messages[slot].trace.renderedMillis = nowMs;
+}
+
+void MessageQueue::markAsAcknowledged(int index) {
+    int slot = slotAt(index);
+    if (slot < 0) return;
+    if (messages[slot].status == STATUS_UNREAD) unreadCount--;
+    messages[slot].status = STATUS_ACKNOWLEDGED;
+}
+
+void MessageQueue::removeMessage(int index) {
+    int slot = slotAt(index);
+    if (slot >= 0) unlinkSlot(slot);
+}
+
+void MessageQueue::clearAll() {
+    init();
+}
+
+// Returns how many messages expired; cheap enough to call every loop
+int MessageQueue::cleanup() {
+    if (millis() - lastCleanup < CLEANUP_INTERVAL_MS) return 0;
+    lastCleanup = millis();
+    return removeExpiredMessages();
+}
+
+void MessageQueue::printQueue() {
+    Serial.printf("=== Message Queue: %d messages, %d unread ===\n", messageCount, unreadCount);
+    for (int i = 0; i < messageCount; i++) {
+        int slot = slotAt(i);
+        const EnhancedMessage& message = messages[slot];
+        Serial.printf("%c%d: [P%d] %s (%s)\n", slot == currentSlot ? '>' : ' ', i, (int)message.priority,
+                      message.messageId, message.status == STATUS_UNREAD ? "unread" : "read");
+    }
+}
+
+// ================================
+// ENHANCED DISPLAY MANAGER
+// ================================
+void EnhancedDisplayManager::init() {
+    currentMessage = nullptr;
+    messageDisplayed = false;
+    currentPage = 0;
+    totalPages = 0;
+}
+
+void EnhancedDisplayManager::setPageGeometry(int charsPerLine, int lines) {
+    lineWidth = charsPerLine;
+    linesPerPage = lines;
+}
+
+void EnhancedDisplayManager::setPageRenderer(PageRenderer renderer) {
+    pageRenderer = renderer;
+}
+
+// Lays the message out once; paging afterwards only changes currentPage
+void EnhancedDisplayManager::displayMessage(const EnhancedMessage& message) {
+    currentMessage = &message;
+    messageDisplayed = true;
+    displayStartTime = millis();
+    calculatePages(message.data.rawMessage);
+    currentPage = 0;
+    refreshDisplay();
+}
+
+void EnhancedDisplayManager::calculatePages(const char* text) {
+    MessageFormatter::layoutText(text, lineWidth, linesPerPage, layout);
+    totalPages = layout.pageCount;
+}
+
+void EnhancedDisplayManager::displayPage(const char* text, int page) {
+    (void)text;
+    if (pageRenderer && currentMessage) {
+        pageRenderer(*currentMessage, layout, page);
+    }
+}
+
+void EnhancedDisplayManager::nextPage() {
+    if (!messageDisplayed || totalPages <= 1) return;
+    currentPage = (currentPage + 1) % totalPages;
+    refreshDisplay();
+}
+
+void EnhancedDisplayManager::previousPage() {
+    if (!messageDisplayed || totalPages <= 1) return;
+    currentPage = (currentPage + totalPages - 1) % totalPages;
+    refreshDisplay();
+}
+
+void EnhancedDisplayManager::refreshDisplay() {
+    if (!messageDisplayed || !currentMessage) return;
+    displayPage(currentMessage->data.rawMessage, currentPage);
+}
+
+void EnhancedDisplayManager::clearDisplay() {
+    currentMessage = nullptr;
+    messageDisplayed = false;
+    currentPage = 0;
+    totalPages = 0;
+}
+
+bool EnhancedDisplayManager::isMessageDisplayed() {
+    return messageDisplayed;
+}
+
+int EnhancedDisplayManager::getCurrentPage() {
+    return currentPage;
+}
+
+int EnhancedDisplayManager::getTotalPages() {
+    return totalPages;
+}
+
+// ================================
+// MESSAGE STATISTICS
+// ================================
+void MessageStatistics::init() {
+    resetStatistics();
+}
+
+void MessageStatistics::recordMessage(MessageType type) {
+    totalMessages++;
+    if (type == MSG_CONSULTATION_REQUEST) consultationRequests++;
+    else if (type == MSG_SYSTEM_NOTIFICATION) systemNotifications++;
+    else if (type == MSG_EMERGENCY) emergencyMessages++;
+}
+
+// Running mean, so no sum can overflow over a long uptime
+void MessageStatistics::recordResponseTime(unsigned long responseTime) {
+    responseCount++;
+    averageResponseTime += ((long)responseTime - (long)averageResponseTime) / (long)responseCount;
+    if (responseTime > maxResponseTime) maxResponseTime = responseTime;
+}
+
+void MessageStatistics::printStatistics() {
+    Serial.printf("Messages: %lu total (%lu consultation, %lu notification, %lu emergency), %lu/h\n",
+                  totalMessages, consultationRequests, systemNotifications, emergencyMessages,
+                  getMessagesPerHour());
+    if (responseCount > 0) {
+        Serial.printf("Responses: %lu, render to button avg %lums max %lums\n",
+                      responseCount, averageResponseTime, maxResponseTime);
+    }
+}
+
+void MessageStatistics::resetStatistics() {
+    totalMessages = 0;
+    consultationRequests = 0;
+    systemNotifications = 0;
+    emergencyMessages = 0;
+    averageResponseTime = 0;
+    responseCount = 0;
+    maxResponseTime = 0;
+    lastResetTime = millis();
+}
+
+unsigned long MessageStatistics::getTotalMessages() {
+    return totalMessages;
+}
+
+unsigned long MessageStatistics::getMessagesPerHour() {
+    unsigned long elapsed = millis() - lastResetTime;
+    if (elapsed < 60000UL) return totalMessages;
+    return (unsigned long)((uint64_t)totalMessages * 3600000UL / elapsed);
+}
+
+float MessageStatistics::getAverageResponseTime() {
+    return responseCount > 0 ? (float)averageResponseTime : 0.0f;
+}
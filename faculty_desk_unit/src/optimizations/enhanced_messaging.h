@@ -7,7 +7,7 @@
 #define ENHANCED_MESSAGING_H
 
 #include <Arduino.h>
-#include <ArduinoJson.h>
+#include "json_stream.h"
 
 // Message type definitions
 enum MessageType {
@@ -62,6 +62,19 @@ struct SystemNotification {
     bool persistent;
 };
 
+// Hop timestamps of one message, epoch milliseconds (0 = unknown, e.g.
+// before NTP sync). The millis() copies give durations that survive an
+// unsynced clock.
+struct MessageTrace {
+    uint64_t sentAtMs;          // Central system, from the payload
+    uint64_t receivedAtMs;
+    uint64_t renderedAtMs;      // First page finished drawing
+    uint64_t respondedAtMs;     // Button pressed
+    unsigned long renderedMillis;
+    unsigned long respondedMillis;
+    bool rendered;
+};
+
 // Enhanced message container
 struct EnhancedMessage {
     MessageType type;
@@ -71,6 +84,7 @@ struct EnhancedMessage {
     unsigned long expiryTime;
     char messageId[32];
     char senderId[32];
+    MessageTrace trace;
     
     union {
         ConsultationRequest consultation;
@@ -79,62 +93,124 @@ struct EnhancedMessage {
     } data;
 };
 
+// Line and page boundaries of one message body, stored as offsets into the
+// text so paging never re-wraps. 64 lines covers a full 512-byte body.
+#define MESSAGE_LAYOUT_MAX_LINES 64
+
+struct MessageLayout {
+    uint16_t lineStart[MESSAGE_LAYOUT_MAX_LINES];
+    uint8_t lineLength[MESSAGE_LAYOUT_MAX_LINES];
+    uint8_t lineCount;
+    uint8_t lineWidth;
+    uint8_t linesPerPage;
+    uint8_t pageCount;
+};
+
 // Message parser class
+// JSON payloads are read in one JsonStream sweep into static scratch fields,
+// then formatted into the message body; nothing is allocated.
 class MessageParser {
 private:
-    static DynamicJsonDocument jsonDoc;
-    static bool parseConsultationRequest(const char* json, ConsultationRequest& request);
-    static bool parseSystemNotification(const char* json, SystemNotification& notification);
-    static MessageType detectMessageType(const char* json);
+    struct ParseScratch {
+        ConsultationRequest request;
+        SystemNotification notification;
+        MessageType type;
+        MessagePriority priority;
+        char messageId[32];
+        char senderId[32];
+        uint64_t sentAtMs;
+        bool hasSentAt;             // sent_at beats the display timestamp
+        bool hasConsultationFields;
+        bool hasNotificationFields;
+    };
+    static ParseScratch scratch;  // Parsing runs on the network side only
+    
+    static bool handleToken(const JsonToken& token, void* context);
+    static void resetScratch();
+    static MessageType detectMessageType(const char* typeStr);
     static MessagePriority parsePriority(const char* priorityStr);
+    static bool parseTimestamp(const JsonToken& token, uint64_t& epochMs);
     
 public:
     static void init();
-    static bool parseMessage(const char* rawMessage, EnhancedMessage& message);
-    static bool parseJSON(const char* json, EnhancedMessage& message);
-    static bool parsePlainText(const char* text, EnhancedMessage& message);
+    static bool parseMessage(const char* rawMessage, size_t length, EnhancedMessage& message);
+    static bool parseJSON(const char* json, size_t length, EnhancedMessage& message);
+    static bool parsePlainText(const char* text, size_t length, EnhancedMessage& message);
     static bool validateMessage(const EnhancedMessage& message);
     static void printMessage(const EnhancedMessage& message);
 };
 
 // Message queue management
+// Fixed inbox of MAX_MESSAGES bodies that never move once written. Order is
+// kept as slot indices in one FIFO ring per priority level, so inserting,
+// expiring the oldest and removing never copy a message. Logical index 0 is
+// the oldest message of the highest priority present.
 class MessageQueue {
 private:
     static const int MAX_MESSAGES = 10;
+    static const int PRIORITY_LEVELS = PRIORITY_EMERGENCY;
+    static const unsigned long CLEANUP_INTERVAL_MS = 1000;
     static EnhancedMessage messages[MAX_MESSAGES];
+    static uint8_t ring[PRIORITY_LEVELS][MAX_MESSAGES];  // Slot indices, oldest first
+    static uint8_t ringHead[PRIORITY_LEVELS];
+    static uint8_t ringCount[PRIORITY_LEVELS];
+    static uint16_t freeSlots;       // Bit per slot that is neither queued nor reserved
+    static uint16_t linkedSlots;     // Bit per slot that is queued in a ring
     static int messageCount;
-    static int currentIndex;
+    static int unreadCount;
+    static int currentSlot;          // Selected message; never evicted or expired
     static unsigned long lastCleanup;
     
-    static void removeExpiredMessages();
+    static int priorityLevel(MessagePriority priority);
+    static int slotAt(int index);
+    static int indexOfSlot(int slot);
+    static int removeExpiredMessages();
     static int findOldestMessage();
-    static void shiftMessages(int startIndex);
+    static void unlinkSlot(int slot);
+    static bool isReserved(int slot);
     
 public:
     static void init();
     static bool addMessage(const EnhancedMessage& message);
+    static EnhancedMessage* reserveSlot();
+    static bool commitSlot(EnhancedMessage* message);   // False unless reserved and not yet committed
+    static bool releaseSlot(EnhancedMessage* message);  // False unless reserved and not yet committed
+    static const EnhancedMessage* peekMessage(int index);
     static bool getMessage(int index, EnhancedMessage& message);
     static bool getCurrentMessage(EnhancedMessage& message);
     static bool getNextMessage(EnhancedMessage& message);
     static bool getPreviousMessage(EnhancedMessage& message);
+    static bool selectMessage(int index);
+    static void clearSelection();
+    static int getCurrentIndex();
     static int getMessageCount();
     static int getUnreadCount();
     static void markAsRead(int index);
+    static void markAsRendered(int index, uint64_t epochMs, unsigned long nowMs);
     static void markAsAcknowledged(int index);
     static void removeMessage(int index);
     static void clearAll();
-    static void cleanup();
+    static int cleanup();
     static void printQueue();
 };
 
 // Enhanced display manager
+// Owns paging state for the displayed message; drawing is delegated to a
+// page renderer supplied by the sketch
 class EnhancedDisplayManager {
+public:
+    typedef void (*PageRenderer)(const EnhancedMessage& message, const MessageLayout& layout, int page);
+
 private:
-    static EnhancedMessage currentMessage;
+    static const EnhancedMessage* currentMessage;  // Points into the MessageQueue, never copied
+    static MessageLayout layout;
+    static PageRenderer pageRenderer;
     static bool messageDisplayed;
     static unsigned long displayStartTime;
     static int currentPage;
     static int totalPages;
+    static int lineWidth;
+    static int linesPerPage;
     
     static void displayConsultationRequest(const ConsultationRequest& request);
     static void displaySystemNotification(const SystemNotification& notification);
@@ -147,6 +223,8 @@ private:
     
 public:
     static void init();
+    static void setPageGeometry(int charsPerLine, int linesPerPage);
+    static void setPageRenderer(PageRenderer renderer);
     static void displayMessage(const EnhancedMessage& message);
     static void displayMessageQueue();
     static void nextPage();
@@ -156,6 +234,8 @@ public:
     static void refreshDisplay();
     static void clearDisplay();
     static bool isMessageDisplayed();
+    static int getCurrentPage();
+    static int getTotalPages();
     static void setAutoAdvance(bool enabled, unsigned long interval);
 };
 
@@ -208,11 +288,14 @@ private:
     static unsigned long systemNotifications;
     static unsigned long emergencyMessages;
     static unsigned long averageResponseTime;
+    static unsigned long responseCount;
+    static unsigned long maxResponseTime;
     static unsigned long lastResetTime;
     
 public:
     static void init();
     static void recordMessage(MessageType type);
+    // Render to button press, in milliseconds
     static void recordResponseTime(unsigned long responseTime);
     static void printStatistics();
     static void resetStatistics();
@@ -230,6 +313,7 @@ namespace MessageFormatter {
     void formatPriority(MessagePriority priority, char* formatted, size_t formattedSize);
     
     // Text wrapping and pagination
+    void layoutText(const char* text, int lineWidth, int linesPerPage, MessageLayout& layout);
     int calculateTextPages(const char* text, int lineWidth, int linesPerPage);
     void getTextPage(const char* text, int page, int lineWidth, int linesPerPage, char* output, size_t outputSize);
     void wrapText(const char* input, char* output, size_t outputSize, int lineWidth);
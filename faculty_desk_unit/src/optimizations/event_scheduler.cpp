@@ -0,0 +1,200 @@
+/**
+ * Deadline scheduler implementation for ConsultEase Faculty Desk Unit
+ */
+
+#include "event_scheduler.h"
+
+EventScheduler::EventScheduler() : heapSize(0), timerCount(0), powerSave(false), busyUs(0) {
+}
+
+bool EventScheduler::earlier(uint8_t a, uint8_t b) const {
+    return (int32_t)(timers[a].deadline - timers[b].deadline) < 0;
+}
+
+void EventScheduler::place(uint8_t position, uint8_t id) {
+    heap[position] = id;
+    timers[id].heapIndex = position;
+}
+
+void EventScheduler::siftUp(uint8_t position) {
+    uint8_t id = heap[position];
+    while (position > 0) {
+        uint8_t parent = (position - 1) / 2;
+        if (!earlier(id, heap[parent])) break;
+        place(position, heap[parent]);
+        position = parent;
+    }
+    place(position, id);
+}
+
+void EventScheduler::siftDown(uint8_t position) {
+    uint8_t id = heap[position];
+    for (;;) {
+        uint8_t child = position * 2 + 1;
+        if (child >= heapSize) break;
+        if (child + 1 < heapSize && earlier(heap[child + 1], heap[child])) child++;
+        if (!earlier(heap[child], id)) break;
+        place(position, heap[child]);
+        position = child;
+    }
+    place(position, id);
+}
+
+void EventScheduler::removeAt(uint8_t position) {
+    timers[heap[position]].heapIndex = EVENT_TIMER_INVALID;
+    heapSize--;
+    if (position == heapSize) return;
+
+    uint8_t moved = heap[heapSize];
+    place(position, moved);
+    siftDown(position);
+    siftUp(timers[moved].heapIndex);
+}
+
+uint8_t EventScheduler::addTimer(const char* name, EventCallback callback, void* context, uint32_t periodMs,
+                                 EventPriority priority, bool powerSensitive) {
+    if (!callback || timerCount >= EVENT_SCHEDULER_MAX_TIMERS) return EVENT_TIMER_INVALID;
+
+    Timer& timer = timers[timerCount];
+    timer.deadline = 0;
+    timer.period = periodMs;
+    timer.callback = callback;
+    timer.context = context;
+    timer.heapIndex = EVENT_TIMER_INVALID;
+    timer.priority = priority;
+    timer.powerSensitive = powerSensitive;
+    timer.runPending = false;
+    memset(&timer.stats, 0, sizeof(timer.stats));
+    timer.stats.name = name ? name : "?";
+    return timerCount++;
+}
+
+void EventScheduler::start(uint8_t id, uint32_t now) {
+    if (id < timerCount) schedule(id, timers[id].period, now);
+}
+
+void EventScheduler::schedule(uint8_t id, uint32_t delayMs, uint32_t now) {
+    if (id >= timerCount) return;
+    timers[id].runPending = false;
+    arm(id, delayMs, now);
+}
+
+void EventScheduler::arm(uint8_t id, uint32_t delayMs, uint32_t now) {
+    Timer& timer = timers[id];
+    timer.deadline = now + delayMs;
+    if (timer.heapIndex == EVENT_TIMER_INVALID) {
+        timer.heapIndex = heapSize;
+        heap[heapSize++] = id;
+    }
+    // The deadline may have moved either way
+    siftDown(timer.heapIndex);
+    siftUp(timer.heapIndex);
+}
+
+void EventScheduler::scheduleNoLaterThan(uint8_t id, uint32_t delayMs, uint32_t now) {
+    if (id >= timerCount) return;
+    if (isArmed(id) && (int32_t)(timers[id].deadline - (now + delayMs)) <= 0) return;
+    schedule(id, delayMs, now);
+}
+
+void EventScheduler::cancel(uint8_t id) {
+    if (id >= timerCount) return;
+    timers[id].runPending = false;
+    if (timers[id].heapIndex != EVENT_TIMER_INVALID) removeAt(timers[id].heapIndex);
+}
+
+bool EventScheduler::isArmed(uint8_t id) const {
+    return id < timerCount && timers[id].heapIndex != EVENT_TIMER_INVALID;
+}
+
+// Periodic timers keep their cadence but never replay periods missed during
+// a stall; one-shots leave the heap
+void EventScheduler::rearm(uint8_t id, uint32_t now) {
+    Timer& timer = timers[id];
+    if (timer.period == 0) {
+        removeAt(timer.heapIndex);
+        return;
+    }
+
+    uint32_t period = timer.period;
+    if (powerSave && timer.powerSensitive) period *= EVENT_POWER_SAVE_STRETCH;
+    uint32_t next = timer.deadline + period;
+    arm(id, (int32_t)(next - now) > 0 ? next - now : period, now);
+}
+
+void EventScheduler::runTimer(uint8_t id, uint32_t deadline) {
+    Timer& timer = timers[id];
+    EventTimerStats& stats = timer.stats;
+
+    int32_t late = (int32_t)(millis() - deadline);
+    if (late < 0) late = 0;
+    stats.totalLateMs += late;
+    if ((uint32_t)late > stats.maxLateMs) stats.maxLateMs = late;
+
+    uint32_t start = micros();
+    timer.callback(timer.context);
+    uint32_t elapsed = micros() - start;
+
+    stats.runs++;
+    stats.totalUs += elapsed;
+    if (elapsed > stats.maxUs) stats.maxUs = elapsed;
+    busyUs += elapsed;
+}
+
+void EventScheduler::runDue(uint32_t now) {
+    // Collect everything due first so priority, not heap order, decides who
+    // goes first; equal priorities keep deadline order
+    uint8_t due[EVENT_SCHEDULER_MAX_TIMERS];
+    uint32_t deadlines[EVENT_SCHEDULER_MAX_TIMERS];
+    uint8_t count = 0;
+
+    while (heapSize > 0 && (int32_t)(timers[heap[0]].deadline - now) <= 0) {
+        uint8_t id = heap[0];
+        uint32_t deadline = timers[id].deadline;
+        timers[id].runPending = true;
+        rearm(id, now);
+
+        uint8_t position = count++;
+        while (position > 0 && timers[due[position - 1]].priority < timers[id].priority) {
+            due[position] = due[position - 1];
+            deadlines[position] = deadlines[position - 1];
+            position--;
+        }
+        due[position] = id;
+        deadlines[position] = deadline;
+    }
+
+    for (uint8_t i = 0; i < count; i++) {
+        // An earlier callback may have rescheduled or cancelled this one
+        if (!timers[due[i]].runPending) continue;
+        timers[due[i]].runPending = false;
+        runTimer(due[i], deadlines[i]);
+    }
+}
+
+uint32_t EventScheduler::msUntilNext(uint32_t now) const {
+    if (heapSize == 0) return EVENT_SCHEDULER_IDLE;
+
+    int32_t remaining = (int32_t)(timers[heap[0]].deadline - now);
+    return remaining > 0 ? remaining : 0;
+}
+
+void EventScheduler::resetStats() {
+    for (uint8_t i = 0; i < timerCount; i++) {
+        const char* name = timers[i].stats.name;
+        memset(&timers[i].stats, 0, sizeof(timers[i].stats));
+        timers[i].stats.name = name;
+    }
+}
+
+void EventScheduler::printStats(const char* label) const {
+    Serial.printf("Scheduler [%s]%s\n", label, powerSave ? " (power save)" : "");
+    for (uint8_t i = 0; i < timerCount; i++) {
+        const EventTimerStats& stats = timers[i].stats;
+        if (stats.runs == 0) continue;
+        Serial.printf("  %-10s runs %lu | avg %luus max %luus | late avg %lums max %lums\n",
+                      stats.name, (unsigned long)stats.runs,
+                      (unsigned long)(stats.totalUs / stats.runs), (unsigned long)stats.maxUs,
+                      (unsigned long)(stats.totalLateMs / stats.runs), (unsigned long)stats.maxLateMs);
+    }
+}
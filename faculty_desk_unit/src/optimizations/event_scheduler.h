@@ -0,0 +1,109 @@
+/**
+ * Deadline scheduler for ConsultEase Faculty Desk Unit
+ * Timers sit in a fixed-size binary min-heap keyed on their next deadline,
+ * so the owner can sleep exactly until the earliest one instead of polling
+ * every subsystem on a fixed tick. Every run is profiled (execution time,
+ * lateness against its deadline) and the busy time feeds CPUOptimizer.
+ */
+
+#ifndef EVENT_SCHEDULER_H
+#define EVENT_SCHEDULER_H
+
+#include <Arduino.h>
+
+#define EVENT_SCHEDULER_MAX_TIMERS 12
+#define EVENT_TIMER_INVALID 0xFF
+
+// msUntilNext() when nothing is armed
+#define EVENT_SCHEDULER_IDLE 0xFFFFFFFFUL
+
+// Power-sensitive periodic timers run this many times less often in power save
+#define EVENT_POWER_SAVE_STRETCH 4
+
+// Timers due in the same pass run highest priority first
+enum EventPriority : uint8_t {
+    EVENT_PRIORITY_LOW = 0,
+    EVENT_PRIORITY_NORMAL,
+    EVENT_PRIORITY_HIGH
+};
+
+typedef void (*EventCallback)(void* context);
+
+struct EventTimerStats {
+    const char* name;
+    uint32_t runs;
+    uint32_t totalUs;
+    uint32_t maxUs;
+    uint32_t totalLateMs;     // Start time minus deadline, summed
+    uint32_t maxLateMs;
+};
+
+class EventScheduler {
+private:
+    struct Timer {
+        uint32_t deadline;
+        uint32_t period;          // 0 = one-shot
+        EventCallback callback;
+        void* context;
+        uint8_t heapIndex;        // EVENT_TIMER_INVALID while disarmed
+        uint8_t priority;
+        bool powerSensitive;
+        bool runPending;          // Collected by runDue(), cleared by schedule/cancel
+        EventTimerStats stats;
+    };
+
+    Timer timers[EVENT_SCHEDULER_MAX_TIMERS];
+    uint8_t heap[EVENT_SCHEDULER_MAX_TIMERS];   // Timer ids, earliest deadline first
+    uint8_t heapSize;
+    uint8_t timerCount;
+    bool powerSave;
+    volatile uint32_t busyUs;     // Running total; wraps, diff successive reads
+
+    // millis() wraps; deadlines are compared by signed distance
+    bool earlier(uint8_t a, uint8_t b) const;
+    void place(uint8_t position, uint8_t id);
+    void siftUp(uint8_t position);
+    void siftDown(uint8_t position);
+    void removeAt(uint8_t position);
+    void arm(uint8_t id, uint32_t delayMs, uint32_t now);
+    void rearm(uint8_t id, uint32_t now);
+    void runTimer(uint8_t id, uint32_t deadline);
+
+public:
+    EventScheduler();
+
+    // Registers a disarmed timer; periodMs > 0 re-arms it after every run.
+    // Power-sensitive timers are stretched while power save is on.
+    uint8_t addTimer(const char* name, EventCallback callback, void* context, uint32_t periodMs,
+                     EventPriority priority = EVENT_PRIORITY_NORMAL, bool powerSensitive = false);
+
+    // Arms a periodic timer for one period from now
+    void start(uint8_t id, uint32_t now);
+    // (Re)arms a timer to fire delayMs from now
+    void schedule(uint8_t id, uint32_t delayMs, uint32_t now);
+    // Arms it for the earlier of its current deadline and delayMs from now
+    void scheduleNoLaterThan(uint8_t id, uint32_t delayMs, uint32_t now);
+    void cancel(uint8_t id);
+    bool isArmed(uint8_t id) const;
+
+    // Runs every timer that is due. Periodic timers are re-armed before their
+    // callback runs, so a callback may reschedule or cancel itself.
+    void runDue(uint32_t now);
+
+    uint32_t msUntilNext(uint32_t now) const;
+
+    void setPowerSave(bool enabled) { powerSave = enabled; }
+    bool isPowerSave() const { return powerSave; }
+
+    // Work done for this scheduler's context outside a timer (event handlers)
+    void recordBusy(uint32_t us) { busyUs += us; }
+    // Only the owning task writes the total, so another task may sample it
+    uint32_t getBusyMicros() const { return busyUs; }
+
+    uint8_t getTimerCount() const { return timerCount; }
+    const EventTimerStats& getStats(uint8_t id) const { return timers[id].stats; }
+    void resetStats();
+    void printStats(const char* label) const;
+};
+
+#endif // EVENT_SCHEDULER_H
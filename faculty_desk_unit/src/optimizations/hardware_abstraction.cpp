@@ -0,0 +1,385 @@
+/**
+ * Hardware abstraction implementation for ConsultEase Faculty Desk Unit
+ */
+
+#include "hardware_abstraction.h"
+#include <Adafruit_GFX.h>
+#include <Adafruit_ST7789.h>
+#include <SPI.h>
+
+#ifdef PLATFORM_ESP32
+    #include <driver/spi_master.h>
+    #include <driver/gpio.h>
+    #include <esp_heap_caps.h>
+#endif
+
+// ST7789 commands used by the DMA path
+#define ST7789_CMD_CASET 0x2A
+#define ST7789_CMD_RASET 0x2B
+#define ST7789_CMD_RAMWR 0x2C
+
+// Transactions per window: CASET + data, RASET + data, RAMWR + pixels
+#define ST7789_WINDOW_TRANSACTIONS 6
+
+static inline uint16_t toPanelOrder(uint16_t color) {
+    return (color >> 8) | (color << 8);
+}
+
+// Routes Adafruit_GFX primitives (text, circles, lines) onto
+// ST7789Display::fillWindow() once the panel has moved to the DMA driver
+class DmaPanelGFX : public Adafruit_GFX {
+private:
+    ST7789Display* panel;
+
+public:
+    DmaPanelGFX(ST7789Display* owner, int16_t w, int16_t h) : Adafruit_GFX(w, h), panel(owner) {}
+
+    void drawPixel(int16_t x, int16_t y, uint16_t color) override {
+        panel->fillWindow(x, y, 1, 1, color);
+    }
+
+    void fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) override {
+        panel->fillWindow(x, y, w, h, color);
+    }
+
+    void drawFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color) override {
+        panel->fillWindow(x, y, w, 1, color);
+    }
+
+    void drawFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color) override {
+        panel->fillWindow(x, y, 1, h, color);
+    }
+
+    void fillScreen(uint16_t color) override {
+        panel->fillWindow(0, 0, width(), height(), color);
+    }
+};
+
+#ifdef PLATFORM_ESP32
+// One transaction set per strip buffer, alive until the DMA finishes with it
+static spi_transaction_t stripTransactions[2][ST7789_WINDOW_TRANSACTIONS];
+static int st7789DcPin = -1;
+
+// Runs in the SPI ISR: D/C low for commands, high for parameters and pixels
+static void IRAM_ATTR st7789PreTransfer(spi_transaction_t* transaction) {
+    gpio_set_level((gpio_num_t)st7789DcPin, (int)(intptr_t)transaction->user);
+}
+
+static void fillCommand(spi_transaction_t& t, uint8_t command) {
+    memset(&t, 0, sizeof(t));
+    t.flags = SPI_TRANS_USE_TXDATA;
+    t.length = 8;
+    t.tx_data[0] = command;
+    t.user = (void*)0;
+}
+
+static void fillRange(spi_transaction_t& t, uint16_t start, uint16_t end) {
+    memset(&t, 0, sizeof(t));
+    t.flags = SPI_TRANS_USE_TXDATA;
+    t.length = 32;
+    t.tx_data[0] = start >> 8;
+    t.tx_data[1] = start & 0xFF;
+    t.tx_data[2] = end >> 8;
+    t.tx_data[3] = end & 0xFF;
+    t.user = (void*)1;
+}
+
+static void fillPixels(spi_transaction_t& t, const uint16_t* pixels, size_t count) {
+    memset(&t, 0, sizeof(t));
+    t.length = count * 16;
+    t.tx_buffer = pixels;
+    t.user = (void*)1;
+}
+#endif
+
+// ================================
+// ST7789 DISPLAY
+// ================================
+ST7789Display::ST7789Display(HardwareConfig* hwConfig)
+    : tft(nullptr), dmaGfx(nullptr), spiDevice(nullptr), config(hwConfig),
+      stripCapacity(0), activeStrip(0), asyncActive(false) {
+    stripBuffers[0] = stripBuffers[1] = nullptr;
+    pendingTransactions[0] = pendingTransactions[1] = 0;
+}
+
+ST7789Display::~ST7789Display() {
+    waitForTransfers();
+    delete (DmaPanelGFX*)dmaGfx;
+    delete (Adafruit_ST7789*)tft;
+
+#ifdef PLATFORM_ESP32
+    if (spiDevice) {
+        spi_bus_remove_device((spi_device_handle_t)spiDevice);
+        spi_bus_free(SPI3_HOST);
+    }
+    heap_caps_free(stripBuffers[0]);
+    heap_caps_free(stripBuffers[1]);
+#else
+    free(stripBuffers[0]);
+    free(stripBuffers[1]);
+#endif
+}
+
+bool ST7789Display::init() {
+    Adafruit_ST7789* panel = new Adafruit_ST7789(config->pinDisplayCS, config->pinDisplayDC, config->pinDisplayRST);
+    if (!panel) return false;
+
+    tft = panel;
+    panel->init(config->displayWidth, config->displayHeight);
+    panel->setRotation(config->displayRotation);
+
+    if (config->pinDisplayBacklight >= 0) {
+        pinMode(config->pinDisplayBacklight, OUTPUT);
+        digitalWrite(config->pinDisplayBacklight, HIGH);
+    }
+    return true;
+}
+
+// Primitives draw on Adafruit_ST7789 until the DMA handoff, then on the adapter
+void* ST7789Display::target() {
+    return asyncActive ? dmaGfx : tft;
+}
+
+void ST7789Display::setRotation(int rotation) {
+    // MADCTL is only written by the Adafruit driver, so rotate before the handoff
+    if (!asyncActive) ((Adafruit_ST7789*)tft)->setRotation(rotation);
+}
+
+void ST7789Display::fillScreen(uint16_t color) {
+    ((Adafruit_GFX*)target())->fillScreen(color);
+}
+
+void ST7789Display::fillRect(int x, int y, int width, int height, uint16_t color) {
+    ((Adafruit_GFX*)target())->fillRect(x, y, width, height, color);
+}
+
+void ST7789Display::drawPixel(int x, int y, uint16_t color) {
+    ((Adafruit_GFX*)target())->drawPixel(x, y, color);
+}
+
+void ST7789Display::drawLine(int x0, int y0, int x1, int y1, uint16_t color) {
+    ((Adafruit_GFX*)target())->drawLine(x0, y0, x1, y1, color);
+}
+
+void ST7789Display::drawRect(int x, int y, int width, int height, uint16_t color) {
+    ((Adafruit_GFX*)target())->drawRect(x, y, width, height, color);
+}
+
+void ST7789Display::drawCircle(int x, int y, int radius, uint16_t color) {
+    ((Adafruit_GFX*)target())->drawCircle(x, y, radius, color);
+}
+
+void ST7789Display::fillCircle(int x, int y, int radius, uint16_t color) {
+    ((Adafruit_GFX*)target())->fillCircle(x, y, radius, color);
+}
+
+void ST7789Display::setCursor(int x, int y) {
+    ((Adafruit_GFX*)target())->setCursor(x, y);
+}
+
+void ST7789Display::setTextColor(uint16_t color) {
+    ((Adafruit_GFX*)target())->setTextColor(color);
+}
+
+void ST7789Display::setTextSize(int size) {
+    ((Adafruit_GFX*)target())->setTextSize(size);
+}
+
+void ST7789Display::print(const char* text) {
+    ((Adafruit_GFX*)target())->print(text);
+}
+
+void ST7789Display::println(const char* text) {
+    ((Adafruit_GFX*)target())->println(text);
+}
+
+int ST7789Display::width() {
+    return ((Adafruit_GFX*)tft)->width();
+}
+
+int ST7789Display::height() {
+    return ((Adafruit_GFX*)tft)->height();
+}
+
+void ST7789Display::setBacklight(bool enabled) {
+    if (config->pinDisplayBacklight < 0) return;
+    digitalWrite(config->pinDisplayBacklight, enabled ? HIGH : LOW);
+}
+
+void ST7789Display::setBrightness(uint8_t brightness) {
+    if (config->pinDisplayBacklight < 0) return;
+    analogWrite(config->pinDisplayBacklight, brightness);
+}
+
+void ST7789Display::update() {
+    waitForTransfers();
+}
+
+// Allocates the two strip buffers and, on ESP32, takes the panel over from
+// the Arduino SPI driver so strips can be sent by DMA. Without the handoff
+// the buffers are still used, just pushed with blocking writes.
+bool ST7789Display::enableAsyncTransfers(size_t stripPixels, uint32_t spiFrequency) {
+    if (stripBuffers[0]) return asyncActive;
+
+    size_t bytes = stripPixels * sizeof(uint16_t);
+#ifdef PLATFORM_ESP32
+    stripBuffers[0] = (uint16_t*)heap_caps_malloc(bytes, MALLOC_CAP_DMA);
+    stripBuffers[1] = (uint16_t*)heap_caps_malloc(bytes, MALLOC_CAP_DMA);
+#else
+    stripBuffers[0] = (uint16_t*)malloc(bytes);
+    stripBuffers[1] = (uint16_t*)malloc(bytes);
+#endif
+    if (!stripBuffers[0] || !stripBuffers[1]) {
+        Serial.println("WARNING: Display strip buffers unavailable");
+#ifdef PLATFORM_ESP32
+        heap_caps_free(stripBuffers[0]);
+        heap_caps_free(stripBuffers[1]);
+#else
+        free(stripBuffers[0]);
+        free(stripBuffers[1]);
+#endif
+        stripBuffers[0] = stripBuffers[1] = nullptr;
+        return false;
+    }
+    stripCapacity = stripPixels;
+
+#ifdef PLATFORM_ESP32
+    // Release the bus from the Arduino driver; the panel keeps its state
+    SPI.end();
+
+    spi_bus_config_t bus = {};
+    bus.mosi_io_num = config->pinDisplayMOSI;
+    bus.miso_io_num = -1;
+    bus.sclk_io_num = config->pinDisplaySCLK;
+    bus.quadwp_io_num = -1;
+    bus.quadhd_io_num = -1;
+    bus.max_transfer_sz = bytes;
+
+    spi_device_interface_config_t device = {};
+    device.clock_speed_hz = spiFrequency;
+    device.mode = 0;
+    device.spics_io_num = config->pinDisplayCS;
+    device.queue_size = 2 * ST7789_WINDOW_TRANSACTIONS;
+    device.pre_cb = st7789PreTransfer;
+
+    st7789DcPin = config->pinDisplayDC;
+    spi_device_handle_t handle = nullptr;
+    if (spi_bus_initialize(SPI3_HOST, &bus, SPI_DMA_CH_AUTO) != ESP_OK ||
+        spi_bus_add_device(SPI3_HOST, &device, &handle) != ESP_OK) {
+        Serial.println("WARNING: SPI DMA setup failed, staying on blocking writes");
+        spi_bus_free(SPI3_HOST);
+        SPI.begin();
+        return false;
+    }
+
+    spiDevice = handle;
+    dmaGfx = new DmaPanelGFX(this, width(), height());
+    asyncActive = true;
+    Serial.printf("ST7789 DMA enabled: 2 x %u byte strips at %u Hz\n",
+                  (unsigned)bytes, (unsigned)spiFrequency);
+#endif
+    return asyncActive;
+}
+
+// Blocks until every transaction queued from the given strip has completed
+void ST7789Display::waitForStrip(int index) {
+#ifdef PLATFORM_ESP32
+    while (pendingTransactions[index] > 0) {
+        spi_transaction_t* done = nullptr;
+        if (spi_device_get_trans_result((spi_device_handle_t)spiDevice, &done, portMAX_DELAY) != ESP_OK) {
+            break;
+        }
+        // Completions come back in queue order, attribute each to its strip
+        int owner = (done >= stripTransactions[1] &&
+                     done < stripTransactions[1] + ST7789_WINDOW_TRANSACTIONS) ? 1 : 0;
+        pendingTransactions[owner]--;
+    }
+#endif
+    pendingTransactions[index] = 0;
+}
+
+void ST7789Display::waitForTransfers() {
+    waitForStrip(0);
+    waitForStrip(1);
+}
+
+uint16_t* ST7789Display::acquireStripBuffer(size_t* capacityPixels) {
+    if (capacityPixels) *capacityPixels = stripCapacity;
+    if (!stripBuffers[activeStrip]) return nullptr;
+
+    waitForStrip(activeStrip);
+    return stripBuffers[activeStrip];
+}
+
+void ST7789Display::queueWindow(int index, int x, int y, int width, int height) {
+#ifdef PLATFORM_ESP32
+    spi_transaction_t* t = stripTransactions[index];
+    fillCommand(t[0], ST7789_CMD_CASET);
+    fillRange(t[1], x, x + width - 1);
+    fillCommand(t[2], ST7789_CMD_RASET);
+    fillRange(t[3], y, y + height - 1);
+    fillCommand(t[4], ST7789_CMD_RAMWR);
+    fillPixels(t[5], stripBuffers[index], (size_t)width * height);
+
+    for (int i = 0; i < ST7789_WINDOW_TRANSACTIONS; i++) {
+        spi_device_queue_trans((spi_device_handle_t)spiDevice, &t[i], portMAX_DELAY);
+    }
+    pendingTransactions[index] = ST7789_WINDOW_TRANSACTIONS;
+#endif
+}
+
+void ST7789Display::pushStrip(int x, int y, int width, int height, uint16_t* pixels) {
+    int index = (pixels == stripBuffers[1]) ? 1 : 0;
+
+    if (asyncActive) {
+        queueWindow(index, x, y, width, height);
+    } else {
+        Adafruit_ST7789* panel = (Adafruit_ST7789*)tft;
+        panel->startWrite();
+        panel->setAddrWindow(x, y, width, height);
+        panel->writePixels(pixels, (uint32_t)width * height, true, true);
+        panel->endWrite();
+    }
+
+    // Render the next strip into the other buffer while this one is sent
+    activeStrip = index ^ 1;
+}
+
+// Blocking solid fill on the DMA driver, used by the primitive fallbacks
+void ST7789Display::fillWindow(int x, int y, int width, int height, uint16_t color) {
+#ifdef PLATFORM_ESP32
+    if (x < 0) { width += x; x = 0; }
+    if (y < 0) { height += y; y = 0; }
+    if (x + width > this->width()) width = this->width() - x;
+    if (y + height > this->height()) height = this->height() - y;
+    if (width <= 0 || height <= 0) return;
+
+    waitForTransfers();
+
+    uint16_t* buffer = stripBuffers[0];
+    size_t total = (size_t)width * height;
+    size_t chunk = total < stripCapacity ? total : stripCapacity;
+    uint16_t value = toPanelOrder(color);
+    for (size_t i = 0; i < chunk; i++) buffer[i] = value;
+
+    spi_device_handle_t handle = (spi_device_handle_t)spiDevice;
+    spi_transaction_t t;
+    fillCommand(t, ST7789_CMD_CASET);
+    spi_device_polling_transmit(handle, &t);
+    fillRange(t, x, x + width - 1);
+    spi_device_polling_transmit(handle, &t);
+    fillCommand(t, ST7789_CMD_RASET);
+    spi_device_polling_transmit(handle, &t);
+    fillRange(t, y, y + height - 1);
+    spi_device_polling_transmit(handle, &t);
+    fillCommand(t, ST7789_CMD_RAMWR);
+    spi_device_polling_transmit(handle, &t);
+
+    while (total > 0) {
+        size_t count = total < chunk ? total : chunk;
+        fillPixels(t, buffer, count);
+        spi_device_polling_transmit(handle, &t);
+        total -= count;
+    }
+#endif
+}
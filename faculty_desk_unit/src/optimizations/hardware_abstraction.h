@@ -90,6 +90,7 @@ public:
     virtual void drawLine(int x0, int y0, int x1, int y1, uint16_t color) = 0;
     virtual void drawRect(int x, int y, int width, int height, uint16_t color) = 0;
     virtual void drawCircle(int x, int y, int radius, uint16_t color) = 0;
+    virtual void fillCircle(int x, int y, int radius, uint16_t color) = 0;
     virtual void setCursor(int x, int y) = 0;
     virtual void setTextColor(uint16_t color) = 0;
     virtual void setTextSize(int size) = 0;
@@ -100,14 +101,36 @@ public:
     virtual void setBacklight(bool enabled) = 0;
     virtual void setBrightness(uint8_t brightness) = 0;
     virtual void update() = 0;
+
+    // Strip transfers: render big-endian RGB565 into the buffer returned by
+    // acquireStripBuffer(), then hand it to pushStrip(). When the backend is
+    // double-buffered the push returns immediately and the next acquire
+    // hands out the other buffer.
+    virtual uint16_t* acquireStripBuffer(size_t* capacityPixels) = 0;
+    virtual void pushStrip(int x, int y, int width, int height, uint16_t* pixels) = 0;
+    virtual void waitForTransfers() = 0;
 };
 
 // ST7789 display implementation
+// Starts out on Adafruit_ST7789 (blocking SPI). enableAsyncTransfers() then
+// moves the panel onto the ESP-IDF SPI master driver, and strips are sent by
+// DMA from two alternating buffers while the CPU renders the next one.
 class ST7789Display : public AbstractDisplay {
 private:
-    void* tft;  // Adafruit_ST7789*
+    void* tft;        // Adafruit_ST7789*
+    void* dmaGfx;     // Adafruit_GFX adapter used for primitives after the handoff
+    void* spiDevice;  // spi_device_handle_t
     HardwareConfig* config;
-    
+    uint16_t* stripBuffers[2];
+    size_t stripCapacity;
+    int activeStrip;
+    int pendingTransactions[2];
+    bool asyncActive;
+
+    void* target();
+    void waitForStrip(int index);
+    void queueWindow(int index, int x, int y, int width, int height);
+
 public:
     ST7789Display(HardwareConfig* hwConfig);
     virtual ~ST7789Display();
@@ -119,6 +142,7 @@ public:
     virtual void drawLine(int x0, int y0, int x1, int y1, uint16_t color) override;
     virtual void drawRect(int x, int y, int width, int height, uint16_t color) override;
     virtual void drawCircle(int x, int y, int radius, uint16_t color) override;
+    virtual void fillCircle(int x, int y, int radius, uint16_t color) override;
     virtual void setCursor(int x, int y) override;
     virtual void setTextColor(uint16_t color) override;
     virtual void setTextSize(int size) override;
@@ -129,6 +153,13 @@ public:
     virtual void setBacklight(bool enabled) override;
     virtual void setBrightness(uint8_t brightness) override;
     virtual void update() override;
+    virtual uint16_t* acquireStripBuffer(size_t* capacityPixels) override;
+    virtual void pushStrip(int x, int y, int width, int height, uint16_t* pixels) override;
+    virtual void waitForTransfers() override;
+
+    bool enableAsyncTransfers(size_t stripPixels, uint32_t spiFrequency);
+    bool isAsyncActive() const { return asyncActive; }
+    void fillWindow(int x, int y, int width, int height, uint16_t color);
 };
 
 // Abstract BLE interface
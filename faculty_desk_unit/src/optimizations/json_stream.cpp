@@ -0,0 +1,320 @@
+/**
+ * Streaming JSON tokenizer implementation for ConsultEase Faculty Desk Unit
+ */
+
+#include "json_stream.h"
+#include <string.h>
+#include <stdlib.h>
+
+namespace {
+
+enum ParseState {
+    EXPECT_VALUE,
+    EXPECT_FIRST_VALUE,   // Just inside '[': a value or ']'
+    EXPECT_KEY,
+    EXPECT_FIRST_KEY,     // Just inside '{': a key or '}'
+    EXPECT_COMMA_OR_END,
+    PARSE_DONE
+};
+
+inline uint32_t hashStep(uint32_t hash, char c) {
+    return (hash ^ (uint8_t)c) * 16777619UL;
+}
+
+inline bool atEnd(const char* json, size_t length, size_t pos) {
+    return pos >= length || json[pos] == '\0';
+}
+
+size_t skipWhitespace(const char* json, size_t length, size_t pos) {
+    while (!atEnd(json, length, pos) &&
+           (json[pos] == ' ' || json[pos] == '\t' || json[pos] == '\n' || json[pos] == '\r')) {
+        pos++;
+    }
+    return pos;
+}
+
+// pos is on the opening quote and ends past the closing one. Escapes are
+// skipped, not decoded; the hash covers the raw bytes between the quotes.
+bool scanString(const char* json, size_t length, size_t& pos, uint32_t& hash) {
+    uint32_t h = 2166136261UL;
+    pos++;
+    while (!atEnd(json, length, pos)) {
+        char c = json[pos];
+        if (c == '"') {
+            pos++;
+            hash = h;
+            return true;
+        }
+        if (c == '\\') {
+            h = hashStep(h, c);
+            pos++;
+            if (atEnd(json, length, pos)) return false;
+        }
+        h = hashStep(h, json[pos]);
+        pos++;
+    }
+    return false;
+}
+
+bool matchLiteral(const char* json, size_t length, size_t pos, const char* literal, size_t literalLength) {
+    return pos + literalLength <= length && memcmp(json + pos, literal, literalLength) == 0;
+}
+
+int hexValue(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+bool readHex4(const char* raw, size_t rawLength, size_t pos, uint32_t& value) {
+    if (pos + 4 > rawLength) return false;
+    value = 0;
+    for (size_t i = 0; i < 4; i++) {
+        int digit = hexValue(raw[pos + i]);
+        if (digit < 0) return false;
+        value = (value << 4) | digit;
+    }
+    return true;
+}
+
+size_t encodeUtf8(uint32_t codepoint, char* out) {
+    if (codepoint < 0x80) {
+        out[0] = codepoint;
+        return 1;
+    }
+    if (codepoint < 0x800) {
+        out[0] = 0xC0 | (codepoint >> 6);
+        out[1] = 0x80 | (codepoint & 0x3F);
+        return 2;
+    }
+    if (codepoint < 0x10000) {
+        out[0] = 0xE0 | (codepoint >> 12);
+        out[1] = 0x80 | ((codepoint >> 6) & 0x3F);
+        out[2] = 0x80 | (codepoint & 0x3F);
+        return 3;
+    }
+    out[0] = 0xF0 | (codepoint >> 18);
+    out[1] = 0x80 | ((codepoint >> 12) & 0x3F);
+    out[2] = 0x80 | ((codepoint >> 6) & 0x3F);
+    out[3] = 0x80 | (codepoint & 0x3F);
+    return 4;
+}
+
+} // namespace
+
+// ================================
+// TOKENIZER
+// ================================
+bool JsonStream::parse(const char* json, size_t length, JsonTokenHandler handler, void* context) {
+    if (!json || !handler) return false;
+
+    uint32_t arrayBits = 0;   // Bit d set: the container at depth d+1 is an array
+    uint8_t depth = 0;
+    ParseState state = EXPECT_VALUE;
+    size_t pos = 0;
+
+    JsonToken token;
+    token.keyHash = 0;
+    token.key = nullptr;
+    token.keyLength = 0;
+
+    for (;;) {
+        pos = skipWhitespace(json, length, pos);
+        if (atEnd(json, length, pos)) return state == PARSE_DONE;
+        if (state == PARSE_DONE) return true;  // Trailing bytes are ignored
+
+        char c = json[pos];
+        bool inArray = depth > 0 && (arrayBits & (1u << (depth - 1)));
+
+        switch (state) {
+            case EXPECT_FIRST_KEY:
+            case EXPECT_KEY: {
+                if (c == '}' && state == EXPECT_FIRST_KEY) {
+                    pos++;
+                    depth--;
+                    state = depth == 0 ? PARSE_DONE : EXPECT_COMMA_OR_END;
+                    break;
+                }
+                if (c != '"') return false;
+
+                size_t start = pos + 1;
+                if (!scanString(json, length, pos, token.keyHash)) return false;
+                token.key = json + start;
+                token.keyLength = pos - 1 - start;
+
+                pos = skipWhitespace(json, length, pos);
+                if (atEnd(json, length, pos) || json[pos] != ':') return false;
+                pos++;
+                state = EXPECT_VALUE;
+                break;
+            }
+
+            case EXPECT_FIRST_VALUE:
+            case EXPECT_VALUE: {
+                if (c == ']' && state == EXPECT_FIRST_VALUE) {
+                    pos++;
+                    depth--;
+                    state = depth == 0 ? PARSE_DONE : EXPECT_COMMA_OR_END;
+                    break;
+                }
+
+                token.depth = depth;
+                token.value = json + pos;
+
+                if (c == '{' || c == '[') {
+                    if (depth >= JSON_STREAM_MAX_DEPTH) return false;
+                    token.type = (c == '{') ? JSON_VALUE_OBJECT : JSON_VALUE_ARRAY;
+                    token.valueLength = 1;
+                    if (!handler(token, context)) return false;
+
+                    if (c == '[') {
+                        arrayBits |= (1u << depth);
+                        token.keyHash = 0;
+                        token.key = nullptr;
+                        token.keyLength = 0;
+                    } else {
+                        arrayBits &= ~(1u << depth);
+                    }
+                    depth++;
+                    pos++;
+                    state = (c == '{') ? EXPECT_FIRST_KEY : EXPECT_FIRST_VALUE;
+                    break;
+                }
+
+                if (c == '"') {
+                    uint32_t unusedHash;
+                    size_t start = pos + 1;
+                    if (!scanString(json, length, pos, unusedHash)) return false;
+                    token.type = JSON_VALUE_STRING;
+                    token.value = json + start;
+                    token.valueLength = pos - 1 - start;
+                } else if (c == '-' || (c >= '0' && c <= '9')) {
+                    size_t start = pos;
+                    while (!atEnd(json, length, pos) && strchr("0123456789+-.eE", json[pos])) pos++;
+                    token.type = JSON_VALUE_NUMBER;
+                    token.valueLength = pos - start;
+                } else if (matchLiteral(json, length, pos, "true", 4)) {
+                    token.type = JSON_VALUE_BOOL;
+                    token.valueLength = 4;
+                    pos += 4;
+                } else if (matchLiteral(json, length, pos, "false", 5)) {
+                    token.type = JSON_VALUE_BOOL;
+                    token.valueLength = 5;
+                    pos += 5;
+                } else if (matchLiteral(json, length, pos, "null", 4)) {
+                    token.type = JSON_VALUE_NULL;
+                    token.valueLength = 4;
+                    pos += 4;
+                } else {
+                    return false;
+                }
+
+                if (!handler(token, context)) return false;
+                state = depth == 0 ? PARSE_DONE : EXPECT_COMMA_OR_END;
+                break;
+            }
+
+            case EXPECT_COMMA_OR_END:
+                if (c == ',') {
+                    pos++;
+                    if (inArray) {
+                        token.keyHash = 0;
+                        token.key = nullptr;
+                        token.keyLength = 0;
+                        state = EXPECT_VALUE;
+                    } else {
+                        state = EXPECT_KEY;
+                    }
+                } else if ((c == '}' && !inArray) || (c == ']' && inArray)) {
+                    pos++;
+                    depth--;
+                    state = depth == 0 ? PARSE_DONE : EXPECT_COMMA_OR_END;
+                } else {
+                    return false;
+                }
+                break;
+
+            case PARSE_DONE:
+                return true;
+        }
+    }
+}
+
+// ================================
+// VALUE HELPERS
+// ================================
+size_t JsonStream::copyString(const char* raw, size_t rawLength, char* output, size_t outputSize) {
+    if (!output || outputSize == 0) return 0;
+
+    size_t used = 0;
+    size_t pos = 0;
+    while (pos < rawLength) {
+        char encoded[4];
+        size_t encodedLength = 1;
+        char c = raw[pos++];
+
+        if (c == '\\' && pos < rawLength) {
+            char escape = raw[pos++];
+            switch (escape) {
+                case 'n': encoded[0] = '\n'; break;
+                case 'r': encoded[0] = '\r'; break;
+                case 't': encoded[0] = '\t'; break;
+                case 'b': encoded[0] = '\b'; break;
+                case 'f': encoded[0] = '\f'; break;
+                case 'u': {
+                    uint32_t codepoint;
+                    if (!readHex4(raw, rawLength, pos, codepoint)) {
+                        encoded[0] = '?';
+                        break;
+                    }
+                    pos += 4;
+
+                    // Join a surrogate pair; a lone half becomes '?'
+                    if (codepoint >= 0xD800 && codepoint <= 0xDBFF) {
+                        uint32_t low;
+                        if (pos + 1 < rawLength && raw[pos] == '\\' && raw[pos + 1] == 'u' &&
+                            readHex4(raw, rawLength, pos + 2, low) && low >= 0xDC00 && low <= 0xDFFF) {
+                            pos += 6;
+                            codepoint = 0x10000 + ((codepoint - 0xD800) << 10) + (low - 0xDC00);
+                        } else {
+                            codepoint = '?';
+                        }
+                    } else if (codepoint >= 0xDC00 && codepoint <= 0xDFFF) {
+                        codepoint = '?';
+                    }
+                    encodedLength = encodeUtf8(codepoint, encoded);
+                    break;
+                }
+                default: encoded[0] = escape; break;  // \" \\ \/
+            }
+        } else {
+            encoded[0] = c;
+        }
+
+        // Never split a multi-byte sequence when truncating
+        if (used + encodedLength >= outputSize) break;
+        memcpy(output + used, encoded, encodedLength);
+        used += encodedLength;
+    }
+
+    output[used] = '\0';
+    return used;
+}
+
+long JsonStream::toLong(const char* raw, size_t rawLength) {
+    char digits[24];
+    size_t n = rawLength < sizeof(digits) - 1 ? rawLength : sizeof(digits) - 1;
+    memcpy(digits, raw, n);
+    digits[n] = '\0';
+    return strtol(digits, nullptr, 10);
+}
+
+bool JsonStream::toBool(const char* raw, size_t rawLength) {
+    return rawLength == 4 && memcmp(raw, "true", 4) == 0;
+}
+
+bool JsonStream::keyEquals(const JsonToken& token, const char* key) {
+    size_t keyLength = strlen(key);
+    return token.key && token.keyLength == keyLength && memcmp(token.key, key, keyLength) == 0;
+}
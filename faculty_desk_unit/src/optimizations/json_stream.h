@@ -0,0 +1,59 @@
+/**
+ * Streaming JSON tokenizer for ConsultEase Faculty Desk Unit
+ * Single forward pass over an MQTT payload with no heap use and a bounded
+ * nesting stack; members are reported to a handler as they are scanned
+ */
+
+#ifndef JSON_STREAM_H
+#define JSON_STREAM_H
+
+#include <Arduino.h>
+
+// Deepest object/array nesting accepted before the payload is rejected
+#define JSON_STREAM_MAX_DEPTH 16
+
+enum JsonValueType {
+    JSON_VALUE_STRING,
+    JSON_VALUE_NUMBER,
+    JSON_VALUE_BOOL,
+    JSON_VALUE_NULL,
+    JSON_VALUE_OBJECT,   // Reported when the container opens
+    JSON_VALUE_ARRAY
+};
+
+// One scanned member. Slices point into the payload; string values are
+// still escaped (use JsonStream::copyString). Array elements have no key.
+struct JsonToken {
+    uint32_t keyHash;
+    const char* key;
+    size_t keyLength;
+    JsonValueType type;
+    const char* value;
+    size_t valueLength;
+    uint8_t depth;
+};
+
+// Return false to stop the sweep early
+typedef bool (*JsonTokenHandler)(const JsonToken& token, void* context);
+
+namespace JsonStream {
+    // FNV-1a over the key bytes. Being constexpr, known keys can be case
+    // labels in a switch on token.keyHash; the compiler rejects two known
+    // keys with the same hash. An unknown key can still collide with a known
+    // one, so each case confirms the match with keyEquals().
+    constexpr uint32_t keyHash(const char* key, uint32_t hash = 2166136261UL) {
+        return *key ? keyHash(key + 1, (hash ^ (uint8_t)*key) * 16777619UL) : hash;
+    }
+
+    // Scans one JSON value (normally an object). Returns false on malformed
+    // input or when the handler stopped; already reported tokens stand.
+    bool parse(const char* json, size_t length, JsonTokenHandler handler, void* context);
+
+    // Unescapes a string slice into output, truncating to fit; returns the length
+    size_t copyString(const char* raw, size_t rawLength, char* output, size_t outputSize);
+    long toLong(const char* raw, size_t rawLength);
+    bool toBool(const char* raw, size_t rawLength);
+    bool keyEquals(const JsonToken& token, const char* key);
+}
+
+#endif // JSON_STREAM_H
@@ -0,0 +1,579 @@
+/**
+ * Memory optimization implementation for ConsultEase Faculty Desk Unit
+ */
+
+#include "memory_optimization.h"
+#include "json_stream.h"
+#include <string.h>
+#include <stdlib.h>
+#include <esp_heap_caps.h>
+
+// Global instances
+OptimizedStringHandler globalStringHandler;
+char mqttTopicBuffer[64];
+char timeBuffer[32];
+char dateBuffer[32];
+
+// Static member definitions
+char DisplayBuffer::displayBuffer[DISPLAY_BUFFER_SIZE];
+bool DisplayBuffer::bufferDirty = false;
+
+// Optimized message processing function
+void optimizedDisplayMessage(const char* message) {
+    if (!message) return;
+
+    // Use global string handler to avoid memory allocation
+    globalStringHandler.reset();
+
+    // Process message with word wrapping
+    const char* ptr = message;
+    int lineWidth = 35; // Approximate characters per line
+    int currentLineLength = 0;
+
+    while (*ptr) {
+        char c = *ptr;
+
+        if (c == '\n' || currentLineLength >= lineWidth) {
+            globalStringHandler.append('\n');
+            currentLineLength = 0;
+
+            // Skip the newline if it was a forced wrap
+            if (c != '\n') {
+                globalStringHandler.append(c);
+                currentLineLength = 1;
+            }
+        } else {
+            globalStringHandler.append(c);
+            currentLineLength++;
+        }
+
+        ptr++;
+    }
+
+    // Display the processed message
+    Serial.println("Optimized Message Display:");
+    Serial.println(globalStringHandler.getString());
+}
+
+// Fields of a consultation payload, collected in one JsonStream sweep
+struct ProcessedMessageFields {
+    const char* message;
+    size_t messageLength;
+    const char* field[3];      // student_name, course_code, request_message
+    size_t fieldLength[3];
+};
+
+static const char* const MESSAGE_FIELD_KEYS[3] = { "student_name", "course_code", "request_message" };
+
+static bool collectMessageFields(const JsonToken& token, void* context) {
+    ProcessedMessageFields& fields = *static_cast<ProcessedMessageFields*>(context);
+    if (token.type != JSON_VALUE_STRING) return true;
+
+    // The hash picks the case and the key bytes confirm it
+    int index = -1;
+    switch (token.keyHash) {
+        case JsonStream::keyHash("message"):
+            if (!JsonStream::keyEquals(token, "message")) return true;
+            if (!fields.message) {
+                fields.message = token.value;
+                fields.messageLength = token.valueLength;
+            }
+            return true;
+        case JsonStream::keyHash("student_name"): index = 0; break;
+        case JsonStream::keyHash("course_code"): index = 1; break;
+        case JsonStream::keyHash("request_message"): index = 2; break;
+        default: return true;
+    }
+    if (!JsonStream::keyEquals(token, MESSAGE_FIELD_KEYS[index])) return true;
+
+    if (!fields.field[index]) {
+        fields.field[index] = token.value;
+        fields.fieldLength[index] = token.valueLength;
+    }
+    return true;
+}
+
+// Optimized message processing function
+void optimizedProcessMessage(const char* input, char* output, size_t outputSize) {
+    if (!input || !output || outputSize == 0) return;
+
+    globalStringHandler.reset();
+
+    // Check if JSON format
+    if (input[0] == '{') {
+        ProcessedMessageFields fields;
+        memset(&fields, 0, sizeof(fields));
+        JsonStream::parse(input, strlen(input), collectMessageFields, &fields);
+
+        // A message field is shown as-is
+        if (fields.message && fields.messageLength < MAX_MESSAGE_LENGTH - 1) {
+            JsonStream::copyString(fields.message, fields.messageLength, output, outputSize);
+            return;
+        }
+
+        // Otherwise build the display text from the request fields
+        static const char* const labels[] = {"Student: ", "Course: ", "Request: "};
+        for (int i = 0; i < 3; i++) {
+            size_t fieldLen = fields.fieldLength[i];
+            if (fields.field[i] && fieldLen > 0 && globalStringHandler.length() + fieldLen + 20 < MAX_MESSAGE_LENGTH) {
+                char value[MAX_MESSAGE_LENGTH];
+                JsonStream::copyString(fields.field[i], fieldLen, value, sizeof(value));
+                globalStringHandler.append(labels[i]);
+                globalStringHandler.append(value);
+                globalStringHandler.append('\n');
+            }
+        }
+
+        SAFE_STRING_COPY(output, globalStringHandler.getString(), outputSize);
+    } else {
+        // Plain text message
+        SAFE_STRING_COPY(output, input, outputSize);
+    }
+}
+
+struct JSONExtractRequest {
+    const char* key;
+    uint32_t keyHash;
+    char* value;
+    size_t valueSize;
+    bool found;
+};
+
+static bool extractJSONField(const JsonToken& token, void* context) {
+    JSONExtractRequest& request = *static_cast<JSONExtractRequest*>(context);
+    if (token.keyHash != request.keyHash || !JsonStream::keyEquals(token, request.key)) return true;
+    if (token.type == JSON_VALUE_OBJECT || token.type == JSON_VALUE_ARRAY) return true;
+
+    JsonStream::copyString(token.value, token.valueLength, request.value, request.valueSize);
+    request.found = true;
+    return false;  // First match wins; stop the sweep
+}
+
+// Optimized JSON field extraction: one escape-aware pass that stops at the key
+bool optimizedJSONExtract(const char* json, const char* key, char* value, size_t valueSize) {
+    if (!json || !key || !value || valueSize == 0) return false;
+
+    JSONExtractRequest request = { key, JsonStream::keyHash(key), value, valueSize, false };
+    JsonStream::parse(json, strlen(json), extractJSONField, &request);
+    return request.found;
+}
+
+// ================================
+// BLOCK POOL
+// ================================
+static portMUX_TYPE poolMux = portMUX_INITIALIZER_UNLOCKED;
+
+static size_t alignUp(size_t size) {
+    return (size + MEMORY_BLOCK_ALIGNMENT - 1) & ~(size_t)(MEMORY_BLOCK_ALIGNMENT - 1);
+}
+
+BlockPool::BlockPool(void* storage, size_t blockSize, uint8_t blockCount)
+    : storage(static_cast<uint8_t*>(storage)), blockSize(alignUp(blockSize)),
+      blockCount(blockCount > BLOCK_POOL_MAX_BLOCKS ? BLOCK_POOL_MAX_BLOCKS : blockCount),
+      inUse(0), highWater(0), failures(0) {
+    freeMask = this->blockCount >= 32 ? 0xFFFFFFFFUL : (1UL << this->blockCount) - 1;
+}
+
+void* BlockPool::acquire() {
+    portENTER_CRITICAL(&poolMux);
+    if (freeMask == 0) {
+        failures++;
+        portEXIT_CRITICAL(&poolMux);
+        return nullptr;
+    }
+    int index = __builtin_ctz(freeMask);
+    freeMask &= ~(1UL << index);
+    if (++inUse > highWater) highWater = inUse;
+    portEXIT_CRITICAL(&poolMux);
+    return storage + index * blockSize;
+}
+
+void BlockPool::release(void* block) {
+    if (!block) return;
+    size_t offset = static_cast<uint8_t*>(block) - storage;
+    size_t index = offset / blockSize;
+    if (index >= blockCount || offset % blockSize != 0) return;
+
+    portENTER_CRITICAL(&poolMux);
+    if (!(freeMask & (1UL << index))) {
+        freeMask |= 1UL << index;
+        inUse--;
+    }
+    portEXIT_CRITICAL(&poolMux);
+}
+
+// ================================
+// SCRATCH ARENA
+// ================================
+ScratchArena::ScratchArena(void* storage, size_t capacity)
+    : storage(static_cast<uint8_t*>(storage)), capacity(capacity), used(0), highWater(0), failures(0) {
+}
+
+void* ScratchArena::allocate(size_t size) {
+    size = alignUp(size);
+    if (size > capacity - used) {
+        failures++;
+        return nullptr;
+    }
+    void* block = storage + used;
+    used += size;
+    if (used > highWater) highWater = used;
+    return block;
+}
+
+// ================================
+// FIFO ARENA
+// ================================
+static const size_t FIFO_NO_ROOM = (size_t)-1;
+
+FifoArena::FifoArena(void* storage, size_t capacity)
+    : storage(static_cast<uint8_t*>(storage)), capacity(capacity), head(0), tail(0), wrapEnd(0),
+      used(0), highWater(0), failures(0) {
+}
+
+// Offset the next block of this size would start at
+size_t FifoArena::placement(size_t size) const {
+    if (used == 0) return size <= capacity ? 0 : FIFO_NO_ROOM;
+    if (wrapEnd) return head - tail >= size ? tail : FIFO_NO_ROOM;
+    if (capacity - tail >= size) return tail;
+    return head >= size ? 0 : FIFO_NO_ROOM;
+}
+
+void* FifoArena::reserve(size_t size) {
+    size_t offset = placement(size);
+    if (size == 0 || offset == FIFO_NO_ROOM) {
+        failures++;
+        return nullptr;
+    }
+    return storage + offset;
+}
+
+void FifoArena::commit(size_t size) {
+    size_t offset = placement(size);
+    if (size == 0 || offset == FIFO_NO_ROOM) return;
+
+    if (used == 0) {
+        head = 0;
+    } else if (!wrapEnd && offset == 0) {
+        wrapEnd = tail;
+    }
+    tail = offset + size;
+    used += size;
+    if (used > highWater) highWater = used;
+}
+
+void* FifoArena::allocate(size_t size) {
+    void* block = reserve(size);
+    if (block) commit(size);
+    return block;
+}
+
+void FifoArena::releaseOldest(size_t size) {
+    if (size > used) size = used;
+    head += size;
+    used -= size;
+
+    if (used == 0) {
+        reset();
+    } else if (wrapEnd && head >= wrapEnd) {
+        head = 0;
+        wrapEnd = 0;
+    }
+}
+
+void FifoArena::reset() {
+    head = 0;
+    tail = 0;
+    wrapEnd = 0;
+    used = 0;
+}
+
+// ================================
+// MEMORY MONITOR
+// ================================
+HeapSnapshot MemoryMonitor::last = {};
+uint32_t MemoryMonitor::minLargestBlock = 0;
+uint16_t MemoryMonitor::maxFragmentation = 0;
+MemoryMonitor::TrendPoint MemoryMonitor::history[MEMORY_HISTORY_SIZE];
+uint8_t MemoryMonitor::historyHead = 0;
+uint8_t MemoryMonitor::historyCount = 0;
+MemoryMonitor::TrendPoint MemoryMonitor::bucket = {};
+unsigned long MemoryMonitor::bucketStart = 0;
+MemoryTrend MemoryMonitor::trend = {};
+MemoryPressure MemoryMonitor::pressure = MEMORY_PRESSURE_NONE;
+MemoryPressure MemoryMonitor::notifiedPressure = MEMORY_PRESSURE_NONE;
+unsigned long MemoryMonitor::lastNotify = 0;
+MemoryMonitor::PressureHandler MemoryMonitor::pressureHandler = nullptr;
+
+void MemoryMonitor::init() {
+    minLargestBlock = 0;
+    maxFragmentation = 0;
+    historyHead = 0;
+    historyCount = 0;
+    memset(&trend, 0, sizeof(trend));
+    trend.hoursToExhaustion = MEMORY_NO_EXHAUSTION;
+    pressure = MEMORY_PRESSURE_NONE;
+    notifiedPressure = MEMORY_PRESSURE_NONE;
+
+    bucket.freeBytes = 0xFFFFFFFFUL;
+    bucket.largestBlock = 0xFFFFFFFFUL;
+    bucketStart = millis();
+    sample();
+    Serial.printf("Memory Monitor initialized - Free: %lu bytes, largest block: %lu bytes\n",
+                  (unsigned long)last.freeBytes, (unsigned long)last.largestBlock);
+}
+
+// Share of free memory not usable by one allocation, in permille
+uint16_t MemoryMonitor::fragmentationOf(uint32_t freeBytes, uint32_t largestBlock) {
+    if (freeBytes == 0 || largestBlock >= freeBytes) return 0;
+    return 1000 - (uint16_t)((uint64_t)largestBlock * 1000 / freeBytes);
+}
+
+// Internal 8-bit capable RAM, the pool every malloc and String draws from
+const HeapSnapshot& MemoryMonitor::sample() {
+    last.freeBytes = heap_caps_get_free_size(MALLOC_CAP_8BIT);
+    last.minFreeBytes = heap_caps_get_minimum_free_size(MALLOC_CAP_8BIT);
+    last.largestBlock = heap_caps_get_largest_free_block(MALLOC_CAP_8BIT);
+    last.fragmentationPermille = fragmentationOf(last.freeBytes, last.largestBlock);
+
+    if (minLargestBlock == 0 || last.largestBlock < minLargestBlock) minLargestBlock = last.largestBlock;
+    if (last.fragmentationPermille > maxFragmentation) maxFragmentation = last.fragmentationPermille;
+
+    if (last.freeBytes < bucket.freeBytes) bucket.freeBytes = last.freeBytes;
+    if (last.largestBlock < bucket.largestBlock) bucket.largestBlock = last.largestBlock;
+    if (millis() - bucketStart >= MEMORY_TREND_BUCKET_MS) {
+        recordTrendPoint();
+        analyzeMemoryTrend();
+    }
+
+    pressure = assessPressure();
+    if (pressure == MEMORY_PRESSURE_NONE) {
+        notifiedPressure = MEMORY_PRESSURE_NONE;
+    } else if (pressureHandler &&
+               (pressure > notifiedPressure || millis() - lastNotify >= MEMORY_MITIGATION_COOLDOWN_MS)) {
+        Serial.printf("Memory pressure: %s (free %lu, largest %lu, exhaustion in %ldh)\n",
+                      getPressureName(pressure), (unsigned long)last.freeBytes,
+                      (unsigned long)last.largestBlock,
+                      trend.hoursToExhaustion == MEMORY_NO_EXHAUSTION ? -1L : (long)trend.hoursToExhaustion);
+        notifiedPressure = pressure;
+        lastNotify = millis();
+        pressureHandler(pressure);
+    }
+    return last;
+}
+
+void MemoryMonitor::recordTrendPoint() {
+    uint8_t slot = (historyHead + historyCount) % MEMORY_HISTORY_SIZE;
+    if (historyCount == MEMORY_HISTORY_SIZE) {
+        historyHead = (historyHead + 1) % MEMORY_HISTORY_SIZE;
+    } else {
+        historyCount++;
+    }
+    history[slot] = bucket;
+
+    bucket.freeBytes = 0xFFFFFFFFUL;
+    bucket.largestBlock = 0xFFFFFFFFUL;
+    bucketStart = millis();
+}
+
+// Slope in bytes per bucket over the history, oldest first; values are
+// centred before squaring so single precision holds up
+int32_t MemoryMonitor::fitSeries(bool largestBlock, uint16_t& fitPermille) {
+    fitPermille = 0;
+    int n = historyCount;
+    if (n < 2) return 0;
+
+    float meanX = (n - 1) / 2.0f;
+    float meanY = 0;
+    for (int i = 0; i < n; i++) {
+        const TrendPoint& point = history[(historyHead + i) % MEMORY_HISTORY_SIZE];
+        meanY += largestBlock ? point.largestBlock : point.freeBytes;
+    }
+    meanY /= n;
+
+    float sxx = 0, sxy = 0, syy = 0;
+    for (int i = 0; i < n; i++) {
+        const TrendPoint& point = history[(historyHead + i) % MEMORY_HISTORY_SIZE];
+        float dx = i - meanX;
+        float dy = (largestBlock ? point.largestBlock : point.freeBytes) - meanY;
+        sxx += dx * dx;
+        sxy += dx * dy;
+        syy += dy * dy;
+    }
+
+    if (syy > 0) fitPermille = (uint16_t)(1000.0f * sxy * sxy / (sxx * syy));
+    return (int32_t)(sxy / sxx);
+}
+
+// Hours until current falls to floor at the fitted rate, if the fit is
+// trustworthy and heading down
+uint32_t MemoryMonitor::hoursUntil(uint32_t current, int32_t slopePerHour, uint16_t fitPermille,
+                                   uint32_t floor) {
+    if (slopePerHour >= 0 || fitPermille < MEMORY_TREND_MIN_FIT_PERMILLE) return MEMORY_NO_EXHAUSTION;
+    if (current <= floor) return 0;
+    return (current - floor) / (uint32_t)(-slopePerHour);
+}
+
+void MemoryMonitor::analyzeMemoryTrend() {
+    const int32_t bucketsPerHour = 3600000UL / MEMORY_TREND_BUCKET_MS;
+    trend.points = historyCount;
+    trend.freeSlopePerHour = fitSeries(false, trend.freeFitPermille) * bucketsPerHour;
+    trend.blockSlopePerHour = fitSeries(true, trend.blockFitPermille) * bucketsPerHour;
+    trend.hoursToExhaustion = MEMORY_NO_EXHAUSTION;
+    if (historyCount < MEMORY_TREND_MIN_POINTS) return;
+
+    const TrendPoint& newest = history[(historyHead + historyCount - 1) % MEMORY_HISTORY_SIZE];
+    uint32_t freeHours = hoursUntil(newest.freeBytes, trend.freeSlopePerHour, trend.freeFitPermille,
+                                    MEMORY_FREE_FLOOR);
+    uint32_t blockHours = hoursUntil(newest.largestBlock, trend.blockSlopePerHour, trend.blockFitPermille,
+                                     MEMORY_BLOCK_FLOOR);
+    trend.hoursToExhaustion = freeHours < blockHours ? freeHours : blockHours;
+
+    if (trend.hoursToExhaustion != MEMORY_NO_EXHAUSTION) {
+        Serial.printf("Memory trend: free %ld B/h, largest block %ld B/h, exhaustion in ~%luh\n",
+                      (long)trend.freeSlopePerHour, (long)trend.blockSlopePerHour,
+                      (unsigned long)trend.hoursToExhaustion);
+    }
+}
+
+// The projection decides the step; being under a floor right now escalates
+// regardless of the trend
+MemoryPressure MemoryMonitor::assessPressure() {
+    MemoryPressure level = MEMORY_PRESSURE_NONE;
+    uint32_t hours = trend.hoursToExhaustion;
+    if (hours <= MEMORY_REBOOT_HOURS) level = MEMORY_PRESSURE_REBOOT;
+    else if (hours <= MEMORY_RECLAIM_HOURS) level = MEMORY_PRESSURE_RECLAIM;
+    else if (hours <= MEMORY_SHRINK_HOURS) level = MEMORY_PRESSURE_SHRINK;
+
+    MemoryPressure now = MEMORY_PRESSURE_NONE;
+    if (last.freeBytes < MEMORY_FREE_FLOOR || last.largestBlock < MEMORY_BLOCK_FLOOR) {
+        // Still under the floor after reclaiming: only a restart helps
+        bool reclaimed = notifiedPressure >= MEMORY_PRESSURE_RECLAIM &&
+                         millis() - lastNotify >= MEMORY_RECLAIM_SETTLE_MS;
+        now = reclaimed ? MEMORY_PRESSURE_REBOOT : MEMORY_PRESSURE_RECLAIM;
+    } else if (last.freeBytes < 2 * MEMORY_FREE_FLOOR || last.largestBlock < 2 * MEMORY_BLOCK_FLOOR) {
+        now = MEMORY_PRESSURE_SHRINK;
+    }
+    return now > level ? now : level;
+}
+
+const char* MemoryMonitor::getPressureName(MemoryPressure level) {
+    switch (level) {
+        case MEMORY_PRESSURE_NONE: return "none";
+        case MEMORY_PRESSURE_SHRINK: return "shrink";
+        case MEMORY_PRESSURE_RECLAIM: return "reclaim";
+        case MEMORY_PRESSURE_REBOOT: return "reboot";
+        default: return "?";
+    }
+}
+
+void MemoryMonitor::printStatus() {
+    Serial.printf("Heap: %lu free (min %lu) | largest block %lu (min %lu) | fragmentation %u.%u%% (max %u.%u%%)\n",
+                  (unsigned long)last.freeBytes, (unsigned long)last.minFreeBytes,
+                  (unsigned long)last.largestBlock, (unsigned long)minLargestBlock,
+                  last.fragmentationPermille / 10, last.fragmentationPermille % 10,
+                  maxFragmentation / 10, maxFragmentation % 10);
+    if (trend.points >= 2) {
+        Serial.printf("   Trend over %u points: free %ld B/h (r2 %u), block %ld B/h (r2 %u), pressure %s\n",
+                      trend.points, (long)trend.freeSlopePerHour, trend.freeFitPermille,
+                      (long)trend.blockSlopePerHour, trend.blockFitPermille, getPressureName(pressure));
+    }
+}
+
+// Display buffer functions
+void DisplayBuffer::init() {
+    memset(displayBuffer, 0, DISPLAY_BUFFER_SIZE);
+    bufferDirty = false;
+    Serial.println("Display buffer initialized");
+}
+
+char* DisplayBuffer::getBuffer() {
+    return displayBuffer;
+}
+
+void DisplayBuffer::markDirty() {
+    bufferDirty = true;
+}
+
+bool DisplayBuffer::isDirty() {
+    return bufferDirty;
+}
+
+void DisplayBuffer::markClean() {
+    bufferDirty = false;
+}
+
+void DisplayBuffer::clear() {
+    memset(displayBuffer, 0, DISPLAY_BUFFER_SIZE);
+    bufferDirty = true;
+}
+
+// Optimized string handler implementation
+void OptimizedStringHandler::reset() {
+    bufferPos = 0;
+    memset(buffer, 0, MAX_MESSAGE_LENGTH);
+}
+
+bool OptimizedStringHandler::append(const char* str) {
+    size_t len = strlen(str);
+    if (bufferPos + len >= MAX_MESSAGE_LENGTH - 1) {
+        return false; // Buffer overflow protection
+    }
+    strcpy(buffer + bufferPos, str);
+    bufferPos += len;
+    return true;
+}
+
+bool OptimizedStringHandler::append(char c) {
+    if (bufferPos >= MAX_MESSAGE_LENGTH - 1) {
+        return false;
+    }
+    buffer[bufferPos++] = c;
+    buffer[bufferPos] = '\0';
+    return true;
+}
+
+const char* OptimizedStringHandler::getString() const {
+    return buffer;
+}
+
+size_t OptimizedStringHandler::length() const {
+    return bufferPos;
+}
+
+void OptimizedStringHandler::clear() {
+    reset();
+}
+
+// String optimization utilities
+void optimizedStringCopy(char* dest, const char* src, size_t maxLen) {
+    if (!dest || !src || maxLen == 0) return;
+
+    size_t i = 0;
+    while (i < maxLen - 1 && src[i] != '\0') {
+        dest[i] = src[i];
+        i++;
+    }
+    dest[i] = '\0';
+}
+
+int optimizedStringCompare(const char* str1, const char* str2) {
+    if (!str1 || !str2) return -1;
+
+    while (*str1 && *str2 && *str1 == *str2) {
+        str1++;
+        str2++;
+    }
+
+    return *str1 - *str2;
+}
+
+// Memory statistics
+void printMemoryStatistics() {
+    Serial.println("=== Memory Statistics ===");
+    MemoryMonitor::sample();
+    MemoryMonitor::printStatus();
+    Serial.printf("Total Heap: %d bytes\n", ESP.getHeapSize());
+    Serial.printf("Free PSRAM: %d bytes\n", ESP.getFreePsram());
+    Serial.println("========================");
+}
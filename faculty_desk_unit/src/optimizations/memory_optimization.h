@@ -0,0 +1,283 @@
+/**
+ * Memory optimization utilities for ConsultEase Faculty Desk Unit
+ * Optimized for ESP32 platform with limited RAM. Long-lived buffers come
+ * from fixed-size pools and per-iteration temporaries from a scratch arena,
+ * so the heap sees no churn that could fragment it over weeks of uptime.
+ */
+
+#ifndef MEMORY_OPTIMIZATION_H
+#define MEMORY_OPTIMIZATION_H
+
+#include <Arduino.h>
+
+// Memory management constants
+#define MAX_MESSAGE_LENGTH 512
+#define MAX_LINE_LENGTH 64
+#define DISPLAY_BUFFER_SIZE 1024
+
+// Leak and fragmentation trend: each history point is the minimum seen over
+// one bucket, so transient allocations do not mask a slow drift
+#define MEMORY_HISTORY_SIZE 32                 // 8 hours of 15-minute points
+#define MEMORY_TREND_BUCKET_MS 900000UL
+#define MEMORY_TREND_MIN_POINTS 8              // Two hours before a trend is trusted
+#define MEMORY_TREND_MIN_FIT_PERMILLE 500      // r^2 of the fit; below this it is noise
+
+// "Exhausted" means below these, well before malloc actually fails
+#define MEMORY_FREE_FLOOR 16384
+#define MEMORY_BLOCK_FLOOR 8192
+
+// Projected hours to exhaustion that trigger each mitigation step
+#define MEMORY_SHRINK_HOURS 48
+#define MEMORY_RECLAIM_HOURS 12
+#define MEMORY_REBOOT_HOURS 3
+#define MEMORY_MITIGATION_COOLDOWN_MS 1800000UL   // Repeat a step at most this often
+#define MEMORY_RECLAIM_SETTLE_MS 60000UL          // Under a floor this long after reclaiming: reboot
+#define MEMORY_NO_EXHAUSTION 0xFFFFFFFFUL
+
+#define BLOCK_POOL_MAX_BLOCKS 32
+#define MEMORY_BLOCK_ALIGNMENT 8     // Enough for uint64_t members
+
+// Optimized string handling class
+class OptimizedStringHandler {
+private:
+    char buffer[MAX_MESSAGE_LENGTH];
+    size_t bufferPos;
+
+public:
+    OptimizedStringHandler() : bufferPos(0) {
+        buffer[0] = '\0';
+    }
+
+    void reset();
+    bool append(const char* str);
+    bool append(char c);
+    const char* getString() const;
+    size_t length() const;
+    void clear();
+};
+
+// Equal-sized blocks carved from caller-supplied static storage. Blocks never
+// split or merge, so the pool cannot fragment; a bit per block marks it free.
+// Safe to use from any task.
+class BlockPool {
+private:
+    uint8_t* storage;
+    size_t blockSize;
+    uint8_t blockCount;
+    uint32_t freeMask;
+    uint8_t inUse;
+    uint8_t highWater;
+    uint32_t failures;        // acquire() found every block taken
+
+public:
+    // blockSize is rounded up to MEMORY_BLOCK_ALIGNMENT; storage must hold
+    // blockCount blocks of that size
+    BlockPool(void* storage, size_t blockSize, uint8_t blockCount);
+
+    void* acquire();          // nullptr when exhausted
+    void release(void* block);
+
+    uint8_t getInUse() const { return inUse; }
+    uint8_t getHighWater() const { return highWater; }
+    uint8_t getBlockCount() const { return blockCount; }
+    uint32_t getFailures() const { return failures; }
+};
+
+// Bump allocator over static storage for temporaries that live no longer
+// than one pass of the owner's loop. Only the owning task may use it;
+// ScratchFrame gives nested, LIFO lifetimes within the pass.
+class ScratchArena {
+private:
+    uint8_t* storage;
+    size_t capacity;
+    size_t used;
+    size_t highWater;
+    uint32_t failures;
+
+public:
+    ScratchArena(void* storage, size_t capacity);
+
+    void* allocate(size_t size);   // Aligned; nullptr when it does not fit
+    size_t mark() const { return used; }
+    void release(size_t mark) { if (mark < used) used = mark; }
+
+    // Called at the top of each pass so a missed release cannot carry over
+    void reset() { used = 0; }
+
+    size_t getCapacity() const { return capacity; }
+    size_t getHighWater() const { return highWater; }
+    uint32_t getFailures() const { return failures; }
+};
+
+// Everything allocated through a frame is returned when it goes out of scope
+class ScratchFrame {
+private:
+    ScratchArena& arena;
+    size_t start;
+
+public:
+    explicit ScratchFrame(ScratchArena& arena) : arena(arena), start(arena.mark()) {}
+    ~ScratchFrame() { arena.release(start); }
+
+    void* allocate(size_t size) { return arena.allocate(size); }
+
+    ScratchFrame(const ScratchFrame&) = delete;
+    ScratchFrame& operator=(const ScratchFrame&) = delete;
+};
+
+// Variable-length byte blocks over static storage, freed oldest first, for
+// queues whose entries differ widely in size. A block never straddles the
+// end of the storage: one that does not fit there starts again at the front.
+// Only the owning task may use it.
+class FifoArena {
+private:
+    uint8_t* storage;
+    size_t capacity;
+    size_t head;              // Start of the oldest block
+    size_t tail;              // End of the newest block
+    size_t wrapEnd;           // End of the blocks behind head once tail wrapped
+    size_t used;
+    size_t highWater;
+    uint32_t failures;
+
+    size_t placement(size_t size) const;
+
+public:
+    FifoArena(void* storage, size_t capacity);
+
+    // reserve() finds room without taking it, so a block can be filled and
+    // then dropped; commit() takes the same block
+    void* reserve(size_t size);    // nullptr when it does not fit behind the newest
+    void commit(size_t size);
+    void* allocate(size_t size);
+    void releaseOldest(size_t size);
+    void reset();
+
+    size_t getUsed() const { return used; }
+    size_t getCapacity() const { return capacity; }
+    size_t getHighWater() const { return highWater; }
+    uint32_t getFailures() const { return failures; }
+};
+
+// Free bytes alone hide fragmentation: a heap can have plenty free and
+// still fail a 4 KB TLS allocation. The largest free block is what counts.
+struct HeapSnapshot {
+    uint32_t freeBytes;
+    uint32_t minFreeBytes;          // Low-water mark since boot, kept by the allocator
+    uint32_t largestBlock;
+    uint16_t fragmentationPermille; // 0 = one contiguous free region
+};
+
+// Mitigation steps, each implying the ones before it
+enum MemoryPressure : uint8_t {
+    MEMORY_PRESSURE_NONE,
+    MEMORY_PRESSURE_SHRINK,     // Shrink caches
+    MEMORY_PRESSURE_RECLAIM,    // Drop buffers that are rebuilt on demand
+    MEMORY_PRESSURE_REBOOT      // Controlled restart at the next quiet moment
+};
+
+// Least-squares fit over the history, per series
+struct MemoryTrend {
+    int32_t freeSlopePerHour;       // Bytes per hour; negative is a leak
+    int32_t blockSlopePerHour;      // Largest free block; negative is fragmentation
+    uint16_t freeFitPermille;       // r^2 of each fit
+    uint16_t blockFitPermille;
+    uint32_t hoursToExhaustion;     // MEMORY_NO_EXHAUSTION when neither series heads for its floor
+    uint8_t points;
+};
+
+// Memory monitoring utilities
+// Sampling, trend fitting and the choice of mitigation step live here; the
+// sketch supplies the handler that carries the steps out.
+class MemoryMonitor {
+public:
+    typedef void (*PressureHandler)(MemoryPressure level);
+
+private:
+    struct TrendPoint {
+        uint32_t freeBytes;
+        uint32_t largestBlock;
+    };
+
+    static HeapSnapshot last;
+    static uint32_t minLargestBlock;
+    static uint16_t maxFragmentation;
+
+    static TrendPoint history[MEMORY_HISTORY_SIZE];
+    static uint8_t historyHead;         // Oldest point
+    static uint8_t historyCount;
+    static TrendPoint bucket;           // Minimum of the bucket being filled
+    static unsigned long bucketStart;
+    static MemoryTrend trend;
+
+    static MemoryPressure pressure;
+    static MemoryPressure notifiedPressure;
+    static unsigned long lastNotify;
+    static PressureHandler pressureHandler;
+
+    static void recordTrendPoint();
+    static void analyzeMemoryTrend();
+    static int32_t fitSeries(bool largestBlock, uint16_t& fitPermille);
+    static uint32_t hoursUntil(uint32_t current, int32_t slopePerHour, uint16_t fitPermille, uint32_t floor);
+    static MemoryPressure assessPressure();
+
+public:
+    static void init();
+    // Call every few tens of seconds; may invoke the pressure handler
+    static const HeapSnapshot& sample();
+    static const HeapSnapshot& getLast() { return last; }
+    static const MemoryTrend& getTrend() { return trend; }
+    static MemoryPressure getPressure() { return pressure; }
+    static void setPressureHandler(PressureHandler handler) { pressureHandler = handler; }
+    static const char* getPressureName(MemoryPressure level);
+
+    static uint32_t getFreeHeap() { return last.freeBytes; }
+    static uint32_t getMinFreeHeap() { return last.minFreeBytes; }
+    static uint32_t getLargestFreeBlock() { return last.largestBlock; }
+    static uint32_t getMinLargestFreeBlock() { return minLargestBlock; }
+    static uint16_t getFragmentation() { return last.fragmentationPermille; }
+    static uint16_t getMaxFragmentation() { return maxFragmentation; }
+
+    static uint16_t fragmentationOf(uint32_t freeBytes, uint32_t largestBlock);
+    static void printStatus();
+};
+
+// Optimized display buffer management
+class DisplayBuffer {
+private:
+    static char displayBuffer[DISPLAY_BUFFER_SIZE];
+    static bool bufferDirty;
+
+public:
+    static void init();
+    static char* getBuffer();
+    static void markDirty();
+    static bool isDirty();
+    static void markClean();
+    static void clear();
+};
+
+// Static memory allocation for frequently used objects
+extern OptimizedStringHandler globalStringHandler;
+extern char mqttTopicBuffer[64];
+extern char timeBuffer[32];
+extern char dateBuffer[32];
+
+// Memory optimization macros
+#define SAFE_STRING_COPY(dest, src, size) \
+    do { \
+        strncpy(dest, src, size - 1); \
+        dest[size - 1] = '\0'; \
+    } while(0)
+
+#define CHECK_MEMORY() MemoryMonitor::sample()
+
+// Function prototypes for optimized operations
+void optimizedDisplayMessage(const char* message);
+void optimizedProcessMessage(const char* input, char* output, size_t outputSize);
+bool optimizedJSONExtract(const char* json, const char* key, char* value, size_t valueSize);
+void optimizedStringCopy(char* dest, const char* src, size_t maxLen);
+int optimizedStringCompare(const char* str1, const char* str2);
+void printMemoryStatistics();
+
+#endif // MEMORY_OPTIMIZATION_H
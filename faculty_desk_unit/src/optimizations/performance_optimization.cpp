@@ -0,0 +1,923 @@
+/**
+ * Performance optimization implementation for ConsultEase Faculty Desk Unit
+ */
+
+#include "performance_optimization.h"
+#include <string.h>
+
+// Static member definitions
+AbstractDisplay* DisplayOptimizer::display = nullptr;
+StripCanvas* DisplayOptimizer::stripCanvas = nullptr;
+uint16_t* DisplayOptimizer::frameBuffer = nullptr;
+size_t DisplayOptimizer::frameBufferCapacity = 0;
+bool DisplayOptimizer::frameBufferEnabled = true;
+bool DisplayOptimizer::dirtyRegions[DISPLAY_GRID_COLS][DISPLAY_GRID_ROWS];
+uint32_t DisplayOptimizer::tileHashes[DISPLAY_GRID_COLS][DISPLAY_GRID_ROWS];
+DisplayLayerList DisplayOptimizer::layers[DISPLAY_LAYER_COUNT];
+int DisplayOptimizer::currentLayer = -1;
+int DisplayOptimizer::frameDepth = 0;
+int DisplayOptimizer::regionWidth = 40;
+int DisplayOptimizer::regionHeight = 40;
+unsigned long DisplayOptimizer::lastFrameTime = 0;
+int DisplayOptimizer::currentFrameRate = 0;
+unsigned long DisplayOptimizer::framesFlushed = 0;
+unsigned long DisplayOptimizer::tilesPushed = 0;
+unsigned long DisplayOptimizer::lastRateSample = 0;
+unsigned long DisplayOptimizer::framesAtRateSample = 0;
+
+CacheOptimizer::CacheEntry CacheOptimizer::cache[CacheOptimizer::CACHE_SIZE];
+size_t CacheOptimizer::usedBytes = 0;
+size_t CacheOptimizer::byteLimit = CacheOptimizer::CACHE_MAX_BYTES;
+int CacheOptimizer::cacheHits = 0;
+int CacheOptimizer::cacheMisses = 0;
+unsigned long CacheOptimizer::lastCleanup = 0;
+
+bool CPUOptimizer::dynamicFrequency = false;
+uint32_t CPUOptimizer::currentFrequency = 240;
+uint32_t CPUOptimizer::minFrequency = 80;
+uint32_t CPUOptimizer::maxFrequency = 240;
+unsigned long CPUOptimizer::lastFrequencyChange = 0;
+uint16_t CPUOptimizer::loadPermille = 0;
+uint16_t CPUOptimizer::peakLoadPermille = 0;
+unsigned long CPUOptimizer::frequencyChanges = 0;
+
+PerformanceProfiler::Histogram PerformanceProfiler::histograms[PERF_SPAN_COUNT];
+uint32_t PerformanceProfiler::cyclesPerUs = 240;
+bool PerformanceProfiler::profilingEnabled = true;
+unsigned long PerformanceProfiler::windowStart = 0;
+
+static portMUX_TYPE profilerMux = portMUX_INITIALIZER_UNLOCKED;
+
+// FNV-1a over 32-bit words, used for the per-tile content hashes
+static inline uint32_t hashMix(uint32_t hash, uint32_t value) {
+    for (int i = 0; i < 4; i++) {
+        hash ^= (value >> (i * 8)) & 0xFF;
+        hash *= 16777619UL;
+    }
+    return hash;
+}
+
+// ================================
+// STRIP CANVAS
+// ================================
+StripCanvas::StripCanvas(int16_t screenWidth, int16_t screenHeight)
+    : Adafruit_GFX(screenWidth, screenHeight), buffer(nullptr),
+      windowX(0), windowY(0), windowWidth(0), windowHeight(0) {}
+
+void StripCanvas::setWindow(uint16_t* pixels, int x, int y, int width, int height) {
+    buffer = pixels;
+    windowX = x;
+    windowY = y;
+    windowWidth = width;
+    windowHeight = height;
+}
+
+void StripCanvas::drawPixel(int16_t x, int16_t y, uint16_t color) {
+    x -= windowX;
+    y -= windowY;
+    if (x < 0 || y < 0 || x >= windowWidth || y >= windowHeight) return;
+    buffer[y * windowWidth + x] = (color >> 8) | (color << 8);
+}
+
+void StripCanvas::fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) {
+    int16_t x0 = max((int16_t)(x - windowX), (int16_t)0);
+    int16_t y0 = max((int16_t)(y - windowY), (int16_t)0);
+    int16_t x1 = min((int16_t)(x - windowX + w), windowWidth);
+    int16_t y1 = min((int16_t)(y - windowY + h), windowHeight);
+    if (x0 >= x1 || y0 >= y1) return;
+
+    uint16_t value = (color >> 8) | (color << 8);
+    for (int16_t row = y0; row < y1; row++) {
+        uint16_t* line = buffer + row * windowWidth;
+        for (int16_t col = x0; col < x1; col++) {
+            line[col] = value;
+        }
+    }
+}
+
+void StripCanvas::drawFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color) {
+    fillRect(x, y, w, 1, color);
+}
+
+void StripCanvas::drawFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color) {
+    fillRect(x, y, 1, h, color);
+}
+
+void StripCanvas::fillScreen(uint16_t color) {
+    fillRect(windowX, windowY, windowWidth, windowHeight, color);
+}
+
+// Draws cached glyph runs with their top-left corner at (x, y)
+void StripCanvas::blitRuns(int x, int y, const TextRun* runs, int count, uint16_t color) {
+    int top = windowY - y;
+    int bottom = top + windowHeight;
+    for (int i = 0; i < count; i++) {
+        if (runs[i].row < top || runs[i].row >= bottom) continue;
+        fillRect(x + runs[i].x, y + runs[i].row, runs[i].length, 1, color);
+    }
+}
+
+// ================================
+// DISPLAY OPTIMIZER
+// ================================
+void DisplayOptimizer::init(AbstractDisplay* panel) {
+    display = panel;
+    regionWidth = panel->width() / DISPLAY_GRID_COLS;
+    regionHeight = panel->height() / DISPLAY_GRID_ROWS;
+
+    for (int i = 0; i < DISPLAY_LAYER_COUNT; i++) {
+        layers[i].opCount = 0;
+        layers[i].textUsed = 0;
+        layers[i].changed = true;
+    }
+    memset(tileHashes, 0, sizeof(tileHashes));
+    markRegionDirty(0, 0, panel->width(), panel->height());
+
+    if (frameBufferEnabled) {
+        initFrameBuffer();
+    }
+
+    Serial.printf("Display optimizer: %dx%d tiles of %dx%d, strip buffer %s (%u px)\n",
+                  DISPLAY_GRID_COLS, DISPLAY_GRID_ROWS, regionWidth, regionHeight,
+                  frameBufferEnabled ? "enabled" : "disabled", (unsigned)frameBufferCapacity);
+}
+
+void DisplayOptimizer::initFrameBuffer() {
+    // The buffers belong to the display backend; they must hold at least
+    // one line of a tile so every dirty run can be sent in bands
+    frameBuffer = display->acquireStripBuffer(&frameBufferCapacity);
+    if (!frameBuffer || frameBufferCapacity < (size_t)regionWidth) {
+        Serial.println("WARNING: No display strip buffer, using direct redraw");
+        frameBuffer = nullptr;
+        frameBufferEnabled = false;
+        return;
+    }
+
+    if (!stripCanvas) {
+        stripCanvas = new StripCanvas(display->width(), display->height());
+    }
+}
+
+void DisplayOptimizer::enableFrameBuffer(bool enabled) {
+    frameBufferEnabled = enabled;
+    if (enabled && display) {
+        initFrameBuffer();
+    }
+    if (display) {
+        markRegionDirty(0, 0, display->width(), display->height());
+    }
+}
+
+void DisplayOptimizer::beginFrame() {
+    frameDepth++;
+}
+
+void DisplayOptimizer::endFrame() {
+    if (frameDepth > 0) frameDepth--;
+    if (frameDepth == 0) {
+        flushFrameBuffer();
+    }
+}
+
+// Starts re-recording a layer; its previous draw calls are discarded
+void DisplayOptimizer::beginLayer(DisplayLayer layer) {
+    currentLayer = layer;
+    layers[layer].opCount = 0;
+    layers[layer].textUsed = 0;
+    layers[layer].changed = true;
+}
+
+void DisplayOptimizer::markDirty(int x, int y, int width, int height) {
+    markRegionDirty(x, y, width, height);
+}
+
+void DisplayOptimizer::markRegionDirty(int x, int y, int width, int height) {
+    int col0 = max(0, x / regionWidth);
+    int row0 = max(0, y / regionHeight);
+    int col1 = min(DISPLAY_GRID_COLS - 1, (x + width - 1) / regionWidth);
+    int row1 = min(DISPLAY_GRID_ROWS - 1, (y + height - 1) / regionHeight);
+
+    for (int col = col0; col <= col1; col++) {
+        for (int row = row0; row <= row1; row++) {
+            dirtyRegions[col][row] = true;
+        }
+    }
+}
+
+DisplayOp* DisplayOptimizer::appendOp(DisplayOpType type) {
+    if (currentLayer < 0) return nullptr;
+
+    DisplayLayerList& layer = layers[currentLayer];
+    if (layer.opCount >= DISPLAY_MAX_OPS_PER_LAYER) {
+        Serial.printf("WARNING: Display layer %d is full, draw call dropped\n", currentLayer);
+        return nullptr;
+    }
+
+    DisplayOp* op = &layer.ops[layer.opCount++];
+    memset(op, 0, sizeof(DisplayOp));
+    op->type = type;
+    return op;
+}
+
+void DisplayOptimizer::optimizedFillRect(int x, int y, int width, int height, uint16_t color) {
+    DisplayOp* op = appendOp(DISPLAY_OP_FILL_RECT);
+    if (!op) return;
+    op->x = x; op->y = y; op->w = width; op->h = height;
+    op->color = color;
+}
+
+void DisplayOptimizer::optimizedDrawRect(int x, int y, int width, int height, uint16_t color) {
+    DisplayOp* op = appendOp(DISPLAY_OP_DRAW_RECT);
+    if (!op) return;
+    op->x = x; op->y = y; op->w = width; op->h = height;
+    op->color = color;
+}
+
+void DisplayOptimizer::optimizedFillCircle(int x, int y, int radius, uint16_t color) {
+    DisplayOp* op = appendOp(DISPLAY_OP_FILL_CIRCLE);
+    if (!op) return;
+    op->x = x; op->y = y; op->h = radius;
+    op->color = color;
+}
+
+void DisplayOptimizer::optimizedDrawLine(int x0, int y0, int x1, int y1, uint16_t color) {
+    DisplayOp* op = appendOp(DISPLAY_OP_LINE);
+    if (!op) return;
+    op->x = x0; op->y = y0; op->w = x1; op->h = y1;
+    op->color = color;
+}
+
+void DisplayOptimizer::optimizedDrawText(int x, int y, const char* text, uint16_t color, uint8_t size) {
+    if (currentLayer < 0) return;
+
+    DisplayLayerList& layer = layers[currentLayer];
+    size_t length = strlen(text);
+    if (length > 255) length = 255;
+    if (layer.textUsed + length > DISPLAY_TEXT_POOL_SIZE) {
+        Serial.printf("WARNING: Display layer %d text pool is full\n", currentLayer);
+        return;
+    }
+
+    DisplayOp* op = appendOp(DISPLAY_OP_TEXT);
+    if (!op) return;
+    op->x = x; op->y = y;
+    op->color = color;
+    op->size = size;
+    op->textOffset = layer.textUsed;
+    op->textLength = length;
+    memcpy(layer.text + layer.textUsed, text, length);
+    layer.textUsed += length;
+}
+
+// Screen-space bounding box of a draw call, inclusive
+void DisplayOptimizer::getOpBounds(const DisplayOp& op, int16_t& x0, int16_t& y0,
+                                   int16_t& x1, int16_t& y1) {
+    switch (op.type) {
+        case DISPLAY_OP_FILL_CIRCLE:
+            x0 = op.x - op.h; y0 = op.y - op.h;
+            x1 = op.x + op.h; y1 = op.y + op.h;
+            break;
+        case DISPLAY_OP_LINE:
+            x0 = min(op.x, op.w); y0 = min(op.y, op.h);
+            x1 = max(op.x, op.w); y1 = max(op.y, op.h);
+            break;
+        case DISPLAY_OP_TEXT:
+            // Built-in 5x7 font on a 6x8 cell
+            x0 = op.x; y0 = op.y;
+            x1 = op.x + op.textLength * 6 * op.size - 1;
+            y1 = op.y + 8 * op.size - 1;
+            break;
+        default:
+            x0 = op.x; y0 = op.y;
+            x1 = op.x + op.w - 1; y1 = op.y + op.h - 1;
+            break;
+    }
+}
+
+// Hashes every tile's draw calls and flags the tiles whose content changed
+void DisplayOptimizer::updateDirtyRegions() {
+    uint32_t hashes[DISPLAY_GRID_COLS][DISPLAY_GRID_ROWS];
+    for (int col = 0; col < DISPLAY_GRID_COLS; col++) {
+        for (int row = 0; row < DISPLAY_GRID_ROWS; row++) {
+            hashes[col][row] = 2166136261UL;
+        }
+    }
+
+    for (int l = 0; l < DISPLAY_LAYER_COUNT; l++) {
+        const DisplayLayerList& layer = layers[l];
+        for (int i = 0; i < layer.opCount; i++) {
+            const DisplayOp& op = layer.ops[i];
+            int16_t x0, y0, x1, y1;
+            getOpBounds(op, x0, y0, x1, y1);
+            if (x1 < 0 || y1 < 0) continue;
+
+            uint32_t opHash = hashMix(2166136261UL, op.type | (op.size << 8) | ((uint32_t)op.color << 16));
+            opHash = hashMix(opHash, (uint16_t)op.x | ((uint32_t)(uint16_t)op.y << 16));
+            opHash = hashMix(opHash, (uint16_t)op.w | ((uint32_t)(uint16_t)op.h << 16));
+            for (int c = 0; c < op.textLength; c++) {
+                opHash = (opHash ^ (uint8_t)layer.text[op.textOffset + c]) * 16777619UL;
+            }
+
+            int col0 = max(0, x0 / regionWidth);
+            int row0 = max(0, y0 / regionHeight);
+            int col1 = min(DISPLAY_GRID_COLS - 1, x1 / regionWidth);
+            int row1 = min(DISPLAY_GRID_ROWS - 1, y1 / regionHeight);
+            for (int col = col0; col <= col1; col++) {
+                for (int row = row0; row <= row1; row++) {
+                    hashes[col][row] = hashMix(hashes[col][row], opHash);
+                }
+            }
+        }
+    }
+
+    for (int col = 0; col < DISPLAY_GRID_COLS; col++) {
+        for (int row = 0; row < DISPLAY_GRID_ROWS; row++) {
+            if (hashes[col][row] != tileHashes[col][row]) {
+                dirtyRegions[col][row] = true;
+                tileHashes[col][row] = hashes[col][row];
+            }
+        }
+    }
+}
+
+void DisplayOptimizer::replayOp(Adafruit_GFX& target, const DisplayLayerList& layer,
+                                const DisplayOp& op) {
+    switch (op.type) {
+        case DISPLAY_OP_FILL_RECT:
+            target.fillRect(op.x, op.y, op.w, op.h, op.color);
+            break;
+        case DISPLAY_OP_DRAW_RECT:
+            target.drawRect(op.x, op.y, op.w, op.h, op.color);
+            break;
+        case DISPLAY_OP_FILL_CIRCLE:
+            target.fillCircle(op.x, op.y, op.h, op.color);
+            break;
+        case DISPLAY_OP_LINE:
+            target.drawLine(op.x, op.y, op.w, op.h, op.color);
+            break;
+        case DISPLAY_OP_TEXT:
+            target.setCursor(op.x, op.y);
+            target.setTextColor(op.color);
+            target.setTextSize(op.size);
+            target.write((const uint8_t*)layer.text + op.textOffset, op.textLength);
+            break;
+    }
+}
+
+// Looks up (or rasterises once) the glyph runs for a text op. Colour is
+// applied at blit time, so one entry serves every colour of a string.
+const CachedText* DisplayOptimizer::getCachedText(const DisplayLayerList& layer, const DisplayOp& op) {
+    const char* text = layer.text + op.textOffset;
+    char key[32];
+    snprintf(key, sizeof(key), "T%u:%08lx:%u", op.size,
+             (unsigned long)PerformanceUtils::fnv1a(text, op.textLength), op.textLength);
+
+    const CachedText* cached = (const CachedText*)CacheOptimizer::get(key);
+    if (cached) {
+        // Guard against hash collisions
+        if (cached->size == op.size && cached->textLength == op.textLength &&
+            memcmp((const char*)((const TextRun*)(cached + 1) + cached->runCount), text, op.textLength) == 0) {
+            return cached;
+        }
+        CacheOptimizer::remove(key);
+    }
+
+    int width = op.textLength * 6 * op.size;
+    int height = 8 * op.size;
+    GFXcanvas1 mask(width, height);
+    if (!mask.getBuffer()) return nullptr;
+
+    mask.setTextWrap(false);
+    mask.setTextSize(op.size);
+    mask.setTextColor(1);
+    mask.setCursor(0, 0);
+    mask.write((const uint8_t*)text, op.textLength);
+
+    // The classic font leaves a blank column per cell, so a run never spans
+    // two glyphs and always fits TextRun::length. Count the runs first so
+    // the entry is built in a single allocation.
+    int runCount = 0;
+    for (int row = 0; row < height; row++) {
+        bool inRun = false;
+        for (int col = 0; col < width; col++) {
+            bool on = mask.getPixel(col, row);
+            if (on && !inRun) runCount++;
+            inRun = on;
+        }
+    }
+
+    size_t bytes = sizeof(CachedText) + op.textLength + runCount * sizeof(TextRun);
+    CachedText* entry = (CachedText*)malloc(bytes);
+    if (!entry) return nullptr;
+
+    entry->runCount = runCount;
+    entry->size = op.size;
+    entry->textLength = op.textLength;
+    TextRun* runs = (TextRun*)(entry + 1);
+    memcpy((char*)(runs + runCount), text, op.textLength);
+    int run = -1;
+    for (int row = 0; row < height; row++) {
+        bool inRun = false;
+        for (int col = 0; col < width; col++) {
+            bool on = mask.getPixel(col, row);
+            if (on && !inRun) {
+                run++;
+                runs[run].x = col;
+                runs[run].row = row;
+                runs[run].length = 0;
+            }
+            if (on) runs[run].length++;
+            inRun = on;
+        }
+    }
+
+    bool stored = CacheOptimizer::put(key, entry, bytes);
+    free(entry);
+    return stored ? (const CachedText*)CacheOptimizer::get(key) : nullptr;
+}
+
+// Rasterises a window into the display's free strip buffer and hands it
+// over; with a double-buffered backend the transfer overlaps the next render
+void DisplayOptimizer::pushWindow(int x, int y, int width, int height) {
+    frameBuffer = display->acquireStripBuffer(nullptr);
+    stripCanvas->setWindow(frameBuffer, x, y, width, height);
+    stripCanvas->fillScreen(0);
+
+    for (int l = 0; l < DISPLAY_LAYER_COUNT; l++) {
+        const DisplayLayerList& layer = layers[l];
+        for (int i = 0; i < layer.opCount; i++) {
+            int16_t x0, y0, x1, y1;
+            getOpBounds(layer.ops[i], x0, y0, x1, y1);
+            if (x1 < x || x0 >= x + width || y1 < y || y0 >= y + height) continue;
+
+            const DisplayOp& op = layer.ops[i];
+            if (op.type == DISPLAY_OP_TEXT) {
+                const CachedText* cached = getCachedText(layer, op);
+                if (cached) {
+                    stripCanvas->blitRuns(op.x, op.y, (const TextRun*)(cached + 1), cached->runCount, op.color);
+                    continue;
+                }
+            }
+            replayOp(*stripCanvas, layer, op);
+        }
+    }
+
+    display->pushStrip(x, y, width, height, frameBuffer);
+}
+
+// Pushes the dirty tiles of one tile row, coalescing adjacent tiles into one
+// window and splitting windows into bands that fit a strip buffer
+void DisplayOptimizer::pushStrip(int row) {
+    int stripY = row * regionHeight;
+    int col = 0;
+
+    while (col < DISPLAY_GRID_COLS) {
+        if (!dirtyRegions[col][row]) {
+            col++;
+            continue;
+        }
+
+        int runStart = col;
+        while (col < DISPLAY_GRID_COLS && dirtyRegions[col][row]) {
+            dirtyRegions[col][row] = false;
+            col++;
+        }
+        int x = runStart * regionWidth;
+        int width = (col - runStart) * regionWidth;
+        int bandHeight = min(regionHeight, (int)(frameBufferCapacity / width));
+
+        for (int y = stripY; y < stripY + regionHeight; y += bandHeight) {
+            pushWindow(x, y, width, min(bandHeight, stripY + regionHeight - y));
+        }
+        tilesPushed += col - runStart;
+    }
+}
+
+// Fallback without a strip buffer: repaint changed layers with the
+// display's own primitives
+void DisplayOptimizer::replayChangedLayers() {
+    bool repaintAll = layers[DISPLAY_LAYER_BACKGROUND].changed;
+    char text[256];
+
+    for (int l = 0; l < DISPLAY_LAYER_COUNT; l++) {
+        const DisplayLayerList& layer = layers[l];
+        if (!repaintAll && !layer.changed) continue;
+
+        for (int i = 0; i < layer.opCount; i++) {
+            const DisplayOp& op = layer.ops[i];
+            switch (op.type) {
+                case DISPLAY_OP_FILL_RECT:
+                    display->fillRect(op.x, op.y, op.w, op.h, op.color);
+                    break;
+                case DISPLAY_OP_DRAW_RECT:
+                    display->drawRect(op.x, op.y, op.w, op.h, op.color);
+                    break;
+                case DISPLAY_OP_FILL_CIRCLE:
+                    display->fillCircle(op.x, op.y, op.h, op.color);
+                    break;
+                case DISPLAY_OP_LINE:
+                    display->drawLine(op.x, op.y, op.w, op.h, op.color);
+                    break;
+                case DISPLAY_OP_TEXT:
+                    memcpy(text, layer.text + op.textOffset, op.textLength);
+                    text[op.textLength] = '\0';
+                    display->setCursor(op.x, op.y);
+                    display->setTextColor(op.color);
+                    display->setTextSize(op.size);
+                    display->print(text);
+                    break;
+            }
+        }
+    }
+    memset(dirtyRegions, 0, sizeof(dirtyRegions));
+}
+
+void DisplayOptimizer::flushFrameBuffer() {
+    if (!display) return;
+
+    PERF_PROFILE_SCOPE(PERF_SPAN_DISPLAY);
+    unsigned long start = millis();
+
+    if (frameBufferEnabled && frameBuffer) {
+        updateDirtyRegions();
+        for (int row = 0; row < DISPLAY_GRID_ROWS; row++) {
+            for (int col = 0; col < DISPLAY_GRID_COLS; col++) {
+                if (dirtyRegions[col][row]) {
+                    pushStrip(row);
+                    break;
+                }
+            }
+        }
+    } else {
+        replayChangedLayers();
+    }
+
+    for (int l = 0; l < DISPLAY_LAYER_COUNT; l++) {
+        layers[l].changed = false;
+    }
+
+    lastFrameTime = millis() - start;
+    framesFlushed++;
+    if (millis() - lastRateSample >= 1000) {
+        currentFrameRate = framesFlushed - framesAtRateSample;
+        framesAtRateSample = framesFlushed;
+        lastRateSample = millis();
+    }
+}
+
+int DisplayOptimizer::getCurrentFrameRate() {
+    return currentFrameRate;
+}
+
+unsigned long DisplayOptimizer::getLastFrameTime() {
+    return lastFrameTime;
+}
+
+unsigned long DisplayOptimizer::getTilesPushed() {
+    return tilesPushed;
+}
+
+void DisplayOptimizer::printDisplayStats() {
+    Serial.printf("Display Stats - Frames: %lu, Tiles pushed: %lu (%.1f/frame), Last frame: %lums\n",
+                  framesFlushed, tilesPushed,
+                  framesFlushed ? (float)tilesPushed / framesFlushed : 0.0f, lastFrameTime);
+}
+
+// ================================
+// CPU OPTIMIZER
+// ================================
+void CPUOptimizer::init(uint32_t minMhz, uint32_t maxMhz) {
+    minFrequency = minMhz < 80 ? 80 : minMhz;
+    maxFrequency = maxMhz < minFrequency ? minFrequency : maxMhz;
+    currentFrequency = getCpuFrequencyMhz();
+    lastFrequencyChange = millis();
+    loadPermille = 0;
+    peakLoadPermille = 0;
+    frequencyChanges = 0;
+}
+
+void CPUOptimizer::enableDynamicFrequency(bool enabled) {
+    dynamicFrequency = enabled;
+    if (!enabled) applyFrequency(maxFrequency, millis());
+}
+
+void CPUOptimizer::reportLoad(uint32_t busyUs, uint32_t windowUs) {
+    if (windowUs == 0) return;
+
+    uint32_t load = (uint64_t)busyUs * 1000 / windowUs;
+    loadPermille = load > 1000 ? 1000 : load;
+    if (loadPermille > peakLoadPermille) peakLoadPermille = loadPermille;
+
+    if (dynamicFrequency) adjustCPUFrequency(millis());
+}
+
+// Valid steps with the radio on are 80, 160 and 240 MHz. Jump straight to
+// full speed under load; come down one step at a time after a dwell.
+void CPUOptimizer::adjustCPUFrequency(unsigned long now) {
+    if (loadPermille > CPU_LOAD_RAISE_PERMILLE) {
+        if (currentFrequency < maxFrequency) applyFrequency(maxFrequency, now);
+        return;
+    }
+
+    if (now - lastFrequencyChange < CPU_FREQ_MIN_DWELL_MS) return;
+
+    uint32_t lower = currentFrequency > 160 ? 160 : 80;
+    if (lower < minFrequency || lower >= currentFrequency) return;
+
+    // The same work takes proportionally longer on the slower clock
+    uint32_t projected = (uint32_t)loadPermille * currentFrequency / lower;
+    if (projected < CPU_LOAD_LOWER_PERMILLE) applyFrequency(lower, now);
+}
+
+void CPUOptimizer::applyFrequency(uint32_t frequency, unsigned long now) {
+    if (frequency == currentFrequency) return;
+    if (!setCpuFrequencyMhz(frequency)) return;
+
+    Serial.printf("CPU frequency %lu -> %lu MHz (load %u.%u%%)\n",
+                  (unsigned long)currentFrequency, (unsigned long)frequency,
+                  loadPermille / 10, loadPermille % 10);
+    currentFrequency = frequency;
+    PerformanceProfiler::setCpuFrequency(frequency);
+    lastFrequencyChange = now;
+    frequencyChanges++;
+}
+
+float CPUOptimizer::getCPUUsage() {
+    return loadPermille / 10.0f;
+}
+
+uint32_t CPUOptimizer::getCurrentFrequency() {
+    return currentFrequency;
+}
+
+void CPUOptimizer::forceCPUFrequency(uint32_t frequency) {
+    dynamicFrequency = false;
+    applyFrequency(frequency, millis());
+}
+
+void CPUOptimizer::printCPUStats() {
+    Serial.printf("CPU Stats - %lu MHz%s, load %.1f%% (peak %.1f%%), %lu frequency changes\n",
+                  (unsigned long)currentFrequency, dynamicFrequency ? " (dynamic)" : "",
+                  loadPermille / 10.0f, peakLoadPermille / 10.0f, frequencyChanges);
+}
+
+// ================================
+// PERFORMANCE PROFILER
+// ================================
+void PerformanceProfiler::init() {
+    setCpuFrequency(getCpuFrequencyMhz());
+    reset();
+}
+
+void PerformanceProfiler::enableProfiling(bool enabled) {
+    profilingEnabled = enabled;
+}
+
+void PerformanceProfiler::setCpuFrequency(uint32_t mhz) {
+    cyclesPerUs = mhz > 0 ? mhz : 1;
+}
+
+// Values below 4 us get a bucket each; above that, every power of two is
+// split into 2^PERF_HISTOGRAM_SUB_BITS buckets by the bits after the top one
+uint8_t PerformanceProfiler::bucketFor(uint32_t us) {
+    const uint32_t subBuckets = 1 << PERF_HISTOGRAM_SUB_BITS;
+    if (us < subBuckets) return us;
+
+    uint8_t octave = 31 - __builtin_clz(us);
+    uint32_t sub = (us >> (octave - PERF_HISTOGRAM_SUB_BITS)) & (subBuckets - 1);
+    uint32_t bucket = (octave - PERF_HISTOGRAM_SUB_BITS + 1) * subBuckets + sub;
+    return bucket < PERF_HISTOGRAM_BUCKETS ? bucket : PERF_HISTOGRAM_BUCKETS - 1;
+}
+
+uint32_t PerformanceProfiler::bucketUpperBound(uint8_t bucket) {
+    const uint32_t subBuckets = 1 << PERF_HISTOGRAM_SUB_BITS;
+    if (bucket < subBuckets) return bucket;
+
+    uint8_t shift = bucket / subBuckets - 1;
+    uint32_t lower = (subBuckets + bucket % subBuckets) << shift;
+    return lower + (1UL << shift) - 1;
+}
+
+void PerformanceProfiler::end(PerfSpan span, uint32_t startCycles) {
+    if (!profilingEnabled || span >= PERF_SPAN_COUNT) return;
+
+    uint32_t us = (ESP.getCycleCount() - startCycles) / cyclesPerUs;
+    uint8_t bucket = bucketFor(us);
+
+    portENTER_CRITICAL(&profilerMux);
+    Histogram& histogram = histograms[span];
+    if (histogram.buckets[bucket] < 0xFFFF) histogram.buckets[bucket]++;
+    histogram.count++;
+    if (us > histogram.maxUs) histogram.maxUs = us;
+    portEXIT_CRITICAL(&profilerMux);
+}
+
+// Upper edge of the bucket holding the rank-th sample, capped at the max
+uint32_t PerformanceProfiler::percentile(const Histogram& histogram, uint32_t rank) {
+    uint32_t seen = 0;
+    for (uint8_t i = 0; i < PERF_HISTOGRAM_BUCKETS; i++) {
+        seen += histogram.buckets[i];
+        if (seen >= rank) {
+            uint32_t bound = bucketUpperBound(i);
+            return bound < histogram.maxUs ? bound : histogram.maxUs;
+        }
+    }
+    return histogram.maxUs;
+}
+
+PerfSpanSummary PerformanceProfiler::summarize(PerfSpan span) {
+    PerfSpanSummary summary = { 0, 0, 0, 0 };
+    if (span >= PERF_SPAN_COUNT) return summary;
+
+    Histogram snapshot;
+    portENTER_CRITICAL(&profilerMux);
+    snapshot = histograms[span];
+    portEXIT_CRITICAL(&profilerMux);
+
+    // Ranks come from the bucket totals, which saturate before count does
+    uint32_t total = 0;
+    for (uint8_t i = 0; i < PERF_HISTOGRAM_BUCKETS; i++) {
+        total += snapshot.buckets[i];
+    }
+    summary.count = snapshot.count;
+    summary.maxUs = snapshot.maxUs;
+    if (total == 0) return summary;
+
+    summary.p50Us = percentile(snapshot, (total + 1) / 2);
+    summary.p99Us = percentile(snapshot, total - total / 100);
+    return summary;
+}
+
+unsigned long PerformanceProfiler::getWindowMs() {
+    return millis() - windowStart;
+}
+
+void PerformanceProfiler::reset() {
+    portENTER_CRITICAL(&profilerMux);
+    memset(histograms, 0, sizeof(histograms));
+    portEXIT_CRITICAL(&profilerMux);
+    windowStart = millis();
+}
+
+const char* PerformanceProfiler::getSpanName(PerfSpan span) {
+    switch (span) {
+        case PERF_SPAN_SCAN: return "scan";
+        case PERF_SPAN_MQTT_RX: return "mqtt_rx";
+        case PERF_SPAN_DISPLAY: return "display";
+        case PERF_SPAN_PUBLISH: return "publish";
+        default: return "unknown";
+    }
+}
+
+void PerformanceProfiler::printReport() {
+    Serial.printf("Profiler - last %lus\n", getWindowMs() / 1000);
+    for (uint8_t i = 0; i < PERF_SPAN_COUNT; i++) {
+        PerfSpanSummary summary = summarize((PerfSpan)i);
+        if (summary.count == 0) continue;
+        Serial.printf("  %-8s n %lu | p50 %luus p99 %luus max %luus\n", getSpanName((PerfSpan)i),
+                      (unsigned long)summary.count, (unsigned long)summary.p50Us,
+                      (unsigned long)summary.p99Us, (unsigned long)summary.maxUs);
+    }
+}
+
+// ================================
+// CACHE OPTIMIZER
+// ================================
+void CacheOptimizer::init() {
+    clear();
+    cacheHits = 0;
+    cacheMisses = 0;
+    lastCleanup = millis();
+}
+
+int CacheOptimizer::findEntry(const char* key) {
+    uint32_t hash = PerformanceUtils::fnv1a(key, strlen(key));
+    for (int i = 0; i < CACHE_SIZE; i++) {
+        if (cache[i].data && cache[i].keyHash == hash && strcmp(cache[i].key, key) == 0) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+// Least recently used occupied entry, or -1 when the cache is empty
+int CacheOptimizer::findLRUEntry() {
+    int lru = -1;
+    for (int i = 0; i < CACHE_SIZE; i++) {
+        if (!cache[i].data) continue;
+        if (lru < 0 || cache[i].lastAccess < cache[lru].lastAccess) lru = i;
+    }
+    return lru;
+}
+
+void CacheOptimizer::evictEntry(int index) {
+    if (!cache[index].data) return;
+    free(cache[index].data);
+    usedBytes -= cache[index].size;
+    cache[index].data = nullptr;
+    cache[index].size = 0;
+    cache[index].key[0] = '\0';
+}
+
+void CacheOptimizer::updateAccessStats(int index) {
+    cache[index].lastAccess = millis();
+    cache[index].accessCount++;
+}
+
+// Stores a copy of data under key, evicting LRU entries to stay in budget
+bool CacheOptimizer::put(const char* key, const void* data, size_t size) {
+    if (size > byteLimit || strlen(key) >= sizeof(cache[0].key)) return false;
+
+    remove(key);
+    while (usedBytes + size > byteLimit) {
+        evictEntry(findLRUEntry());
+    }
+
+    int index = -1;
+    for (int i = 0; i < CACHE_SIZE && index < 0; i++) {
+        if (!cache[i].data) index = i;
+    }
+    if (index < 0) {
+        index = findLRUEntry();
+        evictEntry(index);
+    }
+
+    void* copy = malloc(size);
+    if (!copy) return false;
+    memcpy(copy, data, size);
+
+    CacheEntry& entry = cache[index];
+    strcpy(entry.key, key);
+    entry.keyHash = PerformanceUtils::fnv1a(key, strlen(key));
+    entry.data = copy;
+    entry.size = size;
+    entry.accessCount = 0;
+    updateAccessStats(index);
+    usedBytes += size;
+    return true;
+}
+
+void* CacheOptimizer::get(const char* key) {
+    int index = findEntry(key);
+    if (index < 0) {
+        cacheMisses++;
+        return nullptr;
+    }
+    cacheHits++;
+    updateAccessStats(index);
+    return cache[index].data;
+}
+
+void CacheOptimizer::remove(const char* key) {
+    int index = findEntry(key);
+    if (index >= 0) evictEntry(index);
+}
+
+void CacheOptimizer::clear() {
+    for (int i = 0; i < CACHE_SIZE; i++) {
+        evictEntry(i);
+    }
+    usedBytes = 0;
+}
+
+float CacheOptimizer::getHitRatio() {
+    int total = cacheHits + cacheMisses;
+    return total ? (float)cacheHits / total : 0.0f;
+}
+
+size_t CacheOptimizer::getUsedBytes() {
+    return usedBytes;
+}
+
+void CacheOptimizer::setByteLimit(size_t bytes) {
+    byteLimit = bytes < CACHE_MAX_BYTES ? bytes : CACHE_MAX_BYTES;
+    while (usedBytes > byteLimit) {
+        evictEntry(findLRUEntry());
+    }
+}
+
+size_t CacheOptimizer::getByteLimit() {
+    return byteLimit;
+}
+
+void CacheOptimizer::printCacheStats() {
+    int entries = 0;
+    for (int i = 0; i < CACHE_SIZE; i++) {
+        if (cache[i].data) entries++;
+    }
+    Serial.printf("Cache Stats - Entries: %d/%d, Bytes: %u/%u, Hit ratio: %.1f%%\n",
+                  entries, CACHE_SIZE, (unsigned)usedBytes, (unsigned)byteLimit,
+                  getHitRatio() * 100.0f);
+}
+
+// ================================
+// PERFORMANCE UTILITIES
+// ================================
+uint32_t PerformanceUtils::fnv1a(const void* data, size_t length, uint32_t seed) {
+    const uint8_t* bytes = (const uint8_t*)data;
+    uint32_t hash = seed;
+    for (size_t i = 0; i < length; i++) {
+        hash = (hash ^ bytes[i]) * 16777619UL;
+    }
+    return hash;
+}
@@ -0,0 +1,420 @@
+/**
+ * Performance optimization utilities for ConsultEase Faculty Desk Unit
+ * Optimizes display rendering, network operations, and system responsiveness
+ */
+
+#ifndef PERFORMANCE_OPTIMIZATION_H
+#define PERFORMANCE_OPTIMIZATION_H
+
+#include <Arduino.h>
+#include <Adafruit_GFX.h>
+#include "hardware_abstraction.h"
+
+// Performance monitoring constants
+#define PERF_SAMPLE_SIZE 10
+#define PERF_UPDATE_INTERVAL 5000
+#define MAX_FRAME_TIME 33  // ~30 FPS target
+
+// Dynamic CPU frequency: step up above the raise load, step down when the
+// lower clock would still stay under the lower load (per mille, busiest core)
+#define CPU_LOAD_RAISE_PERMILLE 600
+#define CPU_LOAD_LOWER_PERMILLE 300
+#define CPU_FREQ_MIN_DWELL_MS 10000
+
+// Hot-path spans timed by PerformanceProfiler
+enum PerfSpan : uint8_t {
+    PERF_SPAN_SCAN = 0,       // Scanner holding its context for one window
+    PERF_SPAN_MQTT_RX,        // onMqttMessage
+    PERF_SPAN_DISPLAY,        // Rasterising and pushing one frame
+    PERF_SPAN_PUBLISH,        // publishWithQueue
+    PERF_SPAN_COUNT
+};
+
+// Log-linear histogram: 4 buckets per power of two (<= 25% error),
+// 1 us up to ~2 minutes
+#define PERF_HISTOGRAM_SUB_BITS 2
+#define PERF_HISTOGRAM_BUCKETS 104
+
+struct PerfSpanSummary {
+    uint32_t count;
+    uint32_t p50Us;
+    uint32_t p99Us;
+    uint32_t maxUs;
+};
+
+// Dirty-region grid: 8x6 tiles of 40x40 pixels on the 320x240 panel
+#define DISPLAY_GRID_COLS 8
+#define DISPLAY_GRID_ROWS 6
+#define DISPLAY_MAX_OPS_PER_LAYER 32
+#define DISPLAY_TEXT_POOL_SIZE 384
+
+// Layers are re-recorded independently and composited in this order
+enum DisplayLayer {
+    DISPLAY_LAYER_BACKGROUND = 0,
+    DISPLAY_LAYER_MAIN,
+    DISPLAY_LAYER_STATUS,
+    DISPLAY_LAYER_CLOCK,
+    DISPLAY_LAYER_COUNT
+};
+
+enum DisplayOpType : uint8_t {
+    DISPLAY_OP_FILL_RECT = 1,
+    DISPLAY_OP_DRAW_RECT,
+    DISPLAY_OP_FILL_CIRCLE,
+    DISPLAY_OP_LINE,
+    DISPLAY_OP_TEXT
+};
+
+// One recorded draw call; text bytes live in the owning layer's pool
+struct DisplayOp {
+    DisplayOpType type;
+    uint8_t size;
+    uint8_t textLength;
+    uint16_t textOffset;
+    int16_t x, y, w, h;    // Line: (x, y) -> (w, h); circle: h = radius
+    uint16_t color;
+};
+
+struct DisplayLayerList {
+    DisplayOp ops[DISPLAY_MAX_OPS_PER_LAYER];
+    char text[DISPLAY_TEXT_POOL_SIZE];
+    uint8_t opCount;
+    uint16_t textUsed;
+    bool changed;
+};
+
+// Pre-rasterised text: glyph pixels of one string at one size, stored as
+// horizontal runs so a redraw is a handful of row fills in the strip buffer
+struct TextRun {
+    uint16_t x;
+    uint8_t row;
+    uint8_t length;
+};
+
+struct CachedText {
+    uint16_t runCount;
+    uint8_t size;
+    uint8_t textLength;
+    // Followed by runCount TextRun entries, then textLength bytes of text
+};
+
+// Adafruit_GFX target over a strip buffer: draws in screen coordinates,
+// clips to the current window and stores pixels in panel (big-endian) order
+class StripCanvas : public Adafruit_GFX {
+private:
+    uint16_t* buffer;
+    int16_t windowX, windowY, windowWidth, windowHeight;
+
+public:
+    StripCanvas(int16_t screenWidth, int16_t screenHeight);
+    void setWindow(uint16_t* pixels, int x, int y, int width, int height);
+    void drawPixel(int16_t x, int16_t y, uint16_t color) override;
+    void fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) override;
+    void drawFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color) override;
+    void drawFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color) override;
+    void fillScreen(uint16_t color) override;
+    void blitRuns(int x, int y, const TextRun* runs, int count, uint16_t color);
+};
+
+// Display optimization class
+// Retained-mode renderer: the UI records draw calls into layers, each frame
+// is hashed per tile, and only tiles whose content changed are rasterised
+// into the display's strip buffers and pushed (by DMA where available).
+class DisplayOptimizer {
+private:
+    static AbstractDisplay* display;
+    static StripCanvas* stripCanvas;
+    static uint16_t* frameBuffer;
+    static size_t frameBufferCapacity;
+    static bool frameBufferEnabled;
+    static bool dirtyRegions[DISPLAY_GRID_COLS][DISPLAY_GRID_ROWS];
+    static uint32_t tileHashes[DISPLAY_GRID_COLS][DISPLAY_GRID_ROWS];
+    static DisplayLayerList layers[DISPLAY_LAYER_COUNT];
+    static int currentLayer;
+    static int frameDepth;
+    static int regionWidth;
+    static int regionHeight;
+    static unsigned long lastFrameTime;
+    static int currentFrameRate;
+    static bool vsyncEnabled;
+    static unsigned long framesFlushed;
+    static unsigned long tilesPushed;
+    static unsigned long lastRateSample;
+    static unsigned long framesAtRateSample;
+
+    static void initFrameBuffer();
+    static void markRegionDirty(int x, int y, int width, int height);
+    static void updateDirtyRegions();
+    static void optimizeSPISettings();
+    static DisplayOp* appendOp(DisplayOpType type);
+    static void getOpBounds(const DisplayOp& op, int16_t& x0, int16_t& y0, int16_t& x1, int16_t& y1);
+    static void replayOp(Adafruit_GFX& target, const DisplayLayerList& layer, const DisplayOp& op);
+    static void pushStrip(int row);
+    static void pushWindow(int x, int y, int width, int height);
+    static void replayChangedLayers();
+    static const CachedText* getCachedText(const DisplayLayerList& layer, const DisplayOp& op);
+
+public:
+    static void init(AbstractDisplay* panel);
+    static void enableFrameBuffer(bool enabled);
+    static void enableVSync(bool enabled);
+    static void beginFrame();
+    static void endFrame();
+    static void beginLayer(DisplayLayer layer);
+    static void markDirty(int x, int y, int width, int height);
+    static void optimizedFillRect(int x, int y, int width, int height, uint16_t color);
+    static void optimizedDrawRect(int x, int y, int width, int height, uint16_t color);
+    static void optimizedFillCircle(int x, int y, int radius, uint16_t color);
+    static void optimizedDrawText(int x, int y, const char* text, uint16_t color, uint8_t size);
+    static void optimizedDrawLine(int x0, int y0, int x1, int y1, uint16_t color);
+    static void flushFrameBuffer();
+    static int getCurrentFrameRate();
+    static unsigned long getLastFrameTime();
+    static unsigned long getTilesPushed();
+    static void printDisplayStats();
+};
+
+// Network optimization class
+class NetworkOptimizer {
+private:
+    static unsigned long lastPingTime;
+    static unsigned long averageLatency;
+    static int connectionQuality;
+    static bool adaptiveQoS;
+    static int messageQueue[16];
+    static int queueHead;
+    static int queueTail;
+    static unsigned long lastOptimization;
+    
+    static void measureLatency();
+    static void adjustQoS();
+    static void optimizeWiFiSettings();
+    static void queueMessage(int messageId);
+    static int dequeueMessage();
+    
+public:
+    static void init();
+    static void enableAdaptiveQoS(bool enabled);
+    static void optimizeConnection();
+    static void recordNetworkActivity();
+    static unsigned long getAverageLatency();
+    static int getConnectionQuality();
+    static void flushMessageQueue();
+    static void printNetworkStats();
+};
+
+// CPU optimization class
+// Picks the clock from the load the event schedulers measure: busy time of
+// the busiest core over a sample window. 80 MHz is the floor WiFi and BLE
+// tolerate, and APB stays at 80 MHz there, so peripherals are unaffected.
+class CPUOptimizer {
+private:
+    static bool dynamicFrequency;
+    static uint32_t currentFrequency;
+    static uint32_t minFrequency;
+    static uint32_t maxFrequency;
+    static unsigned long lastFrequencyChange;
+    static uint16_t loadPermille;            // Last sample, at currentFrequency
+    static uint16_t peakLoadPermille;
+    static unsigned long frequencyChanges;
+
+    static void adjustCPUFrequency(unsigned long now);
+    static void applyFrequency(uint32_t frequency, unsigned long now);
+
+public:
+    static void init(uint32_t minMhz, uint32_t maxMhz);
+    static void enableDynamicFrequency(bool enabled);
+    static void reportLoad(uint32_t busyUs, uint32_t windowUs);
+    static float getCPUUsage();
+    static uint32_t getCurrentFrequency();
+    static void forceCPUFrequency(uint32_t frequency);
+    static void printCPUStats();
+};
+
+// Memory optimization class
+class MemoryOptimizer {
+private:
+    static size_t peakMemoryUsage;
+    static size_t currentMemoryUsage;
+    static unsigned long lastGarbageCollection;
+    static bool autoGarbageCollection;
+    static int fragmentationLevel;
+    
+    static void measureFragmentation();
+    static void performGarbageCollection();
+    static void optimizeHeap();
+    
+public:
+    static void init();
+    static void enableAutoGarbageCollection(bool enabled);
+    static void recordAllocation(size_t size);
+    static void recordDeallocation(size_t size);
+    static size_t getCurrentUsage();
+    static size_t getPeakUsage();
+    static int getFragmentationLevel();
+    static void forceGarbageCollection();
+    static void printMemoryStats();
+};
+
+// Performance profiler
+// Spans are timed with the CPU cycle counter and only touch a fixed
+// histogram, so they are cheap enough to leave on in production. Records
+// may come from either core; a spinlock keeps the counts consistent.
+class PerformanceProfiler {
+private:
+    struct Histogram {
+        uint16_t buckets[PERF_HISTOGRAM_BUCKETS];   // Saturating
+        uint32_t count;
+        uint32_t maxUs;
+    };
+
+    static Histogram histograms[PERF_SPAN_COUNT];
+    static uint32_t cyclesPerUs;
+    static bool profilingEnabled;
+    static unsigned long windowStart;
+
+    static uint8_t bucketFor(uint32_t us);
+    static uint32_t bucketUpperBound(uint8_t bucket);
+    static uint32_t percentile(const Histogram& histogram, uint32_t rank);
+
+public:
+    static void init();
+    static void enableProfiling(bool enabled);
+    static uint32_t begin() { return ESP.getCycleCount(); }
+    static void end(PerfSpan span, uint32_t startCycles);
+    static void setCpuFrequency(uint32_t mhz);   // Cycle counter rate
+
+    // Histograms cover the time since the last reset
+    static PerfSpanSummary summarize(PerfSpan span);
+    static unsigned long getWindowMs();
+    static void reset();
+    static const char* getSpanName(PerfSpan span);
+    static void printReport();
+};
+
+// Times the enclosing scope, whichever way it is left
+class PerfScope {
+private:
+    PerfSpan span;
+    uint32_t start;
+
+public:
+    explicit PerfScope(PerfSpan span) : span(span), start(PerformanceProfiler::begin()) {}
+    ~PerfScope() { PerformanceProfiler::end(span, start); }
+};
+
+// Cache optimization
+// Small LRU cache of heap copies, bounded by entry count and total bytes.
+// Used for pre-rasterised text runs and message line layouts.
+class CacheOptimizer {
+private:
+    struct CacheEntry {
+        char key[32];
+        uint32_t keyHash;
+        void* data;
+        size_t size;
+        unsigned long lastAccess;
+        int accessCount;
+    };
+    
+    static const int CACHE_SIZE = 32;
+    static const size_t CACHE_MAX_BYTES = 12288;
+    static CacheEntry cache[CACHE_SIZE];
+    static size_t usedBytes;
+    static size_t byteLimit;          // CACHE_MAX_BYTES unless shrunk under memory pressure
+    static int cacheHits;
+    static int cacheMisses;
+    static unsigned long lastCleanup;
+    
+    static int findEntry(const char* key);
+    static int findLRUEntry();
+    static void evictEntry(int index);
+    static void updateAccessStats(int index);
+    
+public:
+    static void init();
+    static bool put(const char* key, const void* data, size_t size);
+    static void* get(const char* key);
+    static void remove(const char* key);
+    static void clear();
+    static float getHitRatio();
+    static size_t getUsedBytes();
+    // Evicts LRU entries down to the new budget; capped at CACHE_MAX_BYTES
+    static void setByteLimit(size_t bytes);
+    static size_t getByteLimit();
+    static void printCacheStats();
+};
+
+// Interrupt optimization
+class InterruptOptimizer {
+private:
+    static unsigned long interruptCount;
+    static unsigned long totalInterruptTime;
+    static bool interruptProfiling;
+    
+public:
+    static void init();
+    static void enableProfiling(bool enabled);
+    static void recordInterrupt(unsigned long duration);
+    static float getInterruptLoad();
+    static void printInterruptStats();
+};
+
+// Performance monitoring utilities
+namespace PerformanceUtils {
+    // Timing utilities
+    unsigned long micros_safe();
+    void delay_optimized(unsigned long ms);
+    void yield_optimized();
+    
+    // Memory utilities
+    void* malloc_tracked(size_t size);
+    void free_tracked(void* ptr);
+    void* realloc_tracked(void* ptr, size_t size);
+    
+    // String utilities
+    void strcpy_optimized(char* dest, const char* src, size_t maxLen);
+    int strcmp_optimized(const char* str1, const char* str2);
+    char* strstr_optimized(const char* haystack, const char* needle);
+    
+    // Math utilities
+    int fast_sqrt(int x);
+    int fast_abs(int x);
+    int fast_min(int a, int b);
+    int fast_max(int a, int b);
+    
+    // Hash utilities
+    uint32_t fnv1a(const void* data, size_t length, uint32_t seed = 2166136261UL);
+}
+
+// Performance configuration
+struct PerformanceConfig {
+    bool enableFrameBuffer;
+    bool enableVSync;
+    bool enableAdaptiveQoS;
+    bool enableDynamicFrequency;
+    bool enableAutoGarbageCollection;
+    bool enableProfiling;
+    int targetFrameRate;
+    uint32_t maxCPUFrequency;
+    uint32_t minCPUFrequency;
+    size_t maxMemoryUsage;
+};
+
+extern PerformanceConfig performanceConfig;
+
+// Performance macros
+#define PERF_PROFILE_SCOPE(span) PerfScope perfScope(span)
+#define PERF_BEGIN_FRAME() DisplayOptimizer::beginFrame()
+#define PERF_END_FRAME() DisplayOptimizer::endFrame()
+#define PERF_MARK_DIRTY(x, y, w, h) DisplayOptimizer::markDirty(x, y, w, h)
+#define PERF_YIELD() PerformanceUtils::yield_optimized()
+
+// Function prototypes
+void initPerformanceOptimization();
+void updatePerformanceOptimization();
+void printPerformanceReport();
+void optimizeForBatteryLife();
+void optimizeForPerformance();
+
+#endif // PERFORMANCE_OPTIMIZATION_H
@@ -98,28 +98,6 @@ public:
 // Power-aware delay function
 void powerAwareDelay(unsigned long ms);
 
-// Power-aware task scheduling
-class PowerAwareScheduler {
-private:
-    struct Task {
-        unsigned long interval;
-        unsigned long lastRun;
-        void (*callback)();
-        bool powerSensitive;
-    };
-    
-    static const int MAX_TASKS = 10;
-    static Task tasks[MAX_TASKS];
-    static int taskCount;
-    
-public:
-    static void init();
-    static bool addTask(void (*callback)(), unsigned long interval, bool powerSensitive = true);
-    static void update();
-    static void pausePowerSensitiveTasks();
-    static void resumePowerSensitiveTasks();
-};
-
 // Display power management
 class DisplayPowerManager {
 private:
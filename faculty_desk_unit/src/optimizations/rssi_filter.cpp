@@ -0,0 +1,88 @@
+/**
+ * RSSI filter implementation for ConsultEase Faculty Desk Unit
+ */
+
+#include "rssi_filter.h"
+#include <math.h>
+
+#define Q8_ONE 256
+
+RssiFilter::RssiFilter(int enterThreshold, int hysteresis)
+    : enterThreshold(enterThreshold), exitThreshold(enterThreshold - hysteresis) {
+    reset();
+}
+
+void RssiFilter::reset() {
+    estimate = 0;
+    variance = 0;
+    missedWindows = 0;
+    valid = false;
+    inRange = false;
+}
+
+void RssiFilter::update(int rssi) {
+    int32_t measurement = (int32_t)rssi * Q8_ONE;
+    missedWindows = 0;
+
+    if (!valid) {
+        estimate = measurement;
+        variance = RSSI_MEASUREMENT_NOISE * Q8_ONE;
+        valid = true;
+        updateRange();
+        return;
+    }
+
+    // Predict, then blend in the sample by the Kalman gain (Q8)
+    int32_t predicted = variance + RSSI_PROCESS_NOISE * Q8_ONE;
+    int32_t gain = (predicted * Q8_ONE) / (predicted + RSSI_MEASUREMENT_NOISE * Q8_ONE);
+    estimate += (gain * (measurement - estimate)) / Q8_ONE;
+    variance = ((Q8_ONE - gain) * predicted) / Q8_ONE;
+    updateRange();
+}
+
+// No sample: the estimate stands but grows less certain, faster than the
+// drift model alone since a missing beacon is itself evidence
+void RssiFilter::miss() {
+    if (!valid) return;
+
+    if (++missedWindows >= RSSI_MAX_MISSED_WINDOWS) {
+        reset();
+        return;
+    }
+    variance += 4 * RSSI_PROCESS_NOISE * Q8_ONE;
+}
+
+void RssiFilter::updateRange() {
+    int level = getRssi();
+    if (!inRange && level >= enterThreshold) {
+        inRange = true;
+    } else if (inRange && level < exitThreshold) {
+        inRange = false;
+    }
+}
+
+bool RssiFilter::isConfident() const {
+    if (!valid || !inRange) return false;
+
+    // margin^2 >= (2 sigma)^2, compared in Q8 without a square root
+    int32_t margin = estimate - (int32_t)enterThreshold * Q8_ONE;
+    if (margin < (int32_t)(enterThreshold - exitThreshold) * Q8_ONE) return false;
+    return (margin / 32) * (margin / 32) >= variance;
+}
+
+int RssiFilter::getRssi() const {
+    // Round to nearest; estimate is normally negative
+    return estimate >= 0 ? (estimate + Q8_ONE / 2) / Q8_ONE : (estimate - Q8_ONE / 2) / Q8_ONE;
+}
+
+int RssiFilter::getStdDev() const {
+    return valid ? (int)(sqrtf(variance / (float)Q8_ONE) + 0.5f) : 0;
+}
+
+uint16_t RssiFilter::getDistanceCm(int txPowerAt1m, uint8_t pathLossExponentX10) const {
+    if (!valid || pathLossExponentX10 == 0) return 0;
+
+    float exponent = (txPowerAt1m - estimate / (float)Q8_ONE) / pathLossExponentX10;
+    float centimetres = 100.0f * powf(10.0f, exponent);
+    return centimetres >= 65535.0f ? 65535 : (uint16_t)centimetres;
+}
@@ -0,0 +1,59 @@
+/**
+ * RSSI filter for ConsultEase Faculty Desk Unit
+ * One-dimensional Kalman filter over the best RSSI of each scan window, in
+ * Q8 fixed point, with an in-range decision that has hysteresis and a
+ * log-distance path-loss estimate for reporting
+ */
+
+#ifndef RSSI_FILTER_H
+#define RSSI_FILTER_H
+
+#include <Arduino.h>
+
+// Filter tuning, in dB^2: how far a beacon's true level drifts between
+// windows, and how noisy a single window's best sample is
+#define RSSI_PROCESS_NOISE 2
+#define RSSI_MEASUREMENT_NOISE 16
+
+// Windows without a sighting before the estimate is dropped
+#define RSSI_MAX_MISSED_WINDOWS 4
+
+class RssiFilter {
+private:
+    int32_t estimate;       // dBm, Q8
+    int32_t variance;       // dB^2, Q8
+    int16_t enterThreshold;
+    int16_t exitThreshold;
+    uint8_t missedWindows;
+    bool valid;
+    bool inRange;
+
+    void updateRange();
+
+public:
+    // In range from enterThreshold upwards; out of range again only once the
+    // estimate falls hysteresis dB below it
+    RssiFilter(int enterThreshold, int hysteresis);
+
+    void reset();
+
+    // One call per scan window: the window's best sample, or a miss
+    void update(int rssi);
+    void miss();
+
+    bool isValid() const { return valid; }
+    bool isInRange() const { return inRange; }
+
+    // In range and at least two standard deviations (and the hysteresis
+    // band) above the threshold, so a single window will not flip it
+    bool isConfident() const;
+
+    int getRssi() const;
+    int getStdDev() const;
+
+    // Log-distance path loss: d = 10^((txPower - rssi) / (10 * n)), with
+    // txPower the RSSI at 1 m and n given times ten. 0 when not valid.
+    uint16_t getDistanceCm(int txPowerAt1m, uint8_t pathLossExponentX10) const;
+};
+
+#endif // RSSI_FILTER_H
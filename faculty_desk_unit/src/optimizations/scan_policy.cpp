@@ -0,0 +1,187 @@
+/**
+ * BLE scan scheduling policy implementation for ConsultEase Faculty Desk Unit
+ */
+
+#include "scan_policy.h"
+#include "json_stream.h"
+
+#define SCAN_MIN_INTERVAL_MS 500
+#define SCAN_MAX_INTERVAL_MS 600000
+#define SCAN_MAX_DURATION_S 10
+#define MINUTES_PER_DAY 1440
+
+namespace {
+
+const char* const PROFILE_NAMES[SCAN_POLICY_PROFILES] = { "day", "night" };
+
+const char* const PROFILE_START_KEYS[SCAN_POLICY_PROFILES] = { "day_start", "night_start" };
+
+// Each lookup switches on the hash, then confirms the key bytes, so an
+// unknown key that collides with a known one matches nothing
+int profileFromKey(const JsonToken& token) {
+    int profile;
+    switch (token.keyHash) {
+        case JsonStream::keyHash("day"): profile = 0; break;
+        case JsonStream::keyHash("night"): profile = 1; break;
+        default: return -1;
+    }
+    return JsonStream::keyEquals(token, PROFILE_NAMES[profile]) ? profile : -1;
+}
+
+int profileStartFromKey(const JsonToken& token) {
+    int profile;
+    switch (token.keyHash) {
+        case JsonStream::keyHash("day_start"): profile = 0; break;
+        case JsonStream::keyHash("night_start"): profile = 1; break;
+        default: return -1;
+    }
+    return JsonStream::keyEquals(token, PROFILE_START_KEYS[profile]) ? profile : -1;
+}
+
+int modeFromKey(const JsonToken& token) {
+    ScanPolicyMode mode;
+    switch (token.keyHash) {
+        case JsonStream::keyHash("searching"): mode = SCAN_MODE_SEARCHING; break;
+        case JsonStream::keyHash("monitoring"): mode = SCAN_MODE_MONITORING; break;
+        case JsonStream::keyHash("confident"): mode = SCAN_MODE_CONFIDENT; break;
+        case JsonStream::keyHash("verifying"): mode = SCAN_MODE_VERIFYING; break;
+        case JsonStream::keyHash("grace"): mode = SCAN_MODE_GRACE; break;
+        default: return -1;
+    }
+    return JsonStream::keyEquals(token, TableScanPolicy::getModeName(mode)) ? mode : -1;
+}
+
+// "HH:MM" or a plain minute count
+bool parseMinuteOfDay(const JsonToken& token, uint16_t& minute) {
+    long value;
+    if (token.type == JSON_VALUE_NUMBER) {
+        value = JsonStream::toLong(token.value, token.valueLength);
+    } else if (token.type == JSON_VALUE_STRING && token.valueLength == 5 && token.value[2] == ':') {
+        long hours = JsonStream::toLong(token.value, 2);
+        long minutes = JsonStream::toLong(token.value + 3, 2);
+        if (hours > 23 || minutes > 59) return false;
+        value = hours * 60 + minutes;
+    } else {
+        return false;
+    }
+
+    if (value < 0 || value >= MINUTES_PER_DAY) return false;
+    minute = value;
+    return true;
+}
+
+struct UpdateContext {
+    ScanPolicyTable* table;
+    int8_t container[JSON_STREAM_MAX_DEPTH + 1];   // Open object: profile at depth 1, mode at 2; -1 = other
+    bool failed;
+};
+
+// Containers are not reported when they close, but a member at depth d
+// always belongs to the object most recently opened at depth d - 1
+bool collectPolicyUpdate(const JsonToken& token, void* context) {
+    UpdateContext& update = *static_cast<UpdateContext*>(context);
+
+    if (token.type == JSON_VALUE_OBJECT) {
+        int index = -1;
+        if (token.depth == 1) index = profileFromKey(token);
+        else if (token.depth == 2) index = modeFromKey(token);
+        update.container[token.depth] = index;
+        return true;
+    }
+
+    if (token.depth == 1) {
+        int profile = profileStartFromKey(token);
+        if (profile >= 0 && !parseMinuteOfDay(token, update.table->profileStart[profile])) {
+            update.failed = true;
+            return false;
+        }
+        return true;
+    }
+
+    if (token.depth != 3 || token.type != JSON_VALUE_NUMBER) return true;
+
+    int profile = update.container[1];
+    int mode = update.container[2];
+    if (profile < 0 || mode < 0) return true;
+
+    long value = JsonStream::toLong(token.value, token.valueLength);
+    ScanParams& params = update.table->params[profile][mode];
+    switch (token.keyHash) {
+        case JsonStream::keyHash("interval_ms"):
+            if (!JsonStream::keyEquals(token, "interval_ms")) break;
+            params.intervalMs = value < 0 ? 0 : value;
+            break;
+        case JsonStream::keyHash("duration_s"):
+            if (!JsonStream::keyEquals(token, "duration_s")) break;
+            params.durationSeconds = (value < 0 || value > 255) ? 0 : value;
+            break;
+        default:
+            break;
+    }
+    return true;
+}
+
+} // namespace
+
+TableScanPolicy::TableScanPolicy(const ScanPolicyTable& initial) : table(initial) {
+}
+
+ScanParams TableScanPolicy::getParams(ScanPolicyMode mode, int minuteOfDay) const {
+    return table.params[getProfile(minuteOfDay)][mode];
+}
+
+// The profile whose start time came last, wrapping past midnight. Without a
+// clock the first (office hours) profile applies, favouring latency.
+uint8_t TableScanPolicy::getProfile(int minuteOfDay) const {
+    if (minuteOfDay == SCAN_POLICY_NO_TIME) return 0;
+
+    int best = -1;
+    int latest = 0;
+    for (int i = 0; i < SCAN_POLICY_PROFILES; i++) {
+        if (table.profileStart[i] <= minuteOfDay &&
+            (best < 0 || table.profileStart[i] > table.profileStart[best])) {
+            best = i;
+        }
+        if (table.profileStart[i] > table.profileStart[latest]) latest = i;
+    }
+    return best >= 0 ? best : latest;
+}
+
+const char* TableScanPolicy::getProfileName(uint8_t profile) const {
+    return profile < SCAN_POLICY_PROFILES ? PROFILE_NAMES[profile] : "?";
+}
+
+bool TableScanPolicy::validate(const ScanPolicyTable& candidate) {
+    for (int p = 0; p < SCAN_POLICY_PROFILES; p++) {
+        if (candidate.profileStart[p] >= MINUTES_PER_DAY) return false;
+        for (int m = 0; m < SCAN_MODE_COUNT; m++) {
+            const ScanParams& params = candidate.params[p][m];
+            if (params.intervalMs < SCAN_MIN_INTERVAL_MS || params.intervalMs > SCAN_MAX_INTERVAL_MS) return false;
+            if (params.durationSeconds < 1 || params.durationSeconds > SCAN_MAX_DURATION_S) return false;
+            if (params.durationSeconds * 1000UL > params.intervalMs) return false;
+        }
+    }
+    return true;
+}
+
+bool TableScanPolicy::parseUpdate(const char* json, size_t length, ScanPolicyTable& table) {
+    UpdateContext update;
+    update.table = &table;
+    update.failed = false;
+    for (int i = 0; i <= JSON_STREAM_MAX_DEPTH; i++) {
+        update.container[i] = -1;
+    }
+
+    return JsonStream::parse(json, length, collectPolicyUpdate, &update) && !update.failed;
+}
+
+const char* TableScanPolicy::getModeName(ScanPolicyMode mode) {
+    switch (mode) {
+        case SCAN_MODE_SEARCHING: return "searching";
+        case SCAN_MODE_MONITORING: return "monitoring";
+        case SCAN_MODE_CONFIDENT: return "confident";
+        case SCAN_MODE_VERIFYING: return "verifying";
+        case SCAN_MODE_GRACE: return "grace";
+        default: return "unknown";
+    }
+}
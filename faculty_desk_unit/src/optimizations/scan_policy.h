@@ -0,0 +1,74 @@
+/**
+ * BLE scan scheduling policy for ConsultEase Faculty Desk Unit
+ * Decides the interval and duration of each scan window from the scanner's
+ * mode and the time of day. The default policy is a table of profiles
+ * (office hours, night) that can be replaced over MQTT without reflashing.
+ */
+
+#ifndef SCAN_POLICY_H
+#define SCAN_POLICY_H
+
+#include <Arduino.h>
+
+// Scanner situations a policy has to cover
+enum ScanPolicyMode {
+    SCAN_MODE_SEARCHING,     // Faculty away, waiting for arrival
+    SCAN_MODE_MONITORING,    // Faculty present
+    SCAN_MODE_CONFIDENT,     // Present with a strong, steady signal
+    SCAN_MODE_VERIFYING,     // Confirming a state change
+    SCAN_MODE_GRACE,         // Beacon lost, grace period running
+    SCAN_MODE_COUNT
+};
+
+#define SCAN_POLICY_PROFILES 2       // Day and night
+#define SCAN_POLICY_NO_TIME -1       // Minute of day while the clock is not set
+
+struct ScanParams {
+    uint32_t intervalMs;
+    uint8_t durationSeconds;
+};
+
+struct ScanPolicyTable {
+    ScanParams params[SCAN_POLICY_PROFILES][SCAN_MODE_COUNT];
+    uint16_t profileStart[SCAN_POLICY_PROFILES];   // Minute of day each profile takes over
+};
+
+class ScanPolicy {
+public:
+    virtual ~ScanPolicy() {}
+
+    // minuteOfDay is 0..1439, or SCAN_POLICY_NO_TIME
+    virtual ScanParams getParams(ScanPolicyMode mode, int minuteOfDay) const = 0;
+
+    // Profiles let the scanner account radio time per schedule slot
+    virtual uint8_t getProfile(int minuteOfDay) const = 0;
+    virtual uint8_t getProfileCount() const = 0;
+    virtual const char* getProfileName(uint8_t profile) const = 0;
+};
+
+class TableScanPolicy : public ScanPolicy {
+private:
+    ScanPolicyTable table;
+
+public:
+    explicit TableScanPolicy(const ScanPolicyTable& initial);
+
+    ScanParams getParams(ScanPolicyMode mode, int minuteOfDay) const override;
+    uint8_t getProfile(int minuteOfDay) const override;
+    uint8_t getProfileCount() const override { return SCAN_POLICY_PROFILES; }
+    const char* getProfileName(uint8_t profile) const override;
+
+    const ScanPolicyTable& getTable() const { return table; }
+    void setTable(const ScanPolicyTable& next) { table = next; }
+
+    // Every window must fit inside its interval, within sane bounds
+    static bool validate(const ScanPolicyTable& candidate);
+
+    // Overlays a JSON update onto table; members not mentioned keep their value:
+    // {"day":{"searching":{"interval_ms":2000,"duration_s":3}},"night_start":"19:00"}
+    static bool parseUpdate(const char* json, size_t length, ScanPolicyTable& table);
+
+    static const char* getModeName(ScanPolicyMode mode);
+};
+
+#endif // SCAN_POLICY_H
@@ -5,16 +5,23 @@
 #include "security_enhancements.h"
 #include <Preferences.h>
 #include <esp_random.h>
+#include <esp_mac.h>
 #include <mbedtls/md.h>
 
 // Static member definitions
 uint8_t EncryptionManager::deviceKey[MAX_KEY_LENGTH];
 uint8_t EncryptionManager::sessionKey[MAX_KEY_LENGTH];
 bool EncryptionManager::keyInitialized = false;
-mbedtls_aes_context EncryptionManager::aesContext;
-
-uint8_t MessageAuthenticator::hmacKey[MAX_KEY_LENGTH];
+bool EncryptionManager::cipherReady = false;
+mbedtls_gcm_context EncryptionManager::gcmContext;
+uint8_t EncryptionManager::nonceSalt[GCM_NONCE_SALT_LENGTH];
+uint64_t EncryptionManager::nonceCounter = 0;
+CryptoStats EncryptionManager::stats;
+
+mbedtls_md_context_t MessageAuthenticator::hmacContext;
+bool MessageAuthenticator::contextReady = false;
 bool MessageAuthenticator::keySet = false;
+CryptoStats MessageAuthenticator::stats;
 
 char DeviceAuthenticator::deviceId[64];
 char DeviceAuthenticator::authToken[MAX_TOKEN_LENGTH];
@@ -29,10 +36,53 @@ int SecurityMonitor::failedAuthAttempts = 0;
 int SecurityMonitor::suspiciousActivities = 0;
 bool SecurityMonitor::securityBreach = false;
 
+namespace {
+
+int hexValue(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+bool decodeHex(const char* hex, uint8_t* out, size_t length) {
+    for (size_t i = 0; i < length; i++) {
+        int high = hexValue(hex[i * 2]);
+        int low = hexValue(hex[i * 2 + 1]);
+        if (high < 0 || low < 0) return false;
+        out[i] = (high << 4) | low;
+    }
+    return true;
+}
+
+// Walks backwards so out may be the same buffer as data
+void encodeHex(const uint8_t* data, size_t length, char* out) {
+    static const char digits[] = "0123456789abcdef";
+    out[length * 2] = '\0';
+    for (size_t i = length; i-- > 0;) {
+        uint8_t value = data[i];
+        out[i * 2 + 1] = digits[value & 0x0F];
+        out[i * 2] = digits[value >> 4];
+    }
+}
+
+void recordCrypto(CryptoStats& stats, uint32_t startUs, bool ok) {
+    uint32_t elapsed = micros() - startUs;
+    stats.operations++;
+    if (!ok) stats.failures++;
+    stats.totalUs += elapsed;
+    if (elapsed > stats.maxUs) stats.maxUs = elapsed;
+}
+
+} // namespace
+
 // Encryption Manager Implementation
 void EncryptionManager::init() {
-    mbedtls_aes_init(&aesContext);
+    if (cipherReady) mbedtls_gcm_free(&gcmContext);
+    mbedtls_gcm_init(&gcmContext);
+    cipherReady = false;
     keyInitialized = false;
+    memset(&stats, 0, sizeof(stats));
     
     // Generate device-specific key if not exists
     Preferences prefs;
@@ -57,9 +107,7 @@ void EncryptionManager::init() {
 }
 
 void EncryptionManager::generateRandomBytes(uint8_t* buffer, size_t length) {
-    for (size_t i = 0; i < length; i++) {
-        buffer[i] = esp_random() & 0xFF;
-    }
+    esp_fill_random(buffer, length);
 }
 
 bool EncryptionManager::setDeviceKey(const char* password) {
@@ -84,84 +132,151 @@ bool EncryptionManager::setDeviceKey(const char* password) {
     return true;
 }
 
+// The only place the AES key schedule is computed
+bool EncryptionManager::installKey(const uint8_t* key) {
+    cipherReady = mbedtls_gcm_setkey(&gcmContext, MBEDTLS_CIPHER_ID_AES, key, MAX_KEY_LENGTH * 8) == 0;
+    generateRandomBytes(nonceSalt, GCM_NONCE_SALT_LENGTH);
+    nonceCounter = 0;
+    return cipherReady;
+}
+
 bool EncryptionManager::generateSessionKey() {
     generateRandomBytes(sessionKey, MAX_KEY_LENGTH);
     Serial.println("Generated new session key");
-    return true;
+    return installKey(sessionKey);
 }
 
-bool EncryptionManager::encryptData(const uint8_t* plaintext, size_t plaintextLen,
-                                   uint8_t* ciphertext, size_t* ciphertextLen,
-                                   const uint8_t* key) {
-    if (!keyInitialized || !plaintext || !ciphertext || !ciphertextLen) {
+bool EncryptionManager::setSessionKey(const uint8_t* key, size_t keyLength) {
+    if (!key || keyLength != MAX_KEY_LENGTH) return false;
+    memcpy(sessionKey, key, MAX_KEY_LENGTH);
+    return installKey(sessionKey);
+}
+
+void EncryptionManager::nextNonce(uint8_t* iv) {
+    memcpy(iv, nonceSalt, GCM_NONCE_SALT_LENGTH);
+    uint64_t counter = nonceCounter++;
+    for (int i = GCM_IV_LENGTH - 1; i >= GCM_NONCE_SALT_LENGTH; i--) {
+        iv[i] = counter & 0xFF;
+        counter >>= 8;
+    }
+}
+
+void EncryptionManager::record(uint32_t startUs, bool ok) {
+    recordCrypto(stats, startUs, ok);
+}
+
+bool EncryptionManager::encryptInPlace(uint8_t* data, size_t length, const uint8_t* aad, size_t aadLength,
+                                      uint8_t* iv, uint8_t* tag) {
+    uint32_t start = micros();
+    if (!cipherReady || (!data && length) || !iv || !tag) {
+        record(start, false);
         return false;
     }
     
-    const uint8_t* useKey = key ? key : sessionKey;
+    nextNonce(iv);
+    bool ok = mbedtls_gcm_crypt_and_tag(&gcmContext, MBEDTLS_GCM_ENCRYPT, length, iv, GCM_IV_LENGTH,
+                                        aad, aadLength, data, data, GCM_TAG_LENGTH, tag) == 0;
+    record(start, ok);
+    return ok;
+}
+
+bool EncryptionManager::decryptInPlace(uint8_t* data, size_t length, const uint8_t* aad, size_t aadLength,
+                                      const uint8_t* iv, const uint8_t* tag) {
+    uint32_t start = micros();
+    if (!cipherReady || (!data && length) || !iv || !tag) {
+        record(start, false);
+        return false;
+    }
+    
+    bool ok = mbedtls_gcm_auth_decrypt(&gcmContext, length, iv, GCM_IV_LENGTH, aad, aadLength,
+                                       tag, GCM_TAG_LENGTH, data, data) == 0;
+    record(start, ok);
+    return ok;
+}
+
+bool EncryptionManager::encryptData(const uint8_t* plaintext, size_t plaintextLen,
+                                   uint8_t* ciphertext, size_t* ciphertextLen) {
+    if (!plaintext || !ciphertext || !ciphertextLen || *ciphertextLen < plaintextLen + ENCRYPTION_OVERHEAD) {
+        return false;
+    }
     
-    // Simple XOR encryption for demonstration (use AES in production)
-    for (size_t i = 0; i < plaintextLen; i++) {
-        ciphertext[i] = plaintext[i] ^ useKey[i % MAX_KEY_LENGTH];
+    uint8_t* body = ciphertext + GCM_IV_LENGTH;
+    memmove(body, plaintext, plaintextLen);
+    if (!encryptInPlace(body, plaintextLen, nullptr, 0, ciphertext, body + plaintextLen)) {
+        return false;
     }
     
-    *ciphertextLen = plaintextLen;
+    *ciphertextLen = plaintextLen + ENCRYPTION_OVERHEAD;
     return true;
 }
 
 bool EncryptionManager::decryptData(const uint8_t* ciphertext, size_t ciphertextLen,
-                                   uint8_t* plaintext, size_t* plaintextLen,
-                                   const uint8_t* key) {
-    // XOR decryption is the same as encryption
-    return encryptData(ciphertext, ciphertextLen, plaintext, plaintextLen, key);
+                                   uint8_t* plaintext, size_t* plaintextLen) {
+    if (!ciphertext || !plaintext || !plaintextLen || ciphertextLen < ENCRYPTION_OVERHEAD) {
+        return false;
+    }
+    
+    size_t bodyLen = ciphertextLen - ENCRYPTION_OVERHEAD;
+    if (*plaintextLen < bodyLen) return false;
+    
+    // Moving the body may overwrite the nonce or tag when the buffers overlap
+    uint8_t iv[GCM_IV_LENGTH];
+    uint8_t tag[GCM_TAG_LENGTH];
+    memcpy(iv, ciphertext, GCM_IV_LENGTH);
+    memcpy(tag, ciphertext + GCM_IV_LENGTH + bodyLen, GCM_TAG_LENGTH);
+    memmove(plaintext, ciphertext + GCM_IV_LENGTH, bodyLen);
+    
+    if (!decryptInPlace(plaintext, bodyLen, nullptr, 0, iv, tag)) {
+        return false;
+    }
+    
+    *plaintextLen = bodyLen;
+    return true;
 }
 
+// Seals into the front of the output, then widens it to hex in place
 bool EncryptionManager::encryptString(const char* plaintext, char* ciphertext, size_t ciphertextSize) {
     if (!plaintext || !ciphertext) return false;
     
     size_t plaintextLen = strlen(plaintext);
-    uint8_t* tempCipher = (uint8_t*)malloc(plaintextLen);
-    if (!tempCipher) return false;
-    
-    size_t cipherLen;
-    bool result = encryptData((const uint8_t*)plaintext, plaintextLen, tempCipher, &cipherLen);
+    size_t sealedLen = ciphertextSize;
+    if (ciphertextSize < (plaintextLen + ENCRYPTION_OVERHEAD) * 2 + 1) return false;
     
-    if (result && cipherLen * 2 + 1 < ciphertextSize) {
-        // Convert to hex string
-        for (size_t i = 0; i < cipherLen; i++) {
-            sprintf(ciphertext + i * 2, "%02x", tempCipher[i]);
-        }
-        ciphertext[cipherLen * 2] = '\0';
-    } else {
-        result = false;
+    uint8_t* sealed = (uint8_t*)ciphertext;
+    if (!encryptData((const uint8_t*)plaintext, plaintextLen, sealed, &sealedLen)) {
+        return false;
     }
     
-    free(tempCipher);
-    return result;
+    encodeHex(sealed, sealedLen, ciphertext);
+    return true;
 }
 
+// Decodes the body straight into the output and decrypts it there
 bool EncryptionManager::decryptString(const char* ciphertext, char* plaintext, size_t plaintextSize) {
     if (!ciphertext || !plaintext) return false;
     
-    size_t cipherLen = strlen(ciphertext) / 2;
-    uint8_t* tempCipher = (uint8_t*)malloc(cipherLen);
-    if (!tempCipher) return false;
+    size_t hexLen = strlen(ciphertext);
+    if (hexLen % 2 != 0 || hexLen / 2 < ENCRYPTION_OVERHEAD) return false;
     
-    // Convert from hex string
-    for (size_t i = 0; i < cipherLen; i++) {
-        sscanf(ciphertext + i * 2, "%2hhx", &tempCipher[i]);
-    }
+    size_t bodyLen = hexLen / 2 - ENCRYPTION_OVERHEAD;
+    if (bodyLen >= plaintextSize) return false;
     
-    size_t plainLen;
-    bool result = decryptData(tempCipher, cipherLen, (uint8_t*)plaintext, &plainLen);
+    uint8_t iv[GCM_IV_LENGTH];
+    uint8_t tag[GCM_TAG_LENGTH];
+    const char* bodyHex = ciphertext + GCM_IV_LENGTH * 2;
+    if (!decodeHex(ciphertext, iv, GCM_IV_LENGTH) ||
+        !decodeHex(bodyHex, (uint8_t*)plaintext, bodyLen) ||
+        !decodeHex(bodyHex + bodyLen * 2, tag, GCM_TAG_LENGTH)) {
+        return false;
+    }
     
-    if (result && plainLen < plaintextSize) {
-        plaintext[plainLen] = '\0';
-    } else {
-        result = false;
+    if (!decryptInPlace((uint8_t*)plaintext, bodyLen, nullptr, 0, iv, tag)) {
+        plaintext[0] = '\0';
+        return false;
     }
     
-    free(tempCipher);
-    return result;
+    plaintext[bodyLen] = '\0';
+    return true;
 }
 
 void EncryptionManager::rotateSessionKey() {
@@ -170,51 +285,55 @@ void EncryptionManager::rotateSessionKey() {
 }
 
 void EncryptionManager::clearKeys() {
-    memset(deviceKey, 0, MAX_KEY_LENGTH);
-    memset(sessionKey, 0, MAX_KEY_LENGTH);
+    SecurityUtils::secureMemset(deviceKey, 0, MAX_KEY_LENGTH);
+    SecurityUtils::secureMemset(sessionKey, 0, MAX_KEY_LENGTH);
+    // Freeing the context also wipes the expanded key
+    mbedtls_gcm_free(&gcmContext);
+    mbedtls_gcm_init(&gcmContext);
     keyInitialized = false;
+    cipherReady = false;
     Serial.println("Encryption keys cleared");
 }
 
 // Message Authenticator Implementation
 void MessageAuthenticator::init() {
     keySet = false;
-    memset(hmacKey, 0, MAX_KEY_LENGTH);
+    memset(&stats, 0, sizeof(stats));
+    if (contextReady) return;
+    
+    // The context's one allocation happens here, not per message
+    mbedtls_md_init(&hmacContext);
+    const mbedtls_md_info_t* info = mbedtls_md_info_from_type(MBEDTLS_MD_SHA256);
+    if (mbedtls_md_setup(&hmacContext, info, 1) != 0) {
+        mbedtls_md_free(&hmacContext);
+        Serial.println("HMAC context setup failed");
+        return;
+    }
+    contextReady = true;
 }
 
 bool MessageAuthenticator::setKey(const uint8_t* key, size_t keyLength) {
-    if (!key || keyLength == 0) return false;
+    if (!contextReady || !key || keyLength == 0) return false;
     
-    size_t copyLen = keyLength < MAX_KEY_LENGTH ? keyLength : MAX_KEY_LENGTH;
-    memcpy(hmacKey, key, copyLen);
-    keySet = true;
+    keySet = mbedtls_md_hmac_starts(&hmacContext, key, keyLength) == 0;
     
-    Serial.println("HMAC key set");
-    return true;
+    Serial.println(keySet ? "HMAC key set" : "HMAC key rejected");
+    return keySet;
 }
 
 bool MessageAuthenticator::generateHMAC(const uint8_t* data, size_t dataLength, 
                                        uint8_t* hmac, size_t hmacSize) {
-    if (!keySet || !data || !hmac || hmacSize < MAX_HASH_LENGTH) {
+    uint32_t start = micros();
+    if (!keySet || (!data && dataLength) || !hmac || hmacSize < MAX_HASH_LENGTH) {
+        recordCrypto(stats, start, false);
         return false;
     }
     
-    // Simple hash-based MAC (use proper HMAC in production)
-    mbedtls_md_context_t ctx;
-    mbedtls_md_init(&ctx);
-    
-    const mbedtls_md_info_t* info = mbedtls_md_info_from_type(MBEDTLS_MD_SHA256);
-    if (mbedtls_md_setup(&ctx, info, 1) != 0) {
-        mbedtls_md_free(&ctx);
-        return false;
-    }
-    
-    mbedtls_md_hmac_starts(&ctx, hmacKey, MAX_KEY_LENGTH);
-    mbedtls_md_hmac_update(&ctx, data, dataLength);
-    mbedtls_md_hmac_finish(&ctx, hmac);
-    mbedtls_md_free(&ctx);
-    
-    return true;
+    bool ok = mbedtls_md_hmac_reset(&hmacContext) == 0 &&
+              mbedtls_md_hmac_update(&hmacContext, data, dataLength) == 0 &&
+              mbedtls_md_hmac_finish(&hmacContext, hmac) == 0;
+    recordCrypto(stats, start, ok);
+    return ok;
 }
 
 bool MessageAuthenticator::verifyHMAC(const uint8_t* data, size_t dataLength,
@@ -245,27 +364,102 @@ bool MessageAuthenticator::signMessage(const char* message, char* signature, siz
         return false;
     }
     
-    // Convert to hex string
-    for (int i = 0; i < SIGNATURE_LENGTH; i++) {
-        sprintf(signature + i * 2, "%02x", hmac[i]);
-    }
-    signature[SIGNATURE_LENGTH * 2] = '\0';
-    
+    encodeHex(hmac, SIGNATURE_LENGTH, signature);
     return true;
 }
 
 bool MessageAuthenticator::verifyMessage(const char* message, const char* signature) {
-    if (!message || !signature) return false;
+    if (!message || !signature || strlen(signature) != SIGNATURE_LENGTH * 2) return false;
     
-    // Convert signature from hex
     uint8_t expectedHmac[SIGNATURE_LENGTH];
-    for (int i = 0; i < SIGNATURE_LENGTH; i++) {
-        sscanf(signature + i * 2, "%2hhx", &expectedHmac[i]);
-    }
+    if (!decodeHex(signature, expectedHmac, SIGNATURE_LENGTH)) return false;
     
     return verifyHMAC((const uint8_t*)message, strlen(message), expectedHmac, SIGNATURE_LENGTH);
 }
 
+// Secure MQTT Client Implementation
+SecureMQTTClient::SecureMQTTClient()
+    : mqttClient(tlsClient), tlsEnabled(true), securityLevel(SECURITY_ENHANCED),
+      clientId(nullptr), username(nullptr), password(nullptr) {
+    sealed[0] = '\0';
+}
+
+void SecureMQTTClient::setSecurityLevel(SecurityLevel level) {
+    securityLevel = level;
+}
+
+bool SecureMQTTClient::setCertificates(const char* cert, const char* key, const char* ca) {
+    return tlsClient.setCertificates(ca, cert, key);
+}
+
+void SecureMQTTClient::enableTLS(bool enable) {
+    if (enable == tlsEnabled) return;
+    mqttClient.disconnect();
+    tlsEnabled = enable;
+    if (enable) {
+        mqttClient.setClient(tlsClient);
+    } else {
+        mqttClient.setClient(plainClient);
+    }
+}
+
+bool SecureMQTTClient::connect(const char* server, int port, const char* clientId,
+                               const char* username, const char* password) {
+    if (!server || !clientId) return false;
+    
+    this->clientId = clientId;
+    this->username = username;
+    this->password = password;
+    mqttClient.setServer(server, port);
+    return reconnect();
+}
+
+// The transport keeps its TLS session across disconnects, so this is an
+// abbreviated handshake whenever the broker still holds the session
+bool SecureMQTTClient::reconnect() {
+    if (mqttClient.connected()) return true;
+    if (!clientId) return false;
+    
+    bool connected = mqttClient.connect(clientId, username, password);
+    if (!connected) SecurityMonitor::logSecurityEvent("MQTT connection failed");
+    return connected;
+}
+
+void SecureMQTTClient::disconnect() {
+    mqttClient.disconnect();
+}
+
+bool SecureMQTTClient::isConnected() {
+    return mqttClient.connected();
+}
+
+// Encrypted payloads go out as hex of nonce | ciphertext | tag
+bool SecureMQTTClient::publishSecure(const char* topic, const char* payload, bool encrypt) {
+    if (!SecurityUtils::validateMQTTTopic(topic) ||
+        !SecurityUtils::validateMQTTPayload(payload, SECURE_MQTT_PAYLOAD_MAX)) {
+        return false;
+    }
+    
+    if (encrypt && securityLevel >= SECURITY_ENHANCED) {
+        if (!EncryptionManager::encryptString(payload, sealed, sizeof(sealed))) return false;
+        return mqttClient.publish(topic, sealed);
+    }
+    return mqttClient.publish(topic, payload);
+}
+
+bool SecureMQTTClient::subscribeSecure(const char* topic) {
+    if (!SecurityUtils::validateMQTTTopic(topic)) return false;
+    return mqttClient.subscribe(topic, 1);
+}
+
+void SecureMQTTClient::setSecureCallback(void (*callback)(char*, uint8_t*, unsigned int)) {
+    mqttClient.setCallback(callback);
+}
+
+void SecureMQTTClient::loop() {
+    mqttClient.loop();
+}
+
 // Device Authenticator Implementation
 void DeviceAuthenticator::init() {
     authenticated = false;
@@ -505,7 +699,7 @@ void printSecurityStatus() {
     Serial.printf("Device ID: %s\n", DeviceAuthenticator::getDeviceId());
     Serial.printf("Token Time Remaining: %lu ms\n", DeviceAuthenticator::getTokenTimeRemaining());
     Serial.printf("Security Breach: %s\n", SecurityMonitor::isSecurityBreached() ? "Yes" : "No");
-    Serial.printf("Failed Auth Attempts: %d\n", SecurityMonitor::failedAuthAttempts);
-    Serial.printf("Suspicious Activities: %d\n", SecurityMonitor::suspiciousActivities);
+    Serial.printf("Failed Auth Attempts: %d\n", SecurityMonitor::getFailedAuthAttempts());
+    Serial.printf("Suspicious Activities: %d\n", SecurityMonitor::getSuspiciousActivities());
     Serial.println("======================");
 }
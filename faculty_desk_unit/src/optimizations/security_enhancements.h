@@ -7,11 +7,12 @@
 #define SECURITY_ENHANCEMENTS_H
 
 #include <Arduino.h>
-#include <WiFiClientSecure.h>
+#include <WiFi.h>
 #include <PubSubClient.h>
-#include <mbedtls/aes.h>
-#include <mbedtls/sha256.h>
+#include <mbedtls/gcm.h>
+#include <mbedtls/md.h>
 #include <esp_random.h>
+#include "tls_session.h"
 
 // Security configuration
 #define MAX_KEY_LENGTH 32
@@ -21,6 +22,15 @@
 #define NONCE_LENGTH 16
 #define SIGNATURE_LENGTH 32
 
+// AES-256-GCM: 96-bit nonce, full 128-bit tag
+#define GCM_IV_LENGTH 12
+#define GCM_TAG_LENGTH 16
+#define GCM_NONCE_SALT_LENGTH 4
+// encryptData() output is nonce | ciphertext | tag
+#define ENCRYPTION_OVERHEAD (GCM_IV_LENGTH + GCM_TAG_LENGTH)
+
+#define SECURE_MQTT_PAYLOAD_MAX 512
+
 // Security levels
 enum SecurityLevel {
     SECURITY_NONE,
@@ -29,31 +39,62 @@ enum SecurityLevel {
     SECURITY_MAXIMUM
 };
 
+struct CryptoStats {
+    uint32_t operations;
+    uint32_t failures;        // Bad arguments, buffer too small, or authentication failed
+    uint32_t totalUs;
+    uint32_t maxUs;
+};
+
 // Encryption utilities
+// AES-256-GCM under the session key. The key schedule and GHASH tables are
+// computed once per key, so a message costs only the cipher pass itself,
+// which mbedTLS hands to the AES peripheral. Nothing is allocated per call.
+// The context is shared: use it from one task only (the network task).
 class EncryptionManager {
 private:
     static uint8_t deviceKey[MAX_KEY_LENGTH];
     static uint8_t sessionKey[MAX_KEY_LENGTH];
     static bool keyInitialized;
-    static mbedtls_aes_context aesContext;
+    static bool cipherReady;
+    static mbedtls_gcm_context gcmContext;
+    // Nonce = random salt picked per key | 64-bit counter, so it never repeats under one key
+    static uint8_t nonceSalt[GCM_NONCE_SALT_LENGTH];
+    static uint64_t nonceCounter;
+    static CryptoStats stats;
     
     static void generateRandomBytes(uint8_t* buffer, size_t length);
     static bool deriveKey(const char* password, const uint8_t* salt, uint8_t* key);
+    static bool installKey(const uint8_t* key);
+    static void nextNonce(uint8_t* iv);
+    static void record(uint32_t startUs, bool ok);
     
 public:
     static void init();
     static bool setDeviceKey(const char* password);
     static bool generateSessionKey();
+    // A key agreed with the central system; replaces the random session key
+    static bool setSessionKey(const uint8_t* key, size_t keyLength);
     
-    // AES encryption/decryption
+    // In place: data is overwritten with the ciphertext (or plaintext). aad
+    // is authenticated but sent in the clear; pass nullptr/0 when unused.
+    // iv receives GCM_IV_LENGTH bytes and tag GCM_TAG_LENGTH bytes; both
+    // travel with the message. decryptInPlace() zeroes data when the tag
+    // does not match.
+    static bool encryptInPlace(uint8_t* data, size_t length, const uint8_t* aad, size_t aadLength,
+                               uint8_t* iv, uint8_t* tag);
+    static bool decryptInPlace(uint8_t* data, size_t length, const uint8_t* aad, size_t aadLength,
+                               const uint8_t* iv, const uint8_t* tag);
+    
+    // Sealed buffers: nonce | ciphertext | tag. The length pointers hold the
+    // output capacity on entry and the bytes written on return. Input and
+    // output may overlap.
     static bool encryptData(const uint8_t* plaintext, size_t plaintextLen,
-                           uint8_t* ciphertext, size_t* ciphertextLen,
-                           const uint8_t* key = nullptr);
+                           uint8_t* ciphertext, size_t* ciphertextLen);
     static bool decryptData(const uint8_t* ciphertext, size_t ciphertextLen,
-                           uint8_t* plaintext, size_t* plaintextLen,
-                           const uint8_t* key = nullptr);
+                           uint8_t* plaintext, size_t* plaintextLen);
     
-    // String encryption helpers
+    // String encryption helpers (hex of the sealed buffer)
     static bool encryptString(const char* plaintext, char* ciphertext, size_t ciphertextSize);
     static bool decryptString(const char* ciphertext, char* plaintext, size_t plaintextSize);
     
@@ -61,13 +102,20 @@ public:
     static void rotateSessionKey();
     static bool exportPublicKey(char* publicKey, size_t keySize);
     static void clearKeys();
+    
+    static const CryptoStats& getStats() { return stats; }
 };
 
 // Message authentication
+// HMAC-SHA256 on one context set up in init(). setKey() precomputes the
+// padded key blocks; each message only resets the context, and the SHA
+// rounds run on the SHA peripheral. Same single-task rule as above.
 class MessageAuthenticator {
 private:
-    static uint8_t hmacKey[MAX_KEY_LENGTH];
+    static mbedtls_md_context_t hmacContext;
+    static bool contextReady;
     static bool keySet;
+    static CryptoStats stats;
     
 public:
     static void init();
@@ -78,29 +126,34 @@ public:
                           const uint8_t* expectedHmac, size_t hmacLength);
     static bool signMessage(const char* message, char* signature, size_t signatureSize);
     static bool verifyMessage(const char* message, const char* signature);
+    
+    static const CryptoStats& getStats() { return stats; }
 };
 
 // Secure MQTT client
+// TLS runs over TLSSessionClient: certificates are referenced in flash, not
+// copied, and reconnect() resumes the previous TLS session when it can.
 class SecureMQTTClient {
 private:
-    WiFiClientSecure wifiClient;
+    TLSSessionClient tlsClient;
+    WiFiClient plainClient;
     PubSubClient mqttClient;
-    char clientCertificate[2048];
-    char clientPrivateKey[2048];
-    char caCertificate[2048];
     bool tlsEnabled;
     SecurityLevel securityLevel;
-    
-    bool loadCertificates();
-    bool validateServerCertificate();
-    bool performMutualAuthentication();
+    // Kept from connect() for reconnect()
+    const char* clientId;
+    const char* username;
+    const char* password;
+    char sealed[(SECURE_MQTT_PAYLOAD_MAX + ENCRYPTION_OVERHEAD) * 2 + 1];
     
 public:
     SecureMQTTClient();
     
     // Configuration
     void setSecurityLevel(SecurityLevel level);
+    // PEM strings that outlive the client; cert and key may be null without mutual TLS
     bool setCertificates(const char* cert, const char* key, const char* ca);
+    void setServerName(const char* name) { tlsClient.setServerName(name); }
     void enableTLS(bool enable);
     
     // Connection management
@@ -117,6 +170,7 @@ public:
     // Maintenance
     void loop();
     bool reconnect();
+    const TLSSessionStats& getTLSStats() const { return tlsClient.getStats(); }
 };
 
 // Device authentication
@@ -176,6 +230,8 @@ public:
     static void recordSuspiciousActivity(const char* description);
     static void checkSecurityStatus();
     static bool isSecurityBreached();
+    static int getFailedAuthAttempts() { return failedAuthAttempts; }
+    static int getSuspiciousActivities() { return suspiciousActivities; }
     static void resetSecurityCounters();
     static void enableSecurityMode();
     static void disableSecurityMode();
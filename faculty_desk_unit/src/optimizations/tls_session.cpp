@@ -0,0 +1,386 @@
+/**
+ * Resumable TLS transport implementation for ConsultEase Faculty Desk Unit
+ */
+
+#include "tls_session.h"
+#include <mbedtls/net_sockets.h>
+#include <mbedtls/version.h>
+#include <esp_random.h>
+
+namespace {
+
+// The hardware RNG is a true RNG while the radio is on, which it is for TLS
+int randomBytes(void*, unsigned char* output, size_t length) {
+    esp_fill_random(output, length);
+    return 0;
+}
+
+bool wouldBlock(int ret) {
+    return ret == MBEDTLS_ERR_SSL_WANT_READ || ret == MBEDTLS_ERR_SSL_WANT_WRITE;
+}
+
+#if MBEDTLS_VERSION_NUMBER >= 0x03020000
+bool handshakeOver(mbedtls_ssl_context* ssl) {
+    return mbedtls_ssl_is_handshake_over(ssl);
+}
+#else
+// mbedTLS 2.x (Arduino core 2) has no accessor; state is still public there
+bool handshakeOver(mbedtls_ssl_context* ssl) {
+    return ssl->state == MBEDTLS_SSL_HANDSHAKE_OVER;
+}
+#endif
+
+} // namespace
+
+TLSSessionClient::TLSSessionClient()
+    : caCert(nullptr), clientCert(nullptr), clientKeyPem(nullptr), serverName(nullptr),
+      configured(false), open(false), handshaking(false), peeked(-1), port(0), connectTimeoutMs(0),
+      handshakeStart(0), offered(false), certificateSeen(false), reconnectPending(false),
+      sessionValid(false), sessionSavedAt(0), sessionPort(0) {
+    mbedtls_ssl_init(&ssl);
+    mbedtls_ssl_config_init(&sslConfig);
+    mbedtls_x509_crt_init(&caChain);
+    mbedtls_x509_crt_init(&clientChain);
+    mbedtls_pk_init(&clientKey);
+    mbedtls_ssl_session_init(&session);
+    host[0] = '\0';
+    verifyName[0] = '\0';
+    sessionHost[0] = '\0';
+    sessionName[0] = '\0';
+    memset(&stats, 0, sizeof(stats));
+}
+
+TLSSessionClient::~TLSSessionClient() {
+    stop();
+    release();
+    mbedtls_ssl_session_free(&session);
+}
+
+bool TLSSessionClient::setCertificates(const char* ca, const char* cert, const char* key) {
+    stop();
+    release();
+    forgetSession();
+    caCert = ca;
+    clientCert = cert;
+    clientKeyPem = key;
+    return ca && *ca;
+}
+
+void TLSSessionClient::setServerName(const char* name) {
+    serverName = name;
+    forgetSession();
+}
+
+// Everything here survives stop(); it is redone only when the certificates change
+bool TLSSessionClient::configure() {
+    if (configured) return true;
+    if (!caCert || !*caCert) {
+        Serial.println("TLS: no CA certificate set");
+        return false;
+    }
+
+    int ret = mbedtls_ssl_config_defaults(&sslConfig, MBEDTLS_SSL_IS_CLIENT,
+                                          MBEDTLS_SSL_TRANSPORT_STREAM, MBEDTLS_SSL_PRESET_DEFAULT);
+    // PEM parsing wants the terminating NUL counted
+    if (ret == 0) ret = mbedtls_x509_crt_parse(&caChain, (const unsigned char*)caCert, strlen(caCert) + 1);
+    if (ret == 0 && clientCert && *clientCert && clientKeyPem && *clientKeyPem) {
+        ret = mbedtls_x509_crt_parse(&clientChain, (const unsigned char*)clientCert, strlen(clientCert) + 1);
+        if (ret == 0) {
+            ret = mbedtls_pk_parse_key(&clientKey, (const unsigned char*)clientKeyPem, strlen(clientKeyPem) + 1,
+                                       nullptr, 0);
+        }
+        if (ret == 0) ret = mbedtls_ssl_conf_own_cert(&sslConfig, &clientChain, &clientKey);
+    }
+    if (ret != 0) {
+        Serial.printf("TLS: certificate setup failed (-0x%04x)\n", (unsigned)-ret);
+        release();
+        return false;
+    }
+
+    mbedtls_ssl_conf_ca_chain(&sslConfig, &caChain, nullptr);
+    mbedtls_ssl_conf_authmode(&sslConfig, MBEDTLS_SSL_VERIFY_REQUIRED);
+    mbedtls_ssl_conf_verify(&sslConfig, verifyCallback, this);
+    mbedtls_ssl_conf_rng(&sslConfig, randomBytes, nullptr);
+    mbedtls_ssl_conf_session_tickets(&sslConfig, MBEDTLS_SSL_SESSION_TICKETS_ENABLED);
+
+    // Allocates the record buffers, once
+    ret = mbedtls_ssl_setup(&ssl, &sslConfig);
+    if (ret != 0) {
+        Serial.printf("TLS: context setup failed (-0x%04x)\n", (unsigned)-ret);
+        release();
+        return false;
+    }
+    mbedtls_ssl_set_bio(&ssl, this, sendCallback, recvCallback, nullptr);
+
+    configured = true;
+    return true;
+}
+
+void TLSSessionClient::release() {
+    mbedtls_ssl_free(&ssl);
+    mbedtls_ssl_config_free(&sslConfig);
+    mbedtls_x509_crt_free(&caChain);
+    mbedtls_x509_crt_free(&clientChain);
+    mbedtls_pk_free(&clientKey);
+
+    mbedtls_ssl_init(&ssl);
+    mbedtls_ssl_config_init(&sslConfig);
+    mbedtls_x509_crt_init(&caChain);
+    mbedtls_x509_crt_init(&clientChain);
+    mbedtls_pk_init(&clientKey);
+    configured = false;
+}
+
+int TLSSessionClient::sendCallback(void* context, const unsigned char* data, size_t length) {
+    TLSSessionClient* self = static_cast<TLSSessionClient*>(context);
+    if (!self->socket.connected()) return MBEDTLS_ERR_NET_CONN_RESET;
+
+    size_t written = self->socket.write(data, length);
+    return written > 0 ? (int)written : MBEDTLS_ERR_SSL_WANT_WRITE;
+}
+
+int TLSSessionClient::recvCallback(void* context, unsigned char* data, size_t length) {
+    TLSSessionClient* self = static_cast<TLSSessionClient*>(context);
+    int pending = self->socket.available();
+    if (pending <= 0) {
+        return self->socket.connected() ? MBEDTLS_ERR_SSL_WANT_READ : MBEDTLS_ERR_NET_CONN_RESET;
+    }
+
+    int received = self->socket.read(data, length < (size_t)pending ? length : (size_t)pending);
+    return received > 0 ? received : MBEDTLS_ERR_SSL_WANT_READ;
+}
+
+// Only sees the chain; the CA check itself is left to mbedTLS
+int TLSSessionClient::verifyCallback(void* context, mbedtls_x509_crt*, int, uint32_t*) {
+    static_cast<TLSSessionClient*>(context)->certificateSeen = true;
+    return 0;
+}
+
+bool TLSSessionClient::sessionUsableFor(const char* host, uint16_t port, const char* name) const {
+    return sessionValid && port == sessionPort && strcmp(host, sessionHost) == 0 &&
+           strcmp(name, sessionName) == 0 && millis() - sessionSavedAt < TLS_SESSION_MAX_AGE_MS;
+}
+
+void TLSSessionClient::saveSession() {
+    mbedtls_ssl_session_free(&session);
+    mbedtls_ssl_session_init(&session);
+    sessionValid = mbedtls_ssl_get_session(&ssl, &session) == 0;
+    sessionSavedAt = millis();
+    strncpy(sessionHost, host, sizeof(sessionHost) - 1);
+    sessionHost[sizeof(sessionHost) - 1] = '\0';
+    strcpy(sessionName, verifyName);
+    sessionPort = port;
+}
+
+void TLSSessionClient::forgetSession() {
+    mbedtls_ssl_session_free(&session);
+    mbedtls_ssl_session_init(&session);
+    sessionValid = false;
+}
+
+int TLSSessionClient::connect(IPAddress ip, uint16_t port) {
+    char host[16];
+    snprintf(host, sizeof(host), "%u.%u.%u.%u", ip[0], ip[1], ip[2], ip[3]);
+    return connect(host, port);
+}
+
+int TLSSessionClient::connect(const char* host, uint16_t port) {
+    return connect(host, port, 0);
+}
+
+int TLSSessionClient::connect(const char* host, uint16_t port, int32_t timeoutMs) {
+    if (!begin(host, port, timeoutMs)) return 0;
+
+    int ret;
+    while (wouldBlock(ret = handshakeStep())) delay(1);
+    return ret == 0 ? 1 : 0;
+}
+
+// Offers the saved session first. mbedTLS falls back to a full handshake by
+// itself when the broker declines it; the retry is for brokers that abort on
+// a ticket they can no longer decrypt.
+bool TLSSessionClient::begin(const char* host, uint16_t port, int32_t timeoutMs, const char* serverName) {
+    stop();
+    if (host && (!serverName || !*serverName)) {
+        serverName = this->serverName && *this->serverName ? this->serverName : host;
+    }
+    if (!host || strlen(host) >= sizeof(this->host) || strlen(serverName) >= sizeof(verifyName) || !configure()) {
+        stats.failures++;
+        return false;
+    }
+
+    strcpy(this->host, host);
+    strcpy(verifyName, serverName);
+    this->port = port;
+    connectTimeoutMs = timeoutMs;
+    offered = sessionUsableFor(host, port, verifyName);
+    if (!offered && sessionValid) forgetSession();
+
+    handshakeStart = millis();
+    if (!openSocket()) {
+        stats.failures++;
+        return false;
+    }
+    handshaking = true;
+    return true;
+}
+
+bool TLSSessionClient::openSocket() {
+    bool up = connectTimeoutMs > 0 ? socket.connect(host, port, connectTimeoutMs) : socket.connect(host, port);
+    if (!up) return false;
+
+    mbedtls_ssl_session_reset(&ssl);
+    mbedtls_ssl_set_hostname(&ssl, verifyName);
+    if (offered) mbedtls_ssl_set_session(&ssl, &session);
+    certificateSeen = false;
+    return true;
+}
+
+int TLSSessionClient::handshakeStep() {
+    if (!handshaking) return open ? 0 : MBEDTLS_ERR_SSL_BAD_INPUT_DATA;
+
+    int ret;
+    if (millis() - handshakeStart > TLS_HANDSHAKE_TIMEOUT_MS) {
+        Serial.println("TLS: handshake timed out");
+        ret = MBEDTLS_ERR_SSL_TIMEOUT;
+    } else if (reconnectPending) {
+        // The socket connect is bounded by the caller's timeout; the
+        // handshake itself goes on in the next steps
+        reconnectPending = false;
+        ret = openSocket() ? MBEDTLS_ERR_SSL_WANT_WRITE : MBEDTLS_ERR_NET_CONNECT_FAILED;
+    } else {
+        // Returns as soon as a record has not arrived yet: the BIO never waits
+        ret = mbedtls_ssl_handshake(&ssl);
+        if (ret == 0 && handshakeOver(&ssl)) {
+            finishHandshake();
+            return 0;
+        }
+        if (ret == 0) ret = MBEDTLS_ERR_SSL_WANT_READ;
+        if (!wouldBlock(ret)) {
+            Serial.printf("TLS: handshake failed (-0x%04x, verify 0x%x)\n",
+                          (unsigned)-ret, (unsigned)mbedtls_ssl_get_verify_result(&ssl));
+            closeSocket();
+            if (offered) {
+                forgetSession();
+                offered = false;
+                reconnectPending = true;
+                stats.resumeFallbacks++;
+                return MBEDTLS_ERR_SSL_WANT_WRITE;
+            }
+        }
+    }
+
+    if (wouldBlock(ret)) return ret;
+
+    closeSocket();
+    handshaking = false;
+    reconnectPending = false;
+    stats.failures++;
+    return ret;
+}
+
+// A resumption that the broker accepted skips its certificate, so a session
+// offered and no chain seen means the abbreviated handshake
+void TLSSessionClient::finishHandshake() {
+    uint32_t elapsed = millis() - handshakeStart;
+    stats.lastHandshakeMs = elapsed;
+    if (offered && !certificateSeen) {
+        stats.resumedHandshakes++;
+        if (elapsed > stats.maxResumedMs) stats.maxResumedMs = elapsed;
+    } else {
+        stats.fullHandshakes++;
+        if (elapsed > stats.maxFullMs) stats.maxFullMs = elapsed;
+    }
+    // The broker may have issued a fresh ticket
+    saveSession();
+    handshaking = false;
+    open = true;
+}
+
+size_t TLSSessionClient::write(uint8_t b) {
+    return write(&b, 1);
+}
+
+size_t TLSSessionClient::write(const uint8_t* buf, size_t size) {
+    if (!open) return 0;
+
+    unsigned long start = millis();
+    size_t written = 0;
+    while (written < size) {
+        int ret = mbedtls_ssl_write(&ssl, buf + written, size - written);
+        if (ret > 0) {
+            written += ret;
+        } else if (!wouldBlock(ret) || millis() - start > TLS_WRITE_TIMEOUT_MS) {
+            closeSocket();
+            break;
+        }
+    }
+    return written;
+}
+
+int TLSSessionClient::available() {
+    if (!open) return peeked >= 0 ? 1 : 0;
+
+    // A zero-length read pulls in and decrypts whatever records have arrived
+    int ret = mbedtls_ssl_read(&ssl, nullptr, 0);
+    if (ret < 0 && !wouldBlock(ret)) {
+        closeSocket();
+        return peeked >= 0 ? 1 : 0;
+    }
+    return mbedtls_ssl_get_bytes_avail(&ssl) + (peeked >= 0 ? 1 : 0);
+}
+
+int TLSSessionClient::read() {
+    uint8_t b;
+    return read(&b, 1) == 1 ? b : -1;
+}
+
+int TLSSessionClient::read(uint8_t* buf, size_t size) {
+    if (size == 0) return 0;
+
+    size_t offset = 0;
+    if (peeked >= 0) {
+        buf[offset++] = peeked;
+        peeked = -1;
+        if (offset == size || !open) return offset;
+    } else if (!open) {
+        return -1;
+    }
+
+    int ret = mbedtls_ssl_read(&ssl, buf + offset, size - offset);
+    if (ret > 0) return offset + ret;
+    if (!wouldBlock(ret)) closeSocket();
+    return offset > 0 ? (int)offset : -1;
+}
+
+int TLSSessionClient::peek() {
+    if (peeked < 0) {
+        uint8_t b;
+        if (read(&b, 1) == 1) peeked = b;
+    }
+    return peeked;
+}
+
+// WiFiClient::flush() discards unread input, which would desynchronise the
+// record layer; writes are already pushed out by write()
+void TLSSessionClient::flush() {
+}
+
+void TLSSessionClient::closeSocket() {
+    socket.stop();
+    open = false;
+}
+
+// The saved session is kept, so the next connect can resume it
+void TLSSessionClient::stop() {
+    if (open) mbedtls_ssl_close_notify(&ssl);
+    closeSocket();
+    handshaking = false;
+    reconnectPending = false;
+    peeked = -1;
+}
+
+uint8_t TLSSessionClient::connected() {
+    if (open && !socket.connected()) open = false;
+    return open || peeked >= 0 || mbedtls_ssl_get_bytes_avail(&ssl) > 0;
+}
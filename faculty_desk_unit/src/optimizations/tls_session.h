@@ -0,0 +1,139 @@
+/**
+ * Resumable TLS transport for ConsultEase Faculty Desk Unit
+ * An Arduino Client over WiFiClient that keeps its mbedTLS state between
+ * connections: certificates are parsed once from the PEM strings in flash,
+ * the SSL context and its record buffers are reset rather than reallocated,
+ * and the last session (ID or ticket) is offered on the next connect. A drop
+ * on flaky WiFi then costs an abbreviated handshake - no certificate chain,
+ * no key exchange - instead of a full one.
+ *
+ * The handshake can be stepped: begin() opens the socket and handshakeStep()
+ * runs as far as the bytes on hand allow, so a caller with other work never
+ * waits on the broker's round trips.
+ */
+
+#ifndef TLS_SESSION_H
+#define TLS_SESSION_H
+
+#include <Arduino.h>
+#include <WiFi.h>
+#include <mbedtls/ssl.h>
+#include <mbedtls/x509_crt.h>
+#include <mbedtls/pk.h>
+
+#define TLS_HANDSHAKE_TIMEOUT_MS 10000
+#define TLS_WRITE_TIMEOUT_MS 5000
+// Brokers usually expire tickets after a couple of hours; an older session
+// would only cost a wasted round trip
+#define TLS_SESSION_MAX_AGE_MS 7200000UL
+#define TLS_SERVER_NAME_LENGTH 64
+
+struct TLSSessionStats {
+    uint32_t fullHandshakes;
+    uint32_t resumedHandshakes;
+    uint32_t resumeFallbacks;     // Offered session broke the handshake; retried in full
+    uint32_t failures;
+    uint32_t lastHandshakeMs;
+    uint32_t maxFullMs;
+    uint32_t maxResumedMs;
+};
+
+class TLSSessionClient : public Client {
+private:
+    WiFiClient socket;
+    mbedtls_ssl_context ssl;
+    mbedtls_ssl_config sslConfig;
+    mbedtls_x509_crt caChain;
+    mbedtls_x509_crt clientChain;
+    mbedtls_pk_context clientKey;
+    // PEM in flash; only the pointers are kept
+    const char* caCert;
+    const char* clientCert;
+    const char* clientKeyPem;
+    const char* serverName;       // Overrides the host for certificate checks
+    bool configured;
+    bool open;                    // Handshake finished and not stopped since
+    bool handshaking;             // Between begin() and the end of the handshake
+    int peeked;                   // -1 when empty
+
+    // The handshake in progress
+    char host[TLS_SERVER_NAME_LENGTH];
+    char verifyName[TLS_SERVER_NAME_LENGTH];  // The certificate must be issued for this
+    uint16_t port;
+    int32_t connectTimeoutMs;
+    unsigned long handshakeStart;
+    bool offered;                 // The saved session went out in the client hello
+    bool certificateSeen;         // The broker sent its chain, so it was not a resumption
+    bool reconnectPending;        // Retrying in full after the broker refused the session
+
+    mbedtls_ssl_session session;
+    bool sessionValid;
+    unsigned long sessionSavedAt;
+    char sessionHost[TLS_SERVER_NAME_LENGTH];
+    char sessionName[TLS_SERVER_NAME_LENGTH];
+    uint16_t sessionPort;
+
+    TLSSessionStats stats;
+
+    static int sendCallback(void* context, const unsigned char* data, size_t length);
+    static int recvCallback(void* context, unsigned char* data, size_t length);
+    static int verifyCallback(void* context, mbedtls_x509_crt* certificate, int depth, uint32_t* flags);
+
+    bool configure();
+    void release();
+    bool sessionUsableFor(const char* host, uint16_t port, const char* name) const;
+    bool openSocket();
+    void finishHandshake();
+    void saveSession();
+    void closeSocket();
+
+public:
+    TLSSessionClient();
+    ~TLSSessionClient();
+
+    // PEM strings, NUL-terminated, that outlive the client (string literals).
+    // The CA is required; cert and key are for mutual TLS and may be null or "".
+    bool setCertificates(const char* ca, const char* cert = nullptr, const char* key = nullptr);
+    // Name the broker certificate was issued for, when connecting by IP.
+    // A resumed session skips certificate checks, so this drops the session.
+    void setServerName(const char* name);
+
+    // Blocking, for Client users; they wait out the whole handshake
+    int connect(IPAddress ip, uint16_t port) override;
+    int connect(const char* host, uint16_t port) override;
+    // Bounds the TCP connect; the handshake keeps TLS_HANDSHAKE_TIMEOUT_MS
+    int connect(const char* host, uint16_t port, int32_t timeoutMs);
+
+    // Opens the TCP connection (timeoutMs bounds it, 0 = WiFiClient default)
+    // and queues the client hello. serverName, when set, replaces the one
+    // from setServerName() for this connection only; a session is only
+    // resumed under the name it was verified for. False when the socket did
+    // not open.
+    bool begin(const char* host, uint16_t port, int32_t timeoutMs = 0, const char* serverName = nullptr);
+    // Runs the handshake until it needs bytes that have not arrived.
+    // 0: open. MBEDTLS_ERR_SSL_WANT_READ / WANT_WRITE: call again later.
+    // Anything else: failed, the socket is closed. Fails on its own once
+    // TLS_HANDSHAKE_TIMEOUT_MS has passed since begin().
+    int handshakeStep();
+    bool isHandshaking() const { return handshaking; }
+    size_t write(uint8_t b) override;
+    size_t write(const uint8_t* buf, size_t size) override;
+    int available() override;
+    int read() override;
+    int read(uint8_t* buf, size_t size) override;
+    int peek() override;
+    void flush() override;
+    void stop() override;
+    uint8_t connected() override;
+    operator bool() override { return connected(); }
+    // The TCP socket, for select(); their bytes may already sit decrypted in
+    // the TLS context, so check available() before waiting on it
+    int fd() const { return socket.fd(); }
+
+    // The next connect does a full handshake
+    void forgetSession();
+    bool hasSession() const { return sessionValid; }
+    const TLSSessionStats& getStats() const { return stats; }
+};
+
+#endif // TLS_SESSION_H
@@ -0,0 +1,230 @@
+/**
+ * Unit identity implementation for ConsultEase Faculty Desk Unit
+ */
+
+#include "unit_config.h"
+#include "beacon_registry.h"
+#include "json_stream.h"
+#include <Preferences.h>
+#include <string.h>
+#include <stdio.h>
+
+#define UNIT_RECORD_KEY "identity"
+#define UNIT_RECORD_MAGIC 0x55494431UL
+#define UNIT_ID_DIGITS 5                 // Widest faculty ID, 65535
+#define UNIT_CHIP_DIGITS 12
+
+namespace {
+
+struct UnitRecord {
+    uint32_t magic;
+    UnitIdentity identity;
+    uint32_t check;
+};
+
+// Own-unit topics by UnitTopic; the legacy ones take the leaf after them
+constexpr const char* TOPIC_LEAVES[UNIT_TOPIC_LEGACY_STATUS] = {
+    "status", "messages", "heartbeat", "metrics", "responses", "wire_format", "beacons", "scan_policy"
+};
+constexpr const char* LEGACY_LEAVES[UNIT_TOPIC_PROVISION - UNIT_TOPIC_LEGACY_STATUS] = { "status", "messages" };
+
+constexpr size_t longer(size_t a, size_t b) { return a > b ? a : b; }
+
+constexpr size_t longestLeaf(const char* const* leaves, int count) {
+    return count == 0 ? 0 : longer(UnitConfig::textLength(leaves[count - 1]), longestLeaf(leaves, count - 1));
+}
+
+// The layout is fixed at compile time, so every topic it can produce is
+// known to fit before any unit is flashed
+static_assert(UnitConfig::textLength(UNIT_TOPIC_PREFIX) + UNIT_ID_DIGITS + 1 +
+              longestLeaf(TOPIC_LEAVES, UNIT_TOPIC_LEGACY_STATUS) < UNIT_TOPIC_SIZE,
+              "UNIT_TOPIC_SIZE too small for the faculty topics");
+static_assert(UnitConfig::textLength(UNIT_LEGACY_PREFIX) + UNIT_ID_DIGITS + 1 +
+              longestLeaf(LEGACY_LEAVES, UNIT_TOPIC_PROVISION - UNIT_TOPIC_LEGACY_STATUS) < UNIT_TOPIC_SIZE,
+              "UNIT_TOPIC_SIZE too small for the legacy topics");
+static_assert(UnitConfig::textLength(UNIT_PROVISION_PREFIX) + UNIT_CHIP_DIGITS < UNIT_TOPIC_SIZE,
+              "UNIT_TOPIC_SIZE too small for the provisioning topic");
+static_assert(UnitConfig::textLength(UNIT_CLIENT_ID_PREFIX) + UNIT_ID_DIGITS < UNIT_CLIENT_ID_SIZE,
+              "UNIT_CLIENT_ID_SIZE too small");
+
+uint32_t recordCheck(const UnitRecord& record) {
+    const uint8_t* bytes = (const uint8_t*)&record;
+    uint32_t hash = 2166136261UL;
+    for (size_t i = 0; i < offsetof(UnitRecord, check); i++) {
+        hash = (hash ^ bytes[i]) * 16777619UL;
+    }
+    return hash;
+}
+
+// Into a zeroed field, up to its terminator
+void copyText(char* to, const char* from) {
+    memcpy(to, from, strnlen(from, UNIT_TEXT_SIZE - 1));
+}
+
+// Zeroed first: padding and the bytes after each terminator are hashed too
+void copyIdentity(UnitIdentity& to, const UnitIdentity& from) {
+    memset(&to, 0, sizeof(to));
+    to.facultyId = from.facultyId;
+    to.beaconAddress = from.beaconAddress;
+    copyText(to.name, from.name);
+    copyText(to.department, from.department);
+}
+
+bool loadRecord(UnitIdentity& identity) {
+    UnitRecord record;
+    Preferences prefs;
+    bool loaded = prefs.begin(UNIT_CONFIG_NAMESPACE, true) &&
+                  prefs.getBytes(UNIT_RECORD_KEY, &record, sizeof(record)) == sizeof(record) &&
+                  record.magic == UNIT_RECORD_MAGIC && record.check == recordCheck(record);
+    prefs.end();
+    if (!loaded) return false;
+
+    // Terminators are not trusted, even behind a good check
+    record.identity.name[UNIT_TEXT_SIZE - 1] = '\0';
+    record.identity.department[UNIT_TEXT_SIZE - 1] = '\0';
+    if (!UnitProfile::validate(record.identity)) return false;
+    copyIdentity(identity, record.identity);
+    return true;
+}
+
+struct ProvisioningContext {
+    UnitIdentity* identity;
+    bool failed;
+};
+
+// The hash picks the case and the key bytes confirm it
+bool collectProvisioning(const JsonToken& token, void* context) {
+    ProvisioningContext& update = *static_cast<ProvisioningContext*>(context);
+    if (token.depth != 1) return true;
+
+    UnitIdentity& identity = *update.identity;
+    switch (token.keyHash) {
+        case JsonStream::keyHash("faculty_id"): {
+            if (!JsonStream::keyEquals(token, "faculty_id")) break;
+            long id = token.type == JSON_VALUE_NUMBER ? JsonStream::toLong(token.value, token.valueLength) : 0;
+            if (id <= 0 || id > 0xFFFF) update.failed = true;
+            else identity.facultyId = id;
+            break;
+        }
+        case JsonStream::keyHash("faculty_name"):
+            if (!JsonStream::keyEquals(token, "faculty_name")) break;
+            if (token.type != JSON_VALUE_STRING) update.failed = true;
+            else JsonStream::copyString(token.value, token.valueLength, identity.name, sizeof(identity.name));
+            break;
+        case JsonStream::keyHash("department"):
+            if (!JsonStream::keyEquals(token, "department")) break;
+            if (token.type != JSON_VALUE_STRING) update.failed = true;
+            else JsonStream::copyString(token.value, token.valueLength, identity.department, sizeof(identity.department));
+            break;
+        case JsonStream::keyHash("beacon_mac"):
+            if (!JsonStream::keyEquals(token, "beacon_mac")) break;
+            if (token.type != JSON_VALUE_STRING ||
+                !BeaconRegistry::parseAddress(token.value, token.valueLength, identity.beaconAddress)) {
+                update.failed = true;
+            }
+            break;
+        default:
+            break;
+    }
+    return !update.failed;
+}
+
+} // namespace
+
+UnitProfile::UnitProfile() : provisioned(false) {
+    memset(&identity, 0, sizeof(identity));
+    memset(topics, 0, sizeof(topics));
+    memset(topicLengths, 0, sizeof(topicLengths));
+    clientId[0] = '\0';
+}
+
+void UnitProfile::begin(const UnitIdentity& defaults, uint64_t chipId) {
+    provisioned = loadRecord(identity);
+    if (!provisioned) copyIdentity(identity, defaults);
+    buildNames(chipId);
+}
+
+void UnitProfile::buildNames(uint64_t chipId) {
+    for (int i = 0; i < UNIT_TOPIC_LEGACY_STATUS; i++) {
+        formatTopic(identity.facultyId, (UnitTopic)i, topics[i], UNIT_TOPIC_SIZE);
+    }
+    for (int i = UNIT_TOPIC_LEGACY_STATUS; i < UNIT_TOPIC_PROVISION; i++) {
+        snprintf(topics[i], UNIT_TOPIC_SIZE, UNIT_LEGACY_PREFIX "%u/%s", identity.facultyId,
+                 LEGACY_LEAVES[i - UNIT_TOPIC_LEGACY_STATUS]);
+    }
+
+    // Base MAC in the order esptool prints it; getEfuseMac() has octet 0 lowest
+    char* chip = topics[UNIT_TOPIC_PROVISION];
+    size_t used = snprintf(chip, UNIT_TOPIC_SIZE, UNIT_PROVISION_PREFIX);
+    for (int i = 0; i < 6; i++) {
+        used += snprintf(chip + used, UNIT_TOPIC_SIZE - used, "%02X", (unsigned)((chipId >> (8 * i)) & 0xFF));
+    }
+
+    for (int i = 0; i < UNIT_TOPIC_COUNT; i++) {
+        topicLengths[i] = strlen(topics[i]);
+    }
+    snprintf(clientId, sizeof(clientId), UNIT_CLIENT_ID_PREFIX "%u", identity.facultyId);
+}
+
+// Lengths differ for most topics, so usually only one memcmp runs
+UnitTopic UnitProfile::matchTopic(const char* topic) const {
+    size_t length = strlen(topic);
+    for (int i = 0; i < UNIT_TOPIC_COUNT; i++) {
+        if (topicLengths[i] == length && memcmp(topics[i], topic, length) == 0) return (UnitTopic)i;
+    }
+    return UNIT_TOPIC_NONE;
+}
+
+bool UnitProfile::formatTopic(uint16_t facultyId, UnitTopic topic, char* output, size_t outputSize) {
+    if (topic >= UNIT_TOPIC_LEGACY_STATUS || !output) return false;
+    int written = snprintf(output, outputSize, UNIT_TOPIC_PREFIX "%u/%s", facultyId, TOPIC_LEAVES[topic]);
+    return written > 0 && (size_t)written < outputSize;
+}
+
+bool UnitProfile::parseProvisioning(const char* json, size_t length, UnitIdentity& identity) {
+    UnitIdentity candidate;
+    copyIdentity(candidate, identity);
+
+    ProvisioningContext update;
+    update.identity = &candidate;
+    update.failed = false;
+    if (!JsonStream::parse(json, length, collectProvisioning, &update) || update.failed || !validate(candidate)) {
+        return false;
+    }
+    copyIdentity(identity, candidate);
+    return true;
+}
+
+bool UnitProfile::validate(const UnitIdentity& candidate) {
+    return candidate.facultyId != 0 && candidate.beaconAddress != 0 &&
+           candidate.beaconAddress <= 0xFFFFFFFFFFFFULL && candidate.name[0] != '\0';
+}
+
+bool UnitProfile::sameIdentity(const UnitIdentity& a, const UnitIdentity& b) {
+    return a.facultyId == b.facultyId && a.beaconAddress == b.beaconAddress &&
+           strncmp(a.name, b.name, UNIT_TEXT_SIZE) == 0 &&
+           strncmp(a.department, b.department, UNIT_TEXT_SIZE) == 0;
+}
+
+bool UnitProfile::store(const UnitIdentity& candidate) {
+    if (!validate(candidate)) return false;
+
+    UnitRecord record;
+    memset(&record, 0, sizeof(record));
+    record.magic = UNIT_RECORD_MAGIC;
+    copyIdentity(record.identity, candidate);
+    record.check = recordCheck(record);
+
+    Preferences prefs;
+    bool stored = prefs.begin(UNIT_CONFIG_NAMESPACE, false) &&
+                  prefs.putBytes(UNIT_RECORD_KEY, &record, sizeof(record)) == sizeof(record);
+    prefs.end();
+    return stored;
+}
+
+bool UnitProfile::erase() {
+    Preferences prefs;
+    bool erased = prefs.begin(UNIT_CONFIG_NAMESPACE, false) && prefs.remove(UNIT_RECORD_KEY);
+    prefs.end();
+    return erased;
+}
@@ -0,0 +1,122 @@
+/**
+ * Unit identity for ConsultEase Faculty Desk Unit
+ * Which faculty member a desk unit serves: ID, name, department and beacon.
+ * config.h supplies the defaults, checked by the compiler. A provisioning
+ * record in NVS overrides them, so one firmware image fits every unit.
+ * Topics and the MQTT client ID are assembled once from the identity, and
+ * incoming topics are matched by length and bytes instead of per-message
+ * formatting. The profile is read-only after begin(), so any task may use it.
+ */
+
+#ifndef UNIT_CONFIG_H
+#define UNIT_CONFIG_H
+
+#include <Arduino.h>
+
+#define UNIT_CONFIG_NAMESPACE "unit_config"
+
+// Topic layout shared by the fleet; <id> is the faculty ID in decimal
+#define UNIT_TOPIC_PREFIX "consultease/faculty/"         // consultease/faculty/<id>/<leaf>
+#define UNIT_LEGACY_PREFIX "faculty/"                    // faculty/<id>/<leaf>
+#define UNIT_PROVISION_PREFIX "consultease/provision/"   // consultease/provision/<chip MAC>
+#define UNIT_CLIENT_ID_PREFIX "Faculty_Desk_Unit_"       // Unique per faculty, or units evict each other
+
+#define UNIT_TEXT_SIZE 48            // Faculty name and department, terminator included
+#define UNIT_TOPIC_SIZE 64           // Same as the offline queue and network request topics
+#define UNIT_CLIENT_ID_SIZE 32
+
+enum UnitTopic : uint8_t {
+    UNIT_TOPIC_STATUS,
+    UNIT_TOPIC_MESSAGES,
+    UNIT_TOPIC_HEARTBEAT,
+    UNIT_TOPIC_METRICS,              // Hot-path latency percentiles
+    UNIT_TOPIC_RESPONSES,
+    UNIT_TOPIC_WIRE_FORMAT,          // Retained per-topic encoding choice
+    UNIT_TOPIC_BEACONS,              // Retained colleague beacons, {"MAC":faculty_id}
+    UNIT_TOPIC_SCAN_POLICY,          // Retained scan timing overrides
+    UNIT_TOPIC_LEGACY_STATUS,
+    UNIT_TOPIC_LEGACY_MESSAGES,
+    UNIT_TOPIC_PROVISION,            // Retained identity for this chip
+    UNIT_TOPIC_COUNT,
+    UNIT_TOPIC_NONE = 0xFF
+};
+
+struct UnitIdentity {
+    uint16_t facultyId;
+    uint64_t beaconAddress;          // BeaconRegistry form, first octet highest
+    char name[UNIT_TEXT_SIZE];
+    char department[UNIT_TEXT_SIZE];
+};
+
+namespace UnitConfig {
+    constexpr size_t textLength(const char* text) {
+        return *text ? 1 + textLength(text + 1) : 0;
+    }
+
+    constexpr int hexDigit(char c) {
+        return c >= '0' && c <= '9' ? c - '0'
+             : c >= 'a' && c <= 'f' ? c - 'a' + 10
+             : c >= 'A' && c <= 'F' ? c - 'A' + 10
+             : -1;
+    }
+
+    // "AA:BB:CC:DD:EE:FF" (either case). For static_assert on config.h, so a
+    // mistyped beacon fails the build instead of leaving the unit blind.
+    constexpr bool isAddress(const char* text, int i = 0) {
+        return i == 17 ? text[i] == '\0'
+             : i % 3 == 2 ? text[i] == ':' && isAddress(text, i + 1)
+             : hexDigit(text[i]) >= 0 && isAddress(text, i + 1);
+    }
+
+    // Same integer as BeaconRegistry::parseAddress; text must pass isAddress()
+    constexpr uint64_t addressValue(const char* text, int i = 0, uint64_t value = 0) {
+        return i == 17 ? value
+             : i % 3 == 2 ? addressValue(text, i + 1, value)
+             : addressValue(text, i + 1, (value << 4) | (uint64_t)hexDigit(text[i]));
+    }
+}
+
+class UnitProfile {
+private:
+    UnitIdentity identity;
+    bool provisioned;
+    char topics[UNIT_TOPIC_COUNT][UNIT_TOPIC_SIZE];
+    uint8_t topicLengths[UNIT_TOPIC_COUNT];
+    char clientId[UNIT_CLIENT_ID_SIZE];
+
+    void buildNames(uint64_t chipId);
+
+public:
+    UnitProfile();
+
+    // Takes the NVS record when there is a valid one, the defaults otherwise.
+    // chipId is ESP.getEfuseMac() and names this chip's provisioning topic.
+    void begin(const UnitIdentity& defaults, uint64_t chipId);
+
+    const UnitIdentity& get() const { return identity; }
+    uint16_t getFacultyId() const { return identity.facultyId; }
+    bool isProvisioned() const { return provisioned; }
+
+    const char* getTopic(UnitTopic topic) const { return topics[topic]; }
+    const char* getClientId() const { return clientId; }
+
+    // Which of this unit's topics it is, or UNIT_TOPIC_NONE
+    UnitTopic matchTopic(const char* topic) const;
+
+    // Another faculty member's topic in the same layout (tracked colleagues)
+    static bool formatTopic(uint16_t facultyId, UnitTopic topic, char* output, size_t outputSize);
+
+    // Applies a provisioning payload over identity; members left out keep
+    // their value. False when malformed or the result is not valid, e.g.
+    // {"faculty_id":3,"faculty_name":"Prof. Robert Chen",
+    //  "department":"Computer Science","beacon_mac":"AA:BB:CC:DD:EE:03"}
+    static bool parseProvisioning(const char* json, size_t length, UnitIdentity& identity);
+    static bool validate(const UnitIdentity& candidate);
+    static bool sameIdentity(const UnitIdentity& a, const UnitIdentity& b);
+
+    // The NVS record; a stored identity takes effect at the next begin()
+    static bool store(const UnitIdentity& candidate);
+    static bool erase();
+};
+
+#endif // UNIT_CONFIG_H
@@ -0,0 +1,188 @@
+/**
+ * Wire format encoding implementation for ConsultEase Faculty Desk Unit
+ */
+
+#include "wire_format.h"
+#include <string.h>
+#include <stdio.h>
+
+// CBOR major types
+#define CBOR_UNSIGNED 0
+#define CBOR_NEGATIVE 1
+#define CBOR_TEXT 3
+#define CBOR_FALSE 0xF4
+#define CBOR_TRUE 0xF5
+#define CBOR_BREAK 0xFF
+
+WireWriter::WireWriter(WireFormat format, uint8_t* buffer, size_t capacity)
+    : format(format), buffer(buffer), capacity(capacity), used(0), overflow(false), firstMember(true) {
+    if (capacity > 0) buffer[0] = '\0';
+}
+
+// One byte is always held back so JSON output can be NUL-terminated
+void WireWriter::put(uint8_t byte) {
+    if (used + 1 >= capacity) {
+        overflow = true;
+        return;
+    }
+    buffer[used++] = byte;
+    if (format == WIRE_FORMAT_JSON) buffer[used] = '\0';
+}
+
+void WireWriter::put(const void* data, size_t length) {
+    if (used + length >= capacity) {
+        overflow = true;
+        return;
+    }
+    memcpy(buffer + used, data, length);
+    used += length;
+    if (format == WIRE_FORMAT_JSON) buffer[used] = '\0';
+}
+
+// Shortest head encoding for a major type and argument
+void WireWriter::putCborHead(uint8_t majorType, uint64_t value) {
+    uint8_t head[9];
+    size_t length;
+    uint8_t type = majorType << 5;
+
+    if (value < 24) {
+        head[0] = type | value;
+        length = 1;
+    } else if (value <= 0xFF) {
+        head[0] = type | 24;
+        head[1] = value;
+        length = 2;
+    } else if (value <= 0xFFFF) {
+        head[0] = type | 25;
+        head[1] = value >> 8;
+        head[2] = value;
+        length = 3;
+    } else if (value <= 0xFFFFFFFFULL) {
+        head[0] = type | 26;
+        head[1] = value >> 24;
+        head[2] = value >> 16;
+        head[3] = value >> 8;
+        head[4] = value;
+        length = 5;
+    } else {
+        head[0] = type | 27;
+        for (int i = 0; i < 8; i++) {
+            head[1 + i] = value >> (56 - 8 * i);
+        }
+        length = 9;
+    }
+    put(head, length);
+}
+
+void WireWriter::putJsonString(const char* text) {
+    put('"');
+    for (const char* p = text; *p; p++) {
+        char c = *p;
+        if (c == '"' || c == '\\') {
+            put('\\');
+            put(c);
+        } else if (c == '\n') {
+            put("\\n", 2);
+        } else if (c == '\r') {
+            put("\\r", 2);
+        } else if (c == '\t') {
+            put("\\t", 2);
+        } else if ((uint8_t)c < 0x20) {
+            char escaped[7];
+            snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+            put(escaped, 6);
+        } else {
+            put(c);
+        }
+    }
+    put('"');
+}
+
+void WireWriter::beginMember(const char* key) {
+    if (format == WIRE_FORMAT_CBOR) {
+        size_t keyLength = strlen(key);
+        putCborHead(CBOR_TEXT, keyLength);
+        put(key, keyLength);
+        return;
+    }
+
+    if (!firstMember) put(',');
+    firstMember = false;
+    putJsonString(key);
+    put(':');
+}
+
+// Maps are indefinite-length so members can be added conditionally
+void WireWriter::beginObject() {
+    firstMember = true;
+    if (format == WIRE_FORMAT_CBOR) {
+        put(WIRE_CBOR_MAP_START);
+    } else {
+        put('{');
+    }
+}
+
+void WireWriter::endObject() {
+    put(format == WIRE_FORMAT_CBOR ? CBOR_BREAK : '}');
+}
+
+void WireWriter::addUInt(const char* key, uint32_t value) {
+    beginMember(key);
+    if (format == WIRE_FORMAT_CBOR) {
+        putCborHead(CBOR_UNSIGNED, value);
+    } else {
+        char digits[12];
+        int length = snprintf(digits, sizeof(digits), "%lu", (unsigned long)value);
+        put(digits, length);
+    }
+}
+
+// Epoch milliseconds and other values past 32 bits
+void WireWriter::addUInt64(const char* key, uint64_t value) {
+    beginMember(key);
+    if (format == WIRE_FORMAT_CBOR) {
+        putCborHead(CBOR_UNSIGNED, value);
+    } else {
+        char digits[21];
+        int length = snprintf(digits, sizeof(digits), "%llu", (unsigned long long)value);
+        put(digits, length);
+    }
+}
+
+void WireWriter::addInt(const char* key, int32_t value) {
+    if (value >= 0) {
+        addUInt(key, value);
+        return;
+    }
+
+    beginMember(key);
+    if (format == WIRE_FORMAT_CBOR) {
+        putCborHead(CBOR_NEGATIVE, (uint32_t)(-(value + 1)));
+    } else {
+        char digits[12];
+        int length = snprintf(digits, sizeof(digits), "%ld", (long)value);
+        put(digits, length);
+    }
+}
+
+void WireWriter::addBool(const char* key, bool value) {
+    beginMember(key);
+    if (format == WIRE_FORMAT_CBOR) {
+        put(value ? CBOR_TRUE : CBOR_FALSE);
+    } else if (value) {
+        put("true", 4);
+    } else {
+        put("false", 5);
+    }
+}
+
+void WireWriter::addString(const char* key, const char* value) {
+    beginMember(key);
+    if (format == WIRE_FORMAT_CBOR) {
+        size_t valueLength = strlen(value);
+        putCborHead(CBOR_TEXT, valueLength);
+        put(value, valueLength);
+    } else {
+        putJsonString(value);
+    }
+}
@@ -0,0 +1,56 @@
+/**
+ * Wire format encoding for ConsultEase Faculty Desk Unit
+ * Writes flat key/value payloads as JSON or CBOR (RFC 8949) into a
+ * caller-supplied buffer, so publishers never build Strings on the heap
+ */
+
+#ifndef WIRE_FORMAT_H
+#define WIRE_FORMAT_H
+
+#include <Arduino.h>
+
+enum WireFormat {
+    WIRE_FORMAT_JSON,
+    WIRE_FORMAT_CBOR
+};
+
+// Content type hint a subscriber can use: CBOR payloads always start with
+// an indefinite-length map (0xBF), JSON ones with '{'
+#define WIRE_CBOR_MAP_START 0xBF
+
+class WireWriter {
+private:
+    WireFormat format;
+    uint8_t* buffer;
+    size_t capacity;
+    size_t used;
+    bool overflow;
+    bool firstMember;
+
+    void put(uint8_t byte);
+    void put(const void* data, size_t length);
+    void putCborHead(uint8_t majorType, uint64_t value);
+    void putJsonString(const char* text);
+    void beginMember(const char* key);
+
+public:
+    WireWriter(WireFormat format, uint8_t* buffer, size_t capacity);
+
+    void beginObject();
+    void endObject();
+    void addUInt(const char* key, uint32_t value);
+    void addUInt64(const char* key, uint64_t value);
+    void addInt(const char* key, int32_t value);
+    void addBool(const char* key, bool value);
+    void addString(const char* key, const char* value);
+
+    WireFormat getFormat() const { return format; }
+    const uint8_t* data() const { return buffer; }
+    size_t length() const { return used; }
+    bool ok() const { return !overflow; }
+
+    // JSON output is kept NUL-terminated for the string-based publish path
+    const char* c_str() const { return (const char*)buffer; }
+};
+
+#endif // WIRE_FORMAT_H